@@ -0,0 +1,21 @@
+# - Find LMDB
+# Find the native liblmdb includes and library.
+# Once done this will define
+#
+#  LMDB_INCLUDE_DIRS     - where to find lmdb.h, etc.
+#  LMDB_LIBRARIES        - List of libraries when using liblmdb.
+#  LMDB_FOUND            - True if liblmdb found.
+#
+
+FIND_LIBRARY(LMDB_LIBRARY NAMES lmdb liblmdb HINTS ${LMDB_ROOT_DIR}/lib)
+find_path(LMDB_INCLUDE_DIR NAMES lmdb.h HINTS ${LMDB_ROOT_DIR}/include)
+
+# handle the QUIETLY and REQUIRED arguments and set LMDB_FOUND to TRUE if
+# all listed variables are TRUE
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LMDB REQUIRED_VARS LMDB_LIBRARY LMDB_INCLUDE_DIR)
+
+set(LMDB_INCLUDE_DIRS ${LMDB_INCLUDE_DIR})
+set(LMDB_LIBRARIES ${LMDB_LIBRARY})
+
+MARK_AS_ADVANCED(LMDB_LIBRARY LMDB_INCLUDE_DIR)
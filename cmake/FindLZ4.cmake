@@ -0,0 +1,21 @@
+# - Find LZ4
+# Find the native liblz4 includes and library.
+# Once done this will define
+#
+#  LZ4_INCLUDE_DIRS      - where to find lz4.h, etc.
+#  LZ4_LIBRARIES         - List of libraries when using liblz4.
+#  LZ4_FOUND             - True if liblz4 found.
+#
+
+FIND_LIBRARY(LZ4_LIBRARY NAMES lz4 liblz4 HINTS ${LZ4_ROOT_DIR}/lib)
+find_path(LZ4_INCLUDE_DIR NAMES lz4.h HINTS ${LZ4_ROOT_DIR}/include)
+
+# handle the QUIETLY and REQUIRED arguments and set LZ4_FOUND to TRUE if
+# all listed variables are TRUE
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LZ4 REQUIRED_VARS LZ4_LIBRARY LZ4_INCLUDE_DIR)
+
+set(LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+
+MARK_AS_ADVANCED(LZ4_LIBRARY LZ4_INCLUDE_DIR)
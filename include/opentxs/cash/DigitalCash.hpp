@@ -58,6 +58,8 @@
 // Implementations for Chaum and Brands are circulating online. They could all
 // be easily added here as options for Open-Transactions.
 
+#include <cstdint>
+#include <mutex>
 #include <string>
 
 namespace opentxs
@@ -65,9 +67,13 @@ namespace opentxs
 
 #ifdef OT_CASH_USING_LUCRE
 
+// Tokens can be verified on several threads at once, so the dumper is set up
+// by the first LucreDumper alive and cleaned up by the last.
 class LucreDumper
 {
-    std::string m_str_dumpfile;
+    static std::mutex s_lock;
+    static int32_t s_users;
+    static std::string s_str_dumpfile;
 
 public:
     LucreDumper();
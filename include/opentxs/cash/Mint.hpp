@@ -41,6 +41,7 @@
 
 #include <opentxs/core/Contract.hpp>
 #include <map>
+#include <vector>
 #include <cstdint>
 #include <ctime>
 
@@ -63,6 +64,17 @@ protected:
 
     void InitMint();
 
+    // Generates the key pair for one denomination without touching the mint,
+    // so several can be generated at once. The private half comes back
+    // sealed to theNotary.
+    virtual bool GenerateDenomination(Nym& theNotary, int32_t nPrimeLength,
+                                      OTASCIIArmor& thePublic,
+                                      OTASCIIArmor& thePrivate) = 0;
+    // Adds a generated key pair to the mint, under lDenomination.
+    bool InsertDenomination(Nym& theNotary, int64_t lDenomination,
+                            const OTASCIIArmor& thePublic,
+                            const OTASCIIArmor& thePrivate);
+
     mapOfArmor m_mapPrivate; // An ENVELOPE. You need to pass the Pseudonym to
                              // every method that uses this. Private.
     // Then you have to set it into an envelope and then open it using the Nym.
@@ -211,6 +223,16 @@ public:
                                 int64_t nDenom5 = 0, int64_t nDenom6 = 0,
                                 int64_t nDenom7 = 0, int64_t nDenom8 = 0,
                                 int64_t nDenom9 = 0, int64_t nDenom10 = 0);
+    // The same, for any list of denominations. Their keys are generated
+    // concurrently, on up to nThreads workers (0 means one per core.)
+    // Returns false unless every denomination was added.
+    EXPORT bool GenerateNewMint(int32_t nSeries, time64_t VALID_FROM,
+                                time64_t VALID_TO, time64_t MINT_EXPIRATION,
+                                const Identifier& theInstrumentDefinitionID,
+                                const Identifier& theNotaryID, Nym& theNotary,
+                                const std::vector<int64_t>& denominations,
+                                int32_t nPrimeLength = 1024,
+                                int32_t nThreads = 0);
 
     // step 2: (coin request is in Token)
 
@@ -223,6 +245,16 @@ public:
     // Lucre step 5: mint verifies token when it is redeemed by merchant.
     EXPORT virtual bool VerifyToken(Nym& theNotary, String& theCleartextToken,
                                     int64_t lDenomination) = 0;
+
+    // Step 5 split in two, so that the coins of one deposit can be verified
+    // on several threads. OpenPrivate decrypts the private key for a
+    // denomination with the notary's Nym. VerifyCoin then checks a coin
+    // against that key, using nothing but its arguments, so it may run on
+    // any thread.
+    EXPORT bool OpenPrivate(Nym& theNotary, int64_t lDenomination,
+                            String& strPrivate);
+    EXPORT virtual bool VerifyCoin(const String& strPrivate,
+                                   const String& theCleartextToken) const = 0;
 };
 
 } // namespace opentxs
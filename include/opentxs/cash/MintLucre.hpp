@@ -66,6 +66,10 @@ protected:
     EXPORT MintLucre(const String& strNotaryID, const String& strServerNymID,
                      const String& strInstrumentDefinitionID);
 
+    virtual bool GenerateDenomination(Nym& theNotary, int32_t nPrimeLength,
+                                      OTASCIIArmor& thePublic,
+                                      OTASCIIArmor& thePrivate);
+
 public:
     virtual bool AddDenomination(Nym& theNotary, int64_t lDenomination,
                                  int32_t nPrimeLength = 1024);
@@ -74,6 +78,8 @@ public:
                                   String& theOutput, int32_t nTokenIndex);
     EXPORT virtual bool VerifyToken(Nym& theNotary, String& theCleartextToken,
                                     int64_t lDenomination);
+    EXPORT virtual bool VerifyCoin(const String& strPrivate,
+                                   const String& theCleartextToken) const;
 
     EXPORT virtual ~MintLucre();
 };
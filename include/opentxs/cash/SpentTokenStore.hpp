@@ -0,0 +1,199 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CASH_SPENTTOKENSTORE_HPP
+#define OPENTXS_CASH_SPENTTOKENSTORE_HPP
+
+#include <opentxs/core/util/Common.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace opentxs
+{
+
+// The notary's record of which cash tokens have already been deposited.
+//
+// Records are partitioned by instrument definition and mint series, and each
+// partition lives in the spent folder as three pieces:
+//
+//   "<unitID>.<series>.l"  append-only log, one "<token hash> <token>" line
+//                          per spent token. This is the record of truth.
+//   "<unitID>.<series>.i"  open-addressed hash table on disk, mapping a 64 bit
+//                          fingerprint of each token hash to its offset in the
+//                          log. Derived from the log, and rebuilt from it if
+//                          missing or behind.
+//   in memory              a Bloom filter over the same fingerprints.
+//
+// Looking up a token that was never spent (the normal case) is answered by
+// the Bloom filter without touching the disk. Only filter hits read the
+// index and the log line it points to.
+//
+// Tokens stop being valid once their series reaches its valid-to date, so a
+// partition can then be deleted as a whole. The valid-to date of every
+// partition is kept in the "series" manifest for PruneExpired().
+//
+// Every write is synced to disk before the next one that depends on it: a
+// log record before its index slot, and the slot before the index header
+// claims the record. After a crash the index is therefore at worst behind
+// the log, never ahead of it, and Load() catches it up.
+//
+// Series spent before this store existed were recorded as one file per token,
+// in a "<unitID>.<series>" folder. MigrateLegacy() moves those into the log
+// and deletes them. Until it has run, such folders are still consulted.
+class SpentTokenStore
+{
+public:
+    // Sets spent to whether tokenHash was recorded for this series. Returns
+    // false if the partition could not be read, in which case spent is true.
+    EXPORT static bool IsSpent(
+        const std::string& unitID,
+        const int32_t series,
+        const std::string& tokenHash,
+        bool& spent);
+    // Returns false if the token was already recorded, or on error.
+    EXPORT static bool Record(
+        const std::string& unitID,
+        const int32_t series,
+        const time64_t validTo,
+        const std::string& tokenHash,
+        const std::string& token);
+    EXPORT static bool Prune(const std::string& unitID, const int32_t series);
+    // Deletes every partition whose series was valid until before now.
+    // Returns the number of partitions deleted.
+    EXPORT static std::size_t PruneExpired(const time64_t now);
+    // Moves every legacy per-token folder into its partition. Returns the
+    // number of folders migrated.
+    EXPORT static std::size_t MigrateLegacy();
+    // Forgets every partition held in memory, so each is read again from
+    // disk the next time it is used.
+    EXPORT static void Unload();
+
+private:
+    class Partition
+    {
+    public:
+        std::mutex lock_;
+        std::vector<std::uint64_t> bloom_;
+        std::uint64_t slots_ = 0;
+        std::uint64_t entries_ = 0;
+        // Length of the log covered by the index
+        std::uint64_t indexed_ = 0;
+        bool legacy_ = false;
+        bool loaded_ = false;
+    };
+
+    // fingerprint, offset of the record in the log
+    typedef std::pair<std::uint64_t, std::uint64_t> Slot;
+    typedef std::map<std::string, time64_t> Manifest;
+
+    static std::mutex registry_lock_;
+    static std::map<std::string, std::shared_ptr<Partition>> partitions_;
+    // Guards the manifest file. Never held while acquiring a partition lock.
+    static std::mutex manifest_lock_;
+
+    static std::string Name(const std::string& unitID, const int32_t series);
+    static std::uint64_t Fingerprint(const std::string& tokenHash);
+    static bool Path(const std::string& file, std::string& path);
+    static std::shared_ptr<Partition> Get(const std::string& name);
+    static bool Erase(const std::string& name);
+    // Adds name to the manifest, or extends its valid-to date.
+    static bool Register(const std::string& name, const time64_t validTo);
+    // Caller must hold manifest_lock_ for the following methods
+    static void ReadManifest(Manifest& manifest);
+    static bool WriteManifest(const Manifest& manifest);
+
+    // Caller must hold partition.lock_ for the following methods
+    static bool Load(const std::string& name, Partition& partition);
+    // Returns false if the record could not be written to the log. Index
+    // failures only mark the partition for reloading.
+    static bool Append(
+        const std::string& name,
+        Partition& partition,
+        const std::string& tokenHash,
+        const std::string& token);
+    static bool Migrate(const std::string& name, Partition& partition);
+    static bool Find(
+        const std::string& name,
+        const Partition& partition,
+        const std::string& tokenHash,
+        bool& found);
+    static bool Insert(
+        const std::string& name,
+        Partition& partition,
+        const std::uint64_t fingerprint,
+        const std::uint64_t offset);
+    static bool CatchUp(
+        const std::string& name,
+        Partition& partition,
+        const std::uint64_t logSize);
+    static bool WriteHeader(
+        const std::string& name,
+        const Partition& partition);
+    static bool WriteIndex(
+        const std::string& name,
+        Partition& partition,
+        const std::vector<Slot>& entries,
+        const std::uint64_t slots);
+    static void ResetBloom(
+        Partition& partition,
+        const std::vector<Slot>& entries);
+    static void AddToBloom(
+        Partition& partition,
+        const std::uint64_t fingerprint);
+    static bool InBloom(
+        const Partition& partition,
+        const std::uint64_t fingerprint);
+
+    static bool ReadIndex(
+        const std::string& name,
+        std::vector<Slot>& entries,
+        std::uint64_t& slots,
+        std::uint64_t& indexed);
+
+    SpentTokenStore() = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CASH_SPENTTOKENSTORE_HPP
@@ -120,6 +120,12 @@ protected:
     String m_strEntityEmail;
     String::Map m_mapConditions; // The legal conditions, usually
                                  // human-readable, on a contract.
+    // Local integrity tag for this contract, if any. (See IntegrityTag.)
+    // Set when the contract is signed or loaded, never when verified.
+    std::string m_strIntegrityTag;
+    // Returns m_strIntegrityTag if it still matches the current contents and
+    // one of the current signatures, otherwise an empty string.
+    std::string ValidIntegrityTag() const;
     bool LoadContractXML(); // The XML file is in m_xmlUnsigned. Load it from
                             // there into members here.
     // return -1 if error, 0 if nothing, and 1 if the node was processed.
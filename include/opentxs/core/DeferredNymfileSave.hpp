@@ -0,0 +1,76 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_DEFERREDNYMFILESAVE_HPP
+#define OPENTXS_CORE_DEFERREDNYMFILESAVE_HPP
+
+namespace opentxs
+{
+
+class Nym;
+
+// Holds back a Nym's nymfile writes for the lifetime of this object, so that
+// a request which adds and removes several numbers signs and writes the
+// nymfile once instead of once per number. See Nym::BeginDeferredSave().
+//
+// The held-back save is written when the scope is committed or destroyed,
+// or earlier, before any account or box is saved (so a failed write stops
+// the transaction before its balances change.) Call Commit() wherever the
+// result matters (e.g. before replying to the client), since a destructor
+// has no way to report a failed write.
+class DeferredNymfileSave
+{
+public:
+    EXPORT explicit DeferredNymfileSave(Nym& theNym);
+    EXPORT ~DeferredNymfileSave();
+
+    // Ends the scope early and writes the nymfile if it is dirty. Returns
+    // false if that write failed. Safe to call more than once.
+    EXPORT bool Commit();
+
+private:
+    Nym* nym_;
+
+    DeferredNymfileSave() = delete;
+    DeferredNymfileSave(const DeferredNymfileSave&) = delete;
+    DeferredNymfileSave& operator=(const DeferredNymfileSave&) = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_DEFERREDNYMFILESAVE_HPP
@@ -41,6 +41,11 @@
 
 #include "OTTransaction.hpp"
 
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
 namespace opentxs
 {
 
@@ -62,6 +67,12 @@ class String;
 
 typedef std::map<int64_t, OTTransaction*> mapOfTransactions;
 
+// Secondary key (type, in-reference-to number, request number) plus
+// transaction number, so that each key's range comes out in the same order
+// as m_mapTransactions.
+typedef std::map<std::pair<int64_t, int64_t>, OTTransaction*>
+    mapOfIndexedTransactions;
+
 // the "inbox" and "outbox" functionality is implemented in this class
 class Ledger : public OTTransactionType
 {
@@ -70,11 +81,45 @@ private: // Private prevents erroneous use by other classes.
 
     friend OTTransactionType* OTTransactionType::TransactionFactory(
         String strInput);
+    friend class OTTransaction; // Calls ReindexReceiptKey.
 
 private:
     mapOfTransactions m_mapTransactions; // a ledger contains a map of
                                          // transactions.
 
+    // Secondary indexes over m_mapTransactions, kept up to date by
+    // AddTransaction and RemoveTransaction. The indexed fields must not
+    // change while a transaction is on the ledger.
+    mapOfIndexedTransactions m_mapByType;
+    mapOfIndexedTransactions m_mapByInRefTo;
+    mapOfIndexedTransactions m_mapReplyNoticesByRequest;
+    // Same order as m_mapTransactions, for lookups by position. Rebuilt on
+    // demand after the ledger changes.
+    mutable std::vector<OTTransaction*> m_vecTransactions;
+    mutable bool m_bVecTransactionsDirty;
+    // Transfer, cheque and voucher receipts by OTTransaction::GetReceiptKey.
+    // Decoding that key means parsing the receipt's reference string, so
+    // it's put off until the next lookup: full receipts added since then
+    // wait in m_setUnkeyedReceipts.
+    mapOfIndexedTransactions m_mapTransferReceiptsByOrigin;
+    mapOfIndexedTransactions m_mapChequeReceiptsByNum;
+    std::set<int64_t> m_setUnkeyedReceipts;
+
+    void IndexTransaction(OTTransaction& theTransaction);
+    void UnindexTransaction(OTTransaction& theTransaction);
+    void QueueReceiptKey(OTTransaction& theTransaction);
+    // Moves a receipt back to m_setUnkeyedReceipts when its reference
+    // string changes. Called by the receipt, before it drops its old key.
+    void ReindexReceiptKey(OTTransaction& theTransaction);
+    void UnindexReceiptKey(OTTransaction& theTransaction);
+    // Keys the receipts in m_setUnkeyedReceipts. If ppChequeOut is given, the
+    // cheque numbered lChequeNum is returned through it (with its receipt in
+    // ppChequeReceipt) when it's loaded along the way.
+    void IndexReceiptKeys(int64_t lChequeNum = 0,
+                          Cheque** ppChequeOut = nullptr,
+                          OTTransaction** ppChequeReceipt = nullptr);
+    const std::vector<OTTransaction*>& GetTransactionVector() const;
+
 protected:
     // return -1 if error, 0 if nothing, and 1 if the node was processed.
     virtual int32_t ProcessXMLNode(irr::io::IrrXMLReader*& xml);
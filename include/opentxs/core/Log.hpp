@@ -46,6 +46,9 @@
 #include <iostream>
 #include <cstdint>
 #include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
 #include <thread>
 
 #if defined(unix) || defined(__unix__) || defined(__unix) ||                   \
@@ -90,8 +93,10 @@ class OTLogStream : public std::ostream, std::streambuf
 {
 private:
     int logLevel;
-    int next;
-    char* pBuffer;
+    // Each thread assembles its own line, so that lines written by
+    // concurrent threads are not interleaved.
+    std::mutex lock_;
+    std::map<std::thread::id, std::string> buffers_;
 
 public:
     OTLogStream(int _logLevel);
@@ -112,6 +117,8 @@ private:
     static const String m_strPathSeparator;
 
     dequeOfStrings logDeque;
+    // Guards logDeque and the log file
+    static std::recursive_mutex lock_;
 
     String m_strThreadContext;
     String m_strLogFileName;
@@ -40,10 +40,13 @@
 #define OPENTXS_CORE_OTPSEUDONYM_HPP
 
 #include <deque>
+#include <functional>
 #include <map>
 #include <list>
 #include <set>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include <czmq.h>
 #include <opentxs-proto/verify/VerifyContracts.hpp>
@@ -52,6 +55,7 @@
 #include <opentxs/core/NymIDSource.hpp>
 #include "crypto/OTASCIIArmor.hpp"
 #include "Identifier.hpp"
+#include "TransactionNumbers.hpp"
 #include "Types.hpp"
 
 namespace opentxs
@@ -65,6 +69,7 @@ class Ledger;
 class Message;
 class OTPassword;
 class OTPasswordData;
+class OTSignedFile;
 class ServerContract;
 class Credential;
 class OTTransaction;
@@ -74,8 +79,7 @@ class Wallet;
 typedef std::deque<Message*> dequeOfMail;
 typedef std::map<std::string, int64_t> mapOfRequestNums;
 typedef std::map<std::string, int64_t> mapOfHighestNums;
-typedef std::deque<int64_t> dequeOfTransNums;
-typedef std::map<std::string, dequeOfTransNums*> mapOfTransNums;
+typedef std::map<std::string, TransactionNumbers*> mapOfTransNums;
 typedef std::map<std::string, Identifier> mapOfIdentifiers;
 typedef std::map<std::string, CredentialSet*> mapOfCredentialSets;
 typedef std::list<OTAsymmetricKey*> listOfAsymmetricKeys;
@@ -210,6 +214,34 @@ private:
                                           // credentials after they are revoked.
     String::List m_listRevokedIDs; // std::string list, any revoked Credential
                                    // IDs. (Mainly for child credentials)
+    // A nymfile whose saves are being held back. Kept by Nym ID rather than
+    // on the Nym, so that every copy of the same Nym sees it.
+    class DeferredSave
+    {
+    public:
+        // Nesting depth of BeginDeferredSave()
+        uint32_t depth_ = 0;
+        // The copy whose state the held-back save will write
+        Nym* nym_ = nullptr;
+        // The signer passed to the most recent SaveSignedNymfile() that was
+        // held back (nullptr if clean.)
+        Nym* signer_ = nullptr;
+    };
+
+    static std::recursive_mutex deferred_lock_;
+    static std::map<std::string, DeferredSave> deferred_saves_;
+
+    // Caller must hold deferred_lock_.
+    static bool WriteDeferredSave(DeferredSave& save);
+    // The most numbers LoadNymFromString accepts in any one list. (0 means no
+    // limit.) See LimitNumbersTo().
+    std::size_t number_limit_ = 0;
+
+    void InsertGenericNums(mapOfTransNums& THE_MAP, const String& strNotaryID,
+                           const TransactionNumbers& theNumbers);
+    // bRanges writes the number lists in the compact range format, which
+    // only the local nymfile uses.
+    bool SavePseudonym(String& strNym, bool bRanges);
 public:
     EXPORT std::string Alias() const { return alias_; }
     EXPORT void SetAlias(const std::string& alias) { alias_ = alias; }
@@ -217,6 +249,10 @@ public:
     EXPORT void GetPrivateCredentials(String& strCredList,
                                       String::Map* pmapCredFiles = nullptr);
     EXPORT const serializedCredentialIndex asPublicNym() const;
+    // Digest of the public credential index, including every credential and
+    // its signatures. Any change to a credential, including a tampered
+    // signature, changes this digest.
+    EXPORT Identifier CredentialIndexHash() const;
     EXPORT size_t GetMasterCredentialCount() const;
     EXPORT size_t GetRevokedCredentialCount() const;
     EXPORT CredentialSet* GetRevokedCredential(const String& strID);
@@ -391,7 +427,33 @@ public:
     // Usually that means the server nym.  Most of the time, m_nymServer will be
     // used as signer.
     EXPORT bool LoadSignedNymfile(Nym& SIGNER_NYM);
+    // Checks a loaded nymfile before its payload is read. The default,
+    // VerifySignedNymfile, checks the file and the signer's signature.
+    typedef std::function<bool(OTSignedFile&, Nym&)> NymfileVerifier;
+    // The same, with the file and signature checks done by verify instead,
+    // e.g. so a cache can skip them for a file it has already verified.
+    EXPORT bool LoadSignedNymfile(Nym& SIGNER_NYM,
+                                  const NymfileVerifier& verify);
+    EXPORT static bool VerifySignedNymfile(OTSignedFile& theNymfile,
+                                           Nym& SIGNER_NYM);
     EXPORT bool SaveSignedNymfile(Nym& SIGNER_NYM);
+    // Coalesces nymfile writes. Between BeginDeferredSave() and the matching
+    // EndDeferredSave(), SaveSignedNymfile() only marks the Nym as dirty, and
+    // the outermost EndDeferredSave() signs and writes it once. Calls nest.
+    // FlushDeferredSave() writes any held-back save immediately, for callers
+    // that need the nymfile on disk before they continue.
+    //
+    // Deferral is tracked by Nym ID: loading another copy of the Nym writes
+    // the held-back save first, and a save from another copy writes it
+    // before writing its own.
+    EXPORT void BeginDeferredSave();
+    EXPORT bool EndDeferredSave();
+    EXPORT bool FlushDeferredSave();
+    EXPORT bool HasDeferredSave() const;
+    // Writes every held-back nymfile save. Accounts and boxes call this
+    // before they are saved, so they never reach the disk ahead of the
+    // numbers recorded on the nymfile.
+    EXPORT static bool FlushDeferredSaves();
     EXPORT bool LoadNymFromString(const String& strNym,
                                String::Map* pMapCredentials =
                                    nullptr, // pMapCredentials can be passed, if
@@ -402,12 +464,21 @@ public:
                                // have been sent inside a message.)
                                String* pstrReason = nullptr,
                                const OTPassword* pImportPassword = nullptr);
+    // For a Nym received from another party (e.g. attached to a balance
+    // statement), call this before LoadNymFromString: it then refuses number
+    // lists much longer than any theTrustedNym holds, instead of expanding
+    // whatever ranges it was sent.
+    EXPORT void LimitNumbersTo(const Nym& theTrustedNym);
     EXPORT bool LoadPublicKey();
     EXPORT bool SavePseudonymWallet(Tag& parent) const;
     EXPORT bool SavePseudonym(); // saves to filename m_strNymfile
 protected:
     EXPORT bool SavePseudonym(const char* szFoldername, const char* szFilename);
+private:
+    bool WriteSignedNymfile(Nym& SIGNER_NYM);
 public:
+    // Writes the number lists one number at a time, which every peer can
+    // read. Use this for anything sent over the wire.
     EXPORT bool SavePseudonym(String& strNym);
     EXPORT bool CompareID(const Identifier& theIdentifier) const
     {
@@ -572,6 +643,9 @@ public:
                                                           // for the notaryID
                                                           // passed. Saves by
                                                           // default.
+    // Numbers are kept in ascending order, and numbers are issued in
+    // ascending order, so the "next" number is always the lowest (oldest)
+    // one, and index 0 of GetGenericNum() and friends is the lowest.
     EXPORT bool RemoveIssuedNum(Nym& SIGNER_NYM, const String& strNotaryID,
                                 const int64_t& lTransNum,
                                 bool bSave); // SAVE OR NOT (your choice)
@@ -341,6 +341,7 @@ same time that it is first being
 
  */
 
+class Cheque;
 class Ledger;
 class Tag;
 
@@ -348,6 +349,7 @@ class OTTransaction : public OTTransactionType
 {
     friend OTTransactionType* OTTransactionType::TransactionFactory(
         String strInput);
+    friend class Ledger; // Maintains m_pReceiptIndex.
 
 public:
     // a transaction can be blank (issued from server)
@@ -477,6 +479,20 @@ public:
     virtual void Release();
     EXPORT virtual int64_t GetNumberOfOrigin();
     EXPORT virtual void CalculateNumberOfOrigin();
+    EXPORT virtual void SetReferenceString(const String& theStr);
+
+    // The key a receipt is looked up by in its box: for a transferReceipt,
+    // the number of origin of the acceptPending item it references; for a
+    // chequeReceipt or voucherReceipt, the transaction number of the
+    // deposited cheque. Decoded from the reference string the first time
+    // it's asked for, and cached until the reference string changes.
+    // Returns 0 for other types, or if the reference can't be decoded.
+    EXPORT int64_t GetReceiptKey();
+
+    // For chequeReceipt and voucherReceipt: loads the cheque from the
+    // depositCheque item this receipt is in reference to, caching its
+    // number as the receipt key. CALLER RESPONSIBLE TO DELETE.
+    EXPORT Cheque* LoadReferencedCheque();
 
     // This calls VerifyContractID() as well as VerifySignature()
     // Use this instead of Contract::VerifyContract, which expects/uses a
@@ -858,6 +874,17 @@ protected:
     // marked as "rejected." All the client has to do is check m_bCancelled
     // to see if it's set to TRUE, and it will know.
     bool m_bCancelled;
+
+    // Cached result of GetReceiptKey(), so a box can be searched for a
+    // receipt without decoding every receipt's reference string each time.
+    bool m_bReceiptKeyLoaded;
+    int64_t m_lReceiptKey;
+    // The ledger indexing this receipt by its key, if any. Set and cleared
+    // by that ledger, and told when the key is about to change.
+    Ledger* m_pReceiptIndex;
+
+    // Drops the cached receipt key after the reference string changes.
+    void ResetReceiptKey();
 };
 
 } // namespace opentxs
@@ -758,7 +758,7 @@ public:
     EXPORT void SetReferenceToNum(int64_t lTransactionNum);
 
     EXPORT void GetReferenceString(String& theStr) const;
-    EXPORT void SetReferenceString(const String& theStr);
+    EXPORT virtual void SetReferenceString(const String& theStr);
 };
 
 } // namespace opentxs
@@ -0,0 +1,148 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_TRANSACTIONNUMBERS_HPP
+#define OPENTXS_CORE_TRANSACTIONNUMBERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+namespace opentxs
+{
+
+class String;
+
+// A sorted set of transaction (or request) numbers, stored as ranges of
+// consecutive numbers. Numbers are issued, and mostly used, in runs, so even
+// a Nym holding thousands of them usually needs only a few ranges. Lookups,
+// insertions and removals are O(log n) in the number of ranges.
+//
+// Serializes either as a comma-separated list of single numbers (the format
+// NumList writes, which every peer understands) or, more compactly, as a list
+// of numbers and ranges, e.g. "5,7-12,20". Load accepts both.
+class TransactionNumbers
+{
+    // first number of each range -> last number of that range
+    typedef std::map<int64_t, int64_t> Ranges;
+
+public:
+    // Visits every number, in ascending order.
+    class const_iterator
+        : public std::iterator<std::forward_iterator_tag, int64_t,
+                               std::ptrdiff_t, const int64_t*, const int64_t&>
+    {
+    public:
+        const_iterator(Ranges::const_iterator range, Ranges::const_iterator end);
+
+        const int64_t& operator*() const
+        {
+            return value_;
+        }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& rhs) const;
+        bool operator!=(const const_iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        Ranges::const_iterator range_;
+        Ranges::const_iterator end_;
+        int64_t value_;
+    };
+
+    EXPORT TransactionNumbers();
+
+    // if false, means the value was already there.
+    EXPORT bool Add(const int64_t& value);
+    // if false, means the value was NOT already there.
+    EXPORT bool Remove(const int64_t& value);
+    EXPORT bool Contains(const int64_t& value) const;
+    // Adds every number from first to last. Returns false (having added
+    // nothing) if last < first.
+    EXPORT bool Insert(int64_t first, int64_t last);
+    // Adds every number in rhs, a range at a time.
+    EXPORT void Insert(const TransactionNumbers& rhs);
+    // Removes the lowest numbers until at most count are left.
+    EXPORT void TrimLowest(std::size_t count);
+    EXPORT void clear();
+
+    bool empty() const
+    {
+        return 0 == size_;
+    }
+    std::size_t size() const
+    {
+        return size_;
+    }
+    std::size_t RangeCount() const
+    {
+        return ranges_.size();
+    }
+    // The lowest and highest numbers. Don't call these when empty.
+    EXPORT int64_t Lowest() const;
+    EXPORT int64_t Highest() const;
+    // The number at position index, counting from the lowest. O(ranges)
+    EXPORT int64_t at(std::size_t index) const;
+
+    EXPORT const_iterator begin() const;
+    EXPORT const_iterator end() const;
+
+    // returns false if the set is empty. Writes ranges only if bRanges is
+    // set; anything sent to another party should use the default.
+    EXPORT bool Output(String& strOutput, bool bRanges = false) const;
+    // Adds the numbers from strInput. Returns false (having added nothing) if
+    // it can't be parsed, or if it lists more than nLimit numbers (0 means no
+    // limit.) Set a limit for any input that didn't come from local storage.
+    EXPORT bool Load(const String& strInput, std::size_t nLimit = 0);
+
+private:
+    Ranges ranges_;
+    std::size_t size_;
+
+    // The range containing value, or ranges_.end()
+    Ranges::iterator Find(const int64_t& value);
+    Ranges::const_iterator Find(const int64_t& value) const;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_TRANSACTIONNUMBERS_HPP
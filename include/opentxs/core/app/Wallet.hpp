@@ -39,12 +39,19 @@
 #ifndef OPENTXS_CORE_APP_WALLET_HPP
 #define OPENTXS_CORE_APP_WALLET_HPP
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
 #include <list>
 #include <map>
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 
 #include "opentxs/core/Nym.hpp"
 #include "opentxs/core/contract/ServerContract.hpp"
@@ -73,19 +80,147 @@ typedef std::shared_ptr<const class UnitDefinition> ConstUnitDefinition;
 class Wallet
 {
 private:
-    typedef std::pair<std::mutex, std::shared_ptr<class Nym>> NymLock;
-    typedef std::map<std::string, NymLock> NymMap;
-    typedef std::map<std::string, std::shared_ptr<class ServerContract>> ServerMap;
-    typedef std::map<std::string, std::shared_ptr<class UnitDefinition>> UnitMap;
+    /** \brief Striped map of contracts, each of which is loaded at most once
+     *  at a time.
+     *
+     *  Ids are spread over independently locked shards, so lookups of
+     *  different contracts rarely contend. A shard is only locked long enough
+     *  to find or insert an entry: loading happens outside the lock, and
+     *  concurrent lookups of an id which is still loading wait on the same
+     *  future instead of loading it again.
+     */
+    template<class T>
+    class ContractMap
+    {
+    public:
+        typedef std::shared_ptr<T> Pointer;
+        typedef std::function<Pointer()> Loader;
+
+        /**   Returns the entry for id, calling loader to create it if there
+         *    is none. A null result from loader is not kept.
+         */
+        Pointer Get(const std::string& id, const Loader& loader)
+        {
+            auto& shard = ShardFor(id);
+            std::unique_lock<std::mutex> lock(shard.lock_);
+            auto it = shard.map_.find(id);
+
+            if (shard.map_.end() != it) {
+                auto future = it->second;
+                lock.unlock();
+
+                return future.get();
+            }
+
+            std::promise<Pointer> promise;
+            shard.map_[id] = promise.get_future().share();
+            lock.unlock();
+
+            Pointer output;
+
+            try {
+                output = loader();
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+                EraseEmpty(id);
+
+                throw;
+            }
+
+            promise.set_value(output);
+
+            if (!output) { EraseEmpty(id); }
+
+            return output;
+        }
+
+        /**   Returns true if id has finished loading and is not null */
+        bool Exists(const std::string& id)
+        {
+            auto& shard = ShardFor(id);
+            std::unique_lock<std::mutex> lock(shard.lock_);
+            auto it = shard.map_.find(id);
+
+            return (shard.map_.end() != it) && Ready(it->second) &&
+                   (nullptr != it->second.get());
+        }
+
+        /**   Replaces the entry for id */
+        void Set(const std::string& id, const Pointer& value)
+        {
+            std::promise<Pointer> promise;
+            promise.set_value(value);
+            auto& shard = ShardFor(id);
+            std::unique_lock<std::mutex> lock(shard.lock_);
+            shard.map_[id] = promise.get_future().share();
+        }
+
+        /**   Returns true if there was an entry for id */
+        bool Erase(const std::string& id)
+        {
+            auto& shard = ShardFor(id);
+            std::unique_lock<std::mutex> lock(shard.lock_);
+
+            return (0 != shard.map_.erase(id));
+        }
+
+    private:
+        static const std::size_t SHARDS = 16;
+
+        struct Shard
+        {
+            std::mutex lock_;
+            std::unordered_map<std::string, std::shared_future<Pointer>> map_;
+        };
+
+        std::array<Shard, SHARDS> shard_;
+
+        static bool Ready(const std::shared_future<Pointer>& future)
+        {
+            return std::future_status::ready ==
+                   future.wait_for(std::chrono::seconds(0));
+        }
+
+        Shard& ShardFor(const std::string& id)
+        {
+            return shard_[std::hash<std::string>()(id) % SHARDS];
+        }
+
+        // Drops a failed load, unless it has been replaced in the meantime.
+        void EraseEmpty(const std::string& id)
+        {
+            auto& shard = ShardFor(id);
+            std::unique_lock<std::mutex> lock(shard.lock_);
+            auto it = shard.map_.find(id);
+
+            if ((shard.map_.end() != it) && Ready(it->second)) {
+                bool failed = true;
+
+                try {
+                    failed = !it->second.get();
+                } catch (...) {
+                }
+
+                if (failed) { shard.map_.erase(it); }
+            }
+        }
+    };
+
+    typedef ContractMap<class Nym> NymMap;
+    typedef ContractMap<class ServerContract> ServerMap;
+    typedef ContractMap<class UnitDefinition> UnitMap;
+    // nym id, (digest of the full credential index, result of
+    // VerifyPseudonym())
+    typedef std::map<std::string, std::pair<std::string, bool>> NymVerifiedMap;
 
     friend App;
 
     NymMap nym_map_;
     ServerMap server_map_;
     UnitMap unit_map_;
-    std::mutex nym_map_lock_;
-    std::mutex server_map_lock_;
-    std::mutex unit_map_lock_;
+    NymVerifiedMap nym_verified_;
+    std::mutex nym_verified_lock_;
+    std::atomic<std::uint64_t> nym_verifications_{0};
 
     Wallet() = default;
     Wallet(const Wallet&) = delete;
@@ -146,6 +281,21 @@ public:
      */
     ConstNym Nym(const proto::CredentialIndex& nym);
 
+    /**   Verify a nym's credentials, reusing the previous result if they
+     *    have not changed since the last verification.
+     *
+     *    Verification uses the nym's keys, so no other thread may be using
+     *    nym at the same time. Nyms returned by Nym() are already verified.
+     *
+     *    \param[in] nym the nym to verify
+     */
+    bool VerifyNym(const class Nym& nym);
+
+    /**   Returns the number of full nym credential verifications performed
+     *    since the wallet was started
+     */
+    std::uint64_t NymVerifications() const;
+
     /**   Unload and delete a server contract
      *
      *    This method destroys the contract object, removes it from the
@@ -0,0 +1,154 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_CONTRACT_ACCOUNTREGISTRY_HPP
+#define OPENTXS_CORE_CONTRACT_ACCOUNTREGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace opentxs
+{
+
+// The list of user accounts for each instrument definition, used to visit
+// every holder of a unit (e.g. when paying dividends.)
+//
+// Each list lives on disk, in the contracts folder, as a sorted file of
+// account IDs ("<unitID>.rs") and an append-only log of the changes made
+// since that file was written ("<unitID>.r"), one "+<acctID>" or
+// "-<acctID>" line per change. Only the changes in the log are kept in
+// memory. Lookups and pages binary search the sorted file and merge in the
+// changes, so a list of any size is never read whole. Once the log is long
+// enough, it is merged into a new sorted file and emptied.
+//
+// A log line which doesn't hold a well formed account ID (e.g. the last
+// line, torn by a crash while it was appended) is dropped when the log is
+// loaded. A list written by older versions, as a StringMap ("<unitID>.a")
+// or as a log alone, is imported the first time the unit is accessed.
+class AccountRegistry
+{
+public:
+    typedef std::vector<std::string> AccountList;
+
+    EXPORT static bool Add(
+        const std::string& unitID,
+        const std::string& accountID);
+    EXPORT static bool Erase(
+        const std::string& unitID,
+        const std::string& accountID);
+    EXPORT static std::size_t Count(const std::string& unitID);
+    // Copies up to count account IDs which sort after "after" into list, in
+    // order. Pass the last ID of the previous page to continue. Accounts
+    // added or removed between calls are seen, or not, consistently with
+    // their position.
+    EXPORT static bool Page(
+        const std::string& unitID,
+        const std::string& after,
+        const std::size_t count,
+        AccountList& list);
+    // Drops what is held in memory. The next call loads it again from disk.
+    EXPORT static void Unload();
+
+private:
+    class Registry
+    {
+    public:
+        std::mutex lock_;
+        // Changes since the sorted file was written: true for an account
+        // which isn't in the file but is on the list, false for one which is
+        // in the file but was removed.
+        std::map<std::string, bool> changes_;
+        std::size_t count_ = 0;
+        std::size_t log_entries_ = 0;
+        bool loaded_ = false;
+    };
+
+    static std::mutex registry_lock_;
+    static std::map<std::string, std::shared_ptr<Registry>> registries_;
+
+    static std::shared_ptr<Registry> Get(const std::string& unitID);
+    static bool Path(const std::string& file, std::string& path);
+    static bool ValidID(const std::string& accountID);
+
+    // Reads the header of a sorted file, leaving sorted at the first ID.
+    static bool OpenSorted(
+        const std::string& unitID,
+        std::ifstream& sorted,
+        std::size_t& count,
+        std::int64_t& end);
+    // Positions sorted at the first ID which sorts after accountID (or at
+    // or after it, if inclusive is set.)
+    static void SeekSorted(
+        std::ifstream& sorted,
+        const std::string& accountID,
+        const bool inclusive,
+        const std::int64_t end);
+    // Sets found if accountID is in the sorted file of unitID.
+    static bool InSorted(
+        const std::string& unitID,
+        const std::string& accountID,
+        bool& found);
+
+    // Caller must hold registry.lock_ for the following methods
+    static bool Load(const std::string& unitID, Registry& registry);
+    // Adds accountID to the list (or removes it, if present is false.)
+    static bool Change(
+        const std::string& unitID,
+        Registry& registry,
+        const std::string& accountID,
+        const bool present);
+    static bool Append(
+        const std::string& unitID,
+        Registry& registry,
+        const char operation,
+        const std::string& accountID);
+    // Merges the changes into a new sorted file, then empties the log.
+    static bool Compact(const std::string& unitID, Registry& registry);
+
+    AccountRegistry() = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_CONTRACT_ACCOUNTREGISTRY_HPP
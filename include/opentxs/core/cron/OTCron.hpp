@@ -61,6 +61,14 @@ class Nym;
 typedef std::map<int64_t, OTCronItem*> mapOfCronItems;
 typedef std::multimap<time64_t, OTCronItem*> multimapOfCronItems;
 
+// multimapOfWakeTimes: Mapped to the next time the item needs processing.
+// mapOfWakeTimes:      Mapped (uniquely) to transaction number, pointing
+//                      into multimapOfWakeTimes.
+//
+// (An item is missing from these only while it is being processed.)
+typedef std::multimap<time64_t, OTCronItem*> multimapOfWakeTimes;
+typedef std::map<int64_t, multimapOfWakeTimes::iterator> mapOfWakeTimes;
+
 // Mapped (uniquely) to market ID.
 typedef std::map<std::string, OTMarket*> mapOfMarkets;
 
@@ -77,6 +85,9 @@ private:
     mapOfMarkets m_mapMarkets;     // A list of all valid markets.
     mapOfCronItems m_mapCronItems; // Cron Items are found on both lists.
     multimapOfCronItems m_multimapCronItems;
+    multimapOfWakeTimes m_multimapWakeTimes; // Only the front of this is
+                                             // processed each round.
+    mapOfWakeTimes m_mapWakeTimes;
     Identifier m_NOTARY_ID; // Always store this in any object that's
                             // associated with a specific server.
 
@@ -101,6 +112,9 @@ private:
 
     static Timer tCron;
 
+    void ScheduleItem(OTCronItem& theItem);
+    void UnscheduleItem(int64_t lTransactionNum);
+
 public:
     static int32_t GetCronMsBetweenProcess()
     {
@@ -152,6 +166,10 @@ public:
     EXPORT mapOfCronItems::iterator FindItemOnMap(int64_t lTransactionNum);
     EXPORT multimapOfCronItems::iterator FindItemOnMultimap(
         int64_t lTransactionNum);
+    // Call this when something outside of ProcessCronItems() may have moved
+    // an item's next wake time earlier. (Flagging it for removal, setting a
+    // smart contract timer, etc.)
+    EXPORT void RescheduleItem(OTCronItem& theItem);
     // MARKETS
     //
     bool AddMarket(OTMarket& theMarket, bool bSaveMarketFile = true);
@@ -193,8 +211,13 @@ public:
     // within, since it will not
     // be replenished again at least until the call has finished.)
     //
+    // Only the items whose next wake time has arrived are processed.
     EXPORT void ProcessCronItems();
 
+    // Milliseconds until the next round should run: no sooner than
+    // __cron_ms_between_process after the last round, and otherwise when the
+    // earliest item wakes up. Never more than __cron_ms_between_process, so
+    // newly added items are noticed.
     int64_t computeTimeout();
 
     inline void SetNotaryID(const Identifier& NOTARY_ID)
@@ -111,6 +111,10 @@ protected:
     } // called by HookRemovalFromCron().
     void ClearClosingNumbers();
 
+    // For GetNextWakeTime() overrides: an item that isn't valid yet does
+    // nothing (except perhaps expire) until its valid-from date.
+    time64_t WakeWhenValid(const time64_t& tWake) const;
+
 public:
     // To force the Nym to close out the closing number on the receipt.
     bool DropFinalReceiptToInbox(
@@ -149,10 +153,7 @@ public:
     {
         return m_bRemovalFlag;
     }
-    inline void FlagForRemoval()
-    {
-        m_bRemovalFlag = true;
-    }
+    void FlagForRemoval();
     inline void SetCronPointer(OTCron& theCron)
     {
         m_pCron = &theCron;
@@ -224,6 +225,11 @@ public:
     virtual bool ProcessCron(); // OTCron calls this regularly, which is my
                                 // chance to expire, etc.
                                 // From OTTrackable (parent class of this)
+
+    // The earliest time at which ProcessCron() might do anything besides
+    // return true straight away. OTCron won't process the item before then.
+    // Returning a time that is too early is harmless; too late is a bug.
+    virtual time64_t GetNextWakeTime();
     virtual ~OTCronItem();
 
     void InitCronItem();
@@ -41,6 +41,8 @@
 
 #include <opentxs/core/String.hpp>
 
+#include <vector>
+
 namespace opentxs
 {
 
@@ -76,6 +78,11 @@ public:
                                bool bLineBreaks) const = 0;
     virtual uint8_t* Base64Decode(const char* input, size_t* out_len,
                                   bool bLineBreaks) const = 0;
+    // Decodes into output, reusing its capacity. Returns false if nothing
+    // was decoded.
+    virtual bool Base64Decode(const char* input, size_t in_len,
+                              std::vector<uint8_t>& output,
+                              bool bLineBreaks) const = 0;
     std::string RandomFilename() const;
     String Nonce(const uint32_t size) const;
     String Nonce(const uint32_t size, OTData& rawOutput) const;
@@ -0,0 +1,115 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_CRYPTO_INTEGRITYTAG_HPP
+#define OPENTXS_CORE_CRYPTO_INTEGRITYTAG_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace opentxs
+{
+
+class Nym;
+class OTPassword;
+class OTSignature;
+class String;
+
+// Local integrity tags for objects a process signs and stores itself.
+//
+// When enabled, every contract signed by the designated signer is also given
+// a keyed MAC over its unsigned contents and that signature. The tag is
+// stored next to the object on disk, and a later VerifySignature() for the
+// same signer accepts a matching tag instead of doing a full asymmetric
+// verification. Objects stored before tags were enabled get one the next
+// time they are signed. The tags never leave the local data folder; anything
+// sent elsewhere still carries (and is checked against) its real signatures.
+class IntegrityTag
+{
+public:
+    EXPORT static void Enable(const OTPassword& key, const String& signerID);
+    EXPORT static void Disable();
+    static bool Enabled() { return enabled_.load(); }
+    static bool IsSigner(const Nym& nym);
+
+    static std::string Calculate(
+        const String& contents,
+        const OTSignature& signature);
+
+    // Writes the tag beside the object, or removes a stale one if tag is
+    // empty. Call after the object itself is stored.
+    static bool Store(
+        const std::string& tag,
+        std::string strFolder,
+        std::string oneStr = "",
+        std::string twoStr = "",
+        std::string threeStr = "");
+    static std::string Load(
+        std::string strFolder,
+        std::string oneStr = "",
+        std::string twoStr = "",
+        std::string threeStr = "");
+
+private:
+    // The key and signer in use. Never modified once published, so that
+    // tags are calculated without any lock.
+    class Key
+    {
+    public:
+        std::unique_ptr<OTPassword> key_;
+        std::string signer_;
+    };
+
+    static std::atomic<bool> enabled_;
+    // Read and replaced with std::atomic_load and std::atomic_store
+    static std::shared_ptr<const Key> key_;
+
+    // Tags are kept beside the object, under its filename plus this suffix.
+    static void TagPath(
+        std::string& strFolder,
+        std::string& oneStr,
+        std::string& twoStr,
+        std::string& threeStr);
+
+    IntegrityTag() = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_CRYPTO_INTEGRITYTAG_HPP
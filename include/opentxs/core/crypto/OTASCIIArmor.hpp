@@ -41,7 +41,10 @@
 
 #include <opentxs/core/String.hpp>
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace opentxs
 {
@@ -97,8 +100,28 @@ extern const char* OT_BEGIN_SIGNED_escaped;
 class OTASCIIArmor : public String
 {
 public:
+    // How SetString compresses its input.
+    //
+    // CODEC_ZLIB writes a plain zlib stream, as OT always has, so any
+    // version can decode it. CODEC_STORED skips compression entirely, and
+    // CODEC_LZ4 writes an LZ4 block, which compresses less than zlib but is
+    // several times faster both ways. Both mark the payload with a versioned
+    // header, which only versions that understand the header can decode.
+    // CODEC_LZ4 is only available in builds with OT_ARMOR_LZ4; other builds
+    // use zlib instead, and can't decode LZ4 armor.
+    enum Codec {
+        CODEC_ZLIB = 0,
+        CODEC_STORED = 1,
+        CODEC_LZ4 = 2
+    };
+
     static OTDB::OTPacker* GetPacker();
 
+    // level is a zlib compression level (0-9). Inputs shorter than
+    // uncompressedBelow bytes are deflated at level 0 (no compression).
+    EXPORT static void SetCompression(Codec codec, int32_t level,
+                                      uint32_t uncompressedBelow);
+
     EXPORT OTASCIIArmor();
     EXPORT OTASCIIArmor(const char* szValue);
     EXPORT OTASCIIArmor(const OTData& theValue);
@@ -168,14 +191,27 @@ public:
     EXPORT bool SetData(const OTData& theData, bool bLineBreaks = true);
 
     EXPORT bool GetString(String& theData, bool bLineBreaks = true) const;
+    // Decodes straight into output, reusing its capacity, so a caller which
+    // decodes many messages can keep one buffer around for all of them.
+    EXPORT bool GetString(std::string& output, bool bLineBreaks = true) const;
     EXPORT bool SetString(const String& theData, bool bLineBreaks = true);
 
 private:
-    std::string compress_string(const std::string& str,
-                                int32_t compressionlevel) const;
-    std::string decompress_string(const std::string& str) const;
+    bool decode_base64(std::vector<uint8_t>& output, bool bLineBreaks) const;
+    void compress_buffer(const char* data, size_t size,
+                         std::string& output) const;
+    void decompress_buffer(const uint8_t* data, size_t size,
+                           std::string& output) const;
+    void deflate_buffer(const char* data, size_t size,
+                        int32_t compressionlevel, std::string& output) const;
+    void inflate_buffer(const uint8_t* data, size_t size,
+                        std::string& output) const;
 
     static std::unique_ptr<OTDB::OTPacker> s_pPacker;
+
+    static std::atomic<int32_t> s_nCodec;
+    static std::atomic<int32_t> s_nCompressionLevel;
+    static std::atomic<uint32_t> s_lUncompressedBelow;
 };
 
 } // namespace opentxs
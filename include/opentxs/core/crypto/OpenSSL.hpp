@@ -115,6 +115,9 @@ public:
                                                         // ('int32_t')
     virtual uint8_t* Base64Decode(const char* input, size_t* out_len,
                                   bool bLineBreaks) const;
+    virtual bool Base64Decode(const char* input, size_t in_len,
+                              std::vector<uint8_t>& output,
+                              bool bLineBreaks) const;
 
     virtual OTPassword* DeriveNewKey(const OTPassword& userPassword,
                                      const OTData& dataSalt,
@@ -351,6 +351,7 @@ public:
     // Return False if expired or otherwise should be removed.
     virtual bool ProcessCron(); // OTCron calls this regularly, which is my
                                 // chance to expire, etc.
+    virtual time64_t GetNextWakeTime();
 protected:
 //  virtual void onFinalReceipt();        // Now handled in the parent class.
 //  virtual void onRemovalFromCron();     // Now handled in the parent class.
@@ -223,6 +223,7 @@ public:
     // Return False if expired or otherwise should be removed.
     virtual bool ProcessCron(); // OTCron calls this regularly, which is my
                                 // chance to expire, etc.
+    virtual time64_t GetNextWakeTime();
 
     virtual bool HasTransactionNum(const int64_t& lInput) const;
     virtual void GetAllTransactionNumbers(NumList& numlistOutput) const;
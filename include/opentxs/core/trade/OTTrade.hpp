@@ -199,6 +199,7 @@ public:
     // Return False if expired or otherwise should be removed.
     virtual bool ProcessCron(); // OTCron calls this regularly, which is my
                                 // chance to expire, etc.
+    virtual time64_t GetNextWakeTime();
     virtual bool CanRemoveItemFromCron(Nym& nym);
 
     // From OTScriptable, we override this function. OTScriptable now does fancy
@@ -41,6 +41,9 @@
 
 #include <opentxs/core/app/Settings.hpp>
 
+#include <string>
+#include <vector>
+
 // All directories have a trailing "/" while files do not. <== remember to
 // enforce this!!!
 
@@ -137,6 +140,21 @@ public:
 
     EXPORT static bool ConfirmCreateFolder(const String& strExactPath,
                                            bool& out_Exists, bool& out_IsNew);
+    EXPORT static bool RemoveFolder(const String& strFolderPath); // the
+                                                                  // folder
+                                                                  // must be
+                                                                  // empty.
+    // Names of the files and folders in strFolderPath (without "." and "..")
+    EXPORT static bool ListFolder(const String& strFolderPath,
+                                  std::vector<std::string>& out_vecNames);
+    // Returns once the contents of the file (or folder) have reached the disk.
+    EXPORT static bool SyncPath(const String& strPath);
+    // A name next to strPath which no other writer (in this process or any
+    // other) is using, for a file that will replace strPath.
+    EXPORT static String TempPath(const String& strPath);
+    // Atomically replaces strTo with strFrom, and returns once the rename
+    // has reached the disk. strFrom should already be synced.
+    EXPORT static bool ReplaceFile(const String& strFrom, const String& strTo);
 
     EXPORT static bool ToReal(const String& strExactPath,
                               String& out_strCanonicalPath);
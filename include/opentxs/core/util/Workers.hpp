@@ -0,0 +1,63 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_UTIL_WORKERS_HPP
+#define OPENTXS_CORE_UTIL_WORKERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace opentxs
+{
+
+// The number of workers to use for a configured thread count. Anything less
+// than one means one worker per core.
+EXPORT std::size_t WorkerCount(int32_t configured);
+
+// Runs work(0) .. work(count - 1) on a pool of threads shared by every
+// caller, with work(0) on the calling thread, and returns when all of them
+// have finished. The pool, with the caller, has one thread per core, so the
+// calls may not all run at once: work must not wait for another of its own
+// calls.
+EXPORT void RunWorkers(std::size_t count,
+                       const std::function<void(std::size_t)>& work);
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_UTIL_WORKERS_HPP
@@ -0,0 +1,226 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_DIVIDENDPAYOUT_HPP
+#define OPENTXS_SERVER_DIVIDENDPAYOUT_HPP
+
+#include "PayDividendVisitor.hpp"
+#include <opentxs/core/Identifier.hpp>
+#include <opentxs/core/String.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace opentxs
+{
+
+class OTServer;
+
+// Pays a dividend to the owners of every account of a shares unit.
+//
+// A payout is not run on the request which asks for it. NotarizePayDividend
+// moves the funds and records the parameters of the payout, then hands it to
+// the notary's payout thread.
+//
+// The payout thread first records the balance of every share account in a
+// snapshot, so that shares which move while the vouchers are being delivered
+// can not be paid twice. Vouchers are then delivered a page at a time from
+// the snapshot. Both the snapshot and the delivery hold the notary lock for
+// each page and release it in between, so client requests are served while
+// a large payout is in progress. While the snapshot is taken, the shares
+// unit is frozen: the notary refuses transactions on its accounts, and cron
+// waits, so no balance changes between two pages of the snapshot. Vouchers
+// are issued one at a time. Everything runs on the payout thread:
+// the server nym, the nymboxes and the accounts are only touched with the
+// notary lock held, the same as for any request.
+//
+// Progress is checkpointed in the receipts folder of the notary, in
+// "dividend-<txn>.h" (the parameters of the payout), "dividend-<txn>.s" (the
+// snapshot of the share accounts) and "dividend-<txn>.l" (an append-only
+// log.) Before vouchers are delivered, a pending line records the
+// transaction numbers of the voucher and of its nymbox notice; once the
+// nymbox is saved, a completion line records the amount paid or returned.
+//
+// If the server stops part way through, the payout is finished when it
+// starts again. A pending voucher counts as delivered if its notice is in
+// the nymbox, or if it has already been deposited; otherwise its account is
+// paid again. Completed accounts are skipped. Whatever was not paid out is
+// then refunded to the payer, and the checkpoint is erased.
+class DividendPayout
+{
+public:
+    DividendPayout(OTServer& server, const Identifier& notaryID,
+                   const Identifier& payerNymID,
+                   const Identifier& sharesUnitID,
+                   const Identifier& payoutUnitID,
+                   const Identifier& voucherAcctID, const String& memo,
+                   int64_t amountPerShare, int64_t totalCost,
+                   int64_t transactionNumber);
+
+    // Records the parameters of the payout so it can be run by the payout
+    // thread. Call once the total cost has been moved to the voucher account.
+    bool Begin();
+    // Pays every account which has not been paid yet, then refunds the
+    // leftovers. The caller must hold the notary lock. If lock is set, it is
+    // released between pages, and the payout stops early (keeping its
+    // checkpoint) once the payout thread is asked to stop.
+    bool Run(std::unique_lock<std::mutex>* lock = nullptr);
+
+    int64_t AmountPaidOut() const
+    {
+        return paid_;
+    }
+
+    // Including the refund of the leftovers.
+    int64_t AmountReturned() const
+    {
+        return returned_;
+    }
+
+    // Runs every payout which has been begun but not finished. Called on the
+    // payout thread, with lock (the notary lock) held.
+    static void ResumePending(OTServer& server,
+                              std::unique_lock<std::mutex>& lock);
+
+    // True while a snapshot of the accounts of this unit is being taken.
+    // Balances of the unit must not change until then. The caller must hold
+    // the notary lock.
+    static bool Frozen(const Identifier& unitID);
+    // True while any unit is frozen.
+    static bool Freezing();
+
+private:
+    // One voucher, to the owner of account_ (or back to the payer.)
+    class Delivery
+    {
+    public:
+        std::string account_;
+        int64_t amount_ = 0;
+        int64_t voucher_number_ = 0;
+        int64_t notice_number_ = 0;
+        String voucher_;
+    };
+
+    // An undelivered voucher found in the checkpoint.
+    class Pending
+    {
+    public:
+        char kind_ = 'P';
+        int64_t amount_ = 0;
+        int64_t voucher_number_ = 0;
+        int64_t notice_number_ = 0;
+        std::string recipient_;
+    };
+
+    // One share account, as recorded in the snapshot.
+    class Share
+    {
+    public:
+        std::string account_;
+        std::string owner_;
+        int64_t amount_ = 0;
+    };
+
+    static std::mutex index_lock_;
+    // The units being snapshotted. Guarded by the notary lock.
+    static std::multiset<std::string> frozen_;
+
+    OTServer& server_;
+    Identifier notary_id_;
+    Identifier payer_nym_id_;
+    Identifier shares_unit_id_;
+    Identifier voucher_acct_id_;
+    int64_t total_cost_;
+    int64_t transaction_number_;
+    PayDividendVisitor vouchers_;
+
+    std::set<std::string> completed_;
+    std::map<std::string, Pending> pending_;
+    bool refunded_ = false;
+
+    int64_t paid_ = 0;
+    int64_t returned_ = 0;
+    std::size_t processed_ = 0;
+    std::chrono::steady_clock::time_point start_;
+
+    static bool AddToIndex(const std::string& notaryID,
+                           const std::string& number);
+    static bool RemoveFromIndex(const std::string& notaryID,
+                                const std::string& number);
+
+    std::string FileName(const char* suffix) const;
+    bool FilePath(const char* suffix, std::string& path) const;
+    bool Append(const std::string& lines);
+    bool LoadCheckpoint();
+    bool ResolvePending();
+    bool Delivered(const Pending& pending) const;
+    void Erase();
+
+    // Records every share account which is owed something, followed by a
+    // line with the number of accounts recorded. If lock is set, it is
+    // released between pages of the registry.
+    bool Snapshot(std::size_t& total, std::unique_lock<std::mutex>* lock);
+    bool RecordShares(std::size_t& total, std::unique_lock<std::mutex>* lock);
+    // True if a complete snapshot was recorded by an earlier run.
+    bool SnapshotComplete(std::size_t& total) const;
+    bool ReadPage(std::istream& snapshot, std::vector<Share>& page) const;
+
+    bool PayPage(const std::vector<Share>& page);
+    bool Deliver(const Identifier& recipient, const char kind,
+                 std::vector<Delivery>& batch);
+    bool RefundLeftovers();
+    void ReportProgress(const std::size_t total) const;
+    // Lets client requests in between two pages. False if the payout thread
+    // has been asked to stop.
+    bool Pause(std::unique_lock<std::mutex>* lock) const;
+
+    DividendPayout() = delete;
+    DividendPayout(const DividendPayout&) = delete;
+    DividendPayout& operator=(const DividendPayout&) = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_DIVIDENDPAYOUT_HPP
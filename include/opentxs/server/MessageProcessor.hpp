@@ -39,8 +39,11 @@
 #ifndef OPENTXS_SERVER_MESSAGEPROCESSOR_HPP
 #define OPENTXS_SERVER_MESSAGEPROCESSOR_HPP
 
+#include <atomic>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
 #include <czmq.h>
 
 // forward declare czmq types
@@ -51,8 +54,11 @@ typedef struct _zpoller_t zpoller_t;
 namespace opentxs
 {
 
+class Identifier;
+class Message;
 class ServerLoader;
 class OTServer;
+class UserCommandProcessor;
 
 class MessageProcessor
 {
@@ -63,14 +69,25 @@ public:
 
 private:
     void init(int port, zcert_t* transportKey);
-    bool processMessage(const std::string& messageString, std::string& reply);
-    void processSocket();
+    // Verifies the sender and the signature of a request without holding
+    // the notary lock, and sets credentials to the hash of the credential
+    // index the signature was verified against. Returns false if the
+    // request must instead be authenticated by UserCommandProcessor, which
+    // includes every request that fails here.
+    bool authenticate(Message& message, Identifier& credentials) const;
+    bool processMessage(UserCommandProcessor& processor,
+                        const std::string& messageString, std::string& reply);
+    void forward(zsock_t* from, zsock_t* to);
+    void worker();
 
 private:
     OTServer* server_;
-    zsock_t* zmqSocket_;
+    zsock_t* zmqSocket_;  // ROUTER, faces the clients
+    zsock_t* zmqBackend_; // DEALER, distributes requests to the workers
     zactor_t* zmqAuth_;
     zpoller_t* zmqPoller_;
+    std::atomic<bool> running_;
+    std::vector<std::thread> workers_;
 };
 
 } // namespace opentxs
@@ -0,0 +1,87 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_MINTGENERATOR_HPP
+#define OPENTXS_SERVER_MINTGENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace opentxs
+{
+
+class OTServer;
+
+// Generates new mint series for the units of a notary.
+//
+// The keys of each series are generated concurrently, by the mint_threads
+// workers, with keys of key_size bits. Each series is saved privately (as
+// "<unit>.<series>") before its public copy ("<unit>.PUBLIC") replaces the
+// previous one, so clients never see a series the notary can't load.
+class MintGenerator
+{
+public:
+    explicit MintGenerator(OTServer& server);
+
+    // Generates and saves the series after the current one of unitID (or
+    // series 0, if the unit has no mint yet.)
+    bool NextSeries(const std::string& unitID, int32_t& series) const;
+    // Does the same for every unit definition on the notary which already
+    // has a mint, logging the progress after each one. Returns the number of
+    // series generated.
+    std::size_t NextSeriesForAllUnits() const;
+
+private:
+    OTServer& server_;
+    std::vector<int64_t> denominations_;
+
+    // The series of the public mint of unitID, or -1 if there isn't one.
+    int32_t CurrentSeries(const std::string& unitID) const;
+    // Generates series of unitID without the notary lock, then saves it and
+    // makes it current with the lock held.
+    bool Generate(const std::string& unitID, const int32_t series) const;
+
+    MintGenerator(const MintGenerator&) = delete;
+    MintGenerator& operator=(const MintGenerator&) = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_MINTGENERATOR_HPP
@@ -45,12 +45,18 @@
 #include "Transactor.hpp"
 #include "Notary.hpp"
 #include "MainFile.hpp"
+#include "ObjectCache.hpp"
 #include "UserCommandProcessor.hpp"
 #include <opentxs/core/util/Common.hpp>
 #include <opentxs/core/cron/OTCron.hpp>
 #include <opentxs/core/Nym.hpp>
 #include <opentxs/core/OTTransaction.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <cstddef>
 #include <czmq.h>
 
@@ -69,6 +75,8 @@ class OTServer
     friend class UserCommandProcessor;
     friend class MainFile;
     friend class PayDividendVisitor;
+    friend class DividendPayout;
+    friend class MintGenerator;
     friend class Notary;
 
 private:
@@ -97,10 +105,11 @@ public:
 
     EXPORT void ActivateCron();
     void ProcessCron();
-    int64_t computeTimeout()
-    {
-        return m_Cron.computeTimeout();
-    }
+
+    // Generates the next mint series for every unit definition on this
+    // notary, and returns how many were generated. Also run by Init when
+    // the "nextmintseries" argument is set.
+    EXPORT std::size_t GenerateNextMintSeries();
 
 private:
     void CreateMainFile(
@@ -113,6 +122,13 @@ private:
                              const OTPayment* payment = nullptr,
                              const char* command = nullptr);
 
+    bool SendInstrumentsToNym(const Identifier& notaryID,
+                              const Identifier& senderNymID,
+                              const Identifier& recipientNymID,
+                              const std::vector<const OTPayment*>& payments,
+                              const std::vector<int64_t>& numbers,
+                              const char* command = nullptr);
+
     // Note: SendInstrumentToNym and SendMessageToNym CALL THIS.
     // They are higher-level, this is lower-level.
     bool DropMessageToNymbox(const Identifier& notaryID,
@@ -122,12 +138,43 @@ private:
                              Message* msg = nullptr,
                              const String* messageString = nullptr,
                              const char* command = nullptr);
+    bool LoadRecipientNym(Nym& recipient) const;
+    bool SealMessageToNym(const Identifier& senderNymID,
+                          const Identifier& recipientNymID,
+                          const Nym& recipient, const String& messageString,
+                          Message& msg) const;
+
+    // Loads (or creates) the integrity key sealed to the server nym and
+    // enables integrity tags, if configured.
+    void InitIntegrity();
+
+    // Runs on cron_thread_ until the server is destroyed.
+    void CronThread();
+    void StopCron();
+
+    // Runs dividend payouts on payout_thread_ until the server is destroyed.
+    void StartPayouts();
+    void PayoutThread();
+    void StopPayouts();
+    // Wakes the payout thread. The caller must hold lock_.
+    void QueuePayouts();
 
 private:
     MainFile mainFile_;
     Notary notary_;
     Transactor transactor_;
-    UserCommandProcessor userCommandProcessor_;
+    // Serializes access to the notary state between the request workers
+    // and cron.
+    std::mutex lock_;
+    std::thread cron_thread_;
+    std::atomic<bool> cron_running_;
+    // Signalled (with lock_) to wake the cron thread early.
+    std::condition_variable cron_wake_;
+    std::thread payout_thread_;
+    std::atomic<bool> payout_running_;
+    // Set (with lock_) when a payout has been begun and not yet run.
+    bool payout_pending_;
+    std::condition_variable payout_wake_;
 
     String m_strWalletFilename;
     // Used at least for whether or not to write to the PID.
@@ -146,6 +193,9 @@ private:
     Nym m_nymServer;
 
     OTCron m_Cron; // This is where re-occurring and expiring tasks go.
+
+    // Verified nymfiles, credentials and boxes, shared by the request workers.
+    ObjectCache cache_;
 };
 
 } // namespace opentxs
@@ -0,0 +1,106 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_OBJECTCACHE_HPP
+#define OPENTXS_SERVER_OBJECTCACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+
+class Contract;
+class Nym;
+class String;
+
+// Remembers which serialized objects the notary has already loaded and
+// verified, so that a hot Nym or box does not go through signature
+// verification on every request.
+//
+// Entries are keyed by object ID plus a hash of the serialized content. Any
+// change to the stored object changes the hash, so a stale entry can never be
+// returned; it simply ages out of the LRU list.
+class ObjectCache
+{
+public:
+    explicit ObjectCache(const std::size_t capacity);
+
+    // Drop-in replacements for the corresponding Nym and Contract methods.
+    // VerifyPseudonym uses the wallet's nym verification cache.
+    bool VerifyPseudonym(const Nym& nym);
+    bool LoadSignedNymfile(Nym& nym, Nym& signer);
+    bool VerifySignature(const Contract& contract, const Nym& signer);
+
+    std::uint64_t Hits() const { return hits_.load(); }
+    std::uint64_t Misses() const { return misses_.load(); }
+    std::size_t Size() const;
+    void SetCapacity(const std::size_t capacity);
+    void Clear();
+
+private:
+    typedef std::list<std::string> LRU;
+    typedef std::pair<std::string, LRU::iterator> Entry;
+
+    mutable std::mutex lock_;
+    std::size_t capacity_;
+    LRU lru_;
+    std::map<std::string, Entry> entries_;
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> misses_;
+
+    static std::string Hash(const String& input);
+
+    bool Find(const std::string& key, std::string& value);
+    void Insert(const std::string& key, const std::string& value);
+    // Caller must hold lock_
+    void Trim();
+
+    ObjectCache() = delete;
+    ObjectCache(const ObjectCache&) = delete;
+    ObjectCache& operator=(const ObjectCache&) = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_OBJECTCACHE_HPP
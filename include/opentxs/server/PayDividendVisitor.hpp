@@ -119,6 +119,9 @@ public:
         return m_lAmountReturned;
     }
 
+    bool IssueVoucher(int64_t lAmount, int64_t lTransactionNumber,
+                      const Identifier& recipientNymID, String& strVoucher);
+
     virtual bool Trigger(Account& theAccount);
 };
 
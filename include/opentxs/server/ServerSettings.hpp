@@ -77,6 +77,66 @@ struct ServerSettings
         __heartbeat_ms_between_beats = value;
     }
 
+    static int32_t GetWorkerThreads()
+    {
+        return __worker_threads;
+    }
+
+    static void SetWorkerThreads(int32_t value)
+    {
+        __worker_threads = value;
+    }
+
+    static int32_t GetTokenVerifyThreads()
+    {
+        return __token_verify_threads;
+    }
+
+    static void SetTokenVerifyThreads(int32_t value)
+    {
+        __token_verify_threads = value;
+    }
+
+    static int32_t GetMintThreads()
+    {
+        return __mint_threads;
+    }
+
+    static void SetMintThreads(int32_t value)
+    {
+        __mint_threads = value;
+    }
+
+    static int32_t GetMintKeySize()
+    {
+        return __mint_key_size;
+    }
+
+    static void SetMintKeySize(int32_t value)
+    {
+        __mint_key_size = value;
+    }
+
+    static int64_t GetObjectCacheSize()
+    {
+        return __object_cache_size;
+    }
+
+    static void SetObjectCacheSize(int64_t value)
+    {
+        __object_cache_size = value;
+    }
+
+    static bool GetIntegrityTags()
+    {
+        return __integrity_tags;
+    }
+
+    static void SetIntegrityTags(bool value)
+    {
+        __integrity_tags = value;
+    }
+
     static const std::string& GetOverrideNymID()
     {
         return __override_nym_id;
@@ -92,6 +152,27 @@ struct ServerSettings
     static int32_t __heartbeat_no_requests;
     static int32_t __heartbeat_ms_between_beats;
 
+    // The number of threads servicing client requests.
+    static int32_t __worker_threads;
+
+    // The number of tokens verified at once for a cash deposit.
+    // (0 means one per core.)
+    static int32_t __token_verify_threads;
+
+    // The number of threads generating the keys of a new mint series.
+    // (0 means one per core.)
+    static int32_t __mint_threads;
+
+    // The size, in bits, of the keys of a new mint series.
+    static int32_t __mint_key_size;
+
+    // The maximum number of verified objects kept in the notary's cache.
+    static int64_t __object_cache_size;
+
+    // Tag stored objects with a local MAC instead of re-verifying the server's
+    // own signatures when they are loaded.
+    static bool __integrity_tags;
+
     // The Nym who's allowed to do certain commands even if they are turned off.
     static std::string __override_nym_id;
     // Are usage credits REQUIRED in order to use this server?
@@ -43,6 +43,9 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include <cstddef>
 #include <cstdint>
 
 namespace opentxs
@@ -65,6 +68,13 @@ public:
 
     bool issueNextTransactionNumber(int64_t& txNumber);
     bool issueNextTransactionNumberToNym(Nym& nym, int64_t& txNumber);
+    // Issues count numbers with a single save of the main file.
+    bool issueTransactionNumbers(const std::size_t count,
+                                 std::vector<int64_t>& numbers);
+    // Issues count numbers to nym with a single save of the main file and a
+    // single save of the nymfile.
+    bool issueTransactionNumbersToNym(Nym& nym, const std::size_t count,
+                                      std::vector<int64_t>& numbers);
     bool verifyTransactionNumber(Nym& nym, const int64_t& transactionNumber);
     bool removeTransactionNumber(Nym& nym, const int64_t& transactionNumber,
                                  bool save = false);
@@ -112,6 +122,9 @@ public:
     // Each asset contract has its own series of Mints
     Mint* getMint(const Identifier& instrumentDefinitionID,
                   int32_t seriesCount);
+    // Drops the cached mints of instrumentDefinitionID, so that they are
+    // loaded again (from the files of the latest series) when next used.
+    void forgetMints(const String& instrumentDefinitionID);
 
 private:
     // Why does the map of mints use multimap instead of map?
@@ -132,6 +145,17 @@ private:
     typedef std::map<std::string, std::string> BasketsMap;
 
 private:
+    // Caller must hold lock_. Advances the counter by count and saves the
+    // main file, setting first to the lowest of the new numbers.
+    bool reserveTransactionNumbers(const std::size_t count, int64_t& first);
+    // Caller must hold lock_.
+    void releaseTransactionNumbers(const std::size_t count);
+    Nym& issuingNym(Nym& nym);
+
+    // Guards transactionNumber_ and the numbers being recorded on the nym
+    // they are issued to. Numbers are only issued with the notary lock held
+    // (dividend payouts included), so this is never contended today.
+    std::mutex lock_;
     // This stores the last VALID AND ISSUED transaction number.
     int64_t transactionNumber_;
     // maps basketId with basketAccountId
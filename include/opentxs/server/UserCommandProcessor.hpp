@@ -55,8 +55,13 @@ class UserCommandProcessor
 public:
     UserCommandProcessor(OTServer* server);
 
+    // If verifiedCredentials is set, the caller has already verified the
+    // signature on msgIn against the sender's credentials, and this is the
+    // hash of their credential index. The checks are only skipped if the
+    // credentials loaded here hash the same.
     bool ProcessUserCommand(Message& msgIn, Message& msgOut,
-                            ClientConnection* connection, Nym* nym);
+                            ClientConnection* connection, Nym* nym,
+                            const Identifier* verifiedCredentials = nullptr);
 
 private:
     bool SendMessageToNym(const Identifier& notaryID,
@@ -40,6 +40,8 @@
 #define OPENTXS_STORAGE_STORAGE_HPP
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <iostream>
@@ -51,12 +53,15 @@
 #include <string>
 #include <thread>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include <opentxs-proto/verify/VerifyCredentials.hpp>
 #include <opentxs-proto/verify/VerifyContacts.hpp>
 #include <opentxs-proto/verify/VerifyContracts.hpp>
 #include <opentxs-proto/verify/VerifyStorage.hpp>
 
+#include <opentxs/storage/StorageCache.hpp>
 #include <opentxs/storage/StorageConfig.hpp>
 
 namespace opentxs
@@ -112,7 +117,7 @@ class Storage
 template<class T>
 bool LoadProto(
     const std::string& hash,
-    std::shared_ptr<T>& serialized,
+    std::shared_ptr<const T>& serialized,
     const bool checking = false)
 {
     if (hash.empty()) {
@@ -123,6 +128,10 @@ bool LoadProto(
         return false;
     }
 
+    serialized = std::dynamic_pointer_cast<const T>(cache_.Get(hash));
+
+    if (serialized) { return true; }
+
     bool attemptFirst;
     if (gc_running_.load() ) {
         attemptFirst = !current_bucket_;
@@ -131,38 +140,75 @@ bool LoadProto(
     }
 
     std::string data;
+    std::size_t size = 0;
+    std::shared_ptr<T> loaded;
+    // Parses straight from the backend's buffer when it allows
+    const Reader parse =
+        [&loaded, &size](const char* value, const std::size_t length) -> bool
+    {
+        size = length;
 
-    std::lock_guard<std::mutex> bucketLock(bucket_lock_);
-    bool foundInPrimary = false;
-    if (Load(hash, data, attemptFirst)) {
-        if (1 < data.size()) {
-            serialized.reset(new T);
-            serialized->ParseFromArray(data.c_str(), data.size());
+        if (1 >= length) { return false; }
 
-            foundInPrimary = proto::Check<T>(*serialized, 0, 0xFFFFFFFF);
+        loaded.reset(new T);
+
+        if (loaded->ParseFromArray(value, static_cast<int>(length)) &&
+            proto::Check<T>(*loaded, 0, 0xFFFFFFFF)) {
+
+            return true;
         }
-    }
 
-    bool foundInSecondary = false;
-    if (!foundInPrimary) {
-        // try again in the other bucket
-        if (Load(hash, data, !attemptFirst)) {
-            if (1 < data.size()) {
-                serialized.reset(new T);
-                serialized->ParseFromArray(data.c_str(), data.size());
+        loaded.reset();
 
-                foundInSecondary = proto::Check<T>(*serialized, 0, 0xFFFFFFFF);
-            }
+        return false;
+    };
+
+    // Objects written since the last root update have not reached the
+    // backend yet
+    if (LoadPending(hash, data)) { parse(data.data(), data.size()); }
+
+    if (!loaded) {
+        const std::size_t readSlot = BeginRead();
+
+        // try the other bucket if the object is not in the first one
+        for (const bool bucket : {attemptFirst, !attemptFirst}) {
+            if (LoadInPlace(hash, bucket, parse)) { break; }
         }
+
+        EndRead(readSlot);
     }
 
-    if (!foundInPrimary && !foundInSecondary && !checking) {
-        std::cerr << "Failed loading object" << std::endl
-                  << "Hash: " << hash << std::endl
-                  << "Size: " << data.size() << std::endl;
+    if (!loaded) {
+        if (!checking) {
+            std::cerr << "Failed loading object" << std::endl
+                      << "Hash: " << hash << std::endl
+                      << "Size: " << size << std::endl;
+        }
+
+        return false;
     }
 
-    return (foundInPrimary || foundInSecondary);
+    cache_.Insert(hash, loaded, sizeof(T), size);
+    serialized = loaded;
+
+    return true;
+}
+
+template<class T>
+bool LoadProto(
+    const std::string& hash,
+    std::shared_ptr<T>& serialized,
+    const bool checking = false)
+{
+    std::shared_ptr<const T> cached;
+
+    if (!LoadProto<T>(hash, cached, checking)) { return false; }
+
+    // Cached objects are shared, so a caller which may modify the object
+    // gets its own copy
+    serialized.reset(new T(*cached));
+
+    return true;
 }
 
 template<class T>
@@ -172,10 +218,7 @@ bool StoreProto(const T& data, std::string& key, std::string& plaintext)
         plaintext = opentxs::ProtoAsString<T>(data);
         digest_(Storage::HASH_TYPE, plaintext, key);
 
-        return Store(
-            key,
-            plaintext,
-            current_bucket_.load());
+        return StorePending(key, plaintext);
     }
     return false;
 }
@@ -209,6 +252,25 @@ private:
      */
     typedef std::map<std::string, Metadata> Index;
 
+    /** One node of an index trie
+     *
+     *  Each index is persisted as a hash array mapped trie instead of a single
+     *  flat list, so that changing one entry only rewrites the nodes along
+     *  its path. A node without children is serialized as the same protobuf
+     *  type the flat index used, so a flat index written by an older version
+     *  loads as a trie with a single node. A node with children is written as
+     *  a versioned node record (see StoreIndexNode) which points to the hash
+     *  of its children and to a protobuf holding its own leaf entries.
+     */
+    class IndexNode
+    {
+    public:
+        Index items_;
+        std::map<std::uint32_t, std::unique_ptr<IndexNode>> children_;
+        std::string hash_;
+        bool dirty_ = false;
+    };
+
     static Storage* instance_pointer_;
 
     std::thread* gc_thread_ = nullptr;
@@ -219,9 +281,102 @@ private:
 
     void CollectGarbage();
     bool MigrateKey(const std::string& key);
+    // Methods for migrating index tries during garbage collection. A subtree
+    // is marked in the active bucket once all of it has been migrated, so an
+    // interrupted collection resumes without walking it again.
+    static std::string MigratedKey(const std::string& hash);
+    bool Migrated(const std::string& hash);
+    bool MarkMigrated(const std::string& hash);
+    template<class T>
+    bool MigrateIndex(
+        const std::string& hash,
+        const std::function<bool(const proto::StorageItemHash&)>& leaf);
+    // Splits the trie rooted at hash into tasks for the gc worker pool
+    template<class T>
+    bool QueueIndex(
+        const std::string& hash,
+        const std::function<bool(const proto::StorageItemHash&)>& leaf,
+        std::vector<std::function<bool()>>& tasks,
+        std::vector<std::string>& roots);
+    bool RunGCTasks(const std::vector<std::function<bool()>>& tasks);
+
+    // Methods for tracking backend reads without blocking them
+    std::size_t BeginRead();
+    void EndRead(const std::size_t slot);
+    void WaitForReaders();
+
+    // Methods for deferring writes until the next root update
+    void BeginBatch();
+    bool EndBatch();
+    // Locks write_lock_ for a change to the stored objects or indices. While
+    // another thread has a batch open, waits until it is closed, so that a
+    // failed batch can't discard changes which were already reported as
+    // stored.
+    std::unique_lock<std::mutex> LockWrites();
+    // Writes every pending object to the backend in a single call
+    bool Flush();
+    bool LoadPending(const std::string& key, std::string& value);
+    bool StorePending(const std::string& key, const std::string& value);
+
+    // Methods for maintaining index tries
+    static std::uint32_t IndexSlot(
+        const std::string& id,
+        const std::uint32_t depth);
+    void IndexErase(
+        IndexNode& node,
+        const std::uint32_t depth,
+        const std::string& id);
+    void IndexInsert(
+        IndexNode& node,
+        const std::uint32_t depth,
+        const std::string& id,
+        const Metadata& metadata);
+    void IndexSplit(IndexNode& node, const std::uint32_t depth);
+    // Reflects the current state of index[id] in the trie. Caller must hold
+    // the lock for index.
+    void IndexUpdate(
+        const Index& index,
+        IndexNode& trie,
+        const std::string& id);
+    // Methods for raw objects, which bypass proto::Check and the cache
+    bool LoadRaw(const std::string& key, std::string& value);
+    bool StoreRaw(const std::string& value, std::string& key);
+    // Loads a stored trie node. leaves is the hash of the protobuf holding
+    // the leaf entries of the node, or empty if it has none.
+    bool LoadIndexNode(
+        const std::string& hash,
+        std::string& leaves,
+        std::map<std::uint32_t, std::string>& children);
+    bool StoreIndexNode(
+        const std::string& leaves,
+        const std::map<std::uint32_t, std::string>& children,
+        std::string& hash);
+    // Loads the trie rooted at hash into index and node. root, if set,
+    // receives the leaf protobuf of the root node.
+    template<class T>
+    bool ReadIndex(
+        const std::string& hash,
+        Index& index,
+        IndexNode& node,
+        const std::function<void(const T&)>& root = nullptr,
+        const std::uint32_t depth = 0);
+    // Stores every modified node of the trie, and returns the root node
+    template<class T>
+    bool StoreIndex(
+        IndexNode& node,
+        T& serialized,
+        const std::function<void(T&)>& decorate = nullptr);
+    // Visits every node hash and every leaf entry of a stored trie
+    template<class T>
+    bool WalkIndex(
+        const std::string& hash,
+        const std::function<bool(const std::string&)>& node,
+        const std::function<bool(const proto::StorageItemHash&)>& leaf);
     // Regenerate in-memory indices by recursively loading index objects
     // starting from the root hash
     void Read();
+    // Loads the indices from the current root. Caller must hold init_lock_.
+    void ReadIndices();
     void RunMapPublicNyms(NymLambda lambda); // copy the lambda since original
                                              // may destruct during execution
     void RunMapServers(ServerLambda lambda); // copy the lambda since original
@@ -236,31 +391,42 @@ private:
         const std::string& alias);
     bool UpdateNym(const proto::StorageNym& nym, const std::string& alias);
     bool UpdateNymAlias(const std::string& id, const std::string& alias);
-    bool UpdateNyms(std::unique_lock<std::mutex>& nymLock);
+    bool UpdateNyms(
+        std::unique_lock<std::mutex>& nymLock,
+        const std::string& id);
     bool UpdateSeed(
         const std::string& id,
         const std::string& hash,
         const std::string& alias);
     bool UpdateSeedAlias(const std::string& id, const std::string& alias);
     bool UpdateSeedDefault(const std::string& id);
-    bool UpdateSeeds(std::unique_lock<std::mutex>& seedlock);
+    bool UpdateSeeds(
+        std::unique_lock<std::mutex>& seedlock,
+        const std::string& id);
     bool UpdateServer(
         const std::string& id,
         const std::string& hash,
         const std::string& alias);
     bool UpdateServerAlias(const std::string& id, const std::string& alias);
-    bool UpdateServers(std::unique_lock<std::mutex>& serverlock);
+    bool UpdateServers(
+        std::unique_lock<std::mutex>& serverlock,
+        const std::string& id);
     bool UpdateUnit(
         const std::string& id,
         const std::string& hash,
         const std::string& alias);
     bool UpdateUnitAlias(const std::string& id, const std::string& alias);
-    bool UpdateUnits(std::unique_lock<std::mutex>& unitlock);
-    bool UpdateItems(const proto::StorageCredentials& creds);
-    bool UpdateItems(const proto::StorageNymList& nyms);
-    bool UpdateItems(const proto::StorageSeeds& seeds);
-    bool UpdateItems(const proto::StorageServers& servers);
-    bool UpdateItems(const proto::StorageUnits& units);
+    bool UpdateUnits(
+        std::unique_lock<std::mutex>& unitlock,
+        const std::string& id);
+    // Stores the modified index tries and the items object, unless a batch
+    // is open. On failure the in-memory indices are rolled back to the last
+    // stored root. Caller must hold write_lock_.
+    bool UpdateIndices();
+    bool WriteIndices();
+    // Drops pending objects and reloads the indices from the backend.
+    // Caller must hold write_lock_.
+    void Rollback();
     bool UpdateRoot(const proto::StorageItems& items);
     bool UpdateRoot(proto::StorageRoot& root, const std::string& gcroot);
     bool UpdateRoot();
@@ -274,7 +440,6 @@ protected:
     Random random_;
 
     std::mutex init_lock_; // controls access to Read() method
-    std::mutex bucket_lock_; // ensures buckets not changed during read
     std::mutex cred_lock_; // ensures atomic writes to credentials_
     std::mutex default_seed_lock_; // ensures atomic writes to default_seed_
     std::mutex gc_lock_; // prevents multiple garbage collection threads
@@ -283,6 +448,9 @@ protected:
     std::mutex server_lock_; // ensures atomic writes to servers_
     std::mutex unit_lock_; // ensures atomic writes to units_
     std::mutex write_lock_; // ensure atomic writes
+    std::mutex pending_lock_; // ensures atomic writes to pending_
+
+    StorageCache cache_;
 
     std::string root_hash_;
     std::string old_gc_root_; // used if a previous run of gc did not finish
@@ -293,12 +461,40 @@ protected:
     std::atomic<bool> isLoaded_;
     std::atomic<bool> gc_running_;
     std::atomic<bool> gc_resume_;
+    // Backend reads register in the slot for the current epoch, so that
+    // a bucket can be emptied once every read which started before the
+    // bucket stopped being current has finished
+    std::atomic<std::uint64_t> read_epoch_;
+    std::atomic<std::uint64_t> readers_[2];
     int64_t last_gc_ = 0;
+    // Progress of the current garbage collection run
+    std::atomic<int64_t> gc_started_;
+    std::atomic<std::uint64_t> gc_migrated_;
+    std::atomic<std::uint64_t> gc_skipped_;
+    std::atomic<std::uint64_t> gc_tasks_;
+    std::atomic<std::uint64_t> gc_tasks_done_;
+    std::mutex throttle_lock_; // ensures atomic writes to throttle_next_
+    std::chrono::steady_clock::time_point throttle_next_;
     Index credentials_;
     Index nyms_;
     Index seeds_;
     Index servers_;
     Index units_;
+    // Persistent layout of the indices above. Only modified with write_lock_
+    IndexNode credential_trie_;
+    IndexNode nym_trie_;
+    IndexNode seed_trie_;
+    IndexNode server_trie_;
+    IndexNode unit_trie_;
+    // Objects which have been stored but not yet written to the backend.
+    // Flushed immediately before each root update.
+    std::map<std::string, std::string> pending_;
+    // Number of open batches, all on batch_owner_. Only modified with
+    // write_lock_
+    std::uint32_t batches_ = 0;
+    std::thread::id batch_owner_;
+    // Signalled (with write_lock_) when the last open batch is closed
+    std::condition_variable batch_closed_;
 
     Storage(
         const StorageConfig& config,
@@ -320,6 +516,32 @@ protected:
         const bool bucket) const = 0;
     virtual bool EmptyBucket(const bool bucket) = 0;
 
+    // Blocks as needed to keep garbage collection I/O under
+    // config_.gc_max_keys_per_second_
+    void Throttle();
+
+    /** A set of key/value pairs to be written together */
+    typedef std::vector<std::pair<std::string, std::string>> KeyValues;
+
+    // Stores all of values in the same bucket. Backends which can commit
+    // several writes at once (a single transaction, a single sync) should
+    // override this. The default stores them one at a time.
+    virtual bool Store(const KeyValues& values, const bool bucket) const;
+
+    /** Receives a stored value. The data is only valid during the call. */
+    typedef std::function<bool(const char*, const std::size_t)> Reader;
+
+    // Passes the value of key to reader. Backends which can expose a value
+    // without copying it (a memory map) should override this. The default
+    // loads a copy.
+    virtual bool LoadInPlace(
+        const std::string& key,
+        const bool bucket,
+        const Reader& reader) const;
+
+    // False if the backend failed to open
+    virtual bool Ready() const { return true; }
+
 public:
     /** A list of object IDs and their associated aliases
      *  * string: id of the stored object
@@ -327,13 +549,78 @@ public:
      */
     typedef std::list<std::pair<std::string, std::string>> ObjectList;
 
-    // Method for instantiating the singleton.
+    /** Groups several writes into a single index and root update
+     *
+     *  While any Batch is open, stores and alias changes update the in-memory
+     *  indices immediately but the index tries, the items object and the root
+     *  are not rewritten. When the last open Batch is committed (or
+     *  destroyed) the modified indices are stored once, every object written
+     *  in the meantime is handed to the backend in one call, and the root is
+     *  swapped once.
+     *
+     *  Inside a Batch, a successful Store() only means the object was
+     *  staged; nothing has reached the backend yet. Only the result of
+     *  Commit() says whether it was persisted. If the commit fails, every
+     *  change staged since the last stored root is discarded.
+     *
+     *  Batches belong to the thread which opened them. While one is open,
+     *  writes and batches from every other thread wait until it is closed,
+     *  so the changes a failed commit discards are only ever its own. A
+     *  thread must not wait on another thread while it holds a Batch.
+     */
+    class Batch
+    {
+    private:
+        Storage& storage_;
+        bool open_ = true;
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    public:
+        explicit Batch(Storage& storage);
+
+        // Returns false if the writes could not be stored. Only the last
+        // open Batch writes anything, so an inner one always succeeds.
+        bool Commit();
+
+        ~Batch();
+    };
+
+    /** Progress of the current, or most recent, garbage collection run */
+    class GCStatus
+    {
+    public:
+        bool running_ = false;
+        int64_t started_ = 0;
+        // Keys copied to the active bucket
+        std::uint64_t migrated_ = 0;
+        // Subtrees already finished by an interrupted run
+        std::uint64_t skipped_ = 0;
+        std::uint64_t tasks_ = 0;
+        std::uint64_t tasks_done_ = 0;
+    };
+
+    // Opens the backend named by config.backend_. Returns nullptr if that
+    // backend isn't compiled in or can't be opened.
+    static Storage* Factory(
+        const Digest& hash,
+        const Random& random,
+        const StorageConfig& config);
+    // Method for instantiating the singleton. Aborts if the backend can't
+    // be opened.
     static Storage& It(
         const Digest& hash,
         const Random& random,
         const StorageConfig& config);
 
     std::string DefaultSeed();
+    GCStatus GarbageCollectionStatus() const;
+    // Hit rate and memory use of the parsed object cache
+    std::uint64_t CacheHits() const { return cache_.Hits(); }
+    std::uint64_t CacheMisses() const { return cache_.Misses(); }
+    std::size_t CacheBytes() const { return cache_.Bytes(); }
+    std::size_t CacheObjects() const { return cache_.Count(); }
     bool Load(
         const std::string& id,
         std::shared_ptr<proto::Credential>& cred,
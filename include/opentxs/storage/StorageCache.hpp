@@ -0,0 +1,137 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_STORAGE_STORAGECACHE_HPP
+#define OPENTXS_STORAGE_STORAGECACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <google/protobuf/message_lite.h>
+
+namespace opentxs
+{
+
+// Keeps recently loaded objects in parsed and validated form, so that
+// loading the same object again skips both the backend read and the parse.
+//
+// Entries are keyed by the hash of the serialized object. Since a key always
+// refers to the same bytes, an entry never goes stale; entries age out of
+// the LRU list once the memory used by the cached objects exceeds capacity.
+//
+// The cache is split into shards by key, each with its own lock and LRU
+// list, so that concurrent loads of different objects rarely wait for each
+// other.
+class StorageCache
+{
+public:
+    typedef std::shared_ptr<const google::protobuf::MessageLite> Object;
+
+    // capacity is in bytes of memory, spread evenly over the shards
+    explicit StorageCache(const std::size_t capacity);
+
+    Object Get(const std::string& hash);
+    // objectSize is sizeof() the parsed message, serializedSize the length
+    // of the bytes it was parsed from.
+    void Insert(
+        const std::string& hash,
+        const Object& object,
+        const std::size_t objectSize,
+        const std::size_t serializedSize);
+
+    std::uint64_t Hits() const { return hits_.load(); }
+    std::uint64_t Misses() const { return misses_.load(); }
+    // Estimated memory used by the cached entries
+    std::size_t Bytes() const;
+    std::size_t Count() const;
+    void SetCapacity(const std::size_t capacity);
+    void Clear();
+
+    // Estimated memory held by one entry. The protobuf lite runtime can't
+    // report the space a message uses, so this counts the message object,
+    // its field data (at twice the serialized size, for the allocations
+    // behind strings and repeated fields) and the cache's own bookkeeping.
+    static std::size_t Footprint(
+        const std::string& hash,
+        const std::size_t objectSize,
+        const std::size_t serializedSize);
+
+private:
+    typedef std::list<std::string> LRU;
+
+    class Entry
+    {
+    public:
+        Object object_;
+        std::size_t size_;
+        LRU::iterator position_;
+    };
+
+    class Shard
+    {
+    public:
+        mutable std::mutex lock_;
+        std::size_t capacity_ = 0;
+        std::size_t bytes_ = 0;
+        LRU lru_;
+        std::unordered_map<std::string, Entry> entries_;
+
+        // Caller must hold lock_
+        void Trim();
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> misses_;
+
+    Shard& ShardFor(const std::string& hash) const;
+
+    StorageCache() = delete;
+    StorageCache(const StorageCache&) = delete;
+    StorageCache& operator=(const StorageCache&) = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_STORAGE_STORAGECACHE_HPP
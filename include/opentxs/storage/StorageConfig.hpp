@@ -39,6 +39,7 @@
 #ifndef OPENTXS_STORAGE_STORAGECONFIG_HPP
 #define OPENTXS_STORAGE_STORAGECONFIG_HPP
 
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -54,7 +55,23 @@ public:
     bool auto_publish_servers_ = true;
     bool auto_publish_units_ = true;
     int64_t gc_interval_ = 60 * 60 * 1;
+    // Number of threads used to migrate keys during garbage collection
+    int64_t gc_threads_ = 2;
+    // Upper limit on keys migrated per second by garbage collection, so that
+    // it does not starve foreground reads and writes. 0 means no limit.
+    int64_t gc_max_keys_per_second_ = 2000;
+    // Approximate bytes of memory used by the parsed object cache. 0 disables
+    // the cache.
+    int64_t cache_size_ = 16 * 1024 * 1024;
     std::string path_;
+    // Which compiled-in backend to use: "fs", "sqlite3" or "lmdb"
+#if defined OT_STORAGE_SQLITE
+    std::string backend_ = "sqlite3";
+#elif defined OT_STORAGE_LMDB
+    std::string backend_ = "lmdb";
+#else
+    std::string backend_ = "fs";
+#endif
     InsertCB dht_callback_;
 
 #ifdef OT_STORAGE_FS
@@ -69,6 +86,22 @@ public:
     std::string sqlite3_control_table_ = "control";
     std::string sqlite3_root_key_ = "a";
     std::string sqlite3_db_file_ = "opentxs.sqlite3";
+    // Passed to PRAGMA journal_mode and PRAGMA synchronous when the database
+    // is opened. FULL syncs every commit. NORMAL is faster in WAL mode and
+    // never corrupts the database, but can lose the most recent commits on
+    // power loss, so it has to be asked for.
+    std::string sqlite3_journal_mode_ = "WAL";
+    std::string sqlite3_synchronous_ = "FULL";
+#endif
+
+#ifdef OT_STORAGE_LMDB
+    std::string lmdb_primary_bucket_ = "a";
+    std::string lmdb_secondary_bucket_ = "b";
+    std::string lmdb_control_table_ = "control";
+    std::string lmdb_root_key_ = "root";
+    // Upper bound on the size of the database. The file grows as needed, but
+    // the address space is reserved up front.
+    int64_t lmdb_map_size_ = 1024LL * 1024 * 1024 * 16;
 #endif
 };
 
@@ -0,0 +1,135 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_STORAGE_STORAGELMDB_HPP
+#define OPENTXS_STORAGE_STORAGELMDB_HPP
+
+#include <opentxs/storage/Storage.hpp>
+
+#include <string>
+
+extern "C"
+{
+    #include <lmdb.h>
+}
+
+namespace opentxs
+{
+
+class StorageConfig;
+
+// LMDB implementation of opentxs::storage
+//
+// Each bucket is a named database inside a single memory-mapped environment.
+// Reads run in their own read-only transactions, which never block and are
+// never blocked by the single writer.
+class StorageLMDB : public Storage
+{
+private:
+    typedef Storage ot_super;
+
+    friend Storage;
+
+    std::string folder_;
+    MDB_env* env_ = nullptr;
+    MDB_dbi primary_ = 0;
+    MDB_dbi secondary_ = 0;
+    MDB_dbi control_ = 0;
+    bool ready_ = false;
+
+    MDB_dbi GetDatabase(const bool bucket) const
+    {
+        return bucket ? secondary_ : primary_;
+    }
+
+    StorageLMDB() = delete;
+    StorageLMDB(
+        const StorageConfig& config,
+        const Digest& hash,
+        const Random& random);
+    StorageLMDB(const StorageLMDB&) = delete;
+    StorageLMDB& operator=(const StorageLMDB&) = delete;
+
+    // Runs reader on the value in place, inside the read transaction
+    bool Get(
+        const MDB_dbi database,
+        const std::string& key,
+        const Reader& reader) const;
+    bool Get(
+        const MDB_dbi database,
+        const std::string& key,
+        std::string& value) const;
+    bool Put(
+        const MDB_dbi database,
+        const std::string& key,
+        const std::string& value) const;
+    bool OpenDatabase(
+        MDB_txn* transaction,
+        const std::string& name,
+        MDB_dbi& database);
+
+    void Init_StorageLMDB();
+
+public:
+    std::string LoadRoot() const override;
+    bool StoreRoot(const std::string& hash) override;
+    using ot_super::Load;
+    bool Load(
+        const std::string& key,
+        std::string& value,
+        const bool bucket) const override;
+    bool LoadInPlace(
+        const std::string& key,
+        const bool bucket,
+        const Reader& reader) const override;
+    using ot_super::Store;
+    bool Store(
+        const std::string& key,
+        const std::string& value,
+        const bool bucket) const override;
+    bool Store(const KeyValues& values, const bool bucket) const override;
+    bool EmptyBucket(const bool bucket) override;
+    bool Ready() const override { return ready_; }
+
+    void Cleanup_StorageLMDB();
+    void Cleanup() override;
+    ~StorageLMDB();
+};
+
+}  // namespace opentxs
+#endif // OPENTXS_STORAGE_STORAGELMDB_HPP
@@ -41,6 +41,12 @@
 
 #include <opentxs/storage/Storage.hpp>
 
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 extern "C"
 {
@@ -60,8 +66,27 @@ private:
 
     friend Storage;
 
+    // A read-only connection with its own prepared statements. Each reader
+    // is used by one thread at a time, so reads never wait on each other.
+    class Reader
+    {
+    public:
+        sqlite3* db_ = nullptr;
+        std::map<std::string, sqlite3_stmt*> select_statements_;
+    };
+
     std::string folder_;
+    // The write connection
     sqlite3* db_ = nullptr;
+    // Prepared once per table and reused. A statement can only be stepped by
+    // one caller at a time, so all writes happen under write_lock_.
+    mutable std::mutex write_lock_;
+    mutable std::map<std::string, sqlite3_stmt*> upsert_statements_;
+    // Readers not in use. A reader is opened whenever none is idle, so there
+    // are at most as many as there have been concurrent reads.
+    mutable std::mutex reader_lock_;
+    mutable std::vector<std::unique_ptr<Reader>> readers_;
+    bool ready_ = false;
 
     std::string GetTableName(const bool bucket) const
     {
@@ -78,16 +103,43 @@ private:
     StorageSqlite3(const StorageSqlite3&) = delete;
     StorageSqlite3& operator=(const StorageSqlite3&) = delete;
 
+    std::string Filename() const;
+    sqlite3_stmt* Prepared(
+        sqlite3* db,
+        std::map<std::string, sqlite3_stmt*>& statements,
+        const std::string& tablename,
+        const std::string& query) const;
+    std::unique_ptr<Reader> CheckoutReader() const;
+    void ReturnReader(std::unique_ptr<Reader>& reader) const;
+    void CloseReader(Reader& reader) const;
+    // Closes the idle readers
+    void CloseReaders() const;
+    void FinalizeStatements(const std::string& tablename) const;
+    void FinalizeStatements() const;
     bool Select(
         const std::string& key,
         const std::string& tablename,
         std::string& value) const;
+    // Runs read on the value before the statement is reset
+    bool Select(
+        const std::string& key,
+        const std::string& tablename,
+        const ot_super::Reader& read) const;
     bool Upsert(
         const std::string& key,
         const std::string& tablename,
         const std::string& value) const;
+    // Caller must hold write_lock_
+    bool UpsertLocked(
+        const std::string& key,
+        const std::string& tablename,
+        const std::string& value) const;
     bool Create(const std::string& tablename);
     bool Purge(const std::string& tablename);
+    bool Pragma(
+        const std::string& name,
+        const std::string& value,
+        const std::list<std::string>& allowed);
 
     void Init_StorageSqlite3();
 
@@ -99,12 +151,18 @@ public:
         const std::string& key,
         std::string& value,
         const bool bucket) const override;
+    bool LoadInPlace(
+        const std::string& key,
+        const bool bucket,
+        const ot_super::Reader& reader) const override;
     using ot_super::Store;
     bool Store(
         const std::string& key,
         const std::string& value,
         const bool bucket) const override;
+    bool Store(const KeyValues& values, const bool bucket) const override;
     bool EmptyBucket(const bool bucket) override;
+    bool Ready() const override { return ready_; }
 
     void Cleanup_StorageSqlite3();
     void Cleanup() override;
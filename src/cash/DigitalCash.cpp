@@ -86,9 +86,19 @@ void SetDumper(const char* filepathexact)
 
 #ifdef OT_CASH_USING_LUCRE
 
+std::mutex LucreDumper::s_lock;
+int32_t LucreDumper::s_users = 0;
+std::string LucreDumper::s_str_dumpfile;
+
 // We don't need this for release builds
 LucreDumper::LucreDumper()
 {
+    std::lock_guard<std::mutex> lock(s_lock);
+
+    if (0 < s_users++) {
+        return;
+    }
+
 #ifdef _WIN32
 #ifdef _DEBUG
     String strOpenSSLDumpFilename("openssl.dumpfile"), strOpenSSLDumpFilePath,
@@ -112,7 +122,7 @@ LucreDumper::LucreDumper()
                                              // withdrawing cash. (Caused by
                                              // da2ce7 removing Lucre from OT
                                              // and moving it into a dylib.)
-    m_str_dumpfile = strOpenSSLDumpFilePath.Get();
+    s_str_dumpfile = strOpenSSLDumpFilePath.Get();
     strOpenSSLDumpFilePath.Set("");
 #endif
 #else
@@ -122,9 +132,15 @@ LucreDumper::LucreDumper()
 
 LucreDumper::~LucreDumper()
 {
+    std::lock_guard<std::mutex> lock(s_lock);
+
+    if (0 < --s_users) {
+        return;
+    }
+
 #ifdef _WIN32
 #ifdef _DEBUG
-    CleanupDumpFile(m_str_dumpfile.c_str());
+    CleanupDumpFile(s_str_dumpfile.c_str());
 #endif
 #endif
 }
@@ -38,11 +38,14 @@
 
 #include <opentxs/core/stdafx.hpp>
 #include <opentxs/core/crypto/OTAsymmetricKey.hpp>
+#include <opentxs/core/crypto/OTEnvelope.hpp>
 #include <opentxs/core/Account.hpp>
 #include <opentxs/core/util/OTFolders.hpp>
 #include <opentxs/core/util/Tag.hpp>
+#include <opentxs/core/util/Workers.hpp>
 #include <opentxs/core/Log.hpp>
 #include <opentxs/core/Message.hpp>
+#include <opentxs/core/Nym.hpp>
 #include <opentxs/core/OTStorage.hpp>
 
 #include <opentxs/cash/Mint.hpp>
@@ -50,6 +53,9 @@
 
 #include <irrxml/irrXML.hpp>
 
+#include <algorithm>
+#include <initializer_list>
+
 #if defined(OT_CASH_USING_LUCRE)
 #endif
 
@@ -468,6 +474,48 @@ bool Mint::GetPrivate(OTASCIIArmor& theArmor, int64_t lDenomination)
     return false;
 }
 
+bool Mint::OpenPrivate(Nym& theNotary, int64_t lDenomination,
+                       String& strPrivate)
+{
+    OTASCIIArmor theArmor;
+
+    if (!GetPrivate(theArmor, lDenomination)) {
+        otErr << __FUNCTION__ << ": No private key for denomination "
+              << lDenomination << ".\n";
+        return false;
+    }
+
+    OTEnvelope theEnvelope(theArmor);
+
+    return theEnvelope.Open(theNotary, strPrivate);
+}
+
+// Takes a key pair made by GenerateDenomination.
+bool Mint::InsertDenomination(Nym& theNotary, int64_t lDenomination,
+                              const OTASCIIArmor& thePublic,
+                              const OTASCIIArmor& thePrivate)
+{
+    OTASCIIArmor theArmor;
+
+    if (GetPublic(theArmor, lDenomination) ||
+        GetPrivate(theArmor, lDenomination)) {
+        otErr << __FUNCTION__ << ": Denomination " << lDenomination
+              << " already exists.\n";
+        return false;
+    }
+
+    // Add the new key pair to the maps, using denomination as the key
+    m_mapPublic[lDenomination] = new OTASCIIArmor(thePublic);
+    m_mapPrivate[lDenomination] = new OTASCIIArmor(thePrivate);
+
+    // Grab the Server Nym ID and save it with this Mint
+    theNotary.GetIdentifier(m_ServerNymID);
+    m_nDenominationCount++;
+    otWarn << "Successfully added denomination: " << lDenomination << "\n";
+
+    return true;
+}
+
 // The mint has a different key pair for each denomination.
 // Pass in the actual denomination such as 5, 10, 20, 50, 100...
 bool Mint::GetPublic(OTASCIIArmor& theArmor, int64_t lDenomination)
@@ -755,6 +803,28 @@ void Mint::GenerateNewMint(int32_t nSeries, time64_t VALID_FROM,
                            int64_t nDenom4, int64_t nDenom5, int64_t nDenom6,
                            int64_t nDenom7, int64_t nDenom8, int64_t nDenom9,
                            int64_t nDenom10)
+{
+    std::vector<int64_t> denominations;
+
+    for (const int64_t lDenomination :
+         {nDenom1, nDenom2, nDenom3, nDenom4, nDenom5, nDenom6, nDenom7,
+          nDenom8, nDenom9, nDenom10}) {
+        if (lDenomination) {
+            denominations.push_back(lDenomination);
+        }
+    }
+
+    GenerateNewMint(nSeries, VALID_FROM, VALID_TO, MINT_EXPIRATION,
+                    theInstrumentDefinitionID, theNotaryID, theNotary,
+                    denominations); // int32_t nPrimeLength default = 1024
+}
+
+bool Mint::GenerateNewMint(int32_t nSeries, time64_t VALID_FROM,
+                           time64_t VALID_TO, time64_t MINT_EXPIRATION,
+                           const Identifier& theInstrumentDefinitionID,
+                           const Identifier& theNotaryID, Nym& theNotary,
+                           const std::vector<int64_t>& denominations,
+                           int32_t nPrimeLength, int32_t nThreads)
 {
     Release();
 
@@ -795,46 +865,39 @@ void Mint::GenerateNewMint(int32_t nSeries, time64_t VALID_FROM,
         otErr << "Error creating cash reserve account for new mint.\n";
     }
 
-    if (nDenom1) {
-        AddDenomination(theNotary,
-                        nDenom1); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom2) {
-        AddDenomination(theNotary,
-                        nDenom2); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom3) {
-        AddDenomination(theNotary,
-                        nDenom3); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom4) {
-        AddDenomination(theNotary,
-                        nDenom4); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom5) {
-        AddDenomination(theNotary,
-                        nDenom5); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom6) {
-        AddDenomination(theNotary,
-                        nDenom6); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom7) {
-        AddDenomination(theNotary,
-                        nDenom7); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom8) {
-        AddDenomination(theNotary,
-                        nDenom8); // int32_t nPrimeLength default = 1024
-    }
-    if (nDenom9) {
-        AddDenomination(theNotary,
-                        nDenom9); // int32_t nPrimeLength default = 1024
+    // Generating a key pair for each denomination is the slow part, so that
+    // is spread over the workers. The keys are added to the mint afterwards,
+    // in order.
+    const std::size_t count = denominations.size();
+    std::vector<OTASCIIArmor> publics(count), privates(count);
+    std::vector<uint8_t> generated(count, 0);
+
+    if (0 < count) {
+        const std::size_t workers = std::min(WorkerCount(nThreads), count);
+
+        RunWorkers(workers, [&](std::size_t worker) {
+            for (std::size_t i = worker; i < count; i += workers) {
+                generated[i] = GenerateDenomination(theNotary, nPrimeLength,
+                                                    publics[i], privates[i])
+                                   ? 1
+                                   : 0;
+            }
+        });
     }
-    if (nDenom10) {
-        AddDenomination(theNotary,
-                        nDenom10); // int32_t nPrimeLength default = 1024
+
+    bool bSuccess = (nullptr != m_pReserveAcct);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!generated[i] ||
+            !InsertDenomination(theNotary, denominations[i], publics[i],
+                                privates[i])) {
+            otErr << __FUNCTION__ << ": Failed adding denomination "
+                  << denominations[i] << " to the new mint.\n";
+            bSuccess = false;
+        }
     }
+
+    return bSuccess;
 }
 
 } // namespace opentxs
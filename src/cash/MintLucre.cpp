@@ -52,6 +52,13 @@
 #include <opentxs/core/Log.hpp>
 #include <opentxs/core/Nym.hpp>
 
+#include <mutex>
+
+// BIO_get_mem_data() macro from OpenSSL uses old style cast
+#ifndef _WIN32
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#endif
+
 #ifdef __APPLE__
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #endif
@@ -87,8 +94,6 @@ MintLucre::~MintLucre()
 bool MintLucre::AddDenomination(Nym& theNotary, int64_t lDenomination,
                                 int32_t nPrimeLength)
 {
-    bool bReturnValue = false;
-
     // Let's make sure it doesn't already exist
     OTASCIIArmor theArmor;
     if (GetPublic(theArmor, lDenomination)) {
@@ -102,6 +107,23 @@ bool MintLucre::AddDenomination(Nym& theNotary, int64_t lDenomination,
         return false;
     }
 
+    OTASCIIArmor thePublic, thePrivate;
+
+    if (!GenerateDenomination(theNotary, nPrimeLength, thePublic,
+                              thePrivate)) {
+        return false;
+    }
+
+    return InsertDenomination(theNotary, lDenomination, thePublic,
+                              thePrivate);
+}
+
+// Only reads from the mint, so GenerateNewMint can run several of these at
+// once.
+bool MintLucre::GenerateDenomination(Nym& theNotary, int32_t nPrimeLength,
+                                     OTASCIIArmor& thePublic,
+                                     OTASCIIArmor& thePrivate)
+{
     if ((nPrimeLength / 8) < (MIN_COIN_LENGTH + DIGEST_LENGTH)) {
         otErr << "Prime must be at least "
               << (MIN_COIN_LENGTH + DIGEST_LENGTH) * 8 << " bits\n";
@@ -113,13 +135,17 @@ bool MintLucre::AddDenomination(Nym& theNotary, int64_t lDenomination,
         return false;
     }
 
+    // Lucre's monitor is global, so it is only set up once.
+    static std::once_flag monitorOnce;
+    std::call_once(monitorOnce, []() {
 #ifdef _WIN32
-    BIO* out = BIO_new_file("openssl.dump", "w");
-    assert(out);
-    SetDumper(out);
+        BIO* out = BIO_new_file("openssl.dump", "w");
+        assert(out);
+        SetDumper(out);
 #else
-    SetMonitor(stderr);
+        SetMonitor(stderr);
 #endif
+    });
 
     OpenSSL_BIO bio = BIO_new(BIO_s_mem());
     OpenSSL_BIO bioPublic = BIO_new(BIO_s_mem());
@@ -132,53 +158,41 @@ bool MintLucre::AddDenomination(Nym& theNotary, int64_t lDenomination,
     PublicBank pbank(bank);
     pbank.WriteBIO(bioPublic);
 
-    // Copy from BIO back to a normal OTString or Ascii-Armor
-    char privateBankBuffer[4096],
-        publicBankBuffer[4096]; // todo stop hardcoding these string lengths
-    int32_t privatebankLen =
-        BIO_read(bio, privateBankBuffer, 4000); // cutting it a little short on
-                                                // purpose, with the buffer.
-    int32_t publicbankLen =
-        BIO_read(bioPublic, publicBankBuffer,
-                 4000); // Just makes me feel more comfortable for some reason.
-
-    if (privatebankLen && publicbankLen) {
-        // With this, we have the Lucre public and private bank info converted
-        // to OTStrings
-        String strPublicBank;
-        strPublicBank.Set(publicBankBuffer, publicbankLen);
-        String strPrivateBank;
-        strPrivateBank.Set(privateBankBuffer, privatebankLen);
-
-        OTASCIIArmor* pPublic = new OTASCIIArmor();
-        OTASCIIArmor* pPrivate = new OTASCIIArmor();
-
-        OT_ASSERT(nullptr != pPublic);
-        OT_ASSERT(nullptr != pPrivate);
-
-        // Set the public bank info onto pPublic
-        pPublic->SetString(strPublicBank, true); // linebreaks = true
-
-        // Seal the private bank info up into an encrypted Envelope
-        // and set it onto pPrivate
-        OTEnvelope theEnvelope;
-        theEnvelope.Seal(theNotary, strPrivateBank); // Todo check the return
-                                                     // values on these two
-                                                     // functions
-        theEnvelope.GetAsciiArmoredData(*pPrivate);
-
-        // Add the new key pair to the maps, using denomination as the key
-        m_mapPublic[lDenomination] = pPublic;
-        m_mapPrivate[lDenomination] = pPrivate;
-
-        // Grab the Server Nym ID and save it with this Mint
-        theNotary.GetIdentifier(m_ServerNymID);
-        m_nDenominationCount++;
-        bReturnValue = true;
-        otWarn << "Successfully added denomination: " << lDenomination << "\n";
+    // Copy from BIO back to a normal OTString or Ascii-Armor. The memory
+    // BIOs are read in place, whatever the size of the keys.
+    char* privateBankBuffer = nullptr;
+    char* publicBankBuffer = nullptr;
+    const long privatebankLen = BIO_get_mem_data(bio, &privateBankBuffer);
+    const long publicbankLen =
+        BIO_get_mem_data(bioPublic, &publicBankBuffer);
+
+    if ((0 >= privatebankLen) || (0 >= publicbankLen) ||
+        (nullptr == privateBankBuffer) || (nullptr == publicBankBuffer)) {
+        otErr << __FUNCTION__ << ": Failed reading the generated keys.\n";
+        return false;
     }
 
-    return bReturnValue;
+    // With this, we have the Lucre public and private bank info converted
+    // to OTStrings
+    String strPublicBank;
+    strPublicBank.Set(publicBankBuffer, static_cast<uint32_t>(publicbankLen));
+    String strPrivateBank;
+    strPrivateBank.Set(privateBankBuffer,
+                       static_cast<uint32_t>(privatebankLen));
+
+    // Set the public bank info onto thePublic
+    thePublic.SetString(strPublicBank, true); // linebreaks = true
+
+    // Seal the private bank info up into an encrypted Envelope
+    // and set it onto thePrivate
+    OTEnvelope theEnvelope;
+
+    if (!theEnvelope.Seal(theNotary, strPrivateBank)) {
+        otErr << __FUNCTION__ << ": Failed sealing the private key.\n";
+        return false;
+    }
+
+    return theEnvelope.GetAsciiArmoredData(thePrivate);
 }
 
 #if defined(OT_CRYPTO_USING_OPENSSL)
@@ -292,63 +306,42 @@ bool MintLucre::SignToken(Nym& theNotary, Token& theToken, String& theOutput,
 bool MintLucre::VerifyToken(Nym& theNotary, String& theCleartextToken,
                             int64_t lDenomination)
 {
-    bool bReturnValue = false;
+    // --- The Mint private info is encrypted in m_mapPrivate[lDenomination].
+    // So I need to extract that first before I can use it.
+    String strContents; // will contain output from opening the envelope.
+
+    if (!OpenPrivate(theNotary, lDenomination, strContents)) return false;
+
+    return VerifyCoin(strContents, theCleartextToken);
+}
+
+// Every Lucre object here is built from the arguments and dropped on return,
+// so calls on different threads share nothing but the dumper.
+bool MintLucre::VerifyCoin(const String& strPrivate,
+                           const String& theCleartextToken) const
+{
     LucreDumper setDumper;
 
     OpenSSL_BIO bioBank = BIO_new(BIO_s_mem()); // input
     OpenSSL_BIO bioCoin = BIO_new(BIO_s_mem()); // input
 
-    // --- copy theCleartextToken to bioCoin so lucre can load it
+    // --- copy the private key and theCleartextToken to BIOs so lucre can
+    // load them
+    BIO_puts(bioBank, strPrivate.Get());
     BIO_puts(bioCoin, theCleartextToken.Get());
 
-    // --- The Mint private info is encrypted in m_mapPrivate[lDenomination].
-    // So I need to extract that first before I can use it.
-    OTASCIIArmor theArmor;
-    GetPrivate(theArmor, lDenomination);
-    OTEnvelope theEnvelope(theArmor);
+    // ---- Now the bank and coin bios are both ready to go...
 
-    String strContents; // will contain output from opening the envelope.
-    // Decrypt the Envelope into strContents
-    if (theEnvelope.Open(theNotary, strContents)) {
-        // copy strContents to a BIO
-        BIO_puts(bioBank, strContents.Get());
-
-        // ---- Now the bank and coin bios are both ready to go...
-
-        Bank bank(bioBank);
-        Coin coin(bioCoin);
-
-        if (bank.Verify(coin)) // Here's the boolean output: coin is verified!
-        {
-            bReturnValue = true;
-
-            // (Done): When a token is redeemed, need to store it in the spent
-            // token database.
-            // Right now I can verify the token, but unless I check it against a
-            // database, then
-            // even though the signature verifies, it doesn't stop people from
-            // redeeming the same
-            // token again and again and again.
-            //
-            // (done): also need to make sure issuer has double-entries for
-            // total amount outstanding.
-            //
-            // UPDATE: These are both done now.  The Spent Token database is
-            // implemented in the transaction server,
-            // (not OTLib proper) and the same server also now keeps a cash
-            // account to match all cash withdrawals.
-            // (Meaning, if 10,000 clams total have been withdrawn by various
-            // users, then the server actually has
-            // a clam account containing 10,000 clams. As the cash comes in for
-            // redemption, the server debits it from
-            // this account again before sending it to its final destination.
-            // This way the server tracks total outstanding
-            // amount, as an additional level of security after the blind
-            // signature itself.)
-        }
-    }
-
-    return bReturnValue;
+    Bank bank(bioBank);
+    Coin coin(bioCoin);
+
+    // Here's the boolean output: coin is verified!
+    //
+    // Verifying the signature doesn't stop people from redeeming the same
+    // token again and again, so the notary also checks each coin against
+    // its spent token database, and keeps a cash reserve account matching
+    // the total amount outstanding.
+    return bank.Verify(coin);
 }
 
 #endif // defined(OT_CRYPTO_USING_OPENSSL)
@@ -0,0 +1,946 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/core/stdafx.hpp>
+
+#include <opentxs/cash/SpentTokenStore.hpp>
+
+#include <opentxs/cash/Token.hpp>
+#include <opentxs/core/util/OTFolders.hpp>
+#include <opentxs/core/util/OTPaths.hpp>
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/OTStorage.hpp>
+#include <opentxs/core/String.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+// Identifies an index file in the format below. The index is only a cache of
+// the log, so integers are stored in host byte order.
+#define SPENT_TOKEN_INDEX_MAGIC "OTSPENT1"
+// magic, slot count, length of the log covered by the index
+#define SPENT_TOKEN_INDEX_HEADER 24
+// fingerprint, offset of the record in the log plus one (zero if empty)
+#define SPENT_TOKEN_INDEX_SLOT 16
+// Must be a power of two. The table doubles whenever it is half full.
+#define SPENT_TOKEN_INITIAL_SLOTS 1024
+// Bloom filter bits per index slot. Since the index is at most half full,
+// this is at least 16 bits per token, for about one false positive in 1700
+// lookups of unspent tokens.
+#define SPENT_TOKEN_BLOOM_BITS_PER_SLOT 8
+#define SPENT_TOKEN_BLOOM_PROBES 8
+#define SPENT_TOKEN_MANIFEST "series"
+
+namespace opentxs
+{
+
+std::mutex SpentTokenStore::registry_lock_;
+std::map<std::string, std::shared_ptr<SpentTokenStore::Partition>>
+    SpentTokenStore::partitions_;
+std::mutex SpentTokenStore::manifest_lock_;
+
+std::string SpentTokenStore::Name(
+    const std::string& unitID,
+    const int32_t series)
+{
+    // Same name the per-token folders used
+    return unitID + "." + std::to_string(series);
+}
+
+// 64 bit FNV-1a. The fingerprints are stored on disk, so this must not change.
+std::uint64_t SpentTokenStore::Fingerprint(const std::string& tokenHash)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for (const char c : tokenHash) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+bool SpentTokenStore::Path(const std::string& file, std::string& path)
+{
+    if (0 > OTDB::FormPathString(path, OTFolders::Spent().Get(), file)) {
+        otErr << __FUNCTION__ << ": Failed to form path for spent token file "
+              << file << "\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<SpentTokenStore::Partition> SpentTokenStore::Get(
+    const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(registry_lock_);
+    auto& partition = partitions_[name];
+
+    if (!partition) { partition.reset(new Partition); }
+
+    return partition;
+}
+
+void SpentTokenStore::ResetBloom(
+    Partition& partition,
+    const std::vector<Slot>& entries)
+{
+    const std::uint64_t bits =
+        partition.slots_ * SPENT_TOKEN_BLOOM_BITS_PER_SLOT;
+    partition.bloom_.assign(bits / 64, 0);
+
+    for (auto& it : entries) { AddToBloom(partition, it.first); }
+}
+
+void SpentTokenStore::AddToBloom(
+    Partition& partition,
+    const std::uint64_t fingerprint)
+{
+    if (partition.bloom_.empty()) { return; }
+
+    // Double hashing: the probes are fingerprint + i * step.
+    const std::uint64_t mask = partition.bloom_.size() * 64 - 1;
+    const std::uint64_t step = ((fingerprint >> 32) | (fingerprint << 32)) | 1;
+
+    for (std::uint64_t i = 0; i < SPENT_TOKEN_BLOOM_PROBES; i++) {
+        const std::uint64_t bit = (fingerprint + i * step) & mask;
+        partition.bloom_[bit / 64] |= (std::uint64_t(1) << (bit % 64));
+    }
+}
+
+bool SpentTokenStore::InBloom(
+    const Partition& partition,
+    const std::uint64_t fingerprint)
+{
+    if (partition.bloom_.empty()) { return false; }
+
+    const std::uint64_t mask = partition.bloom_.size() * 64 - 1;
+    const std::uint64_t step = ((fingerprint >> 32) | (fingerprint << 32)) | 1;
+
+    for (std::uint64_t i = 0; i < SPENT_TOKEN_BLOOM_PROBES; i++) {
+        const std::uint64_t bit = (fingerprint + i * step) & mask;
+
+        const std::uint64_t word = partition.bloom_[bit / 64];
+
+        if (0 == (word & (std::uint64_t(1) << (bit % 64)))) { return false; }
+    }
+
+    return true;
+}
+
+bool SpentTokenStore::ReadIndex(
+    const std::string& name,
+    std::vector<Slot>& entries,
+    std::uint64_t& slots,
+    std::uint64_t& indexed)
+{
+    std::string path;
+
+    if (!Path(name + ".i", path)) { return false; }
+
+    std::ifstream index(path, std::ios::in | std::ios::binary);
+
+    if (!index.good()) { return false; }
+
+    char header[SPENT_TOKEN_INDEX_HEADER];
+    index.read(header, SPENT_TOKEN_INDEX_HEADER);
+
+    if (!index.good()) { return false; }
+
+    if (0 != std::memcmp(header, SPENT_TOKEN_INDEX_MAGIC, 8)) { return false; }
+
+    std::memcpy(&slots, header + 8, 8);
+    std::memcpy(&indexed, header + 16, 8);
+
+    // Not a power of two
+    if ((0 == slots) || (0 != (slots & (slots - 1)))) { return false; }
+
+    std::string table(slots * SPENT_TOKEN_INDEX_SLOT, '\0');
+    index.read(&table[0], table.size());
+
+    if (!index.good()) { return false; }
+
+    entries.clear();
+
+    for (std::uint64_t i = 0; i < slots; i++) {
+        std::uint64_t fingerprint = 0, stored = 0;
+        std::memcpy(&fingerprint, &table[i * SPENT_TOKEN_INDEX_SLOT], 8);
+        std::memcpy(&stored, &table[i * SPENT_TOKEN_INDEX_SLOT + 8], 8);
+
+        if (0 != stored) { entries.push_back(Slot(fingerprint, stored - 1)); }
+    }
+
+    return true;
+}
+
+bool SpentTokenStore::WriteIndex(
+    const std::string& name,
+    Partition& partition,
+    const std::vector<Slot>& entries,
+    const std::uint64_t slots)
+{
+    OT_ASSERT(2 * entries.size() <= slots);
+
+    std::string table(
+        SPENT_TOKEN_INDEX_HEADER + slots * SPENT_TOKEN_INDEX_SLOT, '\0');
+    std::memcpy(&table[0], SPENT_TOKEN_INDEX_MAGIC, 8);
+    std::memcpy(&table[8], &slots, 8);
+    std::memcpy(&table[16], &partition.indexed_, 8);
+    const std::uint64_t mask = slots - 1;
+
+    for (auto& it : entries) {
+        std::uint64_t position = it.first & mask;
+        std::uint64_t stored = 0;
+
+        for (;;) {
+            std::memcpy(
+                &stored,
+                &table[SPENT_TOKEN_INDEX_HEADER +
+                       position * SPENT_TOKEN_INDEX_SLOT + 8],
+                8);
+
+            if (0 == stored) { break; }
+
+            position = (position + 1) & mask;
+        }
+
+        stored = it.second + 1;
+        char* slot = &table[SPENT_TOKEN_INDEX_HEADER +
+                            position * SPENT_TOKEN_INDEX_SLOT];
+        std::memcpy(slot, &it.first, 8);
+        std::memcpy(slot + 8, &stored, 8);
+    }
+
+    // StorePlainString replaces the old table atomically.
+    std::string path;
+
+    if (!OTDB::StorePlainString(
+            table, OTFolders::Spent().Get(), name + ".i") ||
+        !Path(name + ".i", path) || !OTPaths::SyncPath(String(path))) {
+        otErr << __FUNCTION__ << ": Failed to store spent token index for "
+              << name << "\n";
+
+        return false;
+    }
+
+    partition.slots_ = slots;
+    partition.entries_ = entries.size();
+    ResetBloom(partition, entries);
+
+    return true;
+}
+
+bool SpentTokenStore::WriteHeader(
+    const std::string& name,
+    const Partition& partition)
+{
+    std::string path;
+
+    if (!Path(name + ".i", path)) { return false; }
+
+    std::fstream index(path, std::ios::in | std::ios::out | std::ios::binary);
+    index.seekp(16);
+    index.write(reinterpret_cast<const char*>(&partition.indexed_), 8);
+    index.flush();
+    const bool bWritten = index.good();
+    index.close();
+
+    return bWritten && OTPaths::SyncPath(String(path));
+}
+
+bool SpentTokenStore::Insert(
+    const std::string& name,
+    Partition& partition,
+    const std::uint64_t fingerprint,
+    const std::uint64_t offset)
+{
+    if ((0 == partition.slots_) ||
+        (2 * (partition.entries_ + 1) > partition.slots_)) {
+        std::vector<Slot> entries;
+        std::uint64_t slots = 0, indexed = 0;
+
+        if ((0 < partition.slots_) &&
+            !ReadIndex(name, entries, slots, indexed)) {
+            otErr << __FUNCTION__ << ": Failed reading spent token index for "
+                  << name << "\n";
+
+            return false;
+        }
+
+        const std::uint64_t size = (0 == partition.slots_)
+                                       ? SPENT_TOKEN_INITIAL_SLOTS
+                                       : 2 * partition.slots_;
+
+        if (!WriteIndex(name, partition, entries, size)) { return false; }
+    }
+
+    std::string path;
+
+    if (!Path(name + ".i", path)) { return false; }
+
+    std::fstream index(path, std::ios::in | std::ios::out | std::ios::binary);
+    const std::uint64_t mask = partition.slots_ - 1;
+    std::uint64_t position = fingerprint & mask;
+    char slot[SPENT_TOKEN_INDEX_SLOT];
+
+    for (;;) {
+        index.seekg(
+            SPENT_TOKEN_INDEX_HEADER + position * SPENT_TOKEN_INDEX_SLOT);
+        index.read(slot, SPENT_TOKEN_INDEX_SLOT);
+
+        if (!index.good()) {
+            otErr << __FUNCTION__ << ": Failed reading spent token index for "
+                  << name << "\n";
+
+            return false;
+        }
+
+        std::uint64_t stored = 0;
+        std::memcpy(&stored, slot + 8, 8);
+
+        if (0 == stored) { break; }
+
+        position = (position + 1) & mask;
+    }
+
+    const std::uint64_t stored = offset + 1;
+    std::memcpy(slot, &fingerprint, 8);
+    std::memcpy(slot + 8, &stored, 8);
+    index.seekp(SPENT_TOKEN_INDEX_HEADER + position * SPENT_TOKEN_INDEX_SLOT);
+    index.write(slot, SPENT_TOKEN_INDEX_SLOT);
+    index.flush();
+    const bool bWritten = index.good();
+    index.close();
+
+    if (!bWritten || !OTPaths::SyncPath(String(path))) {
+        otErr << __FUNCTION__ << ": Failed writing spent token index for "
+              << name << "\n";
+
+        return false;
+    }
+
+    partition.entries_++;
+    AddToBloom(partition, fingerprint);
+
+    return true;
+}
+
+// Indexes whatever the log holds past the point the index covers: records
+// appended by a process that stopped before updating the index, or the whole
+// log if the index had to be rebuilt.
+bool SpentTokenStore::CatchUp(
+    const std::string& name,
+    Partition& partition,
+    const std::uint64_t logSize)
+{
+    if (partition.indexed_ >= logSize) { return true; }
+
+    std::string path;
+
+    if (!Path(name + ".l", path)) { return false; }
+
+    std::ifstream log(path, std::ios::in | std::ios::binary);
+    log.seekg(partition.indexed_);
+    const std::string data(
+        (std::istreambuf_iterator<char>(log)),
+        std::istreambuf_iterator<char>());
+    log.close();
+
+    if (data.size() != (logSize - partition.indexed_)) {
+        otErr << __FUNCTION__ << ": Failed reading spent token log for "
+              << name << "\n";
+
+        return false;
+    }
+
+    const std::uint64_t base = partition.indexed_;
+    std::uint64_t added = 0;
+    std::size_t position = 0;
+    bool repaired = false;
+
+    while (position < data.size()) {
+        std::size_t end = data.find('\n', position);
+
+        if (std::string::npos == end) {
+            // The last append never finished. Terminate the partial line, so
+            // the next record starts on a line of its own. Its hash is still
+            // indexed below, if it got that far: it is safer to refuse that
+            // token than to risk accepting it twice.
+            std::ofstream repair(
+                path, std::ios::out | std::ios::app | std::ios::binary);
+            repair << '\n';
+            repair.flush();
+            const bool bRepaired = repair.good();
+            repair.close();
+
+            if (!bRepaired || !OTPaths::SyncPath(String(path))) {
+                otErr << __FUNCTION__ << ": Failed repairing spent token log "
+                      << "for " << name << "\n";
+
+                return false;
+            }
+
+            end = data.size();
+            repaired = true;
+        }
+
+        const std::size_t space = data.find(' ', position);
+
+        if ((std::string::npos != space) && (space < end) &&
+            (space > position)) {
+            const std::string hash = data.substr(position, space - position);
+
+            if (!Insert(
+                    name,
+                    partition,
+                    Fingerprint(hash),
+                    base + position)) {
+
+                return false;
+            }
+
+            added++;
+        }
+
+        position = end + 1;
+    }
+
+    partition.indexed_ = base + data.size() + (repaired ? 1 : 0);
+
+    if (!WriteHeader(name, partition)) { return false; }
+
+    otWarn << __FUNCTION__ << ": Indexed " << added
+           << " spent token records for " << name << "\n";
+
+    return true;
+}
+
+bool SpentTokenStore::Load(const std::string& name, Partition& partition)
+{
+    if (partition.loaded_) { return true; }
+
+    partition.bloom_.clear();
+    partition.slots_ = 0;
+    partition.entries_ = 0;
+    partition.indexed_ = 0;
+
+    std::string path;
+
+    if (!Path(name, path)) { return false; }
+
+    partition.legacy_ = OTPaths::FolderExists(String(path + "/"));
+
+    if (!Path(name + ".l", path)) { return false; }
+
+    std::uint64_t logSize = 0;
+
+    {
+        std::ifstream log(
+            path, std::ios::in | std::ios::binary | std::ios::ate);
+
+        if (log.good()) { logSize = static_cast<std::uint64_t>(log.tellg()); }
+    }
+
+    std::vector<Slot> entries;
+    std::uint64_t slots = 0, indexed = 0;
+
+    if (ReadIndex(name, entries, slots, indexed) && (indexed <= logSize)) {
+        partition.slots_ = slots;
+        partition.entries_ = entries.size();
+        partition.indexed_ = indexed;
+        ResetBloom(partition, entries);
+    } else if (0 < logSize) {
+        otOut << __FUNCTION__ << ": Rebuilding spent token index for " << name
+              << "\n";
+        entries.clear();
+
+        if (!WriteIndex(name, partition, entries, SPENT_TOKEN_INITIAL_SLOTS)) {
+
+            return false;
+        }
+    }
+
+    if (!CatchUp(name, partition, logSize)) { return false; }
+
+    partition.loaded_ = true;
+
+    return true;
+}
+
+bool SpentTokenStore::Find(
+    const std::string& name,
+    const Partition& partition,
+    const std::string& tokenHash,
+    bool& found)
+{
+    found = false;
+    const std::uint64_t fingerprint = Fingerprint(tokenHash);
+
+    if (InBloom(partition, fingerprint)) {
+        std::string indexPath, logPath;
+
+        if (!Path(name + ".i", indexPath) || !Path(name + ".l", logPath)) {
+
+            return false;
+        }
+
+        std::ifstream index(indexPath, std::ios::in | std::ios::binary);
+        std::ifstream log(logPath, std::ios::in | std::ios::binary);
+        const std::uint64_t mask = partition.slots_ - 1;
+        std::uint64_t position = fingerprint & mask;
+        char slot[SPENT_TOKEN_INDEX_SLOT];
+
+        for (std::uint64_t i = 0; i < partition.slots_; i++) {
+            index.seekg(
+                SPENT_TOKEN_INDEX_HEADER + position * SPENT_TOKEN_INDEX_SLOT);
+            index.read(slot, SPENT_TOKEN_INDEX_SLOT);
+
+            if (!index.good()) {
+                otErr << __FUNCTION__ << ": Failed reading spent token index "
+                      << "for " << name << "\n";
+
+                return false;
+            }
+
+            std::uint64_t stored = 0, candidate = 0;
+            std::memcpy(&candidate, slot, 8);
+            std::memcpy(&stored, slot + 8, 8);
+
+            if (0 == stored) { break; }
+
+            if (fingerprint == candidate) {
+                std::string line;
+                log.seekg(stored - 1);
+                std::getline(log, line);
+
+                if (!log.good()) {
+                    otErr << __FUNCTION__ << ": Failed reading spent token "
+                          << "log for " << name << "\n";
+
+                    return false;
+                }
+
+                if ((line.size() > tokenHash.size()) &&
+                    (' ' == line[tokenHash.size()]) &&
+                    (0 == line.compare(0, tokenHash.size(), tokenHash))) {
+                    found = true;
+
+                    break;
+                }
+            }
+
+            position = (position + 1) & mask;
+        }
+    }
+
+    if (!found && partition.legacy_) {
+        found = OTDB::Exists(OTFolders::Spent().Get(), name, tokenHash);
+    }
+
+    return true;
+}
+
+void SpentTokenStore::ReadManifest(Manifest& manifest)
+{
+    manifest.clear();
+
+    if (!OTDB::Exists(OTFolders::Spent().Get(), SPENT_TOKEN_MANIFEST)) {
+
+        return;
+    }
+
+    std::istringstream input(OTDB::QueryPlainString(
+        OTFolders::Spent().Get(), SPENT_TOKEN_MANIFEST));
+    std::string line;
+
+    while (std::getline(input, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        time64_t validTo = 0;
+
+        if (fields >> name >> validTo) { manifest[name] = validTo; }
+    }
+}
+
+bool SpentTokenStore::WriteManifest(const Manifest& manifest)
+{
+    std::string contents;
+
+    for (auto& it : manifest) {
+        contents += it.first + " " + std::to_string(it.second) + "\n";
+    }
+
+    if (!OTDB::StorePlainString(
+            contents, OTFolders::Spent().Get(), SPENT_TOKEN_MANIFEST)) {
+        otErr << __FUNCTION__ << ": Failed to store spent token manifest\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+bool SpentTokenStore::IsSpent(
+    const std::string& unitID,
+    const int32_t series,
+    const std::string& tokenHash,
+    bool& spent)
+{
+    // All errors must count as spent.
+    spent = true;
+    const std::string name = Name(unitID, series);
+    auto partition = Get(name);
+    std::lock_guard<std::mutex> lock(partition->lock_);
+
+    if (!Load(name, *partition)) { return false; }
+
+    bool found = true;
+
+    if (!Find(name, *partition, tokenHash, found)) { return false; }
+
+    spent = found;
+
+    return true;
+}
+
+bool SpentTokenStore::Record(
+    const std::string& unitID,
+    const int32_t series,
+    const time64_t validTo,
+    const std::string& tokenHash,
+    const std::string& token)
+{
+    const std::string name = Name(unitID, series);
+    auto partition = Get(name);
+    std::lock_guard<std::mutex> lock(partition->lock_);
+
+    if (!Load(name, *partition)) { return false; }
+
+    bool found = true;
+
+    if (!Find(name, *partition, tokenHash, found)) { return false; }
+
+    if (found) {
+        otErr << __FUNCTION__ << ": Token " << tokenHash << " was already "
+              << "recorded as spent in " << name << "\n";
+
+        return false;
+    }
+
+    // First record of this series. Register it for pruning before anything
+    // is written that would need pruning.
+    if ((0 == partition->indexed_) && !Register(name, validTo)) {
+
+        return false;
+    }
+
+    return Append(name, *partition, tokenHash, token);
+}
+
+bool SpentTokenStore::Append(
+    const std::string& name,
+    Partition& partition,
+    const std::string& tokenHash,
+    const std::string& token)
+{
+    std::string path;
+
+    if (!Path(name + ".l", path)) { return false; }
+
+    const std::string line = tokenHash + " " + token + "\n";
+    std::ofstream log(path, std::ios::out | std::ios::app | std::ios::binary);
+    log << line;
+    log.flush();
+    const bool bWritten = log.good();
+    log.close();
+
+    if (!bWritten || !OTPaths::SyncPath(String(path))) {
+        otErr << __FUNCTION__ << ": Failed writing spent token log for "
+              << name << "\n";
+
+        return false;
+    }
+
+    // The header must not cover the new record until its slot is on disk.
+    // (Insert may rewrite the whole table, header included, so indexed_ only
+    // moves afterwards.) If we stop in between, CatchUp indexes it again.
+    const std::uint64_t offset = partition.indexed_;
+
+    if (!Insert(name, partition, Fingerprint(tokenHash), offset)) {
+        otErr << __FUNCTION__ << ": Failed indexing spent token " << tokenHash
+              << " in " << name << "\n";
+        // The log entry is what counts, and it was written. Re-read the
+        // partition from the log before it is used again.
+        partition.loaded_ = false;
+
+        return true;
+    }
+
+    partition.indexed_ = offset + line.size();
+
+    if (!WriteHeader(name, partition)) {
+        otErr << __FUNCTION__ << ": Failed updating spent token index for "
+              << name << "\n";
+        partition.loaded_ = false;
+    }
+
+    return true;
+}
+
+bool SpentTokenStore::Register(const std::string& name, const time64_t validTo)
+{
+    std::lock_guard<std::mutex> manifestLock(manifest_lock_);
+    Manifest manifest;
+    ReadManifest(manifest);
+    auto it = manifest.find(name);
+
+    if ((manifest.end() != it) && (it->second >= validTo)) { return true; }
+
+    manifest[name] = validTo;
+
+    return WriteManifest(manifest);
+}
+
+bool SpentTokenStore::Erase(const std::string& name)
+{
+    std::shared_ptr<Partition> partition;
+
+    {
+        std::lock_guard<std::mutex> lock(registry_lock_);
+        auto it = partitions_.find(name);
+
+        if (partitions_.end() != it) {
+            partition = it->second;
+            partitions_.erase(it);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock;
+
+    if (partition) {
+        lock = std::unique_lock<std::mutex>(partition->lock_);
+        partition->loaded_ = false;
+    }
+
+    bool bSuccess = true;
+
+    for (const std::string& file : {name + ".l", name + ".i"}) {
+        if (OTDB::Exists(OTFolders::Spent().Get(), file) &&
+            !OTDB::EraseValueByKey(OTFolders::Spent().Get(), file)) {
+            bSuccess = false;
+        }
+    }
+
+    std::lock_guard<std::mutex> manifestLock(manifest_lock_);
+    Manifest manifest;
+    ReadManifest(manifest);
+
+    if (0 < manifest.erase(name)) {
+        bSuccess = WriteManifest(manifest) && bSuccess;
+    }
+
+    return bSuccess;
+}
+
+bool SpentTokenStore::Prune(const std::string& unitID, const int32_t series)
+{
+    return Erase(Name(unitID, series));
+}
+
+std::size_t SpentTokenStore::PruneExpired(const time64_t now)
+{
+    Manifest manifest;
+
+    {
+        std::lock_guard<std::mutex> lock(manifest_lock_);
+        ReadManifest(manifest);
+    }
+
+    std::size_t pruned = 0;
+
+    for (auto& it : manifest) {
+        if (it.second >= now) { continue; }
+
+        if (Erase(it.first)) {
+            otOut << __FUNCTION__ << ": Pruned spent tokens of expired series "
+                  << it.first << "\n";
+            pruned++;
+        }
+    }
+
+    return pruned;
+}
+
+// Moves the legacy per-token files of one series into its log, then deletes
+// them. The files are only removed once every record is on disk, and tokens
+// that are already in the log are skipped, so this can simply run again if
+// it is interrupted.
+bool SpentTokenStore::Migrate(const std::string& name, Partition& partition)
+{
+    std::string folder;
+
+    if (!Path(name, folder)) { return false; }
+
+    folder += "/";
+    std::vector<std::string> files;
+
+    if (!OTPaths::ListFolder(String(folder), files)) {
+        otErr << __FUNCTION__ << ": Failed listing " << folder << "\n";
+
+        return false;
+    }
+
+    time64_t validTo = OT_TIME_ZERO;
+    std::size_t migrated = 0;
+    // Only the log may answer Find() from here on.
+    partition.legacy_ = false;
+
+    for (auto& tokenHash : files) {
+        if (!partition.loaded_ && !Load(name, partition)) { return false; }
+
+        partition.legacy_ = false;
+        std::string contents =
+            OTDB::QueryPlainString(OTFolders::Spent().Get(), name, tokenHash);
+        std::unique_ptr<Token> token(
+            Token::TokenFactory(String(contents.c_str())));
+
+        if (token) { validTo = std::max(validTo, token->GetValidTo()); }
+
+        bool found = true;
+
+        if (!Find(name, partition, tokenHash, found)) {
+            partition.legacy_ = true;
+
+            return false;
+        }
+
+        if (found) { continue; }
+
+        contents.erase(
+            std::remove_if(
+                contents.begin(),
+                contents.end(),
+                [](const char c) { return ('\n' == c) || ('\r' == c); }),
+            contents.end());
+
+        if (!Append(name, partition, tokenHash, contents)) {
+            partition.legacy_ = true;
+
+            return false;
+        }
+
+        migrated++;
+    }
+
+    if (OT_TIME_ZERO < validTo) {
+        if (!Register(name, validTo)) {
+            partition.legacy_ = true;
+
+            return false;
+        }
+    } else if (!files.empty()) {
+        otErr << __FUNCTION__ << ": No valid-to date found for the spent "
+              << "tokens of " << name << ". They won't be pruned.\n";
+    }
+
+    for (auto& tokenHash : files) {
+        OTDB::EraseValueByKey(OTFolders::Spent().Get(), name, tokenHash);
+    }
+
+    if (!OTPaths::RemoveFolder(String(folder))) {
+        otErr << __FUNCTION__ << ": Failed removing " << folder << "\n";
+    }
+
+    otOut << __FUNCTION__ << ": Migrated " << migrated << " spent tokens of "
+          << name << "\n";
+
+    return true;
+}
+
+std::size_t SpentTokenStore::MigrateLegacy()
+{
+    std::string root;
+
+    if (0 > OTDB::FormPathString(root, ".", OTFolders::Spent().Get())) {
+        otErr << __FUNCTION__ << ": Failed to form path for spent folder\n";
+
+        return 0;
+    }
+
+    root += "/";
+    std::vector<std::string> names;
+
+    // No spent folder yet, so nothing to migrate.
+    if (!OTPaths::ListFolder(String(root), names)) { return 0; }
+
+    std::size_t output = 0;
+
+    for (auto& name : names) {
+        if (!OTPaths::FolderExists(String(root + name + "/"))) { continue; }
+
+        auto partition = Get(name);
+        std::lock_guard<std::mutex> lock(partition->lock_);
+
+        if (!Load(name, *partition)) { continue; }
+
+        if (Migrate(name, *partition)) { output++; }
+    }
+
+    return output;
+}
+
+void SpentTokenStore::Unload()
+{
+    std::lock_guard<std::mutex> lock(registry_lock_);
+
+    for (auto& it : partitions_) {
+        std::lock_guard<std::mutex> partitionLock(it.second->lock_);
+        it.second->loaded_ = false;
+    }
+
+    partitions_.clear();
+}
+
+} // namespace opentxs
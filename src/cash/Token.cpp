@@ -40,6 +40,7 @@
 #include <opentxs/cash/Token.hpp>
 #include <opentxs/cash/Mint.hpp>
 #include <opentxs/cash/Purse.hpp>
+#include <opentxs/cash/SpentTokenStore.hpp>
 
 #if defined(OT_CASH_USING_LUCRE)
 #include <opentxs/cash/TokenLucre.hpp>
@@ -47,14 +48,15 @@
 
 #include <opentxs/core/crypto/OTEnvelope.hpp>
 #include <opentxs/core/crypto/OTNymOrSymmetricKey.hpp>
-#include <opentxs/core/util/OTFolders.hpp>
 #include <opentxs/core/Log.hpp>
-#include <opentxs/core/OTStorage.hpp>
 
 #include <opentxs/core/util/Tag.hpp>
 
 #include <irrxml/irrXML.hpp>
 
+#include <algorithm>
+#include <string>
+
 namespace opentxs
 {
 
@@ -458,24 +460,26 @@ bool Token::IsTokenAlreadySpent(String& theCleartextToken)
 {
     String strInstrumentDefinitionID(GetInstrumentDefinitionID());
 
-    // Calculate the filename (a hash of the Lucre cleartext token ID)
+    // Calculate the record key (a hash of the Lucre cleartext token ID)
     Identifier theTokenHash;
     theTokenHash.CalculateDigest(theCleartextToken);
-
-    // Grab the new hash into a string (for use as a filename)
     String strTokenHash(theTokenHash);
 
-    String strAssetFolder;
-    strAssetFolder.Format("%s.%d", strInstrumentDefinitionID.Get(),
-                          GetSeries());
+    bool bTokenIsSpent = true;
 
-    bool bTokenIsPresent = OTDB::Exists(
-        OTFolders::Spent().Get(), strAssetFolder.Get(), strTokenHash.Get());
+    if (!SpentTokenStore::IsSpent(strInstrumentDefinitionID.Get(),
+                                  GetSeries(), strTokenHash.Get(),
+                                  bTokenIsSpent)) {
+        otErr << "Token::IsTokenAlreadySpent: Unable to read the spent token "
+                 "records for series " << GetSeries() << " of "
+              << strInstrumentDefinitionID << "\n";
+        return true; // all errors must return true in this function.
+    }
 
-    if (bTokenIsPresent) {
+    if (bTokenIsSpent) {
         otOut << "\nToken::IsTokenAlreadySpent: Token was already spent: "
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
-              << Log::PathSeparator() << strTokenHash << "\n";
+              << strInstrumentDefinitionID << "." << GetSeries() << " "
+              << strTokenHash << "\n";
         return true; // all errors must return true in this function.
                      // But this is not an error. Token really WAS already
     }                // spent, and this true is for real. The others are just
@@ -492,55 +496,32 @@ bool Token::RecordTokenAsSpent(String& theCleartextToken)
 {
     String strInstrumentDefinitionID(GetInstrumentDefinitionID());
 
-    // Calculate the filename (a hash of the Lucre cleartext token ID)
+    // Calculate the record key (a hash of the Lucre cleartext token ID)
     Identifier theTokenHash;
     theTokenHash.CalculateDigest(theCleartextToken);
-
-    // Grab the new hash into a string (for use as a filename)
     String strTokenHash(theTokenHash);
 
-    String strAssetFolder;
-    strAssetFolder.Format("%s.%d", strInstrumentDefinitionID.Get(),
-                          GetSeries());
-
-    // See if the spent token file ALREADY EXISTS...
-    bool bTokenIsPresent = OTDB::Exists(
-        OTFolders::Spent().Get(), strAssetFolder.Get(), strTokenHash.Get());
-
-    // If so, we're trying to record a token that was already recorded...
-    if (bTokenIsPresent) {
-        otErr << "Token::RecordTokenAsSpent: Trying to record token as spent,"
-                 " but it was already recorded: " << OTFolders::Spent()
-              << Log::PathSeparator() << strAssetFolder << Log::PathSeparator()
-              << strTokenHash << "\n";
-        return false;
-    }
-
-    // FINISHED:
-    //
-    // We actually save the token itself into the file, which is named based
-    // on a hash of the Lucre data.
-    // The success of that operation is also now the success of this one.
-
-    String strFinal;
+    // We record the token itself along with its hash. Each record is one line
+    // of the spent token log, so the armored token is stored without its line
+    // breaks.
     OTASCIIArmor ascTemp(m_strRawFile);
+    std::string strToken(ascTemp.Get());
+    strToken.erase(std::remove_if(strToken.begin(), strToken.end(),
+                                  [](const char c) {
+                                      return ('\n' == c) || ('\r' == c);
+                                  }),
+                   strToken.end());
+
+    // Tokens can't be deposited past their valid-to date, so the records for
+    // this series can be pruned after that.
+    const bool bSaved = SpentTokenStore::Record(
+        strInstrumentDefinitionID.Get(), GetSeries(), GetValidTo(),
+        strTokenHash.Get(), strToken);
 
-    if (false ==
-        ascTemp.WriteArmoredString(strFinal, m_strContractType.Get())) {
-        otErr << "Token::RecordTokenAsSpent: Error recording token as "
-                 "spent (failed writing armored string):\n"
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
-              << Log::PathSeparator() << strTokenHash << "\n";
-        return false;
-    }
-
-    const bool bSaved =
-        OTDB::StorePlainString(strFinal.Get(), OTFolders::Spent().Get(),
-                               strAssetFolder.Get(), strTokenHash.Get());
     if (!bSaved) {
-        otErr << "Token::RecordTokenAsSpent: Error saving file: "
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
-              << Log::PathSeparator() << strTokenHash << "\n";
+        otErr << "Token::RecordTokenAsSpent: Failed recording token as spent: "
+              << strInstrumentDefinitionID << "." << GetSeries() << " "
+              << strTokenHash << "\n";
     }
 
     return bSaved;
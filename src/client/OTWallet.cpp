@@ -1450,6 +1450,10 @@ bool OTWallet::LoadWallet(const char* szFilename)
         // key,
         // NOW we can go through and convert them all, now that they're all
         // loaded.
+        //
+        // Storing them all under one root update.
+        Storage::Batch batch(App::Me().DB());
+        const setOfIdentifiers alreadyConverted = m_setNymsOnCachedKey;
 
         for (auto& it : m_mapPrivateNyms) {
             Nym* pNym = it.second;
@@ -1464,6 +1468,13 @@ bool OTWallet::LoadWallet(const char* szFilename)
                 bNeedToSaveAgain = true;
         }
 
+        if (bNeedToSaveAgain && !batch.Commit()) {
+            otErr << __FUNCTION__ << ": Failed to store converted Nyms.\n";
+            // Convert them again next time.
+            m_setNymsOnCachedKey = alreadyConverted;
+            bNeedToSaveAgain = false;
+        }
+
         //
         // delete the xml parser after usage
         if (xml) delete xml;
@@ -285,6 +285,14 @@ bool Account::LoadContract()
 
 bool Account::SaveAccount()
 {
+    // The numbers a transaction used must be on the nymfile before the
+    // balance it changed reaches the disk.
+    if (!Nym::FlushDeferredSaves()) {
+        otErr << __FUNCTION__ << ": Failed to save a pending nymfile. Not "
+                                 "saving the account.\n";
+        return false;
+    }
+
     String id;
     GetIdentifier(id);
     return SaveContract(OTFolders::Account().Get(), id.Get());
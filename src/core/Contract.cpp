@@ -41,6 +41,7 @@
 #include <opentxs/core/Contract.hpp>
 #include <opentxs/core/crypto/OTAsymmetricKey.hpp>
 #include <opentxs/core/crypto/CryptoAsymmetric.hpp>
+#include <opentxs/core/crypto/IntegrityTag.hpp>
 #include <opentxs/core/util/OTFolders.hpp>
 #include <opentxs/core/Log.hpp>
 #include <opentxs/core/crypto/OTPasswordData.hpp>
@@ -173,6 +174,7 @@ void Contract::Release_Contract()
     m_strSigHashType = Identifier::DefaultHashAlgorithm;
     m_xmlUnsigned.Release();
     m_strRawFile.Release();
+    m_strIntegrityTag.clear();
 
     ReleaseSignatures();
 
@@ -369,8 +371,13 @@ bool Contract::SignContract(const Nym& theNym, const OTPasswordData* pPWData)
 
     bool bSigned = SignContract(theNym, *pSig, pPWData);
 
-    if (bSigned)
+    if (bSigned) {
         m_listSignatures.push_back(pSig);
+
+        if (IntegrityTag::IsSigner(theNym)) {
+            m_strIntegrityTag = IntegrityTag::Calculate(m_xmlUnsigned, *pSig);
+        }
+    }
     else {
         otErr << __FUNCTION__ << ": Failure while calling "
                                  "SignContract(theNym, *pSig, pPWData)\n";
@@ -580,9 +587,32 @@ bool Contract::VerifySigAuthent(const Nym& theNym,
     return false;
 }
 
+std::string Contract::ValidIntegrityTag() const
+{
+    if (m_strIntegrityTag.empty()) return "";
+
+    for (auto& it : m_listSignatures) {
+        OTSignature* pSig = it;
+        OT_ASSERT(nullptr != pSig);
+
+        if (IntegrityTag::Calculate(m_xmlUnsigned, *pSig) ==
+            m_strIntegrityTag) {
+            return m_strIntegrityTag;
+        }
+    }
+
+    return "";
+}
+
 bool Contract::VerifySignature(const Nym& theNym,
                                const OTPasswordData* pPWData) const
 {
+    // A locally stored object that we signed ourselves carries a keyed MAC
+    // which is much cheaper to check than the signature itself.
+    const bool bIntegritySigner = IntegrityTag::IsSigner(theNym);
+
+    if (bIntegritySigner && !ValidIntegrityTag().empty()) return true;
+
     String strNymID;
     theNym.GetIdentifier(strNymID);
     char cNymID = '0';
@@ -1013,6 +1043,10 @@ bool Contract::SaveContract(const char* szFoldername, const char* szFilename)
         return false;
     }
 
+    if (IntegrityTag::Enabled()) {
+        IntegrityTag::Store(ValidIntegrityTag(), szFoldername, szFilename);
+    }
+
     return true;
 }
 
@@ -1070,6 +1104,7 @@ bool Contract::LoadContractRawFile()
     // either way.)
     //
     m_strRawFile.Set(strFileContents);
+    m_strIntegrityTag = IntegrityTag::Load(szFoldername, szFilename);
 
     return m_strRawFile.Exists();
 }
@@ -0,0 +1,72 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/core/stdafx.hpp>
+
+#include <opentxs/core/DeferredNymfileSave.hpp>
+
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/Nym.hpp>
+
+namespace opentxs
+{
+
+DeferredNymfileSave::DeferredNymfileSave(Nym& theNym)
+    : nym_(&theNym)
+{
+    nym_->BeginDeferredSave();
+}
+
+bool DeferredNymfileSave::Commit()
+{
+    if (nullptr == nym_) return true;
+
+    Nym* pNym = nym_;
+    nym_ = nullptr;
+
+    return pNym->EndDeferredSave();
+}
+
+DeferredNymfileSave::~DeferredNymfileSave()
+{
+    if (!Commit()) {
+        otErr << __FUNCTION__ << ": Failed writing a deferred nymfile save.\n";
+    }
+}
+
+} // namespace opentxs
@@ -181,6 +181,7 @@ bool Item::VerifyTransactionStatement(Nym& THE_NYM,
 
     GetAttachment(strMessageNym);
     Nym theMessageNym;
+    theMessageNym.LimitNumbersTo(THE_NYM);
 
     if ((strMessageNym.GetLength() > 2) &&
         theMessageNym.LoadNymFromString(strMessageNym)) {
@@ -745,14 +746,14 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
     //
     for (auto& it : THE_NYM.GetMapIssuedNum()) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-        OT_ASSERT(nullptr != pDeque);
+        TransactionNumbers* pNumbers = it.second;
+        OT_ASSERT(nullptr != pNumbers);
 
         const Identifier theNotaryID(strNotaryID.c_str());
 
-        if (!(pDeque->empty()) && (theNotaryID == GetPurportedNotaryID())) {
+        if (!(pNumbers->empty()) && (theNotaryID == GetPurportedNotaryID())) {
             nNumberOfTransactionNumbers1 +=
-                static_cast<int32_t>(pDeque->size());
+                static_cast<int32_t>(pNumbers->size());
             break; // There's only one, in this loop, that would/could/should
                    // match. (Therefore, break after finding it.)
         }
@@ -763,23 +764,23 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
     // number is checked.
     GetAttachment(strMessageNym);
     Nym theMessageNym;
+    theMessageNym.LimitNumbersTo(THE_NYM);
 
     if ((strMessageNym.GetLength() > 2) &&
         theMessageNym.LoadNymFromString(strMessageNym)) {
         for (auto& it : theMessageNym.GetMapIssuedNum()) {
             std::string strNotaryID = it.first;
-            dequeOfTransNums* pDeque = it.second;
-            OT_ASSERT(nullptr != pDeque);
+            TransactionNumbers* pNumbers = it.second;
+            OT_ASSERT(nullptr != pNumbers);
 
             const Identifier theNotaryID(strNotaryID.c_str());
             const String OTstrNotaryID(theNotaryID);
 
-            if (!(pDeque->empty()) && (theNotaryID == GetPurportedNotaryID())) {
+            if (!(pNumbers->empty()) && (theNotaryID == GetPurportedNotaryID())) {
                 nNumberOfTransactionNumbers2 +=
-                    static_cast<int32_t>(pDeque->size());
+                    static_cast<int32_t>(pNumbers->size());
 
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    int64_t lTransactionNumber = pDeque->at(i);
+                for (const int64_t lTransactionNumber : *pNumbers) {
                     if (false ==
                         THE_NYM.VerifyIssuedNum(OTstrNotaryID,
                                                 lTransactionNumber)) // FAILURE
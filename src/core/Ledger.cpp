@@ -41,6 +41,7 @@
 #include <opentxs/core/Ledger.hpp>
 #include <opentxs/core/Account.hpp>
 #include <opentxs/core/Cheque.hpp>
+#include <opentxs/core/crypto/IntegrityTag.hpp>
 #include <opentxs/core/crypto/OTEnvelope.hpp>
 #include <opentxs/core/util/OTFolders.hpp>
 #include <opentxs/core/util/Tag.hpp>
@@ -52,6 +53,9 @@
 
 #include <irrxml/irrXML.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <memory>
 
 namespace opentxs
@@ -547,6 +551,11 @@ bool Ledger::LoadGeneric(Ledger::ledgerType theType, const String* pString)
         return false;
     }
     else {
+        if (nullptr == pString) {
+            m_strIntegrityTag =
+                IntegrityTag::Load(szFolder1name, szFolder2name, szFilename);
+        }
+
         otInfo << "Successfully loaded " << pszType << " "
                << ((nullptr != pString) ? "from string" : "from file")
                << " in OTLedger::Load" << pszType << ": " << szFolder1name
@@ -614,6 +623,14 @@ bool Ledger::SaveGeneric(Ledger::ledgerType theType)
     OT_ASSERT(m_strFoldername.GetLength() > 2);
     OT_ASSERT(m_strFilename.GetLength() > 2);
 
+    // The numbers a receipt refers to must be on the nymfile before the
+    // receipt reaches the disk.
+    if (!Nym::FlushDeferredSaves()) {
+        otErr << "OTLedger::SaveGeneric: Failed to save a pending nymfile. "
+                 "Not saving the " << pszType << ".\n";
+        return false;
+    }
+
     String strRawFile;
 
     if (!SaveContractRaw(strRawFile)) {
@@ -644,10 +661,16 @@ bool Ledger::SaveGeneric(Ledger::ledgerType theType)
               << szFolder2name << Log::PathSeparator() << szFilename << "\n";
         return false;
     }
-    else
+    else {
+        if (IntegrityTag::Enabled()) {
+            IntegrityTag::Store(
+                ValidIntegrityTag(), szFolder1name, szFolder2name, szFilename);
+        }
+
         otInfo << "Successfully saved " << pszType << ": " << szFolder1name
                << Log::PathSeparator() << szFolder2name << Log::PathSeparator()
                << szFilename << "\n";
+    }
 
     return bSaved;
 }
@@ -1027,6 +1050,7 @@ void Ledger::InitLedger()
 Ledger::Ledger(const Identifier& theNymID, const Identifier& theAccountID,
                const Identifier& theNotaryID)
     : OTTransactionType(theNymID, theAccountID, theNotaryID)
+    , m_bVecTransactionsDirty(true)
     , m_Type(Ledger::message)
     , m_bLoadedLegacyData(false)
 {
@@ -1042,6 +1066,7 @@ Ledger::Ledger(const Identifier& theNymID, const Identifier& theAccountID,
 // loaded up, and the NymID will hopefully be loaded up with the rest of it.
 Ledger::Ledger(const Identifier& theAccountID, const Identifier& theNotaryID)
     : OTTransactionType()
+    , m_bVecTransactionsDirty(true)
     , m_Type(Ledger::message)
     , m_bLoadedLegacyData(false)
 {
@@ -1054,6 +1079,7 @@ Ledger::Ledger(const Identifier& theAccountID, const Identifier& theNotaryID)
 // This is private now and hopefully will stay that way.
 Ledger::Ledger()
     : OTTransactionType()
+    , m_bVecTransactionsDirty(true)
     , m_Type(Ledger::message)
     , m_bLoadedLegacyData(false)
 {
@@ -1065,6 +1091,140 @@ const mapOfTransactions& Ledger::GetTransactionMap() const
     return m_mapTransactions;
 }
 
+void Ledger::IndexTransaction(OTTransaction& theTransaction)
+{
+    const int64_t lTransactionNum = theTransaction.GetTransactionNum();
+
+    m_mapByType[std::make_pair(
+        static_cast<int64_t>(theTransaction.GetType()), lTransactionNum)] =
+        &theTransaction;
+    m_mapByInRefTo[std::make_pair(theTransaction.GetReferenceToNum(),
+                                  lTransactionNum)] = &theTransaction;
+
+    if (OTTransaction::replyNotice == theTransaction.GetType())
+        m_mapReplyNoticesByRequest[std::make_pair(
+            theTransaction.GetRequestNum(), lTransactionNum)] = &theTransaction;
+
+    QueueReceiptKey(theTransaction);
+
+    m_bVecTransactionsDirty = true;
+}
+
+void Ledger::UnindexTransaction(OTTransaction& theTransaction)
+{
+    const int64_t lTransactionNum = theTransaction.GetTransactionNum();
+
+    m_mapByType.erase(std::make_pair(
+        static_cast<int64_t>(theTransaction.GetType()), lTransactionNum));
+    m_mapByInRefTo.erase(
+        std::make_pair(theTransaction.GetReferenceToNum(), lTransactionNum));
+    m_mapReplyNoticesByRequest.erase(
+        std::make_pair(theTransaction.GetRequestNum(), lTransactionNum));
+
+    UnindexReceiptKey(theTransaction);
+
+    m_bVecTransactionsDirty = true;
+}
+
+void Ledger::QueueReceiptKey(OTTransaction& theTransaction)
+{
+    // Abbreviated receipts have no reference string to decode. They are
+    // replaced by the full box receipt (and indexed then) once it's loaded.
+    if (theTransaction.IsAbbreviated()) return;
+
+    switch (theTransaction.GetType()) {
+    case OTTransaction::transferReceipt:
+    case OTTransaction::chequeReceipt:
+    case OTTransaction::voucherReceipt:
+        m_setUnkeyedReceipts.insert(theTransaction.GetTransactionNum());
+        theTransaction.m_pReceiptIndex = this;
+        break;
+    default:
+        break;
+    }
+}
+
+void Ledger::UnindexReceiptKey(OTTransaction& theTransaction)
+{
+    if (this != theTransaction.m_pReceiptIndex) return;
+
+    theTransaction.m_pReceiptIndex = nullptr;
+
+    const int64_t lTransactionNum = theTransaction.GetTransactionNum();
+
+    // If it was never keyed there's nothing else to remove. Otherwise its
+    // key is still cached (OTTransaction::ResetReceiptKey calls here before
+    // dropping it), so this doesn't decode anything.
+    if (0 < m_setUnkeyedReceipts.erase(lTransactionNum)) return;
+
+    const auto key =
+        std::make_pair(theTransaction.GetReceiptKey(), lTransactionNum);
+
+    m_mapTransferReceiptsByOrigin.erase(key);
+    m_mapChequeReceiptsByNum.erase(key);
+}
+
+void Ledger::ReindexReceiptKey(OTTransaction& theTransaction)
+{
+    UnindexReceiptKey(theTransaction);
+    QueueReceiptKey(theTransaction);
+}
+
+void Ledger::IndexReceiptKeys(int64_t lChequeNum, Cheque** ppChequeOut,
+                              OTTransaction** ppChequeReceipt)
+{
+    for (auto& lTransactionNum : m_setUnkeyedReceipts) {
+        auto it = m_mapTransactions.find(lTransactionNum);
+        OT_ASSERT(m_mapTransactions.end() != it);
+
+        OTTransaction* pReceipt = it->second;
+        OT_ASSERT(nullptr != pReceipt);
+
+        // Decoding a cheque receipt's key means loading its cheque. If the
+        // caller wants that cheque, keep it rather than loading it again.
+        if ((nullptr != ppChequeOut) && (nullptr == *ppChequeOut) &&
+            (OTTransaction::transferReceipt != pReceipt->GetType())) {
+            std::unique_ptr<Cheque> pCheque(pReceipt->LoadReferencedCheque());
+
+            if ((nullptr != pCheque) &&
+                (lChequeNum == pCheque->GetTransactionNum())) {
+                *ppChequeOut = pCheque.release();
+                *ppChequeReceipt = pReceipt;
+            }
+        }
+
+        const int64_t lKey = pReceipt->GetReceiptKey();
+
+        if (0 == lKey) continue; // Already logged.
+
+        if (OTTransaction::transferReceipt == pReceipt->GetType())
+            m_mapTransferReceiptsByOrigin[std::make_pair(
+                lKey, lTransactionNum)] = pReceipt;
+        else
+            m_mapChequeReceiptsByNum[std::make_pair(lKey, lTransactionNum)] =
+                pReceipt;
+    }
+
+    m_setUnkeyedReceipts.clear();
+}
+
+const std::vector<OTTransaction*>& Ledger::GetTransactionVector() const
+{
+    if (m_bVecTransactionsDirty) {
+        m_vecTransactions.clear();
+        m_vecTransactions.reserve(m_mapTransactions.size());
+
+        for (auto& it : m_mapTransactions) {
+            OT_ASSERT(nullptr != it.second);
+            m_vecTransactions.push_back(it.second);
+        }
+
+        m_bVecTransactionsDirty = false;
+    }
+
+    return m_vecTransactions;
+}
+
 /// If transaction #87, in reference to #74, is in the inbox, you can remove it
 /// by calling this function and passing in 87. Deletes.
 ///
@@ -1085,6 +1245,7 @@ bool Ledger::RemoveTransaction(int64_t lTransactionNum, bool bDeleteIt)
         OTTransaction* pTransaction = it->second;
         OT_ASSERT(nullptr != pTransaction);
         m_mapTransactions.erase(it);
+        UnindexTransaction(*pTransaction);
 
         if (bDeleteIt) {
             delete pTransaction;
@@ -1103,6 +1264,7 @@ bool Ledger::AddTransaction(OTTransaction& theTransaction)
     // If it's not already on the list, then add it...
     if (it == m_mapTransactions.end()) {
         m_mapTransactions[theTransaction.GetTransactionNum()] = &theTransaction;
+        IndexTransaction(theTransaction);
         theTransaction.SetParent(*this); // for convenience
         return true;
     }
@@ -1115,56 +1277,55 @@ bool Ledger::AddTransaction(OTTransaction& theTransaction)
     return false;
 }
 
+// Returns the first transaction of that type, in transaction number order.
 OTTransaction* Ledger::GetTransaction(OTTransaction::transactionType theType)
 {
-    // loop through the items that make up this transaction
+    const int64_t lType = static_cast<int64_t>(theType);
+    auto it = m_mapByType.lower_bound(
+        std::make_pair(lType, std::numeric_limits<int64_t>::min()));
 
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
+    if ((m_mapByType.end() == it) || (lType != it->first.first))
+        return nullptr;
 
-        if (theType == pTransaction->GetType()) return pTransaction;
-    }
+    OT_ASSERT(nullptr != it->second);
 
-    return nullptr;
+    return it->second;
 }
 
 // if not found, returns -1
 int32_t Ledger::GetTransactionIndex(int64_t lTransactionNum)
 {
-    // loop through the transactions inside this ledger
     // If a specific transaction is found, returns its index inside the ledger
     //
-    int32_t nIndex = -1;
-
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
-
-        ++nIndex; // 0 on first iteration.
-
-        if (pTransaction->GetTransactionNum() == lTransactionNum) {
-            return nIndex;
-        }
-    }
-    return -1;
+    if (m_mapTransactions.end() == m_mapTransactions.find(lTransactionNum))
+        return -1;
+
+    // The vector is in transaction number order, same as the map.
+    const std::vector<OTTransaction*>& vecTransactions = GetTransactionVector();
+    auto it = std::lower_bound(
+        vecTransactions.begin(), vecTransactions.end(), lTransactionNum,
+        [](const OTTransaction* pTransaction, int64_t lNum) {
+            return pTransaction->GetTransactionNum() < lNum;
+        });
+
+    if ((vecTransactions.end() == it) ||
+        ((*it)->GetTransactionNum() != lTransactionNum))
+        return -1;
+
+    return static_cast<int32_t>(it - vecTransactions.begin());
 }
 
 // Look up a transaction by transaction number and see if it is in the ledger.
 // If it is, return a pointer to it, otherwise return nullptr.
 OTTransaction* Ledger::GetTransaction(int64_t lTransactionNum) const
 {
-    // loop through the transactions inside this ledger
+    auto it = m_mapTransactions.find(lTransactionNum);
 
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
+    if (m_mapTransactions.end() == it) return nullptr;
 
-        if (pTransaction->GetTransactionNum() == lTransactionNum) {
-            return pTransaction;
-        }
-    }
-    return nullptr;
+    OT_ASSERT(nullptr != it->second);
+
+    return it->second;
 }
 
 // Return a count of all the transactions in this ledger that are IN REFERENCE
@@ -1174,16 +1335,12 @@ OTTransaction* Ledger::GetTransaction(int64_t lTransactionNum) const
 //
 int32_t Ledger::GetTransactionCountInRefTo(int64_t lReferenceNum) const
 {
-    int32_t nCount = 0;
-
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
-
-        if (pTransaction->GetReferenceToNum() == lReferenceNum) nCount++;
-    }
+    auto itBegin = m_mapByInRefTo.lower_bound(
+        std::make_pair(lReferenceNum, std::numeric_limits<int64_t>::min()));
+    auto itEnd = m_mapByInRefTo.upper_bound(
+        std::make_pair(lReferenceNum, std::numeric_limits<int64_t>::max()));
 
-    return nCount;
+    return static_cast<int32_t>(std::distance(itBegin, itEnd));
 }
 
 // Look up a transaction by transaction number and see if it is in the ledger.
@@ -1193,20 +1350,11 @@ OTTransaction* Ledger::GetTransactionByIndex(int32_t nIndex) const
     // Out of bounds.
     if ((nIndex < 0) || (nIndex >= GetTransactionCount())) return nullptr;
 
-    int32_t nIndexCount = -1;
+    OTTransaction* pTransaction =
+        GetTransactionVector().at(static_cast<size_t>(nIndex));
+    OT_ASSERT((nullptr != pTransaction)); // Should always be good.
 
-    for (auto& it : m_mapTransactions) {
-        nIndexCount++; // On first iteration, this is now 0, same as nIndex.
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT((nullptr != pTransaction)); // Should always be good.
-
-        // If this transaction is the one at the requested index
-        if (nIndexCount == nIndex) return pTransaction;
-    }
-
-    return nullptr; // Should never reach this point, since bounds are checked
-                    // at
-                    // the top.
+    return pTransaction;
 }
 
 // Nymbox-only.
@@ -1214,182 +1362,87 @@ OTTransaction* Ledger::GetTransactionByIndex(int32_t nIndex) const
 //
 OTTransaction* Ledger::GetReplyNotice(const int64_t& lRequestNum)
 {
-    // loop through the transactions that make up this ledger.
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
+    auto it = m_mapReplyNoticesByRequest.lower_bound(
+        std::make_pair(lRequestNum, std::numeric_limits<int64_t>::min()));
 
-        if (OTTransaction::replyNotice != pTransaction->GetType()) // <=======
-            continue;
+    if ((m_mapReplyNoticesByRequest.end() == it) ||
+        (lRequestNum != it->first.first))
+        return nullptr;
 
-        if (pTransaction->GetRequestNum() == lRequestNum) return pTransaction;
-    }
+    OT_ASSERT(nullptr != it->second);
 
-    return nullptr;
+    return it->second;
 }
 
+// Note: the acceptPending USED to be "in reference to" whatever the pending
+// was in reference to. (i.e. the original transfer.) But since the KacTech
+// bug fix (for accepting multiple transfer receipts) the acceptPending is now
+// "in reference to" the pending itself, instead of the original transfer.
+//
+// Therefore it is necessary to pass in the NumberOfOrigin, and compare it to
+// the NumberOfOrigin on the acceptPending, to find the match.
+//
 OTTransaction* Ledger::GetTransferReceipt(int64_t lNumberOfOrigin)
 {
-    // loop through the transactions that make up this ledger.
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
+    IndexReceiptKeys();
 
-        if (OTTransaction::transferReceipt == pTransaction->GetType()) {
-            String strReference;
-            pTransaction->GetReferenceString(strReference);
+    auto it = m_mapTransferReceiptsByOrigin.lower_bound(
+        std::make_pair(lNumberOfOrigin, std::numeric_limits<int64_t>::min()));
 
-            std::unique_ptr<Item> pOriginalItem(Item::CreateItemFromString(
-                strReference, pTransaction->GetPurportedNotaryID(),
-                pTransaction->GetReferenceToNum()));
-            OT_ASSERT(nullptr != pOriginalItem);
+    if ((m_mapTransferReceiptsByOrigin.end() == it) ||
+        (lNumberOfOrigin != it->first.first))
+        return nullptr;
 
-            if (pOriginalItem->GetType() != Item::acceptPending) {
-                otErr << "OTLedger::" << __FUNCTION__
-                      << ": Wrong item type attached to transferReceipt!\n";
-                return nullptr;
-            }
-            else {
-                // Note: the acceptPending USED to be "in reference to" whatever
-                // the pending
-                // was in reference to. (i.e. the original transfer.) But since
-                // the KacTech
-                // bug fix (for accepting multiple transfer receipts) the
-                // acceptPending is now
-                // "in reference to" the pending itself, instead of the original
-                // transfer.
-                //
-                // It used to be that a caller of GetTransferReceipt would pass
-                // in the InRefTo
-                // expected from the pending in the outbox, and match it to the
-                // InRefTo found
-                // on the acceptPending (inside the transferReceipt) in the
-                // inbox.
-                // But this is no longer possible, since the acceptPending is no
-                // longer InRefTo
-                // whatever the pending is InRefTo.
-                //
-                // Therefore, in this place, it is now necessary to pass in the
-                // NumberOfOrigin,
-                // and compare it to the NumberOfOrigin, to find the match.
-                //
-                if (pOriginalItem->GetNumberOfOrigin() == lNumberOfOrigin)
-                    //              if (pOriginalItem->GetReferenceToNum() ==
-                    // lTransactionNum)
-                    return pTransaction; // FOUND IT!
-            }
-        }
-    }
+    OT_ASSERT(nullptr != it->second);
 
-    return nullptr;
+    return it->second;
 }
 
-// This method loops through all the receipts in the ledger (inbox usually),
-// to see if there's a chequeReceipt for a given cheque. For each cheque
-// receipt,
-// it will load up the original depositCheque item it references, and then load
-// up
-// the actual cheque which is attached to that item. At this point it can verify
-// whether lChequeNum matches the transaction number on the cheque itself, and
-// if
-// so, return a pointer to the relevant chequeReceipt.
+// Finds the chequeReceipt (or voucherReceipt) for a given cheque. Each
+// receipt's cheque number comes from the cheque attached to the original
+// depositCheque item it references, which is loaded once per receipt (see
+// OTTransaction::GetReceiptKey) and then indexed.
 //
 // The caller has the option of passing ppChequeOut if he wants the cheque
-// returned
-// (if he's going to load it anyway, no sense in loading it twice.) If the
-// caller
-// elects this option, he needs to delete the cheque when he's done with it.
-// (But of course do NOT delete the OTTransaction that's returned, since that is
-// owned by the ledger.)
+// returned. If the caller elects this option, he needs to delete the cheque
+// when he's done with it. (But of course do NOT delete the OTTransaction
+// that's returned, since that is owned by the ledger.)
 //
 OTTransaction* Ledger::GetChequeReceipt(int64_t lChequeNum,
                                         Cheque** ppChequeOut) // CALLER
                                                               // RESPONSIBLE
                                                               // TO DELETE.
 {
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pCurrentReceipt = it.second;
-        OT_ASSERT(nullptr != pCurrentReceipt);
-
-        if ((pCurrentReceipt->GetType() != OTTransaction::chequeReceipt) &&
-            (pCurrentReceipt->GetType() != OTTransaction::voucherReceipt))
-            continue;
-
-        String strDepositChequeMsg;
-        pCurrentReceipt->GetReferenceString(strDepositChequeMsg);
-
-        std::unique_ptr<Item> pOriginalItem(Item::CreateItemFromString(
-            strDepositChequeMsg, GetPurportedNotaryID(),
-            pCurrentReceipt->GetReferenceToNum()));
-
-        if (nullptr == pOriginalItem) {
-            otErr << __FUNCTION__
-                  << ": Expected original depositCheque request item to be "
-                     "inside the chequeReceipt "
-                     "(but failed to load it...)\n";
-        }
-        else if (Item::depositCheque != pOriginalItem->GetType()) {
-            String strItemType;
-            pOriginalItem->GetTypeString(strItemType);
-            otErr << __FUNCTION__
-                  << ": Expected original depositCheque request item to be "
-                     "inside the chequeReceipt, "
-                     "but somehow what we found instead was a " << strItemType
-                  << "...\n";
-        }
-        else {
-            // Get the cheque from the Item and load it up into a Cheque object.
-            //
-            String strCheque;
-            pOriginalItem->GetAttachment(strCheque);
+    Cheque* pDecodedCheque = nullptr;
+    OTTransaction* pDecodedReceipt = nullptr;
+    IndexReceiptKeys(lChequeNum,
+                     (nullptr != ppChequeOut) ? &pDecodedCheque : nullptr,
+                     &pDecodedReceipt);
+    std::unique_ptr<Cheque> theChequeAngel(pDecodedCheque);
+
+    auto it = m_mapChequeReceiptsByNum.lower_bound(
+        std::make_pair(lChequeNum, std::numeric_limits<int64_t>::min()));
+
+    if ((m_mapChequeReceiptsByNum.end() == it) ||
+        (lChequeNum != it->first.first))
+        return nullptr;
 
-            Cheque* pCheque = new Cheque;
-            OT_ASSERT(nullptr != pCheque);
-            std::unique_ptr<Cheque> theChequeAngel(pCheque);
+    OTTransaction* pReceipt = it->second;
+    OT_ASSERT(nullptr != pReceipt);
 
-            if (!((strCheque.GetLength() > 2) &&
-                  pCheque->LoadContractFromString(strCheque))) {
-                otErr << __FUNCTION__ << ": Error loading cheque from string:\n"
-                      << strCheque << "\n";
-            }
-            // NOTE: Technically we don'T NEED to load up the cheque anymore,
-            // since
-            // we could just check the NumberOfOrigin, which should already
-            // match the
-            // transaction number on the cheque.
-            // However, even that would have to load up the cheque once, if it
-            // wasn't
-            // already set, and this function already must RETURN a copy of the
-            // cheque
-            // (at least optionally), so we might as well just load it up,
-            // verify it,
-            // and return it. (That's why we are still loading the cheque here
-            // instead
-            // of checking the number of origin.)
-            else {
-                // Success loading the cheque.
-                // Let's see if it's the right cheque...
-                if (pCheque->GetTransactionNum() == lChequeNum) {
-                    // We found it! Let's return a pointer to pCurrentReceipt
+    // The cheque is loaded only if the caller wants it, and only once: if
+    // this receipt was keyed just now, its cheque was kept from then.
+    if (nullptr != ppChequeOut) {
+        if (pDecodedReceipt != pReceipt)
+            theChequeAngel.reset(pReceipt->LoadReferencedCheque());
 
-                    // Also return pCheque, if the caller wants it (otherwise
-                    // delete it.)
-                    //
-                    if (nullptr != ppChequeOut) // caller wants us to return the
-                                                // cheque pointer as well.
-                    {
-                        (*ppChequeOut) =
-                            pCheque; // now caller is responsible to delete.
-                        theChequeAngel.release();
-                    }
+        if (nullptr == theChequeAngel) return nullptr;
 
-                    return pCurrentReceipt;
-                }
-            }
-        }
+        // now caller is responsible to delete.
+        (*ppChequeOut) = theChequeAngel.release();
     }
 
-    return nullptr;
+    return pReceipt;
 }
 
 // Find the finalReceipt in this Inbox, that has lTransactionNum as its "in
@@ -1408,15 +1461,16 @@ OTTransaction* Ledger::GetChequeReceipt(int64_t lChequeNum,
 //
 OTTransaction* Ledger::GetFinalReceipt(int64_t lReferenceNum)
 {
-    // loop through the transactions that make up this ledger.
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
+    // loop through the transactions that are in reference to lReferenceNum.
+    auto it = m_mapByInRefTo.lower_bound(
+        std::make_pair(lReferenceNum, std::numeric_limits<int64_t>::min()));
 
-        if (OTTransaction::finalReceipt != pTransaction->GetType()) // <=======
-            continue;
+    for (; (m_mapByInRefTo.end() != it) && (lReferenceNum == it->first.first);
+         ++it) {
+        OTTransaction* pTransaction = it->second;
+        OT_ASSERT(nullptr != pTransaction);
 
-        if (pTransaction->GetReferenceToNum() == lReferenceNum)
+        if (OTTransaction::finalReceipt == pTransaction->GetType())
             return pTransaction;
     }
 
@@ -2072,6 +2126,7 @@ int32_t Ledger::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
                         //
                         m_mapTransactions[pTransaction->GetTransactionNum()] =
                             pTransaction;
+                        IndexTransaction(*pTransaction);
                         pTransaction->SetParent(*this);
                         //                      otLog5 << "Loaded abbreviated
                         // transaction and adding to m_mapTransactions in
@@ -2241,6 +2296,7 @@ int32_t Ledger::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
                 //
                 m_mapTransactions[pTransaction->GetTransactionNum()] =
                     pTransaction;
+                IndexTransaction(*pTransaction);
                 pTransaction->SetParent(*this);
                 //                otLog5 << "Loaded full transaction and adding
                 // to m_mapTransactions in OTLedger\n");
@@ -2332,6 +2388,15 @@ void Ledger::ReleaseTransactions()
 {
     // If there were any dynamically allocated objects, clean them up here.
 
+    m_mapByType.clear();
+    m_mapByInRefTo.clear();
+    m_mapReplyNoticesByRequest.clear();
+    m_mapTransferReceiptsByOrigin.clear();
+    m_mapChequeReceiptsByNum.clear();
+    m_setUnkeyedReceipts.clear();
+    m_vecTransactions.clear();
+    m_bVecTransactionsDirty = true;
+
     while (!m_mapTransactions.empty()) {
         OTTransaction* pTransaction = m_mapTransactions.begin()->second;
         m_mapTransactions.erase(m_mapTransactions.begin());
@@ -136,6 +136,7 @@ namespace opentxs
 {
 
 Log* Log::pLogger = nullptr;
+std::recursive_mutex Log::lock_;
 
 const String Log::m_strVersion = OPENTXS_VERSION_STRING;
 const String Log::m_strPathSeparator = "/";
@@ -151,33 +152,41 @@ OTLOG_IMPORT OTLogStream otLog5(5); // logs using OTLog::vOutput(5)
 OTLogStream::OTLogStream(int _logLevel)
     : std::ostream(this)
     , logLevel(_logLevel)
-    , next(0)
-    , pBuffer(new char[1024])
 {
 }
 
 OTLogStream::~OTLogStream()
 {
-    delete[] pBuffer;
-    pBuffer = nullptr;
 }
 
 int OTLogStream::overflow(int c)
 {
-    pBuffer[next++] = c;
-    if (c != '\n' && next < 1000) {
-        return 0;
-    }
+    std::string line;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = buffers_.find(std::this_thread::get_id());
+
+        if (buffers_.end() == it) {
+            it = buffers_.emplace(std::this_thread::get_id(), "").first;
+        }
+
+        it->second.push_back(static_cast<char>(c));
+
+        if (c != '\n' && it->second.size() < 1000) {
+            return 0;
+        }
 
-    pBuffer[next++] = '\0';
-    next = 0;
+        line.swap(it->second);
+        buffers_.erase(it);
+    }
 
     if (logLevel < 0) {
-        Log::Error(pBuffer);
+        Log::Error(line.c_str());
         return 0;
     }
 
-    Log::Output(logLevel, pBuffer);
+    Log::Output(logLevel, line.c_str());
     return 0;
 }
 
@@ -366,6 +375,8 @@ bool Log::LogToFile(const String& strOutput)
     bool bSuccess = false;
 
     if (bHaveLogger) {
+        std::lock_guard<std::recursive_mutex> lock(lock_);
+
         // Append to logfile
         if ((strOutput.Exists()) && (Log::pLogger->m_strLogFilePath.Exists())) {
             std::ofstream logfile;
@@ -384,6 +395,8 @@ bool Log::LogToFile(const String& strOutput)
 
 String Log::GetMemlogAtIndex(int32_t nIndex)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
 
@@ -411,6 +424,8 @@ String Log::GetMemlogAtIndex(int32_t nIndex)
 
 int32_t Log::GetMemlogSize()
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
 
@@ -419,6 +434,8 @@ int32_t Log::GetMemlogSize()
 
 String Log::PeekMemlogFront()
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
 
@@ -439,6 +456,8 @@ String Log::PeekMemlogFront()
 
 String Log::PeekMemlogBack()
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
 
@@ -460,6 +479,8 @@ String Log::PeekMemlogBack()
 // static
 bool Log::PopMemlogFront()
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
 
@@ -477,6 +498,8 @@ bool Log::PopMemlogFront()
 // static
 bool Log::PopMemlogBack()
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
 
@@ -494,6 +517,8 @@ bool Log::PopMemlogBack()
 // static
 bool Log::PushMemlogFront(const String& strLog)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
 
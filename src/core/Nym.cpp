@@ -66,11 +66,20 @@
 #include <fstream>
 #include <memory>
 
+#define NYMFILE_VERSION_LIST "1.0"
+#define NYMFILE_VERSION_RANGES "1.1"
+// How many more numbers a Nym from another party may list than the trusted
+// copy holds. Numbers are issued in batches of 100.
+#define OT_MESSAGE_NYM_NUMBER_SLACK 100
+
 // static
 
 namespace opentxs
 {
 
+std::recursive_mutex Nym::deferred_lock_;
+std::map<std::string, Nym::DeferredSave> Nym::deferred_saves_;
+
 void Nym::SetAsPrivate(bool isPrivate)
 {
     m_bPrivate = isPrivate;
@@ -495,9 +504,9 @@ Item* Nym::GenerateTransactionStatement(const OTTransaction& theOwner)
 #define CLEAR_MAP_AND_DEQUE(the_map)                                           \
     for (auto& it : the_map) {                                                 \
         if ((nullptr != pstrNotaryID) && (str_NotaryID != it.first)) continue; \
-        dequeOfTransNums* pDeque = (it.second);                                \
-        OT_ASSERT(nullptr != pDeque);                                          \
-        if (!(pDeque->empty())) pDeque->clear();                               \
+        TransactionNumbers* pNumbers = (it.second);                            \
+        OT_ASSERT(nullptr != pNumbers);                                        \
+        if (!(pNumbers->empty())) pNumbers->clear();                           \
     }
 #endif // CLEAR_MAP_AND_DEQUE
 
@@ -805,11 +814,11 @@ bool Nym::UnRegisterAtServer(const String& strNotaryID)
 #ifndef WIPE_MAP_AND_DEQUE
 #define WIPE_MAP_AND_DEQUE(the_map)                                            \
     while (!the_map.empty()) {                                                 \
-        dequeOfTransNums* pDeque = the_map.begin()->second;                    \
-        OT_ASSERT(nullptr != pDeque);                                          \
+        TransactionNumbers* pNumbers = the_map.begin()->second;                \
+        OT_ASSERT(nullptr != pNumbers);                                        \
         the_map.erase(the_map.begin());                                        \
-        delete pDeque;                                                         \
-        pDeque = nullptr;                                                      \
+        delete pNumbers;                                                       \
+        pNumbers = nullptr;                                                    \
     }
 #endif // WIPE_MAP_AND_DEQUE
 
@@ -1117,49 +1126,24 @@ bool Nym::ResyncWithServer(const Ledger& theNymbox, const Nym& theMessageNym)
     return (SaveSignedNymfile(*this) && bSuccess);
 }
 
-/*
-typedef std::deque<int64_t>                            dequeOfTransNums;
-typedef std::map<std::string, dequeOfTransNums *>    mapOfTransNums;
-*/
-
 // Verify whether a certain transaction number appears on a certain list.
 //
 bool Nym::VerifyGenericNum(const mapOfTransNums& THE_MAP,
                            const String& strNotaryID,
                            const int64_t& lTransNum) const
 {
-    std::string strID = strNotaryID.Get();
+    // The Pseudonym has a set of transaction numbers for each server.
+    // These sets are mapped by Notary ID.
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-    // The Pseudonym has a deque of transaction numbers for each servers.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then find the transaction
-    // number on
-    // that list, and then return true. Else return false.
-    //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
-
-            if (!(pDeque->empty())) // there are some numbers for that server ID
-            {
-                // Let's loop through them and see if the culprit is there
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    // Found it!
-                    if (lTransNum == pDeque->at(i)) {
-                        return true;
-                    }
-                }
-            }
-            break;
-        }
+    if (THE_MAP.end() == it) {
+        return false;
     }
 
-    return false;
+    TransactionNumbers* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
+
+    return pNumbers->Contains(lTransNum);
 }
 
 // On the server side: A user has submitted a specific transaction number.
@@ -1184,42 +1168,16 @@ bool Nym::RemoveGenericNum(mapOfTransNums& THE_MAP, Nym& SIGNER_NYM,
 bool Nym::RemoveGenericNum(mapOfTransNums& THE_MAP, const String& strNotaryID,
                            const int64_t& lTransNum)
 {
-    bool bRetVal = false;
-    std::string strID = strNotaryID.Get();
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-    // The Pseudonym has a deque of transaction numbers for each servers.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then find the transaction
-    // number on
-    // that list, and then remove it, and return true. Else return false.
-    //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-
-            OT_ASSERT(nullptr != pDeque);
-
-            if (!(pDeque->empty())) // there are some numbers for that server ID
-            {
-                // Let's loop through them and see if the culprit is there
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    // Found it!
-                    if (lTransNum == pDeque->at(i)) {
-                        pDeque->erase(pDeque->begin() + i);
-                        bRetVal = true;
-                        break;
-                    }
-                }
-            }
-            break;
-        }
+    if (THE_MAP.end() == it) {
+        return false;
     }
 
-    return bRetVal;
+    TransactionNumbers* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
+
+    return pNumbers->Remove(lTransNum);
 }
 
 // No signer needed for this one, and save is false.
@@ -1227,50 +1185,51 @@ bool Nym::RemoveGenericNum(mapOfTransNums& THE_MAP, const String& strNotaryID,
 bool Nym::AddGenericNum(mapOfTransNums& THE_MAP, const String& strNotaryID,
                         int64_t lTransNum)
 {
-    bool bSuccessFindingNotaryID = false, bSuccess = false;
-    std::string strID = strNotaryID.Get();
+    TransactionNumbers*& pNumbers = THE_MAP[strNotaryID.Get()];
 
-    // The Pseudonym has a deque of transaction numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then add the transaction
-    // number.
-    //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
+    // Apparently there is not yet a set stored for this specific notaryID.
+    // Fine. Let's create it then, and then add the transaction num to it.
+    if (nullptr == pNumbers) {
+        pNumbers = new TransactionNumbers;
+    }
 
-            auto iter = std::find(pDeque->begin(), pDeque->end(), lTransNum);
+    OT_ASSERT(nullptr != pNumbers);
 
-            if (iter == pDeque->end()) // Only add it if it's not already there.
-                                       // No duplicates!
-                pDeque->push_front(lTransNum);
+    pNumbers->Add(lTransNum); // No duplicates!
 
-            bSuccess = true;
-            bSuccessFindingNotaryID = true;
+    return true;
+}
 
-            break;
-        }
+void Nym::LimitNumbersTo(const Nym& theTrustedNym)
+{
+    std::size_t total = OT_MESSAGE_NYM_NUMBER_SLACK;
+
+    for (auto& it : theTrustedNym.m_mapIssuedNum) {
+        OT_ASSERT(nullptr != it.second);
+        total += it.second->size();
     }
 
-    // Apparently there is not yet a deque stored for this specific notaryID.
-    // Fine. Let's create it then, and then add the transaction num to that new
-    // deque.
-    if (!bSuccessFindingNotaryID) {
-        dequeOfTransNums* pDeque = new dequeOfTransNums;
+    for (auto& it : theTrustedNym.m_mapTentativeNum) {
+        OT_ASSERT(nullptr != it.second);
+        total += it.second->size();
+    }
 
-        OT_ASSERT(nullptr != pDeque);
+    number_limit_ = total;
+}
 
-        THE_MAP[strID] = pDeque;
-        pDeque->push_front(lTransNum);
-        bSuccess = true;
+// Like AddGenericNum, but merges a whole set a range at a time.
+void Nym::InsertGenericNums(mapOfTransNums& THE_MAP, const String& strNotaryID,
+                            const TransactionNumbers& theNumbers)
+{
+    TransactionNumbers*& pNumbers = THE_MAP[strNotaryID.Get()];
+
+    if (nullptr == pNumbers) {
+        pNumbers = new TransactionNumbers;
     }
 
-    return bSuccess;
+    OT_ASSERT(nullptr != pNumbers);
+
+    pNumbers->Insert(theNumbers);
 }
 
 // Returns count of transaction numbers available for a given server.
@@ -1278,76 +1237,39 @@ bool Nym::AddGenericNum(mapOfTransNums& THE_MAP, const String& strNotaryID,
 int32_t Nym::GetGenericNumCount(const mapOfTransNums& THE_MAP,
                                 const Identifier& theNotaryID) const
 {
-    int32_t nReturnValue = 0;
-
     const String strNotaryID(theNotaryID);
-    std::string strID = strNotaryID.Get();
-
-    dequeOfTransNums* pDeque = nullptr;
-
-    // The Pseudonym has a deque of transaction numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then we found the right server.
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-            break;
-        }
+    if (THE_MAP.end() == it) {
+        return 0;
     }
 
-    // We found the right server, so let's count the transaction numbers
-    // that this nym has already stored for it.
-    if (nullptr != pDeque) {
-        nReturnValue = static_cast<int32_t>(pDeque->size());
-    }
+    TransactionNumbers* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
 
-    return nReturnValue;
+    return static_cast<int32_t>(pNumbers->size());
 }
 
-// by index.
+// by index, counting from the lowest number.
 int64_t Nym::GetGenericNum(const mapOfTransNums& THE_MAP,
                            const Identifier& theNotaryID, int32_t nIndex) const
 {
-    int64_t lRetVal = 0;
-
     const String strNotaryID(theNotaryID);
-    std::string strID = strNotaryID.Get();
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-    // The Pseudonym has a deque of numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // maps matches the Notary ID that was passed in, then find the number on
-    // that list, and then return it.
-    //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
-
-            if (!(pDeque->empty())) // there are some numbers for that server ID
-            {
-                // Let's loop through them and see if the culprit is there
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    // Found it!
-                    if (static_cast<uint32_t>(nIndex) == i) {
-                        lRetVal = pDeque->at(i); // <==== Got the number here.
-                        break;
-                    }
-                }
-            }
-            break;
-        }
+    if (THE_MAP.end() == it) {
+        return 0;
+    }
+
+    TransactionNumbers* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
+
+    if ((0 > nIndex) ||
+        (pNumbers->size() <= static_cast<std::size_t>(nIndex))) {
+        return 0;
     }
 
-    return lRetVal;
+    return pNumbers->at(static_cast<std::size_t>(nIndex));
 }
 
 // by index.
@@ -1545,33 +1467,20 @@ bool Nym::AddAcknowledgedNum(const String& strNotaryID,
     // total
     // number of ackNums allowed...
     //
-    std::string strID = strNotaryID.Get();
+    auto it = m_mapAcknowledgedNum.find(strNotaryID.Get());
 
-    // The Pseudonym has a deque of transaction numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then we'll pop the size of the
-    // deque
-    // down to our max size (off the back) before then calling AddGenericNum
-    // which will
-    // push the new request number onto the front.
-    //
-    for (auto& it : m_mapAcknowledgedNum) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
-
-            while (pDeque->size() > OT_MAX_ACK_NUMS) {
-                pDeque->pop_back(); // This fixes knotwork's issue where he had
-                                    // thousands of ack nums somehow never
-                                    // getting cleared out. Now we have a MAX
-                                    // and always keep it clean otherwise.
-            }
-            break;
-        }
+    // Request numbers only ever increase, so the lowest are the oldest. Drop
+    // those down to our max size before calling AddGenericNum.
+    if (m_mapAcknowledgedNum.end() != it) {
+        TransactionNumbers* pNumbers = it->second;
+        OT_ASSERT(nullptr != pNumbers);
+
+        pNumbers->TrimLowest(OT_MAX_ACK_NUMS); // This fixes knotwork's
+                                               // issue where he had thousands
+                                               // of ack nums somehow never
+                                               // getting cleared out. Now we
+                                               // have a MAX and always keep
+                                               // it clean otherwise.
     }
 
     return AddGenericNum(m_mapAcknowledgedNum, strNotaryID,
@@ -1703,18 +1612,18 @@ void Nym::HarvestTransactionNumbers(const Identifier& theNotaryID,
 
     for (auto& it : theOtherNym.GetMapIssuedNum()) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
         String OTstrNotaryID = strNotaryID.c_str();
         const Identifier theTempID(OTstrNotaryID);
 
-        if (!(pDeque->empty()) &&
+        if (!(pNumbers->empty()) &&
             (theNotaryID == theTempID)) // only for the matching notaryID.
         {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+            for (const int64_t number : *pNumbers) {
+                lTransactionNumber = number;
 
                 // If number wasn't already on issued list, then add to BOTH
                 // lists.
@@ -1835,17 +1744,17 @@ void Nym::HarvestIssuedNumbers(const Identifier& theNotaryID, Nym& SIGNER_NYM,
 
     for (auto& it : theOtherNym.GetMapIssuedNum()) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
         String OTstrNotaryID =
             ((strNotaryID.size()) > 0 ? strNotaryID.c_str() : "");
         const Identifier theTempID(OTstrNotaryID);
 
-        if (!(pDeque->empty()) && (theNotaryID == theTempID)) {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+        if (!(pNumbers->empty()) && (theNotaryID == theTempID)) {
+            for (const int64_t number : *pNumbers) {
+                lTransactionNumber = number;
 
                 // If number wasn't already on issued list, then add to BOTH
                 // lists.
@@ -1910,31 +1819,20 @@ bool Nym::GetNextTransactionNum(Nym& SIGNER_NYM, const String& strNotaryID,
                                 int64_t& lTransNum, bool bSave)
 {
     bool bRetVal = false;
-    std::string strID = strNotaryID.Get();
+    auto it = m_mapTransNum.find(strNotaryID.Get());
 
-    // The Pseudonym has a deque of transaction numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then send out the transaction
-    // number.
-    //
-    for (auto& it : m_mapTransNum) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
+    // Send out the oldest (lowest) transaction number for that server.
+    if (m_mapTransNum.end() != it) {
+        TransactionNumbers* pNumbers = it->second;
+        OT_ASSERT(nullptr != pNumbers);
 
-            if (!(pDeque->empty())) {
-                lTransNum = pDeque->back();
+        if (!(pNumbers->empty())) {
+            lTransNum = pNumbers->Lowest();
 
-                pDeque->pop_back();
+            pNumbers->Remove(lTransNum);
 
-                // The call has succeeded
-                bRetVal = true;
-            }
-            break;
+            // The call has succeeded
+            bRetVal = true;
         }
     }
 
@@ -2541,62 +2439,52 @@ void Nym::DisplayStatistics(String& strOutput)
 
     for (auto& it : m_mapIssuedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             strOutput.Concatenate(
                 "---- Transaction numbers still signed out from server: %s\n",
                 strNotaryID.c_str());
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                int64_t lTransactionNumber = pDeque->at(i);
-
-                strOutput.Concatenate(0 == i ? "%" PRId64 : ", %" PRId64,
-                                      lTransactionNumber);
-            }
-            strOutput.Concatenate("\n");
+            String strNumbers;
+            pNumbers->Output(strNumbers);
+            strOutput.Concatenate("%s\n", strNumbers.Get());
         }
     } // for
 
     for (auto& it : m_mapTransNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             strOutput.Concatenate(
                 "---- Transaction numbers still usable on server: %s\n",
                 strNotaryID.c_str());
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                int64_t lTransactionNumber = pDeque->at(i);
-                strOutput.Concatenate(0 == i ? "%" PRId64 : ", %" PRId64,
-                                      lTransactionNumber);
-            }
-            strOutput.Concatenate("\n");
+            String strNumbers;
+            pNumbers->Output(strNumbers);
+            strOutput.Concatenate("%s\n", strNumbers.Get());
         }
     } // for
 
     for (auto& it : m_mapAcknowledgedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             strOutput.Concatenate("---- Request numbers for which Nym has "
                                   "already received a reply from server: %s\n",
                                   strNotaryID.c_str());
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                int64_t lRequestNumber = pDeque->at(i);
-                strOutput.Concatenate(0 == i ? "%" PRId64 : ", %" PRId64,
-                                      lRequestNumber);
-            }
-            strOutput.Concatenate("\n");
+            String strNumbers;
+            pNumbers->Output(strNumbers);
+            strOutput.Concatenate("%s\n", strNumbers.Get());
         }
     } // for
 
@@ -2677,7 +2565,7 @@ bool Nym::SavePseudonym(const char* szFoldername, const char* szFilename)
     OT_ASSERT(nullptr != szFilename);
 
     String strNym;
-    SavePseudonym(strNym);
+    SavePseudonym(strNym, true);
 
     bool bSaved =
         OTDB::StorePlainString(strNym.Get(), szFoldername, szFilename);
@@ -2743,6 +2631,16 @@ const serializedCredentialIndex Nym::asPublicNym() const
     return SerializeCredentialIndex(Nym::FULL_CREDS);
 }
 
+Identifier Nym::CredentialIndexHash() const
+{
+    Identifier hash;
+    hash.CalculateDigest(
+        proto::ProtoAsData<proto::CredentialIndex>(
+            SerializeCredentialIndex(Nym::FULL_CREDS)));
+
+    return hash;
+}
+
 void Nym::GetPrivateCredentials(String& strCredList, String::Map* pmapCredFiles)
 {
     Tag tag("nymData");
@@ -2933,13 +2831,21 @@ bool Nym::LoadCredentialIndex(const serializedCredentialIndex& index)
 
 // Save the Pseudonym to a string...
 bool Nym::SavePseudonym(String& strNym)
+{
+    return SavePseudonym(strNym, false);
+}
+
+bool Nym::SavePseudonym(String& strNym, bool bRanges)
 {
     Tag tag("nymData");
 
     String nymID;
     GetIdentifier(nymID);
 
-    tag.add_attribute("version", m_strVersion.Get());
+    // Older versions can't read the range format, so it gets its own version
+    // number, and is only written to our own storage.
+    tag.add_attribute("version",
+                      bRanges ? NYMFILE_VERSION_RANGES : NYMFILE_VERSION_LIST);
     tag.add_attribute("nymID", nymID.Get());
 
     if (m_lUsageCredits != 0)
@@ -2990,24 +2896,15 @@ bool Nym::SavePseudonym(String& strNym)
                                            "FOR DELETION AT ITS OWN REQUEST");
     }
 
-    int64_t lTransactionNumber = 0;
-
     for (auto& it : m_mapTransNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-
-        OT_ASSERT(nullptr != pDeque);
+        TransactionNumbers* pNumbers = it.second;
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
+        OT_ASSERT(nullptr != pNumbers);
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
-                theList.Add(lTransactionNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp, bRanges) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -3019,24 +2916,15 @@ bool Nym::SavePseudonym(String& strNym)
         }
     } // for
 
-    lTransactionNumber = 0;
-
     for (auto& it : m_mapIssuedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-
-        OT_ASSERT(nullptr != pDeque);
+        TransactionNumbers* pNumbers = it.second;
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
+        OT_ASSERT(nullptr != pNumbers);
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
-                theList.Add(lTransactionNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp, bRanges) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -3048,24 +2936,15 @@ bool Nym::SavePseudonym(String& strNym)
         }
     } // for
 
-    lTransactionNumber = 0;
-
     for (auto& it : m_mapTentativeNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
-
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
-                theList.Add(lTransactionNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp, bRanges) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -3086,20 +2965,13 @@ bool Nym::SavePseudonym(String& strNym)
     //
     for (auto& it : m_mapAcknowledgedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
-
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                const int64_t lRequestNumber = pDeque->at(i);
-                theList.Add(lRequestNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp, bRanges) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -3811,23 +3683,19 @@ bool Nym::LoadNymFromString(const String& strNym,
                           << ": Error: transactionNums field without value.\n";
                     return false; // error condition
                 }
-                NumList theNumList;
-
-                if (strTemp.Exists()) theNumList.Add(strTemp);
-
-                int64_t lTemp = 0;
-                while (theNumList.Peek(lTemp)) {
-                    theNumList.Pop();
-
-                    otLog3 << "Transaction Number " << lTemp
-                           << " ready-to-use for NotaryID: " << tempNotaryID
-                           << "\n";
-                    AddTransactionNum(tempNotaryID, lTemp); // This version
-                                                            // doesn't save to
-                                                            // disk. (Why save
-                                                            // to disk AS WE'RE
-                                                            // LOADING?)
+                TransactionNumbers theNumbers;
+
+                if (strTemp.Exists() &&
+                    !theNumbers.Load(strTemp, number_limit_)) {
+                    otErr << __FUNCTION__ << ": Error: failed parsing numbers "
+                          << "for NotaryID: " << tempNotaryID << "\n";
+                    return false; // error condition
                 }
+
+                otLog3 << theNumbers.size() << " transaction numbers "
+                       << "ready-to-use for NotaryID: " << tempNotaryID
+                       << "\n";
+                InsertGenericNums(m_mapTransNum, tempNotaryID, theNumbers);
             }
             else if (strNodeName.Compare("issuedNums")) {
                 const String tempNotaryID = xml->getAttributeValue("notaryID");
@@ -3838,21 +3706,19 @@ bool Nym::LoadNymFromString(const String& strNym,
                           << ": Error: issuedNums field without value.\n";
                     return false; // error condition
                 }
-                NumList theNumList;
-
-                if (strTemp.Exists()) theNumList.Add(strTemp);
-
-                int64_t lTemp = 0;
-                while (theNumList.Peek(lTemp)) {
-                    theNumList.Pop();
+                TransactionNumbers theNumbers;
 
-                    otLog3 << "Currently liable for issued trans# " << lTemp
-                           << " at NotaryID: " << tempNotaryID << "\n";
-                    AddIssuedNum(tempNotaryID, lTemp); // This version doesn't
-                                                       // save to disk. (Why
-                                                       // save to disk AS WE'RE
-                                                       // LOADING?)
+                if (strTemp.Exists() &&
+                    !theNumbers.Load(strTemp, number_limit_)) {
+                    otErr << __FUNCTION__ << ": Error: failed parsing numbers "
+                          << "for NotaryID: " << tempNotaryID << "\n";
+                    return false; // error condition
                 }
+
+                otLog3 << "Currently liable for " << theNumbers.size()
+                       << " issued trans#s at NotaryID: " << tempNotaryID
+                       << "\n";
+                InsertGenericNums(m_mapIssuedNum, tempNotaryID, theNumbers);
             }
             else if (strNodeName.Compare("tentativeNums")) {
                 const String tempNotaryID = xml->getAttributeValue("notaryID");
@@ -3863,23 +3729,20 @@ bool Nym::LoadNymFromString(const String& strNym,
                              "tentativeNums field without value.\n";
                     return false; // error condition
                 }
-                NumList theNumList;
-
-                if (strTemp.Exists()) theNumList.Add(strTemp);
-
-                int64_t lTemp = 0;
-                while (theNumList.Peek(lTemp)) {
-                    theNumList.Pop();
-
-                    otLog3 << "Tentative: Currently awaiting success notice, "
-                              "for accepting trans# " << lTemp
-                           << " for NotaryID: " << tempNotaryID << "\n";
-                    AddTentativeNum(tempNotaryID, lTemp); // This version
-                                                          // doesn't save to
-                                                          // disk. (Why save to
-                                                          // disk AS WE'RE
-                                                          // LOADING?)
+                TransactionNumbers theNumbers;
+
+                if (strTemp.Exists() &&
+                    !theNumbers.Load(strTemp, number_limit_)) {
+                    otErr << __FUNCTION__ << ": Error: failed parsing numbers "
+                          << "for NotaryID: " << tempNotaryID << "\n";
+                    return false; // error condition
                 }
+
+                otLog3 << "Tentative: Currently awaiting success notice, "
+                          "for accepting " << theNumbers.size()
+                       << " trans#s for NotaryID: " << tempNotaryID << "\n";
+                InsertGenericNums(m_mapTentativeNum, tempNotaryID,
+                                  theNumbers);
             }
             else if (strNodeName.Compare("ackNums")) {
                 const String tempNotaryID = xml->getAttributeValue("notaryID");
@@ -3905,23 +3768,23 @@ bool Nym::LoadNymFromString(const String& strNym,
                              "that value.)\n";
                     return false; // error condition
                 }
-                NumList theNumList;
-
-                if (strTemp.Exists()) theNumList.Add(strTemp);
-
-                int64_t lTemp = 0;
-                while (theNumList.Peek(lTemp)) {
-                    theNumList.Pop();
-
-                    otInfo << "Acknowledgment record exists for server reply, "
-                              "for Request Number " << lTemp
-                           << " for NotaryID: " << tempNotaryID << "\n";
-                    AddAcknowledgedNum(tempNotaryID, lTemp); // This version
-                                                             // doesn't save to
-                                                             // disk. (Why save
-                                                             // to disk AS WE'RE
-                                                             // LOADING?)
+                TransactionNumbers theNumbers;
+
+                if (strTemp.Exists() &&
+                    !theNumbers.Load(strTemp, number_limit_)) {
+                    otErr << __FUNCTION__ << ": Error: failed parsing numbers "
+                          << "for NotaryID: " << tempNotaryID << "\n";
+                    return false; // error condition
                 }
+
+                otInfo << "Acknowledgment records exist for "
+                       << theNumbers.size() << " server replies for "
+                       << "NotaryID: " << tempNotaryID << "\n";
+                InsertGenericNums(m_mapAcknowledgedNum, tempNotaryID,
+                                  theNumbers);
+                // Same cap AddAcknowledgedNum keeps.
+                m_mapAcknowledgedNum[tempNotaryID.Get()]->TrimLowest(
+                    OT_MAX_ACK_NUMS);
             }
             else if (strNodeName.Compare("MARKED_FOR_DELETION")) {
                 m_bMarkForDeletion = true;
@@ -4110,6 +3973,45 @@ bool Nym::LoadNymFromString(const String& strNym,
 
 bool Nym::LoadSignedNymfile(Nym& SIGNER_NYM)
 {
+    return LoadSignedNymfile(SIGNER_NYM, &Nym::VerifySignedNymfile);
+}
+
+// We verify:
+//
+// 1. That the local subdir and filename match the versions inside the file.
+// 2. That the signature matches for the signer nym who was passed in.
+//
+bool Nym::VerifySignedNymfile(OTSignedFile& theNymfile, Nym& SIGNER_NYM)
+{
+    String strFilename;
+    theNymfile.GetFilename(strFilename);
+
+    if (!theNymfile.VerifyFile()) {
+        otErr << __FUNCTION__ << ": Nymfile doesn't match its location: "
+              << strFilename << "\n";
+
+        return false;
+    }
+
+    if (!theNymfile.VerifySignature(SIGNER_NYM)) {
+        String strSignerNymID;
+        SIGNER_NYM.GetIdentifier(strSignerNymID);
+        otErr << __FUNCTION__
+              << ": Failed verifying signature on nymfile: " << strFilename
+              << "\n Signer Nym ID: " << strSignerNymID << "\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+bool Nym::LoadSignedNymfile(Nym& SIGNER_NYM, const NymfileVerifier& verify)
+{
+    // Don't let a reload silently discard changes that are still waiting for
+    // a deferred save.
+    FlushDeferredSave();
+
     // Get the Nym's ID in string form
     String nymID;
     GetIdentifier(nymID);
@@ -4122,27 +4024,13 @@ bool Nym::LoadSignedNymfile(Nym& SIGNER_NYM)
         otWarn << __FUNCTION__ << ": Failed loading a signed nymfile: " << nymID
                << "\n\n";
     }
-    // We verify:
-    //
-    // 1. That the file even exists and loads.
-    // 2. That the local subdir and filename match the versions inside the file.
-    // 3. That the signature matches for the signer nym who was passed in.
-    //
-    else if (!theNymfile.VerifyFile()) {
+    // NOTE: Pass a verifier which always succeeds if you want to load a Nym
+    // without having to verify his information. (For development reasons.
+    // Never do that normally.)
+    else if (!verify(theNymfile, SIGNER_NYM)) {
         otErr << __FUNCTION__ << ": Failed verifying nymfile: " << nymID
               << "\n\n";
     }
-    else if (!theNymfile.VerifySignature(SIGNER_NYM)) {
-        String strSignerNymID;
-        SIGNER_NYM.GetIdentifier(strSignerNymID);
-        otErr << __FUNCTION__
-              << ": Failed verifying signature on nymfile: " << nymID
-              << "\n Signer Nym ID: " << strSignerNymID << "\n";
-    }
-    // NOTE: Comment out the above two blocks if you want to load a Nym without
-    // having
-    // to verify his information. (For development reasons. Never do that
-    // normally.)
     else {
         otInfo
             << "Loaded and verified signed nymfile. Reading from string...\n";
@@ -4163,6 +4051,115 @@ bool Nym::LoadSignedNymfile(Nym& SIGNER_NYM)
 }
 
 bool Nym::SaveSignedNymfile(Nym& SIGNER_NYM)
+{
+    std::lock_guard<std::recursive_mutex> lock(deferred_lock_);
+    auto it = deferred_saves_.find(String(m_nymID).Get());
+
+    if (deferred_saves_.end() == it) return WriteSignedNymfile(SIGNER_NYM);
+
+    DeferredSave& save = it->second;
+
+    if (save.nym_ != this) {
+        // Another copy of this Nym is saving. Write what the deferred copy
+        // has first, so the two land in the order they were made.
+        if (!WriteDeferredSave(save)) return false;
+
+        return WriteSignedNymfile(SIGNER_NYM);
+    }
+
+    // Only one signer can be held back. If this save is signed by someone
+    // else, write out what we have under the previous signer first.
+    if ((nullptr != save.signer_) && (save.signer_ != &SIGNER_NYM) &&
+        !WriteDeferredSave(save))
+        return false;
+
+    save.signer_ = &SIGNER_NYM;
+
+    return true;
+}
+
+void Nym::BeginDeferredSave()
+{
+    std::lock_guard<std::recursive_mutex> lock(deferred_lock_);
+    DeferredSave& save = deferred_saves_[String(m_nymID).Get()];
+
+    if (nullptr == save.nym_) save.nym_ = this;
+
+    ++save.depth_;
+}
+
+bool Nym::EndDeferredSave()
+{
+    std::lock_guard<std::recursive_mutex> lock(deferred_lock_);
+    auto it = deferred_saves_.find(String(m_nymID).Get());
+
+    OT_ASSERT(deferred_saves_.end() != it);
+    OT_ASSERT(0 < it->second.depth_);
+
+    if (0 < --it->second.depth_) return true;
+
+    const bool bWritten = WriteDeferredSave(it->second);
+
+    if (!bWritten) {
+        otErr << __FUNCTION__ << ": Failed to save nymfile for "
+              << String(m_nymID) << ". Changes since the last save are lost.\n";
+    }
+
+    deferred_saves_.erase(it);
+
+    return bWritten;
+}
+
+bool Nym::FlushDeferredSave()
+{
+    std::lock_guard<std::recursive_mutex> lock(deferred_lock_);
+    auto it = deferred_saves_.find(String(m_nymID).Get());
+
+    if (deferred_saves_.end() == it) return true;
+
+    return WriteDeferredSave(it->second);
+}
+
+bool Nym::HasDeferredSave() const
+{
+    std::lock_guard<std::recursive_mutex> lock(deferred_lock_);
+    auto it = deferred_saves_.find(String(m_nymID).Get());
+
+    return (deferred_saves_.end() != it) && (nullptr != it->second.signer_);
+}
+
+// static
+bool Nym::FlushDeferredSaves()
+{
+    std::lock_guard<std::recursive_mutex> lock(deferred_lock_);
+    bool bSuccess = true;
+
+    for (auto& it : deferred_saves_) {
+        if (!WriteDeferredSave(it.second)) bSuccess = false;
+    }
+
+    return bSuccess;
+}
+
+// static
+bool Nym::WriteDeferredSave(DeferredSave& save)
+{
+    if (nullptr == save.signer_) return true;
+
+    if (nullptr == save.nym_) return false;
+
+    Nym* pSigner = save.signer_;
+    save.signer_ = nullptr;
+
+    if (save.nym_->WriteSignedNymfile(*pSigner)) return true;
+
+    // Still dirty. A later flush (or the end of the scope) will try again.
+    save.signer_ = pSigner;
+
+    return false;
+}
+
+bool Nym::WriteSignedNymfile(Nym& SIGNER_NYM)
 {
     // Get the Nym's ID in string form
     String strNymID;
@@ -4177,7 +4174,7 @@ bool Nym::SaveSignedNymfile(Nym& SIGNER_NYM)
 
     // First we save this nym to a string...
     // Specifically, the file payload string on the OTSignedFile object.
-    SavePseudonym(theNymfile.GetFilePayload());
+    SavePseudonym(theNymfile.GetFilePayload(), true);
 
     // Now the OTSignedFile contains the path, the filename, AND the
     // contents of the Nym itself, saved to a string inside the OTSignedFile
@@ -4222,12 +4219,12 @@ bool Nym::VerifyIssuedNumbersOnNym(Nym& THE_NYM)
     // numbers total he has...
     //
     for (auto& it : GetMapIssuedNum()) {
-        dequeOfTransNums* pDeque = (it.second);
-        OT_ASSERT(nullptr != pDeque);
+        TransactionNumbers* pNumbers = (it.second);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             nNumberOfTransactionNumbers1 +=
-                static_cast<int32_t>(pDeque->size());
+                static_cast<int32_t>(pNumbers->size());
         }
     } // for
 
@@ -4237,14 +4234,14 @@ bool Nym::VerifyIssuedNumbersOnNym(Nym& THE_NYM)
     //
     for (auto& it : THE_NYM.GetMapIssuedNum()) {
         strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-        OT_ASSERT(nullptr != pDeque);
+        TransactionNumbers* pNumbers = it.second;
+        OT_ASSERT(nullptr != pNumbers);
 
         String OTstrNotaryID = strNotaryID.c_str();
 
-        if (!(pDeque->empty())) {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+        if (!(pNumbers->empty())) {
+            for (const int64_t number : *pNumbers) {
+                lTransactionNumber = number;
 
                 //                if ()
                 {
@@ -4308,15 +4305,15 @@ bool Nym::VerifyTransactionStatementNumbersOnNym(Nym& THE_NYM) // THE_NYM is
     //
     for (auto& it : GetMapIssuedNum()) {
         strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        TransactionNumbers* pNumbers = it.second;
 
         String OTstrNotaryID = strNotaryID.c_str();
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+        if (!(pNumbers->empty())) {
+            for (const int64_t number : *pNumbers) {
+                lTransactionNumber = number;
 
                 if (false ==
                     THE_NYM.VerifyIssuedNum(OTstrNotaryID,
@@ -4598,7 +4595,7 @@ Nym::Nym(const NymParameters& nymParameters)
 
 void Nym::Initialize()
 {
-    m_strVersion = "1.0";
+    m_strVersion = NYMFILE_VERSION_LIST;
 }
 
 Nym::Nym(const String& name, const String& filename, const String& nymID)
@@ -4687,6 +4684,21 @@ void Nym::ClearAll()
 
 Nym::~Nym()
 {
+    {
+        std::lock_guard<std::recursive_mutex> lock(deferred_lock_);
+        auto it = deferred_saves_.find(String(m_nymID).Get());
+
+        if ((deferred_saves_.end() != it) && (this == it->second.nym_)) {
+            if (nullptr != it->second.signer_) {
+                otErr << __FUNCTION__ << ": Destroying Nym " << String(m_nymID)
+                      << " with a deferred nymfile save still pending. "
+                         "Changes since the last save are lost.\n";
+            }
+
+            it->second.nym_ = nullptr;
+            it->second.signer_ = nullptr;
+        }
+    }
 
     ClearAll();
     ClearCredentials();
@@ -4694,6 +4706,9 @@ Nym::~Nym()
 
 bool Nym::WriteCredentials() const
 {
+    // One root update for the list and every credential in it
+    Storage::Batch batch(App::Me().DB());
+
     if (!SaveCredentialIDs()) {
         otErr << __FUNCTION__ << ": Failed to save credential lists.\n";
         return false;
@@ -4706,6 +4721,11 @@ bool Nym::WriteCredentials() const
         }
     }
 
+    if (!batch.Commit()) {
+        otErr << __FUNCTION__ << ": Failed to store credentials.\n";
+        return false;
+    }
+
     return true;
 }
 
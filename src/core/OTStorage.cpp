@@ -46,6 +46,7 @@
 #include <opentxs/core/OTData.hpp>
 #include <opentxs/core/OTStoragePB.hpp>
 
+#include <cstdio>
 #include <sstream>
 #include <fstream>
 #include <typeinfo>
@@ -2712,18 +2713,34 @@ bool StorageFS::onStorePlainString(std::string& theBuffer,
     // In a key/value database, szFilename is the "key" and strFinal.Get() is
     // the "value".
     //
-    std::ofstream ofs(strOutput.c_str(), std::ios::out | std::ios::binary);
+    // The new contents are written next to the target and then renamed over
+    // it, so a crash mid-write leaves the previous version intact instead of a
+    // truncated file. (Nymfiles in particular are now written once per
+    // request, so a torn write would lose everything that request did.)
+    //
+    // Each write gets its own temp file, so concurrent writers of the same
+    // target can't interleave their contents, and the temp file is synced
+    // before the rename so the rename can't expose an unwritten file.
+    //
+    const String strTemp = OTPaths::TempPath(String(strOutput.c_str()));
+    std::ofstream ofs(strTemp.Get(), std::ios::out | std::ios::binary);
 
     if (ofs.fail()) {
-        otErr << __FUNCTION__ << ": Error opening file: " << strOutput << "\n";
+        otErr << __FUNCTION__ << ": Error opening file: " << strTemp << "\n";
         return false;
     }
 
     ofs.clear();
     ofs << theBuffer;
+    ofs.flush();
     bool bSuccess = ofs.good();
     ofs.close();
 
+    bSuccess = bSuccess && !ofs.fail() && OTPaths::SyncPath(strTemp) &&
+               OTPaths::ReplaceFile(strTemp, String(strOutput.c_str()));
+
+    if (!bSuccess) std::remove(strTemp.Get());
+
     // TODO: Remove the .lock file.
 
     return bSuccess;
@@ -1641,6 +1641,7 @@ bool OTTransaction::VerifyBalanceReceipt(
     // LOAD MESSAGE NYM (THE LIST OF ISSUED NUMBERS ACCORDING TO THE RECEIPT.)
 
     Nym theMessageNym;
+    theMessageNym.LimitNumbersTo(THE_NYM);
     String strMessageNym; // Okay now we have the transaction numbers in this
                           // MessageNym string.
 
@@ -3122,6 +3123,9 @@ OTTransaction::OTTransaction()
     , m_lRequestNumber(0)
     , m_bReplyTransSuccess(false)
     , m_bCancelled(false)
+    , m_bReceiptKeyLoaded(false)
+    , m_lReceiptKey(0)
+    , m_pReceiptIndex(nullptr)
 {
     InitTransaction();
 }
@@ -3147,6 +3151,9 @@ OTTransaction::OTTransaction(const Ledger& theOwner)
     , m_lRequestNumber(0)
     , m_bReplyTransSuccess(false)
     , m_bCancelled(false)
+    , m_bReceiptKeyLoaded(false)
+    , m_lReceiptKey(0)
+    , m_pReceiptIndex(nullptr)
 {
     InitTransaction();
 }
@@ -3176,6 +3183,9 @@ OTTransaction::OTTransaction(const Identifier& theNymID,
     , m_lRequestNumber(0)
     , m_bReplyTransSuccess(false)
     , m_bCancelled(false)
+    , m_bReceiptKeyLoaded(false)
+    , m_lReceiptKey(0)
+    , m_pReceiptIndex(nullptr)
 {
     InitTransaction();
 
@@ -3201,6 +3211,9 @@ OTTransaction::OTTransaction(const Identifier& theNymID,
     , m_lRequestNumber(0)
     , m_bReplyTransSuccess(false)
     , m_bCancelled(false)
+    , m_bReceiptKeyLoaded(false)
+    , m_lReceiptKey(0)
+    , m_pReceiptIndex(nullptr)
 {
     InitTransaction();
 
@@ -3253,6 +3266,9 @@ OTTransaction::OTTransaction(
     , m_lRequestNumber(lRequestNum)
     , m_bReplyTransSuccess(bReplyTransSuccess)
     , m_bCancelled(false)
+    , m_bReceiptKeyLoaded(false)
+    , m_lReceiptKey(0)
+    , m_pReceiptIndex(nullptr)
 {
     InitTransaction();
 
@@ -3392,9 +3408,122 @@ void OTTransaction::Release()
         delete pItem;
     }
 
+    ResetReceiptKey();
+
     OTTransactionType::Release();
 }
 
+void OTTransaction::ResetReceiptKey()
+{
+    // The ledger looks up its index entry by the old key, so tell it before
+    // that key is forgotten.
+    if (nullptr != m_pReceiptIndex) m_pReceiptIndex->ReindexReceiptKey(*this);
+
+    m_bReceiptKeyLoaded = false;
+    m_lReceiptKey = 0;
+}
+
+void OTTransaction::SetReferenceString(const String& theStr)
+{
+    OTTransactionType::SetReferenceString(theStr);
+
+    ResetReceiptKey();
+}
+
+int64_t OTTransaction::GetReceiptKey()
+{
+    if (m_bReceiptKeyLoaded) return m_lReceiptKey;
+
+    m_lReceiptKey = 0;
+
+    switch (GetType()) {
+    case transferReceipt: {
+        String strReference;
+        GetReferenceString(strReference);
+
+        std::unique_ptr<Item> pOriginalItem(Item::CreateItemFromString(
+            strReference, GetPurportedNotaryID(), GetReferenceToNum()));
+
+        if (nullptr == pOriginalItem)
+            otErr << __FUNCTION__ << ": Failed loading the acceptPending item "
+                                     "from transferReceipt "
+                  << GetTransactionNum() << ".\n";
+        else if (Item::acceptPending != pOriginalItem->GetType())
+            otErr << __FUNCTION__
+                  << ": Wrong item type attached to transferReceipt "
+                  << GetTransactionNum() << ".\n";
+        else
+            m_lReceiptKey = pOriginalItem->GetNumberOfOrigin();
+    } break;
+
+    case chequeReceipt:
+    case voucherReceipt: {
+        std::unique_ptr<Cheque> pCheque(LoadReferencedCheque());
+
+        if (nullptr != pCheque) m_lReceiptKey = pCheque->GetTransactionNum();
+    } break;
+
+    default:
+        break;
+    }
+
+    m_bReceiptKeyLoaded = true;
+
+    return m_lReceiptKey;
+}
+
+Cheque* OTTransaction::LoadReferencedCheque()
+{
+    if ((chequeReceipt != GetType()) && (voucherReceipt != GetType()))
+        return nullptr;
+
+    String strDepositChequeMsg;
+    GetReferenceString(strDepositChequeMsg);
+
+    std::unique_ptr<Item> pOriginalItem(Item::CreateItemFromString(
+        strDepositChequeMsg, GetPurportedNotaryID(), GetReferenceToNum()));
+
+    if (nullptr == pOriginalItem) {
+        otErr << __FUNCTION__
+              << ": Expected original depositCheque request item to be "
+                 "inside the chequeReceipt "
+                 "(but failed to load it...)\n";
+        return nullptr;
+    }
+
+    if (Item::depositCheque != pOriginalItem->GetType()) {
+        String strItemType;
+        pOriginalItem->GetTypeString(strItemType);
+        otErr << __FUNCTION__
+              << ": Expected original depositCheque request item to be "
+                 "inside the chequeReceipt, "
+                 "but somehow what we found instead was a " << strItemType
+              << "...\n";
+        return nullptr;
+    }
+
+    // Get the cheque from the Item and load it up into a Cheque object.
+    //
+    String strCheque;
+    pOriginalItem->GetAttachment(strCheque);
+
+    std::unique_ptr<Cheque> pCheque(new Cheque);
+
+    if (!((strCheque.GetLength() > 2) &&
+          pCheque->LoadContractFromString(strCheque))) {
+        otErr << __FUNCTION__ << ": Error loading cheque from string:\n"
+              << strCheque << "\n";
+        return nullptr;
+    }
+
+    // The cheque number is this receipt's key, so there's no need to load
+    // the cheque again for GetReceiptKey.
+    m_lReceiptKey = pCheque->GetTransactionNum();
+    m_bReceiptKeyLoaded = true;
+
+    return pCheque.release();
+}
+
 // You have to allocate the item on the heap and then pass it in as a reference.
 // OTTransaction will take care of it from there and will delete it in
 // destructor.
@@ -4221,6 +4350,8 @@ int32_t OTTransaction::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
             return (-1); // error condition
         }
 
+        ResetReceiptKey();
+
         return 1;
     }
     else if (!strcmp("item", xml->getNodeName())) {
@@ -0,0 +1,424 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/core/stdafx.hpp>
+
+#include <opentxs/core/TransactionNumbers.hpp>
+
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/String.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace opentxs
+{
+
+namespace
+{
+
+// The count of numbers from first to last. Unsigned arithmetic, so that it
+// can't overflow for any first <= last short of the full int64_t span.
+std::size_t RangeLength(int64_t first, int64_t last)
+{
+    return static_cast<std::size_t>(static_cast<uint64_t>(last) -
+                                    static_cast<uint64_t>(first)) +
+           1;
+}
+
+} // namespace
+
+TransactionNumbers::const_iterator::const_iterator(
+    Ranges::const_iterator range, Ranges::const_iterator end)
+    : range_(range)
+    , end_(end)
+    , value_((range == end) ? 0 : range->first)
+{
+}
+
+TransactionNumbers::const_iterator& TransactionNumbers::const_iterator::
+operator++()
+{
+    if (value_ < range_->second) {
+        ++value_;
+    } else {
+        ++range_;
+        value_ = (range_ == end_) ? 0 : range_->first;
+    }
+
+    return *this;
+}
+
+TransactionNumbers::const_iterator TransactionNumbers::const_iterator::
+operator++(int)
+{
+    const_iterator output(*this);
+    ++(*this);
+
+    return output;
+}
+
+bool TransactionNumbers::const_iterator::operator==(
+    const const_iterator& rhs) const
+{
+    return (range_ == rhs.range_) && (value_ == rhs.value_);
+}
+
+TransactionNumbers::TransactionNumbers()
+    : size_(0)
+{
+}
+
+TransactionNumbers::Ranges::iterator TransactionNumbers::Find(
+    const int64_t& value)
+{
+    auto it = ranges_.upper_bound(value);
+
+    if (ranges_.begin() == it) {
+        return ranges_.end();
+    }
+
+    --it;
+
+    return (value <= it->second) ? it : ranges_.end();
+}
+
+TransactionNumbers::Ranges::const_iterator TransactionNumbers::Find(
+    const int64_t& value) const
+{
+    auto it = ranges_.upper_bound(value);
+
+    if (ranges_.begin() == it) {
+        return ranges_.end();
+    }
+
+    --it;
+
+    return (value <= it->second) ? it : ranges_.end();
+}
+
+bool TransactionNumbers::Contains(const int64_t& value) const
+{
+    return ranges_.end() != Find(value);
+}
+
+bool TransactionNumbers::Add(const int64_t& value)
+{
+    auto next = ranges_.upper_bound(value);
+    auto previous = ranges_.end();
+
+    if (ranges_.begin() != next) {
+        previous = next;
+        --previous;
+
+        if (value <= previous->second) {
+            return false; // already there.
+        }
+    }
+
+    // Since value isn't in previous, previous->second + 1 can't overflow.
+    // And if value is the highest possible number, there is no next.
+    const bool joinPrevious =
+        (ranges_.end() != previous) && (previous->second + 1 == value);
+    const bool joinNext = (ranges_.end() != next) && (next->first - 1 == value);
+
+    if (joinPrevious && joinNext) {
+        previous->second = next->second;
+        ranges_.erase(next);
+    } else if (joinPrevious) {
+        previous->second = value;
+    } else if (joinNext) {
+        const int64_t last = next->second;
+        ranges_.erase(next);
+        ranges_[value] = last;
+    } else {
+        ranges_[value] = value;
+    }
+
+    ++size_;
+
+    return true;
+}
+
+bool TransactionNumbers::Remove(const int64_t& value)
+{
+    auto it = Find(value);
+
+    if (ranges_.end() == it) {
+        return false;
+    }
+
+    const int64_t first = it->first;
+    const int64_t last = it->second;
+
+    if (first == value) {
+        ranges_.erase(it);
+
+        if (value < last) {
+            ranges_[value + 1] = last;
+        }
+    } else {
+        it->second = value - 1;
+
+        if (value < last) {
+            ranges_[value + 1] = last;
+        }
+    }
+
+    --size_;
+
+    return true;
+}
+
+bool TransactionNumbers::Insert(int64_t first, int64_t last)
+{
+    if (last < first) {
+        return false;
+    }
+
+    auto it = ranges_.upper_bound(first);
+
+    if (ranges_.begin() != it) {
+        auto previous = it;
+        --previous;
+
+        // Overlapping or adjacent. (If previous->second is INT64_MAX, the
+        // first test is already true.)
+        if ((previous->second >= first) || (previous->second + 1 == first)) {
+            it = previous;
+        }
+    }
+
+    while ((ranges_.end() != it) &&
+           ((INT64_MAX == last) || (it->first <= last + 1))) {
+        size_ -= RangeLength(it->first, it->second);
+        first = std::min(first, it->first);
+        last = std::max(last, it->second);
+        it = ranges_.erase(it);
+    }
+
+    ranges_[first] = last;
+    size_ += RangeLength(first, last);
+
+    return true;
+}
+
+void TransactionNumbers::Insert(const TransactionNumbers& rhs)
+{
+    for (auto& it : rhs.ranges_) {
+        Insert(it.first, it.second);
+    }
+}
+
+void TransactionNumbers::TrimLowest(std::size_t count)
+{
+    while (size_ > count) {
+        auto it = ranges_.begin();
+        const std::size_t length = RangeLength(it->first, it->second);
+        const std::size_t excess = size_ - count;
+
+        if (length <= excess) {
+            ranges_.erase(it);
+            size_ -= length;
+        } else {
+            const int64_t last = it->second;
+            ranges_.erase(it);
+            ranges_[last - static_cast<int64_t>(length - excess) + 1] = last;
+            size_ -= excess;
+        }
+    }
+}
+
+void TransactionNumbers::clear()
+{
+    ranges_.clear();
+    size_ = 0;
+}
+
+int64_t TransactionNumbers::Lowest() const
+{
+    OT_ASSERT(!ranges_.empty());
+
+    return ranges_.begin()->first;
+}
+
+int64_t TransactionNumbers::Highest() const
+{
+    OT_ASSERT(!ranges_.empty());
+
+    return ranges_.rbegin()->second;
+}
+
+int64_t TransactionNumbers::at(std::size_t index) const
+{
+    OT_ASSERT(index < size_);
+
+    for (auto& it : ranges_) {
+        const std::size_t length = RangeLength(it.first, it.second);
+
+        if (index < length) {
+            return it.first + static_cast<int64_t>(index);
+        }
+
+        index -= length;
+    }
+
+    OT_FAIL;
+
+    return 0;
+}
+
+TransactionNumbers::const_iterator TransactionNumbers::begin() const
+{
+    return const_iterator(ranges_.begin(), ranges_.end());
+}
+
+TransactionNumbers::const_iterator TransactionNumbers::end() const
+{
+    return const_iterator(ranges_.end(), ranges_.end());
+}
+
+bool TransactionNumbers::Output(String& strOutput, bool bRanges) const
+{
+    if (ranges_.empty()) {
+        return false;
+    }
+
+    std::ostringstream output;
+
+    if (bRanges) {
+        for (auto it = ranges_.begin(); it != ranges_.end(); ++it) {
+            if (ranges_.begin() != it) {
+                output << ",";
+            }
+
+            output << it->first;
+
+            if (it->first != it->second) {
+                output << "-" << it->second;
+            }
+        }
+    } else {
+        for (auto it = begin(); it != end(); ++it) {
+            if (begin() != it) {
+                output << ",";
+            }
+
+            output << *it;
+        }
+    }
+
+    strOutput.Set(output.str().c_str());
+
+    return true;
+}
+
+bool TransactionNumbers::Load(const String& strInput, std::size_t nLimit)
+{
+    std::istringstream input(strInput.Get());
+    std::string token;
+    std::vector<std::pair<int64_t, int64_t>> loaded;
+    std::size_t total = 0;
+
+    // Parse everything first, so nothing is added unless all of it is valid.
+    while (std::getline(input, token, ',')) {
+        const auto begin = token.find_first_not_of(" \t\r\n");
+
+        if (std::string::npos == begin) {
+            continue;
+        }
+
+        const auto end = token.find_last_not_of(" \t\r\n");
+        token = token.substr(begin, end - begin + 1);
+        const auto dash = token.find('-');
+        char* stop = nullptr;
+        errno = 0;
+        const int64_t first = std::strtoll(token.c_str(), &stop, 10);
+        int64_t last = first;
+
+        if ((0 > first) || (stop == token.c_str()) || (ERANGE == errno)) {
+            return false;
+        }
+
+        if (std::string::npos == dash) {
+            if ('\0' != *stop) {
+                return false;
+            }
+        } else {
+            if (stop != token.c_str() + dash) {
+                return false;
+            }
+
+            last = std::strtoll(token.c_str() + dash + 1, &stop, 10);
+
+            if (('\0' != *stop) || (last < first) || (ERANGE == errno)) {
+                return false;
+            }
+        }
+
+        // Overlapping entries are counted twice, which only errs on the side
+        // of rejecting.
+        if (0 < nLimit) {
+            const std::size_t length = RangeLength(first, last);
+
+            if (length > nLimit - total) {
+                otErr << __FUNCTION__ << ": Input lists more than " << nLimit
+                      << " numbers.\n";
+
+                return false;
+            }
+
+            total += length;
+        }
+
+        loaded.push_back(std::make_pair(first, last));
+    }
+
+    for (auto& it : loaded) {
+        Insert(it.first, it.second);
+    }
+
+    return true;
+}
+
+} // namespace opentxs
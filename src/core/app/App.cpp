@@ -47,6 +47,7 @@
 #include <opentxs/core/OTStorage.hpp>
 #include <opentxs/core/String.hpp>
 #include <opentxs/core/app/Settings.hpp>
+#include <opentxs/core/crypto/OTASCIIArmor.hpp>
 #include <opentxs/core/util/OTDataFolder.hpp>
 #include <opentxs/core/util/OTFolders.hpp>
 
@@ -78,6 +79,40 @@ void App::Init_Config()
     String strConfigFilePath;
     OTDataFolder::GetConfigFilePath(strConfigFilePath);
     config_ = new Settings(strConfigFilePath);
+
+    bool notUsed;
+    int64_t armorCodec = OTASCIIArmor::CODEC_ZLIB;
+    int64_t armorLevel = 9;
+    int64_t armorUncompressedBelow = 0;
+    Config().CheckSet_long(
+        "armor", "codec",
+        armorCodec, armorCodec, notUsed,
+        "0 = zlib, 1 = stored, 2 = lz4 (1 and 2 are not readable by "
+        "older versions, 2 needs a build with LZ4 support)");
+    Config().CheckSet_long(
+        "armor", "compression_level",
+        armorLevel, armorLevel, notUsed);
+    Config().CheckSet_long(
+        "armor", "uncompressed_below",
+        armorUncompressedBelow, armorUncompressedBelow, notUsed);
+
+    OTASCIIArmor::Codec codec = OTASCIIArmor::CODEC_ZLIB;
+
+    switch (armorCodec) {
+    case OTASCIIArmor::CODEC_STORED:
+        codec = OTASCIIArmor::CODEC_STORED;
+        break;
+    case OTASCIIArmor::CODEC_LZ4:
+        codec = OTASCIIArmor::CODEC_LZ4;
+        break;
+    default:
+        break;
+    }
+
+    OTASCIIArmor::SetCompression(
+        codec,
+        static_cast<int32_t>(armorLevel),
+        static_cast<uint32_t>(armorUncompressedBelow));
 }
 
 void App::Init_Contracts()
@@ -136,9 +171,22 @@ void App::Init_Storage()
     Config().CheckSet_long(
         "storage", "gc_interval",
         config.gc_interval_, config.gc_interval_, notUsed);
+    Config().CheckSet_long(
+        "storage", "gc_threads",
+        config.gc_threads_, config.gc_threads_, notUsed);
+    Config().CheckSet_long(
+        "storage", "gc_max_keys_per_second",
+        config.gc_max_keys_per_second_, config.gc_max_keys_per_second_,
+        notUsed);
+    Config().CheckSet_long(
+        "storage", "cache_size",
+        config.cache_size_, config.cache_size_, notUsed);
     Config().CheckSet_str(
         "storage", "path",
         config.path_, config.path_, notUsed);
+    Config().CheckSet_str(
+        "storage", "backend",
+        config.backend_, config.backend_, notUsed);
 #ifdef OT_STORAGE_FS
     Config().CheckSet_str(
         "storage", "fs_primary",
@@ -166,6 +214,29 @@ void App::Init_Storage()
     Config().CheckSet_str(
         "storage", "sqlite3_db_file",
         config.sqlite3_db_file_, config.sqlite3_db_file_, notUsed);
+    Config().CheckSet_str(
+        "storage", "sqlite3_journal_mode",
+        config.sqlite3_journal_mode_, config.sqlite3_journal_mode_, notUsed);
+    Config().CheckSet_str(
+        "storage", "sqlite3_synchronous",
+        config.sqlite3_synchronous_, config.sqlite3_synchronous_, notUsed);
+#endif
+#ifdef OT_STORAGE_LMDB
+    Config().CheckSet_str(
+        "storage", "lmdb_primary",
+        config.lmdb_primary_bucket_, config.lmdb_primary_bucket_, notUsed);
+    Config().CheckSet_str(
+        "storage", "lmdb_secondary",
+        config.lmdb_secondary_bucket_, config.lmdb_secondary_bucket_, notUsed);
+    Config().CheckSet_str(
+        "storage", "lmdb_control",
+        config.lmdb_control_table_, config.lmdb_control_table_, notUsed);
+    Config().CheckSet_str(
+        "storage", "lmdb_root_key",
+        config.lmdb_root_key_, config.lmdb_root_key_, notUsed);
+    Config().CheckSet_long(
+        "storage", "lmdb_map_size",
+        config.lmdb_map_size_, config.lmdb_map_size_, notUsed);
 #endif
 
     if (nullptr != dht_) {
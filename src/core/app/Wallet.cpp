@@ -50,55 +50,48 @@ ConstNym Wallet::Nym(
     const std::chrono::milliseconds& timeout)
 {
     const std::string nym = String(id).Get();
-    std::unique_lock<std::mutex> mapLock(nym_map_lock_);
-    bool inMap = (nym_map_.find(nym) != nym_map_.end());
-    bool valid = false;
 
-    if (!inMap) {
+    auto pNym = nym_map_.Get(nym, [&]() -> std::shared_ptr<class Nym> {
         std::shared_ptr<proto::CredentialIndex> serialized;
-
         std::string alias;
-        bool loaded = App::Me().DB().Load(nym, serialized, alias, true);
-
-        if (loaded) {
-            auto& pNym = nym_map_[nym].second;
-            pNym.reset(new class Nym(id));
-            if (pNym) {
-                if (pNym->LoadCredentialIndex(*serialized)) {
-                    valid = pNym->VerifyPseudonym();
-                    pNym->SetAlias(alias);
-                }
-            }
-        } else {
-            App::Me().DHT().GetPublicNym(nym);
 
-            if (timeout > std::chrono::milliseconds(0)) {
-                mapLock.unlock();
-                auto start = std::chrono::high_resolution_clock::now();
-                auto end = start + timeout;
-                const auto interval = std::chrono::milliseconds(100);
+        if (!App::Me().DB().Load(nym, serialized, alias, true)) {
 
-                while (std::chrono::high_resolution_clock::now() < end) {
-                    std::this_thread::sleep_for(interval);
-                    mapLock.lock();
-                    bool found = (nym_map_.find(nym) != nym_map_.end());
-                    mapLock.unlock();
+            return nullptr;
+        }
 
-                    if (found) { break; }
-                }
+        std::shared_ptr<class Nym> loaded(new class Nym(id));
 
-                return Nym(id); // timeout of zero prevents infinite recursion
-            }
+        if (loaded->LoadCredentialIndex(*serialized)) {
+            loaded->SetAlias(alias);
         }
-    } else {
-        auto& pNym = nym_map_[nym].second;
-        if (pNym) {
-            valid = pNym->VerifyPseudonym();
+
+        // Verified once per load, before any other thread can see it. Only
+        // verified nyms are kept in the map.
+        if (!VerifyNym(*loaded)) {
+
+            return nullptr;
         }
-    }
 
-    if (valid) {
-        return nym_map_[nym].second;
+        return loaded;
+    });
+
+    if (pNym) { return pNym; }
+
+    App::Me().DHT().GetPublicNym(nym);
+
+    if (timeout > std::chrono::milliseconds(0)) {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto end = start + timeout;
+        const auto interval = std::chrono::milliseconds(100);
+
+        while (std::chrono::high_resolution_clock::now() < end) {
+            std::this_thread::sleep_for(interval);
+
+            if (nym_map_.Exists(nym)) { break; }
+        }
+
+        return Nym(id); // timeout of zero prevents infinite recursion
     }
 
     return nullptr;
@@ -125,26 +118,57 @@ ConstNym Wallet::Nym(
     if (candidate) {
         candidate->LoadCredentialIndex(publicNym);
 
-        if (candidate->VerifyPseudonym()) {
+        if (VerifyNym(*candidate)) {
+            Storage::Batch batch(App::Me().DB());
             candidate->WriteCredentials();
             candidate->SaveCredentialIDs();
             SetNymAlias(nym, candidate->Alias());
-            std::unique_lock<std::mutex> mapLock(nym_map_lock_);
-            nym_map_[nym].second.reset(candidate.release());
-            mapLock.unlock();
+
+            if (batch.Commit()) {
+                nym_map_.Set(
+                    nym, std::shared_ptr<class Nym>(candidate.release()));
+            }
         }
     }
 
     return Nym(nym);
 }
 
+std::uint64_t Wallet::NymVerifications() const
+{
+    return nym_verifications_.load();
+}
+
+bool Wallet::VerifyNym(const class Nym& nym)
+{
+    const std::string id = String(nym.ID()).Get();
+    const std::string hash = String(nym.CredentialIndexHash()).Get();
+
+    std::unique_lock<std::mutex> verifiedLock(nym_verified_lock_);
+    auto it = nym_verified_.find(id);
+
+    if ((nym_verified_.end() != it) && (hash == it->second.first)) {
+
+        return it->second.second;
+    }
+
+    verifiedLock.unlock();
+
+    const bool valid = nym.VerifyPseudonym();
+    nym_verifications_++;
+
+    verifiedLock.lock();
+    nym_verified_[id] = std::make_pair(hash, valid);
+    verifiedLock.unlock();
+
+    return valid;
+}
+
 bool Wallet::RemoveServer(const Identifier& id)
 {
     std::string server(String(id).Get());
-    std::unique_lock<std::mutex> mapLock(server_map_lock_);
-    auto deleted = server_map_.erase(server);
 
-    if (0 != deleted) {
+    if (server_map_.Erase(server)) {
         return App::Me().DB().RemoveServer(server);
     }
 
@@ -154,10 +178,8 @@ bool Wallet::RemoveServer(const Identifier& id)
 bool Wallet::RemoveUnitDefinition(const Identifier& id)
 {
     std::string unit(String(id).Get());
-    std::unique_lock<std::mutex> mapLock(unit_map_lock_);
-    auto deleted = unit_map_.erase(unit);
 
-    if (0 != deleted) {
+    if (unit_map_.Erase(unit)) {
         return App::Me().DB().RemoveUnitDefinition(unit);
     }
 
@@ -170,63 +192,69 @@ ConstServerContract Wallet::Server(
 {
     const String strID(id);
     const std::string server = strID.Get();
-    std::unique_lock<std::mutex> mapLock(server_map_lock_);
-    bool inMap = (server_map_.find(server) != server_map_.end());
-    bool valid = false;
+    bool loaded = false;
 
-    if (!inMap) {
-        std::shared_ptr<proto::ServerContract> serialized;
+    auto pServer = server_map_.Get(
+        server, [&]() -> std::shared_ptr<class ServerContract> {
+            std::shared_ptr<proto::ServerContract> serialized;
+            std::string alias;
+            loaded = App::Me().DB().Load(server, serialized, alias, true);
 
-        std::string alias;
-        bool loaded = App::Me().DB().Load(server, serialized, alias, true);
+            if (!loaded) {
+
+                return nullptr;
+            }
 
-        if (loaded) {
             auto nym = Nym(serialized->nymid());
 
             if (!nym && serialized->has_publicnym()) {
                 nym = Nym(serialized->publicnym());
             }
 
-            if (nym) {
-                auto& pServer = server_map_[server];
-                pServer.reset(
-                    ServerContract::Factory(nym, *serialized));
+            if (!nym) {
 
-                if (pServer) {
-                    valid = true; // Factory() performs validation
-                    pServer->SetAlias(alias);
-                }
+                return nullptr;
             }
-        } else {
-            App::Me().DHT().GetServerContract(server);
 
-            if (timeout > std::chrono::milliseconds(0)) {
-                mapLock.unlock();
-                auto start = std::chrono::high_resolution_clock::now();
-                auto end = start + timeout;
-                const auto interval = std::chrono::milliseconds(100);
+            // Factory() performs validation
+            std::shared_ptr<class ServerContract> contract(
+                ServerContract::Factory(nym, *serialized));
 
-                while (std::chrono::high_resolution_clock::now() < end) {
-                    std::this_thread::sleep_for(interval);
-                    mapLock.lock();
-                    bool found = (server_map_.find(server) != server_map_.end());
-                    mapLock.unlock();
+            if (contract) {
+                contract->SetAlias(alias);
+            }
 
-                    if (found) { break; }
-                }
+            return contract;
+        });
 
-                return Server(id); // timeout of zero prevents infinite recursion
-            }
-        }
-    } else {
-        auto& pServer = server_map_[server];
-        if (pServer) {
-            valid = pServer->Validate();
+    if (pServer) {
+        if (pServer->Validate()) {
+
+            return pServer;
         }
+
+        return nullptr;
     }
 
-    if (valid) {
-        return server_map_[server];
+    if (loaded) {
+
+        return nullptr;
+    }
+
+    App::Me().DHT().GetServerContract(server);
+
+    if (timeout > std::chrono::milliseconds(0)) {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto end = start + timeout;
+        const auto interval = std::chrono::milliseconds(100);
+
+        while (std::chrono::high_resolution_clock::now() < end) {
+            std::this_thread::sleep_for(interval);
+
+            if (server_map_.Exists(server)) { break; }
+        }
+
+        return Server(id); // timeout of zero prevents infinite recursion
     }
 
     return nullptr;
@@ -242,9 +270,10 @@ ConstServerContract Wallet::Server(
             if (App::Me().DB().Store(
                 contract->Contract(),
                 contract->Alias())) {
-                    std::unique_lock<std::mutex> mapLock(server_map_lock_);
-                    server_map_[server].reset(contract.release());
-                    mapLock.unlock();
+                    server_map_.Set(
+                        server,
+                        std::shared_ptr<class ServerContract>(
+                            contract.release()));
             }
         }
     }
@@ -271,9 +300,10 @@ ConstServerContract Wallet::Server(
                 if (App::Me().DB().Store(
                     candidate->Contract(),
                     candidate->Alias())) {
-                        std::unique_lock<std::mutex> mapLock(server_map_lock_);
-                        server_map_[server].reset(candidate.release());
-                        mapLock.unlock();
+                        server_map_.Set(
+                            server,
+                            std::shared_ptr<class ServerContract>(
+                                candidate.release()));
                 }
             }
         }
@@ -347,63 +377,70 @@ ConstUnitDefinition Wallet::UnitDefinition(
 {
     const String strID(id);
     const std::string unit = strID.Get();
-    std::unique_lock<std::mutex> mapLock(unit_map_lock_);
-    bool inMap = (unit_map_.find(unit) != unit_map_.end());
-    bool valid = false;
+    bool loaded = false;
 
-    if (!inMap) {
-        std::shared_ptr<proto::UnitDefinition> serialized;
+    auto pUnit = unit_map_.Get(
+        unit, [&]() -> std::shared_ptr<class UnitDefinition> {
+            std::shared_ptr<proto::UnitDefinition> serialized;
+            std::string alias;
+            loaded = App::Me().DB().Load(unit, serialized, alias, true);
 
-        std::string alias;
-        bool loaded = App::Me().DB().Load(unit, serialized, alias, true);
+            if (!loaded) {
+
+                return nullptr;
+            }
 
-        if (loaded) {
             auto nym = Nym(serialized->nymid());
 
             if (!nym && serialized->has_publicnym()) {
                 nym = Nym(serialized->publicnym());
             }
 
-            if (nym) {
-                auto& pUnit = unit_map_[unit];
-                pUnit.reset(UnitDefinition::Factory(nym, *serialized));
+            if (!nym) {
 
-                if (pUnit) {
-                    valid = true; // Factory() performs validation
-                    pUnit->SetAlias(alias);
-                }
+                return nullptr;
             }
-        } else {
-            App::Me().DHT().GetUnitDefinition(unit);
 
-            if (timeout > std::chrono::milliseconds(0)) {
-                mapLock.unlock();
-                auto start = std::chrono::high_resolution_clock::now();
-                auto end = start + timeout;
-                const auto interval = std::chrono::milliseconds(100);
+            // Factory() performs validation
+            std::shared_ptr<class UnitDefinition> contract(
+                UnitDefinition::Factory(nym, *serialized));
 
-                while (std::chrono::high_resolution_clock::now() < end) {
-                    std::this_thread::sleep_for(interval);
-                    mapLock.lock();
-                    bool found = (unit_map_.find(unit) != unit_map_.end());
-                    mapLock.unlock();
+            if (contract) {
+                contract->SetAlias(alias);
+            }
 
-                    if (found) { break; }
-                }
+            return contract;
+        });
 
-                return UnitDefinition(id); // timeout of zero prevents
-                                           // infinite recursion
-            }
-        }
-    } else {
-        auto& pUnit = unit_map_[unit];
-        if (pUnit) {
-            valid = pUnit->Validate();
+    if (pUnit) {
+        if (pUnit->Validate()) {
+
+            return pUnit;
         }
+
+        return nullptr;
     }
 
-    if (valid) {
-        return unit_map_[unit];
+    if (loaded) {
+
+        return nullptr;
+    }
+
+    App::Me().DHT().GetUnitDefinition(unit);
+
+    if (timeout > std::chrono::milliseconds(0)) {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto end = start + timeout;
+        const auto interval = std::chrono::milliseconds(100);
+
+        while (std::chrono::high_resolution_clock::now() < end) {
+            std::this_thread::sleep_for(interval);
+
+            if (unit_map_.Exists(unit)) { break; }
+        }
+
+        return UnitDefinition(id); // timeout of zero prevents
+                                   // infinite recursion
     }
 
     return nullptr;
@@ -419,9 +456,10 @@ ConstUnitDefinition Wallet::UnitDefinition(
             if (App::Me().DB().Store(
                 contract->Contract(),
                 contract->Alias())) {
-                    std::unique_lock<std::mutex> mapLock(unit_map_lock_);
-                    unit_map_[unit].reset(contract.release());
-                    mapLock.unlock();
+                    unit_map_.Set(
+                        unit,
+                        std::shared_ptr<class UnitDefinition>(
+                            contract.release()));
             }
         }
     }
@@ -448,9 +486,10 @@ ConstUnitDefinition Wallet::UnitDefinition(
                 if (App::Me().DB().Store(
                     candidate->Contract(),
                     candidate->Alias())) {
-                        std::unique_lock<std::mutex> mapLock(unit_map_lock_);
-                        unit_map_[unit].reset(candidate.release());
-                        mapLock.unlock();
+                        unit_map_.Set(
+                            unit,
+                            std::shared_ptr<class UnitDefinition>(
+                                candidate.release()));
                 }
             }
         }
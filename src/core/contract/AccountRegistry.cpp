@@ -0,0 +1,607 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/core/stdafx.hpp>
+
+#include <opentxs/core/contract/AccountRegistry.hpp>
+
+#include <opentxs/core/util/OTFolders.hpp>
+#include <opentxs/core/util/OTPaths.hpp>
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/OTStorage.hpp>
+#include <opentxs/core/String.hpp>
+
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <sstream>
+
+// Merge the log into the sorted file once it holds this many lines
+#define ACCOUNT_REGISTRY_COMPACT_ENTRIES 4096
+// Below this many bytes, the sorted file is scanned instead of bisected
+#define ACCOUNT_REGISTRY_SCAN_BYTES 4096
+// The longest account ID accepted from the log
+#define ACCOUNT_REGISTRY_MAX_ID 256
+// First line of the sorted file, followed by the number of IDs in it
+#define ACCOUNT_REGISTRY_HEADER "otaccounts 1"
+
+namespace opentxs
+{
+
+std::mutex AccountRegistry::registry_lock_;
+std::map<std::string, std::shared_ptr<AccountRegistry::Registry>>
+    AccountRegistry::registries_;
+
+std::shared_ptr<AccountRegistry::Registry> AccountRegistry::Get(
+    const std::string& unitID)
+{
+    std::lock_guard<std::mutex> lock(registry_lock_);
+    auto& registry = registries_[unitID];
+
+    if (!registry) { registry.reset(new Registry); }
+
+    return registry;
+}
+
+bool AccountRegistry::Path(const std::string& file, std::string& path)
+{
+    if (0 > OTDB::FormPathString(path, OTFolders::Contract().Get(), file)) {
+        otErr << __FUNCTION__ << ": Failed to form path for account records "
+              << file << "\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+bool AccountRegistry::ValidID(const std::string& accountID)
+{
+    if (accountID.empty() || (ACCOUNT_REGISTRY_MAX_ID < accountID.size())) {
+        return false;
+    }
+
+    for (const auto& c : accountID) {
+        if (0 == std::isalnum(static_cast<unsigned char>(c))) { return false; }
+    }
+
+    return true;
+}
+
+bool AccountRegistry::OpenSorted(
+    const std::string& unitID,
+    std::ifstream& sorted,
+    std::size_t& count,
+    std::int64_t& end)
+{
+    count = 0;
+    end = 0;
+    std::string path;
+
+    if (!Path(unitID + ".rs", path)) { return false; }
+
+    sorted.open(path, std::ios::in | std::ios::binary);
+
+    // No sorted file yet: the list is whatever the log holds.
+    if (!sorted.is_open()) { return true; }
+
+    std::string header;
+    std::getline(sorted, header);
+    const std::streamoff start = sorted.tellg();
+
+    if (0 != header.compare(
+            0, sizeof(ACCOUNT_REGISTRY_HEADER), ACCOUNT_REGISTRY_HEADER " ") ||
+        (0 > start)) {
+        otErr << __FUNCTION__ << ": Unrecognized account records file "
+              << path << "\n";
+        sorted.close();
+
+        return false;
+    }
+
+    count = static_cast<std::size_t>(std::strtoull(
+        header.c_str() + sizeof(ACCOUNT_REGISTRY_HEADER), nullptr, 10));
+    sorted.seekg(0, std::ios::end);
+    end = static_cast<std::int64_t>(sorted.tellg());
+    sorted.seekg(start);
+
+    return true;
+}
+
+void AccountRegistry::SeekSorted(
+    std::ifstream& sorted,
+    const std::string& accountID,
+    const bool inclusive,
+    const std::int64_t end)
+{
+    // True for the IDs which come before the position wanted
+    const auto before = [&accountID, inclusive](const std::string& key) {
+        return inclusive ? (key < accountID) : (key <= accountID);
+    };
+
+    std::int64_t lo = static_cast<std::int64_t>(sorted.tellg());
+    std::int64_t hi = end;
+    std::string key;
+
+    // lo is always the start of a line. Bisect by bytes, moving each probe
+    // forward to the start of the next line.
+    while (ACCOUNT_REGISTRY_SCAN_BYTES < (hi - lo)) {
+        const std::int64_t mid = lo + ((hi - lo) / 2);
+        sorted.clear();
+        sorted.seekg(mid - 1);
+        std::getline(sorted, key);
+        const std::int64_t position = static_cast<std::int64_t>(sorted.tellg());
+
+        if ((0 > position) || (hi <= position)) { break; }
+
+        std::getline(sorted, key);
+
+        if (before(key)) {
+            lo = position + static_cast<std::int64_t>(key.size()) + 1;
+        } else {
+            hi = position;
+        }
+    }
+
+    sorted.clear();
+    sorted.seekg(lo);
+
+    while (true) {
+        const std::streamoff position = sorted.tellg();
+
+        if (!std::getline(sorted, key)) { return; }
+
+        if (!before(key)) {
+            sorted.clear();
+            sorted.seekg(position);
+
+            return;
+        }
+    }
+}
+
+bool AccountRegistry::InSorted(
+    const std::string& unitID,
+    const std::string& accountID,
+    bool& found)
+{
+    found = false;
+    std::ifstream sorted;
+    std::size_t count = 0;
+    std::int64_t end = 0;
+
+    if (!OpenSorted(unitID, sorted, count, end)) { return false; }
+
+    if (!sorted.is_open()) { return true; }
+
+    SeekSorted(sorted, accountID, true, end);
+    std::string key;
+    found = (std::getline(sorted, key) && (key == accountID));
+
+    return true;
+}
+
+bool AccountRegistry::Load(const std::string& unitID, Registry& registry)
+{
+    if (registry.loaded_) { return true; }
+
+    registry.changes_.clear();
+    registry.count_ = 0;
+    registry.log_entries_ = 0;
+
+    const std::string logFile = unitID + ".r";
+    const std::string legacyFile = unitID + ".a";
+    std::ifstream sorted;
+    std::int64_t end = 0;
+
+    if (!OpenSorted(unitID, sorted, registry.count_, end)) { return false; }
+
+    const bool haveSorted = sorted.is_open();
+    sorted.close();
+    bool rewrite = false;
+
+    if (OTDB::Exists(OTFolders::Contract().Get(), logFile)) {
+        std::string path;
+
+        if (!Path(logFile, path)) { return false; }
+
+        std::ifstream log(path, std::ios::in | std::ios::binary);
+        std::string line;
+
+        while (std::getline(log, line)) {
+            const std::string accountID = line.substr(std::min<std::size_t>(
+                1, line.size()));
+
+            // A line cut short by a crash has no newline, and may hold a
+            // truncated ID.
+            if (log.eof() || ('+' != line[0] && '-' != line[0]) ||
+                !ValidID(accountID)) {
+                otErr << __FUNCTION__ << ": Dropping malformed line from the "
+                      << "account records of instrument definition "
+                      << unitID << "\n";
+                rewrite = true;
+
+                continue;
+            }
+
+            registry.log_entries_++;
+            const bool present = ('+' == line[0]);
+            auto it = registry.changes_.find(accountID);
+            bool inSorted = false;
+
+            if (registry.changes_.end() != it) {
+                inSorted = !it->second;
+            } else if (!InSorted(unitID, accountID, inSorted)) {
+                return false;
+            }
+
+            const bool wasPresent =
+                (registry.changes_.end() != it) ? it->second : inSorted;
+
+            if (present == wasPresent) { continue; }
+
+            if (present == inSorted) {
+                registry.changes_.erase(accountID);
+            } else {
+                registry.changes_[accountID] = present;
+            }
+
+            if (present) {
+                registry.count_++;
+            } else {
+                registry.count_--;
+            }
+        }
+    } else if (
+        !haveSorted &&
+        OTDB::Exists(OTFolders::Contract().Get(), legacyFile)) {
+        std::unique_ptr<OTDB::Storable> pStorable(OTDB::QueryObject(
+            OTDB::STORED_OBJ_STRING_MAP, OTFolders::Contract().Get(),
+            legacyFile));
+        OTDB::StringMap* pMap = dynamic_cast<OTDB::StringMap*>(pStorable.get());
+
+        if (nullptr == pMap) {
+            otErr << __FUNCTION__ << ": Failed loading account records file "
+                  << legacyFile << "\n";
+
+            return false;
+        }
+
+        for (auto& it : pMap->the_map) {
+            // Every account should map to the same instrument definition
+            if (unitID != it.second) {
+                otErr << __FUNCTION__ << ": Skipping account " << it.first
+                      << " with wrong instrument definition ID " << it.second
+                      << " when expecting: " << unitID << "\n";
+
+                continue;
+            }
+
+            if (registry.changes_.insert({it.first, true}).second) {
+                registry.count_++;
+            }
+        }
+
+        rewrite = true;
+        otOut << __FUNCTION__ << ": Importing " << registry.count_
+              << " account records for instrument definition " << unitID
+              << "\n";
+    }
+
+    // A log written before the sorted file existed holds the whole list.
+    if (rewrite ||
+        (ACCOUNT_REGISTRY_COMPACT_ENTRIES <= registry.log_entries_)) {
+        if (!Compact(unitID, registry)) { return false; }
+    }
+
+    registry.loaded_ = true;
+
+    return true;
+}
+
+bool AccountRegistry::Change(
+    const std::string& unitID,
+    Registry& registry,
+    const std::string& accountID,
+    const bool present)
+{
+    if (!ValidID(accountID)) {
+        otErr << __FUNCTION__ << ": Invalid account ID " << accountID << "\n";
+
+        return false;
+    }
+
+    if (!Load(unitID, registry)) { return false; }
+
+    auto it = registry.changes_.find(accountID);
+    bool inSorted = false;
+
+    if (registry.changes_.end() != it) {
+        inSorted = !it->second;
+    } else if (!InSorted(unitID, accountID, inSorted)) {
+        return false;
+    }
+
+    const bool wasPresent =
+        (registry.changes_.end() != it) ? it->second : inSorted;
+
+    // Already the desired end result.
+    if (present == wasPresent) { return true; }
+
+    if (!Append(unitID, registry, present ? '+' : '-', accountID)) {
+        return false;
+    }
+
+    if (present == inSorted) {
+        registry.changes_.erase(accountID);
+    } else {
+        registry.changes_[accountID] = present;
+    }
+
+    if (present) {
+        registry.count_++;
+    } else {
+        registry.count_--;
+    }
+
+    // The change is already in the log, so a failure here only postpones
+    // the merge.
+    if ((ACCOUNT_REGISTRY_COMPACT_ENTRIES <= registry.log_entries_) &&
+        !Compact(unitID, registry)) {
+        otErr << __FUNCTION__ << ": Failed to merge the account records log "
+              << "of instrument definition " << unitID << "\n";
+    }
+
+    return true;
+}
+
+bool AccountRegistry::Append(
+    const std::string& unitID,
+    Registry& registry,
+    const char operation,
+    const std::string& accountID)
+{
+    std::string path;
+
+    if (!Path(unitID + ".r", path)) { return false; }
+
+    std::ofstream log(path, std::ios::out | std::ios::app | std::ios::binary);
+    log << operation << accountID << '\n';
+    log.flush();
+
+    if (!log.good()) {
+        otErr << __FUNCTION__ << ": Failed writing account records of "
+              << "instrument definition " << unitID << "\n";
+
+        return false;
+    }
+
+    registry.log_entries_++;
+
+    return true;
+}
+
+bool AccountRegistry::Compact(const std::string& unitID, Registry& registry)
+{
+    std::string path, logPath;
+
+    if (!Path(unitID + ".rs", path) || !Path(unitID + ".r", logPath)) {
+        return false;
+    }
+
+    std::ifstream sorted;
+    std::size_t count = 0;
+    std::int64_t end = 0;
+
+    if (!OpenSorted(unitID, sorted, count, end)) { return false; }
+
+    const String strTemp = OTPaths::TempPath(String(path.c_str()));
+    std::ofstream output(strTemp.Get(),
+                         std::ios::out | std::ios::trunc | std::ios::binary);
+    char header[64]{};
+    // The count is written again, once known, so it has a fixed width.
+    std::snprintf(header, sizeof(header), "%s %020" PRIu64 "\n",
+                  ACCOUNT_REGISTRY_HEADER, static_cast<std::uint64_t>(0));
+    output << header;
+
+    std::uint64_t written = 0;
+    std::string key;
+    bool haveKey = sorted.is_open() && std::getline(sorted, key);
+    auto change = registry.changes_.begin();
+
+    while (haveKey || (registry.changes_.end() != change)) {
+        const bool takeSorted =
+            haveKey && ((registry.changes_.end() == change) ||
+                        (key < change->first));
+        const bool takeChange =
+            (registry.changes_.end() != change) &&
+            (!haveKey || (change->first < key));
+
+        if (takeSorted) {
+            output << key << '\n';
+            ++written;
+        } else if (takeChange) {
+            if (change->second) {
+                output << change->first << '\n';
+                ++written;
+            }
+        } else if (change->second) {
+            // In both. Shouldn't happen, but is harmless.
+            output << key << '\n';
+            ++written;
+        }
+
+        if (!takeChange) {
+            haveKey = static_cast<bool>(std::getline(sorted, key));
+        }
+
+        if (!takeSorted) { ++change; }
+    }
+
+    std::snprintf(header, sizeof(header), "%s %020" PRIu64 "\n",
+                  ACCOUNT_REGISTRY_HEADER, written);
+    output.seekp(0);
+    output << header;
+    output.close();
+    sorted.close();
+
+    bool success = !output.fail() && OTPaths::SyncPath(strTemp) &&
+                   OTPaths::ReplaceFile(strTemp, String(path.c_str()));
+
+    if (!success) {
+        std::remove(strTemp.Get());
+        otErr << __FUNCTION__ << ": Failed to store account records of "
+              << "instrument definition " << unitID << "\n";
+
+        return false;
+    }
+
+    // If this doesn't happen, the log is merged into the new file again the
+    // next time it is loaded, to the same effect.
+    std::ofstream log(logPath, std::ios::out | std::ios::trunc |
+                                   std::ios::binary);
+    log.close();
+
+    if (log.fail() || !OTPaths::SyncPath(String(logPath.c_str()))) {
+        otErr << __FUNCTION__ << ": Failed to empty the account records log "
+              << "of instrument definition " << unitID << "\n";
+    }
+
+    registry.changes_.clear();
+    registry.count_ = static_cast<std::size_t>(written);
+    registry.log_entries_ = 0;
+
+    return true;
+}
+
+bool AccountRegistry::Add(
+    const std::string& unitID,
+    const std::string& accountID)
+{
+    auto registry = Get(unitID);
+    std::lock_guard<std::mutex> lock(registry->lock_);
+
+    return Change(unitID, *registry, accountID, true);
+}
+
+bool AccountRegistry::Erase(
+    const std::string& unitID,
+    const std::string& accountID)
+{
+    auto registry = Get(unitID);
+    std::lock_guard<std::mutex> lock(registry->lock_);
+
+    return Change(unitID, *registry, accountID, false);
+}
+
+std::size_t AccountRegistry::Count(const std::string& unitID)
+{
+    auto registry = Get(unitID);
+    std::lock_guard<std::mutex> lock(registry->lock_);
+
+    if (!Load(unitID, *registry)) { return 0; }
+
+    return registry->count_;
+}
+
+bool AccountRegistry::Page(
+    const std::string& unitID,
+    const std::string& after,
+    const std::size_t count,
+    AccountList& list)
+{
+    list.clear();
+    auto registry = Get(unitID);
+    std::lock_guard<std::mutex> lock(registry->lock_);
+
+    if (!Load(unitID, *registry)) { return false; }
+
+    std::ifstream sorted;
+    std::size_t total = 0;
+    std::int64_t end = 0;
+
+    if (!OpenSorted(unitID, sorted, total, end)) { return false; }
+
+    if (sorted.is_open() && !after.empty()) {
+        SeekSorted(sorted, after, false, end);
+    }
+
+    const auto& changes = registry->changes_;
+    auto change = after.empty() ? changes.begin() : changes.upper_bound(after);
+    std::string key;
+    bool haveKey = sorted.is_open() && std::getline(sorted, key);
+
+    while ((list.size() < count) &&
+           (haveKey || (changes.end() != change))) {
+        const bool takeSorted =
+            haveKey && ((changes.end() == change) || (key < change->first));
+        const bool takeChange =
+            (changes.end() != change) && (!haveKey || (change->first < key));
+
+        if (takeSorted) {
+            list.push_back(key);
+        } else if (takeChange) {
+            if (change->second) { list.push_back(change->first); }
+        } else if (change->second) {
+            list.push_back(key);
+        }
+
+        if (!takeChange) {
+            haveKey = static_cast<bool>(std::getline(sorted, key));
+        }
+
+        if (!takeSorted) { ++change; }
+    }
+
+    return true;
+}
+
+void AccountRegistry::Unload()
+{
+    std::lock_guard<std::mutex> lock(registry_lock_);
+
+    for (auto& it : registries_) {
+        std::lock_guard<std::mutex> registryLock(it.second->lock_);
+        it.second->loaded_ = false;
+        it.second->changes_.clear();
+    }
+
+    registries_.clear();
+}
+
+} // namespace opentxs
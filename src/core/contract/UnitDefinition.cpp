@@ -42,11 +42,10 @@
 
 #include <opentxs/core/contract/basket/Basket.hpp>
 #include <opentxs/core/contract/basket/BasketContract.hpp>
+#include <opentxs/core/contract/AccountRegistry.hpp>
 #include <opentxs/core/Account.hpp>
 #include <opentxs/core/AccountVisitor.hpp>
-#include <opentxs/core/util/OTFolders.hpp>
 #include <opentxs/core/Log.hpp>
-#include <opentxs/core/OTStorage.hpp>
 #include <opentxs/core/Proto.hpp>
 #include "opentxs/core/app/App.hpp"
 #include "opentxs/core/contract/CurrencyContract.hpp"
@@ -55,9 +54,14 @@
 #include <cmath>
 #include <sstream>
 #include <fstream>
+#include <future>
+#include <map>
 #include <memory>
 #include <iomanip>
 
+// Number of account records visited, and prefetched, at a time
+#define ACCOUNT_RECORDS_PAGE_SIZE 256
+
 namespace opentxs
 {
 
@@ -285,123 +289,114 @@ bool UnitDefinition::DisplayStatistics(String& strContents) const
 // reserve accounts, or cash reserve accounts, are not included on this list.
 bool UnitDefinition::VisitAccountRecords(AccountVisitor& visitor) const
 {
-    String strInstrumentDefinitionID = ID();
-    String strAcctRecordFile;
-    strAcctRecordFile.Format("%s.a", strInstrumentDefinitionID.Get());
+    const std::string unitID = String(ID()).Get();
+    Identifier* pNotaryID = visitor.GetNotaryID();
+    OT_ASSERT_MSG(nullptr != pNotaryID,
+                  "Assert: nullptr Notary ID on functor. "
+                  "(How did you even construct the "
+                  "thing?)");
+    const Identifier notaryID(*pNotaryID);
+
+    // The visitor has a list of 'already loaded' accounts, just in case.
+    mapOfAccounts* pLoadedAccounts = visitor.GetLoadedAccts();
+
+    typedef std::map<std::string, std::shared_ptr<Account>> Prefetched;
+
+    // Accounts are visited a page at a time. While the visitor works through
+    // one page, the accounts on the next page are loaded on another thread.
+    auto prefetch = [pLoadedAccounts, notaryID](
+        const AccountRegistry::AccountList& page) -> std::future<Prefetched>
+    {
+        AccountRegistry::AccountList toLoad;
 
-    std::unique_ptr<OTDB::Storable> pStorable(OTDB::QueryObject(
-        OTDB::STORED_OBJ_STRING_MAP, OTFolders::Contract().Get(),
-        strAcctRecordFile.Get()));
+        for (auto& id : page) {
+            if ((nullptr == pLoadedAccounts) ||
+                (pLoadedAccounts->end() == pLoadedAccounts->find(id))) {
+                toLoad.push_back(id);
+            }
+        }
 
-    OTDB::StringMap* pMap = dynamic_cast<OTDB::StringMap*>(pStorable.get());
+        return std::async(std::launch::async, [toLoad, notaryID]()
+            {
+                Prefetched output;
 
-    // There was definitely a StringMap loaded from local storage.
-    // (Even an empty one, possibly.) This is the only block that matters in
-    // this function.
-    //
-    if (nullptr != pMap) {
-        Identifier* pNotaryID = visitor.GetNotaryID();
-        OT_ASSERT_MSG(nullptr != pNotaryID,
-                      "Assert: nullptr Notary ID on functor. "
-                      "(How did you even construct the "
-                      "thing?)");
-
-        auto& theMap = pMap->the_map;
-
-        // todo: optimize: will probably have to use a database for this,
-        // int64_t term.
-        // (What if there are a million acct IDs in this flat file? Not
-        // scaleable.)
-        //
-        for (auto& it : theMap) {
-            const std::string& str_acct_id =
-                it.first; // Containing the account ID.
-            const std::string& str_instrument_definition_id =
-                it.second; // Containing the instrument definition ID. (Just in
-                           // case
-                           // someone copied the wrong file here...)
-
-            if (!strInstrumentDefinitionID.Compare(
-                    str_instrument_definition_id.c_str())) {
-                otErr << "OTUnitDefinition::VisitAccountRecords: Error: wrong "
-                         "instrument definition ID ("
-                      << str_instrument_definition_id
-                      << ") when expecting: " << strInstrumentDefinitionID
-                      << "\n";
-            }
-            else {
-                Account* pAccount = nullptr;
-                std::unique_ptr<Account> theAcctAngel;
+                for (auto& id : toLoad) {
+                    output[id].reset(Account::LoadExistingAccount(
+                        Identifier(id.c_str()), notaryID));
+                }
 
-                const Identifier theAccountID(str_acct_id.c_str());
+                return output;
+            });
+    };
 
-                // Before loading it from local storage, let's first make sure
-                // it's not already loaded.
-                // (visitor functor has a list of 'already loaded' accounts,
-                // just in case.)
-                //
-                mapOfAccounts* pLoadedAccounts = visitor.GetLoadedAccts();
-
-                if (nullptr !=
-                    pLoadedAccounts) // there are some accounts already loaded,
-                { // let's see if the one we're looking for is there...
-                    auto found_it = pLoadedAccounts->find(str_acct_id);
-
-                    if (pLoadedAccounts->end() != found_it) // FOUND IT.
-                    {
-                        pAccount = found_it->second;
-                        OT_ASSERT(nullptr != pAccount);
-
-                        if (theAccountID != pAccount->GetPurportedAccountID()) {
-                            otErr << "Error: the actual account didn't have "
-                                     "the ID that the std::map SAID it had! "
-                                     "(Should never happen.)\n";
-                            pAccount = nullptr;
-                        }
+    AccountRegistry::AccountList page, nextPage;
+
+    if (!AccountRegistry::Page(unitID, "", ACCOUNT_RECORDS_PAGE_SIZE, page)) {
+        otErr << __FUNCTION__ << ": Error: failed loading account records "
+              << "for instrument definition: " << unitID << "\n";
+
+        return false;
+    }
+
+    std::future<Prefetched> next = prefetch(page);
+
+    while (!page.empty()) {
+        Prefetched accounts = next.get();
+
+        AccountRegistry::Page(
+            unitID, page.back(), ACCOUNT_RECORDS_PAGE_SIZE, nextPage);
+
+        if (!nextPage.empty()) { next = prefetch(nextPage); }
+
+        for (auto& str_acct_id : page) {
+            Account* pAccount = nullptr;
+            const Identifier theAccountID(str_acct_id.c_str());
+
+            // Before loading it from local storage, let's first make sure
+            // it's not already loaded.
+            if (nullptr != pLoadedAccounts) {
+                auto found_it = pLoadedAccounts->find(str_acct_id);
+
+                if (pLoadedAccounts->end() != found_it) // FOUND IT.
+                {
+                    pAccount = found_it->second;
+                    OT_ASSERT(nullptr != pAccount);
+
+                    if (theAccountID != pAccount->GetPurportedAccountID()) {
+                        otErr << "Error: the actual account didn't have "
+                                 "the ID that the std::map SAID it had! "
+                                 "(Should never happen.)\n";
+                        pAccount = nullptr;
                     }
                 }
+            }
 
-                // I guess it wasn't already loaded...
-                // Let's try to load it.
-                //
-                if (nullptr == pAccount) {
-                    pAccount =
-                        Account::LoadExistingAccount(theAccountID, *pNotaryID);
-                    theAcctAngel.reset(pAccount);
-                }
+            if (nullptr == pAccount) {
+                auto it = accounts.find(str_acct_id);
 
-                bool bSuccessLoadingAccount =
-                    ((pAccount != nullptr) ? true : false);
-                if (bSuccessLoadingAccount) {
-                    bool bTriggerSuccess = visitor.Trigger(*pAccount);
-                    if (!bTriggerSuccess)
-                        otErr << __FUNCTION__ << ": Error: Trigger Failed.";
-                }
-                else {
-                    otErr << __FUNCTION__ << ": Error: Failed Loading Account!";
-                }
+                if (accounts.end() != it) { pAccount = it->second.get(); }
+            }
+
+            if (nullptr != pAccount) {
+                bool bTriggerSuccess = visitor.Trigger(*pAccount);
+                if (!bTriggerSuccess)
+                    otErr << __FUNCTION__ << ": Error: Trigger Failed.";
+            }
+            else {
+                otErr << __FUNCTION__ << ": Error: Failed Loading Account!";
             }
         }
-        return true;
+
+        page.swap(nextPage);
+        nextPage.clear();
     }
+
     return true;
 }
 
-bool UnitDefinition::AddAccountRecord(const Account& theAccount) const // adds
-                                                                      // the
-// account
-// to the
-// list.
-// (When
-// account
-// is
-// created.)
+// adds the account to the list. (When account is created.)
+bool UnitDefinition::AddAccountRecord(const Account& theAccount) const
 {
-    //  Load up account list StringMap. Create it if doesn't already exist.
-    //  See if account is already there in the map. Add it otherwise.
-    //  Save the StringMap back again. (The account records list for a given
-    // instrument definition.)
-
     const char* szFunc = "OTUnitDefinition::AddAccountRecord";
 
     if (theAccount.GetInstrumentDefinitionID() != id_) {
@@ -412,177 +407,39 @@ bool UnitDefinition::AddAccountRecord(const Account& theAccount) const // adds
 
     const Identifier theAcctID(theAccount);
     const String strAcctID(theAcctID);
+    const String strInstrumentDefinitionID = ID();
 
-    String strInstrumentDefinitionID = ID();
-    String strAcctRecordFile;
-    strAcctRecordFile.Format("%s.a", strInstrumentDefinitionID.Get());
-
-    OTDB::Storable* pStorable = nullptr;
-    std::unique_ptr<OTDB::Storable> theAngel;
-    OTDB::StringMap* pMap = nullptr;
-
-    if (OTDB::Exists(OTFolders::Contract().Get(),
-                     strAcctRecordFile.Get())) // the file already exists; let's
-                                               // try to load it up.
-        pStorable = OTDB::QueryObject(OTDB::STORED_OBJ_STRING_MAP,
-                                      OTFolders::Contract().Get(),
-                                      strAcctRecordFile.Get());
-    else // the account records file (for this instrument definition) doesn't
-         // exist.
-        pStorable = OTDB::CreateObject(
-            OTDB::STORED_OBJ_STRING_MAP); // this asserts already, on failure.
-
-    theAngel.reset(pStorable);
-    pMap = (nullptr == pStorable) ? nullptr
-                                  : dynamic_cast<OTDB::StringMap*>(pStorable);
-
-    // It exists.
-    //
-    if (nullptr == pMap) {
-        otErr << szFunc
-              << ": Error: failed trying to load or create the account records "
-                 "file for instrument definition: " << strInstrumentDefinitionID
-              << "\n";
-        return false;
-    }
-
-    auto& theMap = pMap->the_map;
-    auto map_it = theMap.find(strAcctID.Get());
-
-    if (theMap.end() != map_it) // we found it.
-    {                           // We were ADDING IT, but it was ALREADY THERE.
-        // (Thus, we're ALREADY DONE.)
-        // Let's just make sure the right instrument definition ID is associated
-        // with this
-        // account
-        // (it better be, since we loaded the account records file based on the
-        // instrument definition ID as its filename...)
-        //
-        const std::string& str2 = map_it->second; // Containing the instrument
-                                                  // definition ID. (Just in
-                                                  // case
-        // someone copied the wrong file here,
-        // --------------------------------          // every account should map
-        // to the SAME instrument definition id.)
-
-        if (false == strInstrumentDefinitionID.Compare(str2.c_str())) // should
-                                                                      // never
-                                                                      // happen.
-        {
-            otErr << szFunc << ": Error: wrong instrument definition found in "
-                               "account records "
-                               "file...\n For instrument definition: "
-                  << strInstrumentDefinitionID << "\n "
-                                                  "For account: " << strAcctID
-                  << "\n Found wrong instrument definition: " << str2 << "\n";
-            return false;
-        }
-
-        return true; // already there (no need to add.) + the instrument
-                     // definition ID
-                     // matches.
-    }
-
-    // it wasn't already on the list...
-
-    // ...so add it.
-    //
-    theMap[strAcctID.Get()] = strInstrumentDefinitionID.Get();
-
-    // Then save it back to local storage:
-    //
-    if (!OTDB::StoreObject(*pMap, OTFolders::Contract().Get(),
-                           strAcctRecordFile.Get())) {
+    if (!AccountRegistry::Add(
+            strInstrumentDefinitionID.Get(), strAcctID.Get())) {
         otErr << szFunc
-              << ": Failed trying to StoreObject, while saving updated "
-                 "account records file for instrument definition: "
-              << strInstrumentDefinitionID
+              << ": Failed trying to save updated account records for "
+                 "instrument definition: " << strInstrumentDefinitionID
               << "\n to contain account ID: " << strAcctID << "\n";
         return false;
     }
 
-    // Okay, we saved the updated file, with the account added. (done, success.)
-    //
     return true;
 }
 
-bool UnitDefinition::EraseAccountRecord(const Identifier& theAcctID)
-    const // removes the account from the list. (When
-          // account is deleted.)
+// removes the account from the list. (When account is deleted.)
+bool UnitDefinition::EraseAccountRecord(const Identifier& theAcctID) const
 {
-    //  Load up account list StringMap. Create it if doesn't already exist.
-    //  See if account is already there in the map. Erase it, if it is.
-    //  Save the StringMap back again. (The account records list for a given
-    // instrument definition.)
-
     const char* szFunc = "OTUnitDefinition::EraseAccountRecord";
 
     const String strAcctID(theAcctID);
+    const String strInstrumentDefinitionID = ID();
 
-    String strInstrumentDefinitionID = ID();
-    String strAcctRecordFile;
-    strAcctRecordFile.Format("%s.a", strInstrumentDefinitionID.Get());
-
-    OTDB::Storable* pStorable = nullptr;
-    std::unique_ptr<OTDB::Storable> theAngel;
-    OTDB::StringMap* pMap = nullptr;
-
-    if (OTDB::Exists(OTFolders::Contract().Get(),
-                     strAcctRecordFile.Get())) // the file already exists; let's
-                                               // try to load it up.
-        pStorable = OTDB::QueryObject(OTDB::STORED_OBJ_STRING_MAP,
-                                      OTFolders::Contract().Get(),
-                                      strAcctRecordFile.Get());
-    else // the account records file (for this instrument definition) doesn't
-         // exist.
-        pStorable = OTDB::CreateObject(
-            OTDB::STORED_OBJ_STRING_MAP); // this asserts already, on failure.
-
-    theAngel.reset(pStorable);
-    pMap = (nullptr == pStorable) ? nullptr
-                                  : dynamic_cast<OTDB::StringMap*>(pStorable);
-
-    // It exists.
-    //
-    if (nullptr == pMap) {
-        otErr << szFunc
-              << ": Error: failed trying to load or create the account records "
-                 "file for instrument definition: " << strInstrumentDefinitionID
-              << "\n";
-        return false;
-    }
-
-    // Before we can erase it, let's see if it's even there....
-    //
-    auto& theMap = pMap->the_map;
-    auto map_it = theMap.find(strAcctID.Get());
-
-    // we found it!
-    if (theMap.end() != map_it) //  Acct ID was already there...
-    {
-        theMap.erase(map_it); // remove it
-    }
-
-    // it wasn't already on the list...
-    // (So it's like success, since the end result is, acct ID will not appear
-    // on this list--whether
-    // it was there or not beforehand, it's definitely not there now.)
-
-    // Then save it back to local storage:
-    //
-    if (!OTDB::StoreObject(*pMap, OTFolders::Contract().Get(),
-                           strAcctRecordFile.Get())) {
+    // If the account wasn't on the list that counts as success, since the end
+    // result is the same: the acct ID will not appear on this list.
+    if (!AccountRegistry::Erase(
+            strInstrumentDefinitionID.Get(), strAcctID.Get())) {
         otErr << szFunc
-              << ": Failed trying to StoreObject, while saving updated "
-                 "account records file for instrument definition: "
-              << strInstrumentDefinitionID
+              << ": Failed trying to save updated account records for "
+                 "instrument definition: " << strInstrumentDefinitionID
               << "\n to erase account ID: " << strAcctID << "\n";
         return false;
     }
 
-    // Okay, we saved the updated file, with the account removed. (done,
-    // success.)
-    //
     return true;
 }
 
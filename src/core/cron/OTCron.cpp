@@ -46,7 +46,9 @@
 
 #include <irrxml/irrXML.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 // Note: these are only code defaults -- the values are actually loaded from
 // ~/.ot/server.cfg.
@@ -562,7 +564,59 @@ void OTCron::UpdateContents()
 
 int64_t OTCron::computeTimeout()
 {
-    return OTCron::GetCronMsBetweenProcess() - tCron.getElapsedTimeInMilliSec();
+    const int64_t lMsBetweenProcess = OTCron::GetCronMsBetweenProcess();
+    const int64_t lSinceLastRound =
+        lMsBetweenProcess -
+        static_cast<int64_t>(tCron.getElapsedTimeInMilliSec());
+
+    if (lSinceLastRound > 0) return lSinceLastRound;
+
+    if (m_multimapWakeTimes.empty()) return lMsBetweenProcess;
+
+    const int64_t lUntilNextWake =
+        OTTimeGetTimeInterval(m_multimapWakeTimes.begin()->first,
+                              OTTimeGetCurrentTime()) *
+        1000;
+
+    if (lUntilNextWake <= 0) return 0;
+
+    return std::min(lUntilNextWake, lMsBetweenProcess);
+}
+
+// (Re)insert theItem on the wake-time index, at whatever time it says it next
+// needs processing.
+void OTCron::ScheduleItem(OTCronItem& theItem)
+{
+    const int64_t lTransactionNum = theItem.GetTransactionNum();
+
+    UnscheduleItem(lTransactionNum);
+
+    auto it = m_multimapWakeTimes.insert(std::pair<time64_t, OTCronItem*>(
+        theItem.GetNextWakeTime(), &theItem));
+    m_mapWakeTimes[lTransactionNum] = it;
+}
+
+void OTCron::UnscheduleItem(int64_t lTransactionNum)
+{
+    auto it = m_mapWakeTimes.find(lTransactionNum);
+
+    if (m_mapWakeTimes.end() == it) return;
+
+    m_multimapWakeTimes.erase(it->second);
+    m_mapWakeTimes.erase(it);
+}
+
+void OTCron::RescheduleItem(OTCronItem& theItem)
+{
+    auto it = m_mapWakeTimes.find(theItem.GetTransactionNum());
+
+    // Not on Cron, or currently being processed (in which case it will be
+    // rescheduled once ProcessCron() returns.)
+    if (m_mapWakeTimes.end() == it) return;
+
+    if (&theItem != it->second->second) return;
+
+    ScheduleItem(theItem);
 }
 
 // Make sure to call this regularly so the CronItems get a chance to process and
@@ -596,11 +650,29 @@ void OTCron::ProcessCronItems()
     }
     bool bNeedToSave = false;
 
-    // loop through the cron items and tell each one to ProcessCron().
+    // Take every item that is due off the wake-time index before processing
+    // any of them, since processing one item (a trade, say) can reschedule
+    // another.
+    const time64_t tNow = OTTimeGetCurrentTime();
+    std::vector<OTCronItem*> vecDueItems;
+
+    while (!m_multimapWakeTimes.empty() &&
+           (m_multimapWakeTimes.begin()->first <= tNow)) {
+        auto it = m_multimapWakeTimes.begin();
+        OTCronItem* pItem = it->second;
+        OT_ASSERT(nullptr != pItem);
+
+        vecDueItems.push_back(pItem);
+        m_mapWakeTimes.erase(pItem->GetTransactionNum());
+        m_multimapWakeTimes.erase(it);
+    }
+
+    // loop through the due cron items and tell each one to ProcessCron().
     // If the item returns true, that means leave it on the list. Otherwise,
     // if it returns false, that means "it's done: remove it."
-    for (auto it = m_multimapCronItems.begin();
-         it != m_multimapCronItems.end();) {
+    for (auto it = vecDueItems.begin(); it != vecDueItems.end(); ++it) {
+        OTCronItem* pItem = *it;
+
         if (GetTransactionCount() <= nTwentyPercent) {
             otErr << "WARNING: Cron has fewer than 20 percent of its normal "
                      "transaction "
@@ -613,22 +685,29 @@ void OTCron::ProcessCronItems()
                   << " were used in the current round alone!!! \n"
                      "SKIPPING THE REMAINDER OF THE CRON ITEMS THAT WERE "
                      "SCHEDULED FOR THIS ROUND!!!\n\n";
+
+            // They are still due, so they go back on the index for the next
+            // round.
+            for (; it != vecDueItems.end(); ++it) {
+                ScheduleItem(**it);
+            }
+
             break;
         }
-        OTCronItem* pItem = it->second;
-        OT_ASSERT(nullptr != pItem);
         otInfo << "OTCron::" << __FUNCTION__
                << ": Processing item number: " << pItem->GetTransactionNum()
                << " \n";
 
         if (pItem->ProcessCron()) {
-            it++;
+            ScheduleItem(*pItem);
             continue;
         }
         pItem->HookRemovalFromCron(nullptr, GetNextTransactionNumber());
         otOut << "OTCron::" << __FUNCTION__
               << ": Removing cron item: " << pItem->GetTransactionNum() << "\n";
-        it = m_multimapCronItems.erase(it);
+        auto it_multimap = FindItemOnMultimap(pItem->GetTransactionNum());
+        OT_ASSERT(m_multimapCronItems.end() != it_multimap);
+        m_multimapCronItems.erase(it_multimap);
         auto it_map = FindItemOnMap(pItem->GetTransactionNum());
         OT_ASSERT(m_mapCronItems.end() != it_map);
         m_mapCronItems.erase(it_map);
@@ -704,6 +783,10 @@ bool OTCron::AddCronItem(OTCronItem& theItem, Nym* pActivator,
         // But if actually being activated for the first time, then this is
         // true.
 
+        // Activation may have changed when the item next needs processing,
+        // so it goes on the wake-time index last.
+        ScheduleItem(theItem);
+
         // When an item is added to Cron for the first time, a copy of it is
         // saved to the
         // cron folder, and it has the user's original signature on it. (If it's
@@ -780,6 +863,7 @@ bool OTCron::RemoveCronItem(int64_t lTransactionNum,
 
         m_mapCronItems.erase(it_map);           // Remove from MAP.
         m_multimapCronItems.erase(it_multimap); // Remove from MULTIMAP.
+        UnscheduleItem(lTransactionNum);        // Remove from wake times.
 
         delete pItem;
 
@@ -1120,6 +1204,9 @@ void OTCron::Release_Cron()
         // same pItems being deleted in the next block.
     }
 
+    m_mapWakeTimes.clear();
+    m_multimapWakeTimes.clear();
+
     while (!m_mapCronItems.empty()) {
         OTCronItem* pItem = m_mapCronItems.begin()->second;
         auto it = m_mapCronItems.begin();
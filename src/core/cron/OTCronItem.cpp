@@ -51,6 +51,7 @@
 
 #include <irrxml/irrXML.hpp>
 
+#include <algorithm>
 #include <memory>
 
 // Base class for OTTrade and OTAgreement and OTPaymentPlan.
@@ -694,6 +695,35 @@ bool OTCronItem::ProcessCron()
     return true;
 }
 
+// Subclasses with a processing interval (trades, payment plans, smart
+// contracts) return early from ProcessCron until it has elapsed, so that is
+// the soonest anything can happen.
+time64_t OTCronItem::GetNextWakeTime()
+{
+    if (GetLastProcessDate() <= OT_TIME_ZERO) return OT_TIME_ZERO;
+
+    return OTTimeAddTimeInterval(GetLastProcessDate(),
+                                 GetProcessInterval() + 1);
+}
+
+time64_t OTCronItem::WakeWhenValid(const time64_t& tWake) const
+{
+    if (IsFlaggedForRemoval() || (GetValidFrom() <= tWake)) return tWake;
+
+    // Expiring before ever becoming valid is odd, but still needs processing.
+    if ((GetValidTo() > OT_TIME_ZERO) && (GetValidTo() < GetValidFrom()))
+        return std::max(tWake, GetValidTo());
+
+    return GetValidFrom();
+}
+
+void OTCronItem::FlagForRemoval()
+{
+    m_bRemovalFlag = true;
+
+    if (nullptr != m_pCron) m_pCron->RescheduleItem(*this);
+}
+
 // OTCron calls this when a cron item is added.
 // bForTheFirstTime=true means that this cron item is being
 // activated for the very first time. (Versus being re-added
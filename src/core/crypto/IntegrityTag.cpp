@@ -0,0 +1,180 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/core/stdafx.hpp>
+
+#include <opentxs/core/crypto/IntegrityTag.hpp>
+
+#include <opentxs/core/app/App.hpp>
+#include <opentxs/core/crypto/CryptoEngine.hpp>
+#include <opentxs/core/crypto/CryptoHash.hpp>
+#include <opentxs/core/crypto/OTASCIIArmor.hpp>
+#include <opentxs/core/crypto/OTPassword.hpp>
+#include <opentxs/core/crypto/OTSignature.hpp>
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/Nym.hpp>
+#include <opentxs/core/OTData.hpp>
+#include <opentxs/core/OTStorage.hpp>
+#include <opentxs/core/String.hpp>
+
+#define INTEGRITY_TAG_SUFFIX ".mac"
+
+namespace opentxs
+{
+
+std::atomic<bool> IntegrityTag::enabled_(false);
+std::shared_ptr<const IntegrityTag::Key> IntegrityTag::key_;
+
+void IntegrityTag::Enable(const OTPassword& key, const String& signerID)
+{
+    std::shared_ptr<Key> replacement(new Key);
+    replacement->key_.reset(new OTPassword(key));
+    replacement->signer_ = signerID.Get();
+    std::atomic_store(&key_, std::shared_ptr<const Key>(replacement));
+    enabled_.store(true);
+}
+
+void IntegrityTag::Disable()
+{
+    enabled_.store(false);
+    std::atomic_store(&key_, std::shared_ptr<const Key>());
+}
+
+bool IntegrityTag::IsSigner(const Nym& nym)
+{
+    if (!Enabled()) { return false; }
+
+    const auto key = std::atomic_load(&key_);
+
+    if (!key) { return false; }
+
+    String nymID;
+    nym.GetIdentifier(nymID);
+
+    return (key->signer_ == nymID.Get());
+}
+
+std::string IntegrityTag::Calculate(
+    const String& contents,
+    const OTSignature& signature)
+{
+    const auto key = std::atomic_load(&key_);
+
+    if (!key) { return ""; }
+
+    std::string input(key->signer_);
+    input.push_back('\n');
+    input.append(contents.Get(), contents.GetLength());
+    input.push_back('\n');
+    input.append(signature.Get(), signature.GetLength());
+
+    const OTData data(input.data(), input.size());
+    OTPassword digest;
+
+    if (!App::Me().Crypto().Hash().HMAC(
+            CryptoHash::SHA256, *key->key_, data, digest)) {
+        otErr << __FUNCTION__ << ": Failed to calculate integrity tag.\n";
+
+        return "";
+    }
+
+    const OTData output(digest.getMemory(), digest.getMemorySize());
+
+    return OTASCIIArmor(output).Get();
+}
+
+void IntegrityTag::TagPath(
+    std::string& strFolder,
+    std::string& oneStr,
+    std::string& twoStr,
+    std::string& threeStr)
+{
+    if (!threeStr.empty()) {
+        threeStr += INTEGRITY_TAG_SUFFIX;
+    } else if (!twoStr.empty()) {
+        twoStr += INTEGRITY_TAG_SUFFIX;
+    } else if (!oneStr.empty()) {
+        oneStr += INTEGRITY_TAG_SUFFIX;
+    } else {
+        strFolder += INTEGRITY_TAG_SUFFIX;
+    }
+}
+
+bool IntegrityTag::Store(
+    const std::string& tag,
+    std::string strFolder,
+    std::string oneStr,
+    std::string twoStr,
+    std::string threeStr)
+{
+    if (!Enabled()) { return false; }
+
+    TagPath(strFolder, oneStr, twoStr, threeStr);
+
+    // The tag and the object are separate files, each replaced atomically.
+    // A crash between the two writes leaves the old tag beside the new
+    // object. That is safe, since a tag only counts if it matches the
+    // contents and signature it is loaded with: the object is then fully
+    // verified, as if it had no tag.
+    if (tag.empty()) {
+        if (!OTDB::Exists(strFolder, oneStr, twoStr, threeStr)) {
+            return true;
+        }
+
+        return OTDB::EraseValueByKey(strFolder, oneStr, twoStr, threeStr);
+    }
+
+    return OTDB::StorePlainString(tag, strFolder, oneStr, twoStr, threeStr);
+}
+
+std::string IntegrityTag::Load(
+    std::string strFolder,
+    std::string oneStr,
+    std::string twoStr,
+    std::string threeStr)
+{
+    if (!Enabled()) { return ""; }
+
+    TagPath(strFolder, oneStr, twoStr, threeStr);
+
+    if (!OTDB::Exists(strFolder, oneStr, twoStr, threeStr)) { return ""; }
+
+    return OTDB::QueryPlainString(strFolder, oneStr, twoStr, threeStr);
+}
+
+} // namespace opentxs
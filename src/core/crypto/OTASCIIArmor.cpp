@@ -44,10 +44,18 @@
 #include <opentxs/core/Log.hpp>
 #include <opentxs/core/OTStorage.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <fstream>
 #include <cstring>
+#include <stdexcept>
 #include <zlib.h>
+#ifdef OT_ARMOR_LZ4
+#include <lz4.h>
+#endif
+
+// Bytes inflated per call to zlib
+#define OT_ARMOR_INFLATE_CHUNK 16384
 
 namespace opentxs
 {
@@ -61,6 +69,46 @@ const char* OT_END_ARMORED_escaped = "- -----END OT ARMORED";
 const char* OT_BEGIN_SIGNED = "-----BEGIN SIGNED";
 const char* OT_BEGIN_SIGNED_escaped = "- -----BEGIN SIGNED";
 
+// A payload which starts with this byte carries a header: the marker, the
+// header version, and the codec. A zlib stream can never start with it (the
+// low nibble of a zlib stream's first byte is always 8), so anything else is
+// treated as a plain zlib stream, which is what OT has always written.
+static const char ARMOR_HEADER_MARKER = '\x00';
+static const char ARMOR_HEADER_VERSION = '\x01';
+static const size_t ARMOR_HEADER_SIZE = 3;
+#ifdef OT_ARMOR_LZ4
+// An LZ4 payload follows its header with the uncompressed size, as a 32 bit
+// little-endian integer, since the block format doesn't record it.
+static const size_t ARMOR_LZ4_SIZE_BYTES = 4;
+#endif
+
+std::atomic<int32_t> OTASCIIArmor::s_nCodec(OTASCIIArmor::CODEC_ZLIB);
+std::atomic<int32_t> OTASCIIArmor::s_nCompressionLevel(Z_BEST_COMPRESSION);
+std::atomic<uint32_t> OTASCIIArmor::s_lUncompressedBelow(0);
+
+// static
+void OTASCIIArmor::SetCompression(Codec codec, int32_t level,
+                                  uint32_t uncompressedBelow)
+{
+    if ((Z_NO_COMPRESSION > level) || (Z_BEST_COMPRESSION < level)) {
+        otErr << __FUNCTION__ << ": Invalid compression level " << level
+              << ", using " << Z_BEST_COMPRESSION << " instead.\n";
+        level = Z_BEST_COMPRESSION;
+    }
+
+#ifndef OT_ARMOR_LZ4
+    if (CODEC_LZ4 == codec) {
+        otErr << __FUNCTION__ << ": This build has no LZ4 support, using zlib "
+              << "instead.\n";
+        codec = CODEC_ZLIB;
+    }
+#endif
+
+    s_nCodec.store(codec);
+    s_nCompressionLevel.store(level);
+    s_lUncompressedBelow.store(uncompressedBelow);
+}
+
 // Let's say you don't know if the input string is raw base64, or if it has
 // bookends
 // on it like -----BEGIN BLAH BLAH ...
@@ -179,12 +227,155 @@ OTASCIIArmor& OTASCIIArmor::operator=(const OTASCIIArmor& strValue)
     return *this;
 }
 
-// Source for these two functions: http://panthema.net/2007/0328-ZLibString.html
+// The encode and decode paths work in per-thread buffers which are reused
+// from one call to the next. A buffer which grew past this size is released
+// after use, so one huge message doesn't pin memory in every thread.
+static const size_t ARMOR_BUFFER_RETAIN = 4 * 1024 * 1024;
+
+template <class T> static void trim_buffer(T& buffer)
+{
+    if (ARMOR_BUFFER_RETAIN < buffer.capacity()) { T().swap(buffer); }
+}
+
+#ifdef OT_ARMOR_LZ4
+/** Compress binary data into a headed LZ4 block. */
+static void lz4_compress_buffer(const char* data, size_t size,
+                                std::string& output)
+{
+    const size_t offset = ARMOR_HEADER_SIZE + ARMOR_LZ4_SIZE_BYTES;
+    const int bound = LZ4_compressBound(static_cast<int>(size));
+
+    output.resize(offset + static_cast<size_t>(bound));
+    output[0] = ARMOR_HEADER_MARKER;
+    output[1] = ARMOR_HEADER_VERSION;
+    output[2] = static_cast<char>(OTASCIIArmor::CODEC_LZ4);
+
+    for (size_t i = 0; i < ARMOR_LZ4_SIZE_BYTES; ++i) {
+        output[ARMOR_HEADER_SIZE + i] = static_cast<char>(size >> (8 * i));
+    }
+
+    const int written = LZ4_compress_default(
+        data, &output[offset], static_cast<int>(size), bound);
+
+    if (0 >= written) {
+        throw(std::runtime_error("LZ4 compression failed."));
+    }
+
+    output.resize(offset + static_cast<size_t>(written));
+}
+
+/** Decompress a headed LZ4 block. */
+static void lz4_decompress_buffer(const uint8_t* data, size_t size,
+                                  std::string& output)
+{
+    if (ARMOR_LZ4_SIZE_BYTES > size) {
+        throw(std::runtime_error("Truncated LZ4 header."));
+    }
+
+    size_t expected = 0;
+
+    for (size_t i = 0; i < ARMOR_LZ4_SIZE_BYTES; ++i) {
+        expected |= static_cast<size_t>(data[i]) << (8 * i);
+    }
+
+    const size_t compressed = size - ARMOR_LZ4_SIZE_BYTES;
+
+    // No LZ4 block expands by more than 255 to 1, so a larger size is a lie
+    if ((static_cast<size_t>(LZ4_MAX_INPUT_SIZE) < expected) ||
+        (255 * compressed + 16 < expected)) {
+        throw(std::runtime_error("Invalid LZ4 size."));
+    }
+
+    output.resize(expected);
+
+    const int read = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(data + ARMOR_LZ4_SIZE_BYTES),
+        &output[0], static_cast<int>(compressed),
+        static_cast<int>(expected));
+
+    if ((0 > read) || (expected != static_cast<size_t>(read))) {
+        throw(std::runtime_error("Invalid LZ4 block."));
+    }
+}
+#endif
+
+/** Compress binary data according to the current compression policy. */
+void OTASCIIArmor::compress_buffer(const char* data, size_t size,
+                                   std::string& output) const
+{
+    const int32_t codec = s_nCodec.load();
+
+    if (CODEC_STORED == codec) {
+        output.clear();
+        output.reserve(ARMOR_HEADER_SIZE + size);
+        output.push_back(ARMOR_HEADER_MARKER);
+        output.push_back(ARMOR_HEADER_VERSION);
+        output.push_back(static_cast<char>(CODEC_STORED));
+        output.append(data, size);
+
+        return;
+    }
+
+#ifdef OT_ARMOR_LZ4
+    if ((CODEC_LZ4 == codec) &&
+        (static_cast<size_t>(LZ4_MAX_INPUT_SIZE) >= size)) {
+        lz4_compress_buffer(data, size, output);
+
+        return;
+    }
+#endif
+
+    const int32_t compressionlevel =
+        (size < s_lUncompressedBelow.load()) ? Z_NO_COMPRESSION
+                                             : s_nCompressionLevel.load();
+
+    deflate_buffer(data, size, compressionlevel, output);
+}
+
+/** Decompress binary data written by compress_buffer, by this version or any
+ * earlier one. */
+void OTASCIIArmor::decompress_buffer(const uint8_t* data, size_t size,
+                                     std::string& output) const
+{
+    if ((0 == size) || (ARMOR_HEADER_MARKER != static_cast<char>(data[0]))) {
+        inflate_buffer(data, size, output);
+
+        return;
+    }
+
+    if ((ARMOR_HEADER_SIZE > size) ||
+        (ARMOR_HEADER_VERSION != static_cast<char>(data[1]))) {
+        throw(std::runtime_error("Unsupported armor header version."));
+    }
+
+    switch (static_cast<int32_t>(data[2])) {
+    case CODEC_ZLIB:
+        inflate_buffer(data + ARMOR_HEADER_SIZE, size - ARMOR_HEADER_SIZE,
+                       output);
+        break;
+    case CODEC_STORED:
+        output.assign(reinterpret_cast<const char*>(data + ARMOR_HEADER_SIZE),
+                      size - ARMOR_HEADER_SIZE);
+        break;
+    case CODEC_LZ4:
+#ifdef OT_ARMOR_LZ4
+        lz4_decompress_buffer(data + ARMOR_HEADER_SIZE,
+                              size - ARMOR_HEADER_SIZE, output);
+        break;
+#else
+        throw(std::runtime_error("This build can't decode LZ4 armor."));
+#endif
+    default:
+        throw(std::runtime_error("Unsupported armor codec."));
+    }
+}
+
+// Originally based on: http://panthema.net/2007/0328-ZLibString.html
 
-/** Compress a STL string using zlib with given compression level and return
- * the binary data. */
-std::string OTASCIIArmor::compress_string(
-    const std::string& str, int32_t compressionlevel = Z_BEST_COMPRESSION) const
+/** Compress binary data using zlib with given compression level. */
+void OTASCIIArmor::deflate_buffer(const char* data, size_t size,
+                                  int32_t compressionlevel,
+                                  std::string& output) const
 {
     z_stream zs; // z_stream is zlib's control structure
     memset(&zs, 0, sizeof(zs));
@@ -192,25 +383,16 @@ std::string OTASCIIArmor::compress_string(
     if (deflateInit(&zs, compressionlevel) != Z_OK)
         throw(std::runtime_error("deflateInit failed while compressing."));
 
-    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(str.data()));
-    zs.avail_in = static_cast<uInt>(str.size()); // set the z_stream's input
+    // deflateBound gives the worst case up front, so this is a single pass.
+    output.resize(deflateBound(&zs, static_cast<uLong>(size)));
 
-    int32_t ret;
-    char outbuffer[32768];
-    std::string outstring;
-
-    // retrieve the compressed bytes blockwise
-    do {
-        zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = static_cast<uInt>(size); // set the z_stream's input
+    zs.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    zs.avail_out = static_cast<uInt>(output.size());
 
-        ret = deflate(&zs, Z_FINISH);
-
-        if (outstring.size() < zs.total_out) {
-            // append the block to the output string
-            outstring.append(outbuffer, zs.total_out - outstring.size());
-        }
-    } while (ret == Z_OK);
+    const int32_t ret = deflate(&zs, Z_FINISH);
+    const size_t total = zs.total_out;
 
     deflateEnd(&zs);
 
@@ -220,11 +402,12 @@ std::string OTASCIIArmor::compress_string(
         throw(std::runtime_error(oss.str()));
     }
 
-    return outstring;
+    output.resize(total);
 }
 
-/** Decompress an STL string using zlib and return the original data. */
-std::string OTASCIIArmor::decompress_string(const std::string& str) const
+/** Decompress binary data using zlib. */
+void OTASCIIArmor::inflate_buffer(const uint8_t* data, size_t size,
+                                  std::string& output) const
 {
     z_stream zs; // z_stream is zlib's control structure
     memset(&zs, 0, sizeof(zs));
@@ -232,24 +415,26 @@ std::string OTASCIIArmor::decompress_string(const std::string& str) const
     if (inflateInit(&zs) != Z_OK)
         throw(std::runtime_error("inflateInit failed while decompressing."));
 
-    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(str.data()));
-    zs.avail_in = static_cast<uInt>(str.size());
+    zs.next_in = const_cast<Bytef*>(data);
+    zs.avail_in = static_cast<uInt>(size);
 
+    // The inflated size isn't recorded in a zlib stream, so reserve a guess
+    // and let the string grow geometrically past it. Inflating through a
+    // chunk means the output is never zero-filled ahead of the data.
+    output.clear();
+    output.reserve(4 * size + 64);
+
+    Bytef chunk[OT_ARMOR_INFLATE_CHUNK];
     int32_t ret;
-    char outbuffer[32768];
-    std::string outstring;
 
-    // get the decompressed bytes blockwise using repeated calls to inflate
     do {
-        zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
-
-        ret = inflate(&zs, 0);
+        zs.next_out = chunk;
+        zs.avail_out = sizeof(chunk);
 
-        if (outstring.size() < zs.total_out) {
-            outstring.append(outbuffer, zs.total_out - outstring.size());
-        }
+        ret = inflate(&zs, Z_NO_FLUSH);
 
+        output.append(reinterpret_cast<const char*>(chunk),
+                      sizeof(chunk) - zs.avail_out);
     } while (ret == Z_OK);
 
     inflateEnd(&zs);
@@ -262,8 +447,30 @@ std::string OTASCIIArmor::decompress_string(const std::string& str) const
         }
         throw(std::runtime_error(oss.str()));
     }
+}
 
-    return outstring;
+bool OTASCIIArmor::decode_base64(std::vector<uint8_t>& output,
+                                 bool bLineBreaks) const
+{
+    auto& util = App::Me().Crypto().Util();
+
+    // Some versions of OpenSSL will handle input without line breaks when
+    // bLineBreaks is true, other versions of OpenSSL will return a
+    // zero-length output.
+    //
+    // Functions which call this method do not always know the correct value
+    // for bLineBreaks, since the input may be too short to warrant a line
+    // break.
+    //
+    // To make this function less fragile, if the first attempt does not
+    // result in the expected output, try again with the opposite value set
+    // for bLineBreaks.
+    if (util.Base64Decode(Get(), GetLength(), output, bLineBreaks)) {
+
+        return true;
+    }
+
+    return util.Base64Decode(Get(), GetLength(), output, !bLineBreaks);
 }
 
 // Base64-decode
@@ -274,26 +481,16 @@ bool OTASCIIArmor::GetData(OTData& theData,
 
     if (GetLength() < 1) return true;
 
-    size_t outSize = 0;
-    uint8_t* pData = App::Me().Crypto().Util().Base64Decode(Get(), &outSize, bLineBreaks);
+    thread_local std::vector<uint8_t> decoded;
 
-    // Some versions of OpenSSL will handle input without line breaks when bLineBreaks is true,
-    // other versions of OpenSSL will return a zero-length output.
-    //
-    // Functions which call this method do not always know the correct value for bLineBreaks, since
-    // the input may be too short to warrant a line break.
-    //
-    // To make this funciton less fragile, if the first attempt does not result in the expected
-    // output, try again with the opposite value set for bLineBreaks.
-    if (!pData||(0==outSize)) {
-        pData = App::Me().Crypto().Util().Base64Decode(Get(), &outSize, !bLineBreaks);
-        if (!pData||(0==outSize)) {
-            otErr << __FUNCTION__ << "Base64Decode fail\n";
-            return false;
-        }
+    if (!decode_base64(decoded, bLineBreaks)) {
+        otErr << __FUNCTION__ << "Base64Decode fail\n";
+        trim_buffer(decoded);
+        return false;
     }
-    theData.Assign(pData, outSize);
-    delete[] pData;
+
+    theData.Assign(decoded.data(), static_cast<uint32_t>(decoded.size()));
+    trim_buffer(decoded);
     return true;
 }
 
@@ -318,7 +515,7 @@ bool OTASCIIArmor::SetData(const OTData& theData, bool bLineBreaks)
     return true;
 }
 
-// Base64-decode an decompress
+// Base64-decode and decompress
 bool OTASCIIArmor::GetString(String& strData,
                              bool bLineBreaks) const // bLineBreaks=true
 {
@@ -328,30 +525,52 @@ bool OTASCIIArmor::GetString(String& strData,
         return true;
     }
 
-    size_t outSize = 0;
-    uint8_t* pData = App::Me().Crypto().Util().Base64Decode(Get(), &outSize, bLineBreaks);
+    thread_local std::string decompressed;
 
-    if (!pData) {
-        otErr << __FUNCTION__ << "Base64Decode fail\n";
+    if (!GetString(decompressed, bLineBreaks)) {
+        trim_buffer(decompressed);
         return false;
     }
 
-    std::string str_decoded(pData, pData + outSize);
+    strData.Set(decompressed.c_str(),
+                static_cast<uint32_t>(decompressed.length()));
+    trim_buffer(decompressed);
 
-    delete[] pData;
+    return true;
+}
+
+// Base64-decode and decompress into a reusable buffer
+bool OTASCIIArmor::GetString(std::string& output,
+                             bool bLineBreaks) const // bLineBreaks=true
+{
+    output.clear();
+
+    if (GetLength() < 1) {
+        return true;
+    }
+
+    thread_local std::vector<uint8_t> decoded;
+
+    if (!decode_base64(decoded, bLineBreaks)) {
+        otErr << __FUNCTION__ << "Base64Decode fail\n";
+        trim_buffer(decoded);
+        return false;
+    }
+
+    bool success = true;
 
-    std::string str_uncompressed;
     try {
-        str_uncompressed = decompress_string(str_decoded);
+        decompress_buffer(decoded.data(), decoded.size(), output);
     }
     catch (const std::runtime_error&) {
         otErr << __FUNCTION__ << ": decompress failed\n";
-        return false;
+        output.clear();
+        success = false;
     }
 
-    strData.Set(str_uncompressed.c_str(), str_uncompressed.length());
+    trim_buffer(decoded);
 
-    return true;
+    return success;
 }
 
 // Compress and Base64-encode
@@ -361,18 +580,20 @@ bool OTASCIIArmor::SetString(const String& strData, bool bLineBreaks) //=true
 
     if (strData.GetLength() < 1) return true;
 
-    std::string stdstring = std::string(strData.Get());
-    std::string str_compressed = compress_string(stdstring);
+    thread_local std::string compressed;
+    compress_buffer(strData.Get(), strData.GetLength(), compressed);
 
     // "Success"
-    if (str_compressed.size() == 0) {
+    if (compressed.size() == 0) {
         otErr << "OTASCIIArmor::" << __FUNCTION__ << ": compression fail 0.\n";
         return false;
     }
 
     char* pString = App::Me().Crypto().Util().Base64Encode(
-        reinterpret_cast<const uint8_t*>((str_compressed.data())),
-        static_cast<int32_t>(str_compressed.size()), bLineBreaks);
+        reinterpret_cast<const uint8_t*>((compressed.data())),
+        static_cast<int32_t>(compressed.size()), bLineBreaks);
+
+    trim_buffer(compressed);
 
     if (!pString) {
         otErr << "OTASCIIArmor::" << __FUNCTION__ << ": Base64Encode fail.\n";
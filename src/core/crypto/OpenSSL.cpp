@@ -479,6 +479,43 @@ uint8_t* OpenSSL::Base64Decode(const char* input, size_t* out_len,
     return buf;
 }
 
+bool OpenSSL::Base64Decode(const char* input, size_t in_len,
+                           std::vector<uint8_t>& output,
+                           bool bLineBreaks) const
+{
+    OT_ASSERT(nullptr != input);
+
+    const int32_t out_max_len = static_cast<int32_t>((in_len * 6 + 7) / 8);
+    output.resize(out_max_len);
+
+    if (0 == out_max_len) return false;
+
+    int32_t read = 0;
+    OpenSSL_BIO b64 = BIO_new(BIO_f_base64());
+
+    if (b64) {
+        if (!bLineBreaks) BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
+
+        OpenSSL_BIO bmem = BIO_new_mem_buf(const_cast<char*>(input),
+                                           static_cast<int32_t>(in_len));
+        OT_ASSERT(nullptr != bmem);
+
+        OpenSSL_BIO b64join = BIO_push(b64, bmem);
+        b64.release();
+        bmem.release();
+        OT_ASSERT(nullptr != b64join);
+
+        read = BIO_read(b64join, output.data(), out_max_len);
+    }
+    else {
+        OT_FAIL_MSG("Failed creating new Bio in base64_decode.\n");
+    }
+
+    output.resize((0 < read) ? read : 0);
+
+    return (0 < read);
+}
+
 // Decode formatted OT ID to the binary hash ID.
 void OpenSSL::SetIDFromEncoded(const String& strInput,
                                      Identifier& theOutput) const
@@ -48,7 +48,9 @@
 
 #include <irrxml/irrXML.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 // return -1 if error, 0 if nothing, and 1 if the node was processed.
 
@@ -1501,6 +1503,76 @@ bool OTPaymentPlan::ProcessCron()
     return true;
 }
 
+// Mirrors the checks in ProcessCron(): the plan sleeps until its next payment
+// (or retry, or expiry) is due, rather than being looked at every interval.
+time64_t OTPaymentPlan::GetNextWakeTime()
+{
+    const time64_t tThrottle = ot_super::GetNextWakeTime();
+    const time64_t tWake = WakeWhenValid(tThrottle);
+
+    if (IsFlaggedForRemoval() || (tWake != tThrottle)) return tWake;
+
+    // Nothing left to do but be removed.
+    if (HasInitialPayment() && IsInitialPaymentDone() && !HasPaymentPlan())
+        return tWake;
+
+    std::vector<time64_t> vecEvents;
+
+    if (GetValidTo() > OT_TIME_ZERO) vecEvents.push_back(GetValidTo());
+
+    if (HasInitialPayment() && !IsInitialPaymentDone()) {
+        time64_t tInitial = OTTimeAddTimeInterval(GetInitialPaymentDate(), 1);
+
+        if (OT_TIME_ZERO != GetLastFailedInitialPaymentDate())
+            tInitial = std::max(
+                tInitial, OTTimeAddTimeInterval(
+                              GetLastFailedInitialPaymentDate(),
+                              OTTimeGetSecondsFromTime(OT_TIME_DAY_IN_SECONDS) +
+                                  1));
+
+        vecEvents.push_back(tInitial);
+    }
+
+    if (HasPaymentPlan()) {
+        const time64_t tStart = GetPaymentPlanStartDate();
+        const int64_t lBetween =
+            OTTimeGetSecondsFromTime(GetTimeBetweenPayments());
+
+        // Can't predict anything here; fall back to the interval.
+        if (lBetween <= 0) return tWake;
+
+        if (GetPaymentPlanLength() > OT_TIME_ZERO)
+            vecEvents.push_back(OTTimeAddTimeInterval(
+                tStart, OTTimeGetSecondsFromTime(GetPaymentPlanLength())));
+
+        time64_t tPayment = OTTimeAddTimeInterval(tStart, 1);
+
+        if ((GetMaximumNoPayments() <= 0) ||
+            (GetNoPaymentsDone() < GetMaximumNoPayments())) {
+            tPayment = std::max(
+                tPayment,
+                OTTimeAddTimeInterval(tStart, GetNoPaymentsDone() * lBetween));
+            tPayment = std::max(
+                tPayment,
+                OTTimeAddTimeInterval(GetDateOfLastPayment(), lBetween));
+
+            if (OT_TIME_ZERO != GetDateOfLastFailedPayment())
+                tPayment = std::max(
+                    tPayment,
+                    OTTimeAddTimeInterval(
+                        GetDateOfLastFailedPayment(),
+                        OTTimeGetSecondsFromTime(OT_TIME_DAY_IN_SECONDS)));
+        }
+
+        vecEvents.push_back(tPayment);
+    }
+
+    if (vecEvents.empty()) return tWake;
+
+    return std::max(tWake,
+                    *std::min_element(vecEvents.begin(), vecEvents.end()));
+}
+
 void OTPaymentPlan::InitPaymentPlan()
 {
     m_strContractType = "PAYMENT PLAN";
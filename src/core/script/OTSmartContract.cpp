@@ -524,6 +524,7 @@ various sequence numbers. Hm.
 #include <opentxs/core/script/OTScript.hpp>
 #endif
 
+#include <algorithm>
 #include <memory>
 
 #ifndef SMART_CONTRACT_PROCESS_INTERVAL
@@ -990,6 +991,10 @@ void OTSmartContract::SetRemainingTimer(
             SetNextProcessDate(OT_TIME_ZERO); // This way, you can deactivate
                                               // the timer, by setting the next
                                               // process date to 0.
+
+        // The script may have been triggered from outside of Cron, so let it
+        // know the timer changed.
+        if (nullptr != GetCron()) GetCron()->RescheduleItem(*this);
     }
 }
 
@@ -3644,6 +3649,37 @@ bool OTSmartContract::ProcessCron()
 }
 
 // virtual
+// Mirrors the checks in ProcessCron(): a contract with a timer sleeps until
+// it fires, and one without a timer or a cron_process hook only needs
+// processing when it expires.
+time64_t OTSmartContract::GetNextWakeTime()
+{
+    const time64_t tThrottle = ot_super::GetNextWakeTime();
+    const time64_t tWake = WakeWhenValid(tThrottle);
+
+    if (IsFlaggedForRemoval() || (tWake != tThrottle)) return tWake;
+
+    const time64_t& tNextProcessDate = GetNextProcessDate();
+
+    if (tNextProcessDate > OT_TIME_ZERO)
+        return std::max(tWake, OTTimeAddTimeInterval(tNextProcessDate, 1));
+
+    const std::string str_HookName(SMARTCONTRACT_HOOK_ON_PROCESS);
+    mapOfClauses theMatchingClauses;
+
+    if (GetHooks(str_HookName, theMatchingClauses)) return tWake;
+
+    if (GetValidTo() > OT_TIME_ZERO) return std::max(tWake, GetValidTo());
+
+    // Dormant until a party triggers a clause. (Which reschedules it, if the
+    // clause sets a timer or deactivates the contract.) Look in once a day
+    // regardless.
+    return std::max(
+        tWake, OTTimeAddTimeInterval(
+                   OTTimeGetCurrentTime(),
+                   OTTimeGetSecondsFromTime(OT_TIME_DAY_IN_SECONDS)));
+}
+
 void OTSmartContract::SetDisplayLabel(const std::string* pstrLabel)
 {
     m_strLabel.Format("smartcontract trans# %" PRId64 ", clause: %s",
@@ -1143,6 +1143,13 @@ bool OTTrade::ProcessCron()
                           // removing it for a reason.
 }
 
+// Active trades are matched against the market every processing interval,
+// since the market can change under them at any time.
+time64_t OTTrade::GetNextWakeTime()
+{
+    return WakeWhenValid(ot_super::GetNextWakeTime());
+}
+
 /*
 X OTIdentifier    currencyTypeID_;    // GOLD (Asset) is trading for DOLLARS
 (Currency).
@@ -45,16 +45,25 @@
 #endif
 #include <opentxs/core/util/StringUtils.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <cstdio>
+#include <string>
 #include <vector>
 #include <cstdlib>
 
 #include <sys/stat.h>
 
+#include <fcntl.h>
+
 #ifdef _WIN32
 #include <direct.h>
+#include <io.h>
+#include <process.h>
 #include <shlobj.h>
 #else
+#include <dirent.h>
 #include <libgen.h>
 #include <unistd.h>
 #endif
@@ -834,6 +843,143 @@ bool OTPaths::FolderExists(const String& strFolderPath)
     return false;
 }
 
+// static
+bool OTPaths::RemoveFolder(const String& strFolderPath)
+{
+    if (!strFolderPath.Exists()) return false;
+
+#ifdef _WIN32
+    return (0 == _rmdir(strFolderPath.Get()));
+#else
+    return (0 == rmdir(strFolderPath.Get()));
+#endif
+}
+
+// static
+bool OTPaths::ListFolder(const String& strFolderPath,
+                         std::vector<std::string>& out_vecNames)
+{
+    out_vecNames.clear();
+
+    if (!strFolderPath.Exists()) return false;
+
+    std::string l_strPath(strFolderPath.Get());
+
+#ifdef _WIN32
+    if ('/' != *l_strPath.rbegin() && '\\' != *l_strPath.rbegin())
+        l_strPath += "/";
+
+    struct _finddata_t fileinfo;
+    const intptr_t handle = _findfirst((l_strPath + "*").c_str(), &fileinfo);
+
+    if (-1 == handle) return false;
+
+    do {
+        const std::string name(fileinfo.name);
+
+        if (("." != name) && (".." != name)) out_vecNames.push_back(name);
+    } while (0 == _findnext(handle, &fileinfo));
+
+    _findclose(handle);
+#else
+    DIR* dir = opendir(l_strPath.c_str());
+
+    if (nullptr == dir) return false;
+
+    while (struct dirent* entry = readdir(dir)) {
+        const std::string name(entry->d_name);
+
+        if (("." != name) && (".." != name)) out_vecNames.push_back(name);
+    }
+
+    closedir(dir);
+#endif
+
+    return true;
+}
+
+// static
+bool OTPaths::SyncPath(const String& strPath)
+{
+    if (!strPath.Exists()) return false;
+
+#ifdef _WIN32
+    // Windows can't open a folder this way, and doesn't need to: a rename is
+    // made durable along with the file.
+    const int fd = _open(strPath.Get(), _O_RDWR | _O_BINARY);
+
+    if (-1 == fd) return FolderExists(strPath);
+
+    const bool bSynced = (0 == _commit(fd));
+    _close(fd);
+#else
+    const int fd = open(strPath.Get(), O_RDONLY);
+
+    if (-1 == fd) return false;
+
+    const bool bSynced = (0 == fsync(fd));
+    close(fd);
+#endif
+
+    if (!bSynced) {
+        otErr << "OTPaths::" << __FUNCTION__ << ": Failed to sync " << strPath
+              << "\n";
+    }
+
+    return bSynced;
+}
+
+// static
+String OTPaths::TempPath(const String& strPath)
+{
+    static std::atomic<uint64_t> counter(0);
+
+#ifdef _WIN32
+    const int64_t pid = _getpid();
+#else
+    const int64_t pid = getpid();
+#endif
+
+    const std::string strTemp = std::string(strPath.Get()) + "." +
+                                std::to_string(pid) + "." +
+                                std::to_string(++counter) + ".tmp";
+
+    return String(strTemp.c_str());
+}
+
+// static
+bool OTPaths::ReplaceFile(const String& strFrom, const String& strTo)
+{
+    if (!strFrom.Exists() || !strTo.Exists()) return false;
+
+#ifdef _WIN32
+    // Unlike rename(), this replaces an existing file in one step, and
+    // write-through returns once the move is on the disk.
+    const bool bReplaced =
+        (0 != MoveFileExA(strFrom.Get(), strTo.Get(),
+                          MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH));
+#else
+    bool bReplaced = (0 == std::rename(strFrom.Get(), strTo.Get()));
+
+    if (bReplaced) {
+        // The rename is only durable once the folder holding it is synced.
+        std::string strFolder(strTo.Get());
+        const std::size_t slash = strFolder.find_last_of('/');
+        strFolder = (std::string::npos == slash)
+                        ? std::string(".")
+                        : strFolder.substr(0, std::max<std::size_t>(slash, 1));
+        bReplaced = SyncPath(String(strFolder.c_str()));
+    }
+#endif
+
+    if (!bReplaced) {
+        otErr << "OTPaths::" << __FUNCTION__ << ": Failed to replace " << strTo
+              << " with " << strFrom << "\n";
+    }
+
+    return bReplaced;
+}
+
 // static
 bool OTPaths::ConfirmCreateFolder(const String& strExactPath, bool& out_Exists,
                                   bool& out_IsNew)
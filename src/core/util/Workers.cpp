@@ -0,0 +1,195 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/core/stdafx.hpp>
+
+#include <opentxs/core/util/Workers.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace opentxs
+{
+namespace
+{
+
+// Threads shared by every RunWorkers call, started on first use and
+// stopped at exit. A caller waiting on its own tasks runs queued tasks
+// too, so nested calls can't starve the pool.
+class WorkerPool
+{
+private:
+    std::mutex lock_;
+    std::condition_variable wake_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+    bool stop_ = false;
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void Thread()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+
+            if (tasks_.empty()) { return; }
+
+            auto task = std::move(tasks_.front());
+            tasks_.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+public:
+    WorkerPool()
+    {
+        // The caller of RunWorkers is one of the workers
+        const std::size_t threads = WorkerCount(0) - 1;
+
+        for (std::size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back(&WorkerPool::Thread, this);
+        }
+    }
+
+    static WorkerPool& It()
+    {
+        static WorkerPool pool;
+
+        return pool;
+    }
+
+    void Push(std::function<void()> task)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        tasks_.push_back(std::move(task));
+        wake_.notify_one();
+    }
+
+    // Runs one queued task on the calling thread. False if there was none.
+    bool RunOne()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        if (tasks_.empty()) { return false; }
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+
+        return true;
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            stop_ = true;
+        }
+
+        wake_.notify_all();
+
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+};
+
+// The tasks of one RunWorkers call which haven't finished yet
+class WorkerGroup
+{
+public:
+    std::mutex lock_;
+    std::condition_variable done_;
+    std::size_t remaining_ = 0;
+};
+
+} // namespace
+
+std::size_t WorkerCount(int32_t configured)
+{
+    if (0 < configured) {
+        return static_cast<std::size_t>(configured);
+    }
+
+    const unsigned int cores = std::thread::hardware_concurrency();
+
+    // hardware_concurrency() returns 0 when it can't tell.
+    return (0 < cores) ? cores : 1;
+}
+
+void RunWorkers(std::size_t count,
+                const std::function<void(std::size_t)>& work)
+{
+    if (0 == count) { return; }
+
+    WorkerPool& pool = WorkerPool::It();
+    auto group = std::make_shared<WorkerGroup>();
+    group->remaining_ = count - 1;
+
+    for (std::size_t i = 1; i < count; ++i) {
+        pool.Push([group, &work, i]() {
+            work(i);
+
+            std::lock_guard<std::mutex> lock(group->lock_);
+
+            if (0 == --group->remaining_) { group->done_.notify_all(); }
+        });
+    }
+
+    work(0);
+
+    // Help with whatever is queued until this call's tasks are all taken,
+    // then wait for the ones still running elsewhere.
+    while (pool.RunOne()) {
+    }
+
+    std::unique_lock<std::mutex> lock(group->lock_);
+    group->done_.wait(lock, [&group]() { return 0 == group->remaining_; });
+}
+
+} // namespace opentxs
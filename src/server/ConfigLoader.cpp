@@ -171,6 +171,99 @@ bool ConfigLoader::load(String& walletFilename)
             static_cast<int32_t>(lValue));
     }
 
+    // WORKERS
+
+    {
+        const char* szComment = ";; WORKERS\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("workers", szComment, bSectionExist);
+    }
+
+    {
+        const char* szComment = "; worker_threads is the number of threads "
+                                "that decode, process and reply to\n"
+                                "; client requests.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("workers", "worker_threads",
+                                ServerSettings::GetWorkerThreads(), lValue,
+                                bIsNewKey, szComment);
+        ServerSettings::SetWorkerThreads(static_cast<int32_t>(lValue));
+    }
+
+    {
+        const char* szComment = "; token_verify_threads is the number of "
+                                "tokens verified at once\n"
+                                "; for a cash deposit. 0 means one per "
+                                "core.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("workers", "token_verify_threads",
+                                ServerSettings::GetTokenVerifyThreads(),
+                                lValue, bIsNewKey, szComment);
+        ServerSettings::SetTokenVerifyThreads(static_cast<int32_t>(lValue));
+    }
+
+    {
+        const char* szComment = "; mint_threads is the number of threads "
+                                "that generate the keys of a new\n"
+                                "; mint series. 0 means one per core.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("workers", "mint_threads",
+                                ServerSettings::GetMintThreads(), lValue,
+                                bIsNewKey, szComment);
+        ServerSettings::SetMintThreads(static_cast<int32_t>(lValue));
+    }
+
+    // CACHE
+
+    {
+        const char* szComment = ";; CACHE\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("cache", szComment, bSectionExist);
+    }
+
+    {
+        const char* szComment = "; object_cache_size is the number of "
+                                "verified nymfiles, credentials and boxes\n"
+                                "; the server keeps in memory. 0 disables "
+                                "the cache.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("cache", "object_cache_size",
+                                ServerSettings::GetObjectCacheSize(), lValue,
+                                bIsNewKey, szComment);
+        ServerSettings::SetObjectCacheSize(lValue);
+    }
+
+    // MINT
+
+    {
+        const char* szComment = ";; MINT\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("mint", szComment, bSectionExist);
+    }
+
+    {
+        const char* szComment = "; key_size is the size, in bits, of the "
+                                "keys of each new mint series.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("mint", "key_size",
+                                ServerSettings::GetMintKeySize(), lValue,
+                                bIsNewKey, szComment);
+        ServerSettings::SetMintKeySize(static_cast<int32_t>(lValue));
+    }
+
     // PERMISSIONS
 
     {
@@ -239,6 +332,21 @@ bool ConfigLoader::load(String& walletFilename)
         OTCachedKey::It()->SetTimeoutSeconds(static_cast<int32_t>(lValue));
     }
 
+    // Integrity tags
+    {
+        const char* szComment =
+            "; integrity_tags lets the server check a keyed MAC, instead of\n"
+            "; its own signature, when it loads objects it signed and saved\n"
+            "; itself. The key is sealed to the server nym in integrity.key.\n";
+
+        bool bIsNewKey;
+        bool bValue;
+        App::Me().Config().CheckSet_bool("security", "integrity_tags",
+                                ServerSettings::GetIntegrityTags(), bValue,
+                                bIsNewKey, szComment);
+        ServerSettings::SetIntegrityTags(bValue);
+    }
+
     // Use System Keyring
     {
         bool bIsNewKey;
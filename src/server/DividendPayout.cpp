@@ -0,0 +1,854 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/server/DividendPayout.hpp>
+#include <opentxs/server/OTServer.hpp>
+
+#include <opentxs/core/contract/AccountRegistry.hpp>
+#include <opentxs/core/util/OTFolders.hpp>
+#include <opentxs/core/util/OTPaths.hpp>
+#include <opentxs/core/Account.hpp>
+#include <opentxs/core/Ledger.hpp>
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/Nym.hpp>
+#include <opentxs/core/OTStorage.hpp>
+#include <opentxs/ext/OTPayment.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+// The number of share accounts read from the registry at a time
+#define DIVIDEND_PAGE_SIZE 1024
+// Lists the payouts in progress, in the receipts folder of the notary
+#define DIVIDEND_INDEX_FILE "dividends"
+// The "account" of the voucher which returns the leftovers to the payer
+#define DIVIDEND_REFUND "*"
+// Starts the last line of a complete snapshot
+#define DIVIDEND_SNAPSHOT_END "."
+
+namespace opentxs
+{
+
+std::mutex DividendPayout::index_lock_;
+std::multiset<std::string> DividendPayout::frozen_;
+
+DividendPayout::DividendPayout(
+    OTServer& server, const Identifier& notaryID, const Identifier& payerNymID,
+    const Identifier& sharesUnitID, const Identifier& payoutUnitID,
+    const Identifier& voucherAcctID, const String& memo, int64_t amountPerShare,
+    int64_t totalCost, int64_t transactionNumber)
+    : server_(server)
+    , notary_id_(notaryID)
+    , payer_nym_id_(payerNymID)
+    , shares_unit_id_(sharesUnitID)
+    , voucher_acct_id_(voucherAcctID)
+    , total_cost_(totalCost)
+    , transaction_number_(transactionNumber)
+    , vouchers_(notaryID, payerNymID, payoutUnitID, voucherAcctID, memo,
+                server, amountPerShare)
+{
+}
+
+bool DividendPayout::Frozen(const Identifier& unitID)
+{
+    return (0 < frozen_.count(String(unitID).Get()));
+}
+
+bool DividendPayout::Freezing()
+{
+    return !frozen_.empty();
+}
+
+bool DividendPayout::AddToIndex(const std::string& notaryID,
+                                const std::string& number)
+{
+    std::lock_guard<std::mutex> lock(index_lock_);
+    std::string index;
+
+    if (OTDB::Exists(OTFolders::Receipt().Get(), notaryID,
+                     DIVIDEND_INDEX_FILE)) {
+        index = OTDB::QueryPlainString(OTFolders::Receipt().Get(), notaryID,
+                                       DIVIDEND_INDEX_FILE);
+    }
+
+    std::istringstream lines(index);
+    std::string line;
+
+    while (std::getline(lines, line)) {
+        if (number == line) {
+            return true;
+        }
+    }
+
+    index += number + "\n";
+
+    return OTDB::StorePlainString(index, OTFolders::Receipt().Get(), notaryID,
+                                  DIVIDEND_INDEX_FILE);
+}
+
+bool DividendPayout::RemoveFromIndex(const std::string& notaryID,
+                                     const std::string& number)
+{
+    std::lock_guard<std::mutex> lock(index_lock_);
+
+    if (!OTDB::Exists(OTFolders::Receipt().Get(), notaryID,
+                      DIVIDEND_INDEX_FILE)) {
+        return true;
+    }
+
+    std::istringstream lines(OTDB::QueryPlainString(
+        OTFolders::Receipt().Get(), notaryID, DIVIDEND_INDEX_FILE));
+    std::string index, line;
+
+    while (std::getline(lines, line)) {
+        if (!line.empty() && (number != line)) {
+            index += line + "\n";
+        }
+    }
+
+    return OTDB::StorePlainString(index, OTFolders::Receipt().Get(), notaryID,
+                                  DIVIDEND_INDEX_FILE);
+}
+
+std::string DividendPayout::FileName(const char* suffix) const
+{
+    return "dividend-" + std::to_string(transaction_number_) + suffix;
+}
+
+bool DividendPayout::Begin()
+{
+    const std::string notaryID = String(notary_id_).Get();
+    const std::string header = FileName(".h");
+
+    if (!OTDB::Exists(OTFolders::Receipt().Get(), notaryID, header)) {
+        OT_ASSERT(nullptr != vouchers_.GetPayoutInstrumentDefinitionID());
+        OT_ASSERT(nullptr != vouchers_.GetMemo());
+
+        std::string contents;
+        contents += String(payer_nym_id_).Get() + std::string("\n");
+        contents += String(shares_unit_id_).Get() + std::string("\n");
+        contents += String(*vouchers_.GetPayoutInstrumentDefinitionID()).Get() +
+                    std::string("\n");
+        contents += String(voucher_acct_id_).Get() + std::string("\n");
+        contents += std::to_string(vouchers_.GetPayoutPerShare()) + "\n";
+        contents += std::to_string(total_cost_) + "\n";
+        contents += vouchers_.GetMemo()->Get();
+
+        if (!OTDB::StorePlainString(contents, OTFolders::Receipt().Get(),
+                                    notaryID, header)) {
+            Log::vError("%s: Failed to store checkpoint %s\n", __FUNCTION__,
+                        header.c_str());
+            return false;
+        }
+    }
+
+    return AddToIndex(notaryID, std::to_string(transaction_number_));
+}
+
+bool DividendPayout::FilePath(const char* suffix, std::string& path) const
+{
+    if (0 > OTDB::FormPathString(path, OTFolders::Receipt().Get(),
+                                 String(notary_id_).Get(), FileName(suffix))) {
+        Log::vError("%s: Failed to form path for checkpoint %s\n",
+                    __FUNCTION__, FileName(suffix).c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool DividendPayout::Append(const std::string& lines)
+{
+    std::string path;
+
+    if (!FilePath(".l", path)) {
+        return false;
+    }
+
+    std::ofstream log(path, std::ios::out | std::ios::app | std::ios::binary);
+    log << lines;
+    log.flush();
+
+    if (!log.good()) {
+        Log::vError("%s: Failed writing checkpoint %s\n", __FUNCTION__,
+                    path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+// Each line of the log is one of:
+//   ~ <account> <P|R> <amount> <voucher #> <notice #> <recipient nym>
+//   + <account> <amount paid>
+//   - <account> <amount returned>
+//   = <account>  (nothing delivered)
+bool DividendPayout::LoadCheckpoint()
+{
+    const std::string notaryID = String(notary_id_).Get();
+    const std::string logFile = FileName(".l");
+
+    if (!OTDB::Exists(OTFolders::Receipt().Get(), notaryID, logFile)) {
+        return true;
+    }
+
+    std::istringstream log(
+        OTDB::QueryPlainString(OTFolders::Receipt().Get(), notaryID, logFile));
+    std::string line;
+
+    while (std::getline(log, line)) {
+        std::istringstream fields(line);
+        std::string operation, account;
+        fields >> operation >> account;
+
+        if (account.empty()) {
+            continue;
+        }
+
+        if ("~" == operation) {
+            Pending& pending = pending_[account];
+            fields >> pending.kind_ >> pending.amount_ >>
+                pending.voucher_number_ >> pending.notice_number_ >>
+                pending.recipient_;
+
+            if (fields.fail()) {
+                pending_.erase(account);
+            }
+        } else if ("+" == operation || "-" == operation) {
+            int64_t amount = 0;
+            fields >> amount;
+
+            if ("+" == operation) {
+                paid_ += amount;
+            } else {
+                returned_ += amount;
+            }
+
+            pending_.erase(account);
+            completed_.insert(account);
+        } else if ("=" == operation) {
+            pending_.erase(account);
+            completed_.insert(account);
+        }
+    }
+
+    refunded_ = (0 < completed_.count(DIVIDEND_REFUND));
+
+    return true;
+}
+
+bool DividendPayout::Delivered(const Pending& pending) const
+{
+    const Identifier recipient(pending.recipient_.c_str());
+    Ledger theNymbox(recipient, recipient, notary_id_);
+
+    if (theNymbox.LoadNymbox() &&
+        (nullptr != theNymbox.GetTransaction(pending.notice_number_))) {
+        return true;
+    }
+
+    // Once a voucher has been deposited, its number is no longer issued to
+    // the server nym.
+    return !server_.GetServerNym().VerifyIssuedNum(server_.m_strNotaryID,
+                                                   pending.voucher_number_);
+}
+
+// Settles the vouchers which were about to be delivered when the server
+// stopped. Those which did not arrive are cancelled, and their accounts will
+// be paid again.
+bool DividendPayout::ResolvePending()
+{
+    Nym& theServerNym = server_.m_nymServer;
+    std::string lines;
+    bool cancelled = false;
+
+    for (auto& it : pending_) {
+        const std::string& account = it.first;
+        const Pending& pending = it.second;
+
+        if (Delivered(pending)) {
+            if ('P' == pending.kind_) {
+                lines += "+ " + account + " " +
+                         std::to_string(pending.amount_) + "\n";
+                paid_ += pending.amount_;
+            } else {
+                lines += "- " + account + " " +
+                         std::to_string(pending.amount_) + "\n";
+                returned_ += pending.amount_;
+            }
+
+            completed_.insert(account);
+        } else {
+            server_.transactor_.removeTransactionNumber(
+                theServerNym, pending.voucher_number_);
+            server_.transactor_.removeIssuedNumber(theServerNym,
+                                                   pending.voucher_number_);
+            cancelled = true;
+        }
+    }
+
+    pending_.clear();
+    refunded_ = (0 < completed_.count(DIVIDEND_REFUND));
+
+    if (cancelled) {
+        theServerNym.SaveSignedNymfile(theServerNym);
+    }
+
+    return lines.empty() || Append(lines);
+}
+
+bool DividendPayout::Deliver(const Identifier& recipient, const char kind,
+                             std::vector<Delivery>& batch)
+{
+    const String strRecipient(recipient);
+    const Identifier theServerNymID(server_.GetServerNym());
+    std::vector<std::unique_ptr<OTPayment>> payments;
+    std::vector<const OTPayment*> instruments;
+    std::vector<int64_t> notices;
+    std::string lines;
+
+    for (auto& delivery : batch) {
+        if (!vouchers_.IssueVoucher(delivery.amount_, delivery.voucher_number_,
+                                    recipient, delivery.voucher_)) {
+            return false;
+        }
+
+        payments.emplace_back(new OTPayment(delivery.voucher_));
+        instruments.push_back(payments.back().get());
+        notices.push_back(delivery.notice_number_);
+        lines += std::string("~ ") + delivery.account_ + " " + kind + " " +
+                 std::to_string(delivery.amount_) + " " +
+                 std::to_string(delivery.voucher_number_) + " " +
+                 std::to_string(delivery.notice_number_) + " " +
+                 strRecipient.Get() + "\n";
+    }
+
+    // Nothing is delivered unless it can be found again after a restart.
+    if (!Append(lines)) {
+        return false;
+    }
+
+    if (!server_.SendInstrumentsToNym(notary_id_, theServerNymID, recipient,
+                                      instruments, notices, "payDividend")) {
+        return false;
+    }
+
+    lines.clear();
+
+    for (auto& delivery : batch) {
+        if ('P' == kind) {
+            paid_ += delivery.amount_;
+            lines += "+ ";
+        } else {
+            returned_ += delivery.amount_;
+            lines += "- ";
+        }
+
+        lines += delivery.account_ + " " + std::to_string(delivery.amount_) +
+                 "\n";
+    }
+
+    // If this fails the vouchers are still found in the nymbox on resume.
+    Append(lines);
+
+    return true;
+}
+
+bool DividendPayout::SnapshotComplete(std::size_t& total) const
+{
+    std::string path;
+
+    if (!FilePath(".s", path)) {
+        return false;
+    }
+
+    std::ifstream snapshot(path, std::ios::in | std::ios::binary);
+    std::string line;
+
+    while (std::getline(snapshot, line)) {
+        if (0 == line.compare(0, 2, DIVIDEND_SNAPSHOT_END " ")) {
+            total = static_cast<std::size_t>(
+                std::strtoull(line.c_str() + 2, nullptr, 10));
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The unit is thawed however the snapshot ends. A snapshot which doesn't
+// complete is taken again from the start.
+bool DividendPayout::Snapshot(std::size_t& total,
+                              std::unique_lock<std::mutex>* lock)
+{
+    auto frozen = frozen_.insert(String(shares_unit_id_).Get());
+    const bool recorded = RecordShares(total, lock);
+    frozen_.erase(frozen);
+
+    return recorded;
+}
+
+bool DividendPayout::RecordShares(std::size_t& total,
+                                  std::unique_lock<std::mutex>* lock)
+{
+    const std::string unitID = String(shares_unit_id_).Get();
+    std::string path;
+
+    if (!FilePath(".s", path)) {
+        return false;
+    }
+
+    std::ofstream snapshot(path,
+                           std::ios::out | std::ios::trunc | std::ios::binary);
+    AccountRegistry::AccountList page;
+    std::string after;
+    total = 0;
+
+    while (true) {
+        if (!AccountRegistry::Page(unitID, after, DIVIDEND_PAGE_SIZE, page)) {
+            Log::vError("%s: Error: failed loading account records for "
+                        "instrument definition: %s\n",
+                        __FUNCTION__, unitID.c_str());
+            return false;
+        }
+
+        if (page.empty()) {
+            break;
+        }
+
+        after = page.back();
+
+        for (auto& account : page) {
+            const Identifier theAccountID(account.c_str());
+            std::unique_ptr<Account> pAccount(
+                Account::LoadExistingAccount(theAccountID, notary_id_));
+
+            // The owner of an account which can't be loaded isn't paid, and
+            // the leftovers are refunded to the payer.
+            if (!pAccount) {
+                Log::vError("%s: Error: Failed Loading Account %s\n",
+                            __FUNCTION__, account.c_str());
+                continue;
+            }
+
+            const int64_t amount =
+                pAccount->GetBalance() * vouchers_.GetPayoutPerShare();
+
+            // nothing to pay, since this account owns no shares.
+            if (0 >= amount) {
+                continue;
+            }
+
+            snapshot << account << " " << String(pAccount->GetNymID()).Get()
+                     << " " << amount << "\n";
+            ++total;
+        }
+
+        if (!Pause(lock)) {
+            return false;
+        }
+    }
+
+    snapshot << DIVIDEND_SNAPSHOT_END " " << total << "\n";
+    snapshot.close();
+
+    if (snapshot.fail() || !OTPaths::SyncPath(String(path.c_str()))) {
+        Log::vError("%s: Failed writing checkpoint %s\n", __FUNCTION__,
+                    path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool DividendPayout::ReadPage(std::istream& snapshot,
+                              std::vector<Share>& page) const
+{
+    page.clear();
+    std::string line;
+
+    while ((DIVIDEND_PAGE_SIZE > page.size()) && std::getline(snapshot, line)) {
+        if (0 == line.compare(0, 2, DIVIDEND_SNAPSHOT_END " ")) {
+            break;
+        }
+
+        std::istringstream fields(line);
+        Share share;
+        fields >> share.account_ >> share.owner_ >> share.amount_;
+
+        if (fields.fail()) {
+            Log::vError("%s: Malformed line in checkpoint %s\n", __FUNCTION__,
+                        FileName(".s").c_str());
+            return false;
+        }
+
+        page.push_back(share);
+    }
+
+    return true;
+}
+
+bool DividendPayout::PayPage(const std::vector<Share>& page)
+{
+    Nym& theServerNym = server_.m_nymServer;
+    // Each owner gets all of their vouchers from the page in a single
+    // nymbox write.
+    std::map<std::string, std::vector<Delivery>> batches;
+    std::size_t count = 0;
+
+    for (auto& share : page) {
+        ++processed_;
+
+        if (0 < completed_.count(share.account_)) {
+            continue;
+        }
+
+        Delivery delivery;
+        delivery.account_ = share.account_;
+        delivery.amount_ = share.amount_;
+        batches[share.owner_].push_back(delivery);
+        ++count;
+    }
+
+    if (0 == count) {
+        return true;
+    }
+
+    // We save the voucher numbers on the server Nym (normally we'd discard
+    // them) because when a cheque is deposited, the server nym, as the owner
+    // of the voucher account, needs to verify the transaction # on the cheque
+    // (to prevent double-spending of cheques.) The notice numbers are only
+    // for the nymbox.
+    std::vector<int64_t> voucherNumbers, noticeNumbers;
+
+    if (!server_.transactor_.issueTransactionNumbersToNym(theServerNym, count,
+                                                          voucherNumbers) ||
+        !server_.transactor_.issueTransactionNumbers(count, noticeNumbers)) {
+        Log::vError("%s: ERROR!! Failed issuing transaction numbers while "
+                    "paying dividends to %" PRId64 " accounts. They will be "
+                    "refunded to the payer.\n",
+                    __FUNCTION__, static_cast<int64_t>(count));
+        return false;
+    }
+
+    std::size_t next = 0;
+
+    for (auto& it : batches) {
+        const Identifier recipient(it.first.c_str());
+        std::vector<Delivery>& batch = it.second;
+
+        for (auto& delivery : batch) {
+            delivery.voucher_number_ = voucherNumbers[next];
+            delivery.notice_number_ = noticeNumbers[next];
+            ++next;
+        }
+
+        if (Deliver(recipient, 'P', batch)) {
+            continue;
+        }
+
+        // If we didn't send them, then we need to return the funds to where
+        // they came from. The vouchers were never delivered, so their numbers
+        // can be used again, but each nymbox notice needs a new number.
+        Log::vError("%s: ERROR failed sending dividend vouchers to Nym %s. "
+                    "Returning them to the payer.\n",
+                    __FUNCTION__, it.first.c_str());
+        std::vector<int64_t> returnNotices;
+        bool returned = server_.transactor_.issueTransactionNumbers(
+            batch.size(), returnNotices);
+
+        if (returned) {
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                batch[i].notice_number_ = returnNotices[i];
+            }
+
+            returned = Deliver(payer_nym_id_, 'R', batch);
+        }
+
+        if (!returned) {
+            const String strPayerNymID(payer_nym_id_);
+            Log::vError("%s: ERROR failed returning dividend vouchers to the "
+                        "payout initiator %s. They will be refunded with the "
+                        "leftovers.\n",
+                        __FUNCTION__, strPayerNymID.Get());
+            std::string lines;
+
+            for (auto& delivery : batch) {
+                lines += "= " + delivery.account_ + "\n";
+            }
+
+            Append(lines);
+        }
+    }
+
+    return true;
+}
+
+void DividendPayout::ReportProgress(const std::size_t total) const
+{
+    const std::size_t processed = processed_;
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start_)
+                               .count();
+    const double rate = (0 < seconds) ? processed / seconds : 0;
+    const int64_t remaining =
+        ((0 < rate) && (processed < total))
+            ? static_cast<int64_t>((total - processed) / rate)
+            : 0;
+
+    Log::vOutput(0, "%s: Dividend %" PRId64 ": %" PRId64 " of %" PRId64
+                    " accounts, %" PRId64 " paid out, %.1f accounts/s, "
+                    "about %" PRId64 "s remaining.\n",
+                 __FUNCTION__, transaction_number_,
+                 static_cast<int64_t>(processed), static_cast<int64_t>(total),
+                 paid_, rate, remaining);
+}
+
+bool DividendPayout::Pause(std::unique_lock<std::mutex>* lock) const
+{
+    if (nullptr == lock) {
+        return true;
+    }
+
+    lock->unlock();
+    std::this_thread::yield();
+    lock->lock();
+
+    if (!server_.payout_running_.load()) {
+        Log::vOutput(0, "%s: Dividend %" PRId64 " interrupted. It will be "
+                        "resumed at the next start.\n",
+                     __FUNCTION__, transaction_number_);
+        return false;
+    }
+
+    return true;
+}
+
+// Of the total amount removed from the sender's account, and after paying all
+// dividends, whatever wasn't paid to anybody is returned to the sender.
+bool DividendPayout::RefundLeftovers()
+{
+    const int64_t leftovers = total_cost_ - (paid_ + returned_);
+
+    if (0 >= leftovers) {
+        return true;
+    }
+
+    Log::vOutput(0, "%s: After dividend payout, with %" PRId64
+                    " units removed initially, there were %" PRId64
+                    " units remaining. (Returning them to sender...)\n",
+                 __FUNCTION__, total_cost_, leftovers);
+
+    Nym& theServerNym = server_.m_nymServer;
+    std::vector<Delivery> batch(1);
+    batch[0].account_ = DIVIDEND_REFUND;
+    batch[0].amount_ = leftovers;
+
+    if (server_.transactor_.issueNextTransactionNumberToNym(
+            theServerNym, batch[0].voucher_number_) &&
+        server_.transactor_.issueNextTransactionNumber(
+            batch[0].notice_number_) &&
+        Deliver(payer_nym_id_, 'R', batch)) {
+        refunded_ = true;
+
+        return true;
+    }
+
+    const String strPayerNymID(payer_nym_id_);
+    Log::vError("%s: ERROR failed returning leftovers back to the dividend "
+                "payout initiator. WAS TRYING TO PAY %" PRId64
+                " to Nym %s. Will try again when the server restarts.\n",
+                __FUNCTION__, leftovers, strPayerNymID.Get());
+
+    return false;
+}
+
+void DividendPayout::Erase()
+{
+    const std::string notaryID = String(notary_id_).Get();
+
+    OTDB::EraseValueByKey(OTFolders::Receipt().Get(), notaryID,
+                          FileName(".l"));
+    OTDB::EraseValueByKey(OTFolders::Receipt().Get(), notaryID,
+                          FileName(".s"));
+    OTDB::EraseValueByKey(OTFolders::Receipt().Get(), notaryID,
+                          FileName(".h"));
+    RemoveFromIndex(notaryID, std::to_string(transaction_number_));
+}
+
+bool DividendPayout::Run(std::unique_lock<std::mutex>* lock)
+{
+    if (!LoadCheckpoint() || !ResolvePending()) {
+        Log::vError("%s: Failed to load checkpoint for dividend %" PRId64
+                    "\n",
+                    __FUNCTION__, transaction_number_);
+        return false;
+    }
+
+    bool success = true;
+    start_ = std::chrono::steady_clock::now();
+
+    if (!refunded_) {
+        std::size_t total = 0;
+
+        if (!SnapshotComplete(total) && !Snapshot(total, lock)) {
+            Log::vError("%s: Failed to record the share accounts for "
+                        "dividend %" PRId64 "\n",
+                        __FUNCTION__, transaction_number_);
+            return false;
+        }
+
+        std::string path;
+
+        if (!FilePath(".s", path)) {
+            return false;
+        }
+
+        std::ifstream snapshot(path, std::ios::in | std::ios::binary);
+        std::vector<Share> page;
+
+        while (true) {
+            if (!ReadPage(snapshot, page)) {
+                success = false;
+                break;
+            }
+
+            if (page.empty()) {
+                break;
+            }
+
+            if (!PayPage(page)) {
+                success = false;
+            }
+
+            ReportProgress(total);
+
+            if (!Pause(lock)) {
+                return false;
+            }
+        }
+
+        // Keep the checkpoint, so the refund is tried again at startup.
+        if (!RefundLeftovers()) {
+            return false;
+        }
+    }
+
+    Erase();
+
+    return success;
+}
+
+void DividendPayout::ResumePending(OTServer& server,
+                                   std::unique_lock<std::mutex>& lock)
+{
+    const std::string notaryID = server.m_strNotaryID.Get();
+    std::string index;
+
+    {
+        std::lock_guard<std::mutex> indexLock(index_lock_);
+
+        if (!OTDB::Exists(OTFolders::Receipt().Get(), notaryID,
+                          DIVIDEND_INDEX_FILE)) {
+            return;
+        }
+
+        index = OTDB::QueryPlainString(OTFolders::Receipt().Get(), notaryID,
+                                       DIVIDEND_INDEX_FILE);
+    }
+
+    std::istringstream numbers(index);
+    std::string number;
+
+    while (server.payout_running_.load() && std::getline(numbers, number)) {
+        if (number.empty()) {
+            continue;
+        }
+
+        const std::string header = "dividend-" + number + ".h";
+
+        if (!OTDB::Exists(OTFolders::Receipt().Get(), notaryID, header)) {
+            Log::vError("%s: Missing checkpoint %s\n", __FUNCTION__,
+                        header.c_str());
+            RemoveFromIndex(notaryID, number);
+            continue;
+        }
+
+        std::istringstream fields(OTDB::QueryPlainString(
+            OTFolders::Receipt().Get(), notaryID, header));
+        std::string payer, shares, payout, voucher, perShare, total;
+        std::getline(fields, payer);
+        std::getline(fields, shares);
+        std::getline(fields, payout);
+        std::getline(fields, voucher);
+        std::getline(fields, perShare);
+        std::getline(fields, total);
+        const std::string memo((std::istreambuf_iterator<char>(fields)),
+                               std::istreambuf_iterator<char>());
+
+        if (fields.bad() || total.empty()) {
+            Log::vError("%s: Failed to load checkpoint %s\n", __FUNCTION__,
+                        header.c_str());
+            continue;
+        }
+
+        Log::vOutput(0, "%s: Resuming dividend payout %s\n", __FUNCTION__,
+                     number.c_str());
+
+        DividendPayout thePayout(
+            server, Identifier(server.m_strNotaryID), Identifier(payer.c_str()),
+            Identifier(shares.c_str()), Identifier(payout.c_str()),
+            Identifier(voucher.c_str()), String(memo.c_str()),
+            std::strtoll(perShare.c_str(), nullptr, 10),
+            std::strtoll(total.c_str(), nullptr, 10),
+            std::strtoll(number.c_str(), nullptr, 10));
+
+        if (!thePayout.Run(&lock) && server.payout_running_.load()) {
+            Log::vError("%s: ERROR: dividend payout %s did not complete "
+                        "cleanly.\n",
+                        __FUNCTION__, number.c_str());
+        }
+    }
+}
+
+} // namespace opentxs
@@ -37,12 +37,18 @@
  ************************************************************/
 
 #include <chrono>
+#include <mutex>
 
 #include <opentxs/server/ServerSettings.hpp>
 #include <opentxs/server/ServerLoader.hpp>
 #include <opentxs/server/MessageProcessor.hpp>
 #include <opentxs/server/OTServer.hpp>
 #include <opentxs/server/ClientConnection.hpp>
+#include <opentxs/server/UserCommandProcessor.hpp>
+#include <opentxs/core/app/App.hpp>
+#include <opentxs/core/app/Wallet.hpp>
+#include <opentxs/core/DeferredNymfileSave.hpp>
+#include <opentxs/core/Identifier.hpp>
 #include <opentxs/core/Log.hpp>
 #include <opentxs/core/Message.hpp>
 #include <opentxs/core/String.hpp>
@@ -52,23 +58,39 @@
 
 #include <czmq.h>
 
+#define WORKER_ENDPOINT "inproc://opentxs/notary/workers"
+#define WORKER_POLL_MS 500
+#define FRONTEND_POLL_MS 1000
+
 namespace opentxs
 {
 
 MessageProcessor::MessageProcessor(ServerLoader& loader)
     : server_(loader.getServer())
-    , zmqSocket_(zsock_new_rep(NULL))
+    , zmqSocket_(zsock_new_router(NULL))
+    , zmqBackend_(zsock_new_dealer(NULL))
     , zmqAuth_(zactor_new(zauth, NULL))
-    , zmqPoller_(zpoller_new(zmqSocket_, NULL))
+    , zmqPoller_(zpoller_new(zmqSocket_, zmqBackend_, NULL))
+    , running_(true)
 {
     init(loader.getPort(), loader.getTransportKey());
 }
 
 MessageProcessor::~MessageProcessor()
 {
+    running_.store(false);
+
+    for (auto& thread : workers_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    zpoller_remove(zmqPoller_, zmqBackend_);
     zpoller_remove(zmqPoller_, zmqSocket_);
     zpoller_destroy(&zmqPoller_);
     zactor_destroy(&zmqAuth_);
+    zsock_destroy(&zmqBackend_);
     zsock_destroy(&zmqSocket_);
 }
 
@@ -88,24 +110,45 @@ void MessageProcessor::init(int port, zcert_t* transportKey)
     zcert_apply(transportKey, zmqSocket_);
     zcert_destroy(&transportKey);
     zsock_bind(zmqSocket_, "tcp://*:%d", port);
+
+    // The backend must be bound before any worker tries to connect to it.
+    zsock_bind(zmqBackend_, "%s", WORKER_ENDPOINT);
+
+    int32_t workerCount = ServerSettings::GetWorkerThreads();
+
+    if (1 > workerCount) {
+        workerCount = 1;
+    }
+
+    Log::vOutput(0, "MessageProcessor: starting %d request worker%s.\n",
+                 workerCount, (1 == workerCount) ? "" : "s");
+
+    for (int32_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back(&MessageProcessor::worker, this);
+    }
 }
 
 void MessageProcessor::run()
 {
     for (;;) {
-        // timeout is the time left until the next cron should execute.
-        int64_t timeout = server_->computeTimeout();
-        if (timeout <= 0) {
-            server_->ProcessCron();
+        // Cron runs on its own thread (see OTServer::CronThread), so this
+        // loop only shuttles messages between clients and workers.
+        void* socket = zpoller_wait(zmqPoller_, FRONTEND_POLL_MS);
+
+        if (zmqSocket_ == socket) {
+            // A request from a client, to be picked up by the next idle
+            // worker.
+            forward(zmqSocket_, zmqBackend_);
             continue;
         }
 
-        // wait for incoming message or up to timeout,
-        // i.e. stop polling in time for the next cron execution.
-        if (zpoller_wait(zmqPoller_, timeout)) {
-            processSocket();
+        if (zmqBackend_ == socket) {
+            // A reply from one of the workers, routed back to the client
+            // by the identity frame the ROUTER socket prepended.
+            forward(zmqBackend_, zmqSocket_);
             continue;
         }
+
         if (zpoller_terminated(zmqPoller_)) {
             otErr << __FUNCTION__
                   << ": zpoller_terminated - process interrupted or"
@@ -115,41 +158,110 @@ void MessageProcessor::run()
 
         if (!zpoller_expired(zmqPoller_)) {
             otErr << __FUNCTION__ << ": zpoller_wait error\n";
+            Log::Sleep(std::chrono::milliseconds(100));
         }
-
-        Log::Sleep(std::chrono::milliseconds(100));
     }
 }
 
-void MessageProcessor::processSocket()
+void MessageProcessor::forward(zsock_t* from, zsock_t* to)
 {
-    char* msg = zstr_recv(zmqSocket_);
-    if (msg == nullptr) {
+    zmsg_t* msg = zmsg_recv(from);
+
+    if (nullptr == msg) {
         Log::Error("zeromq recv() failed\n");
         return;
     }
-    std::string requestString(msg);
-    zstr_free(&msg);
 
-    std::string responseString;
+    if (0 != zmsg_send(&msg, to)) {
+        Log::Error("MessageProcessor: failed to forward message\n");
+        zmsg_destroy(&msg);
+    }
+}
+
+// Each worker owns its own REP socket and command processor. Decoding the
+// request and encoding the reply (base64, zlib, XML) happen in parallel
+// across workers. The notary itself (transaction numbers, cron, markets, the
+// main file) is not thread safe, so the command is processed while holding
+// the server lock.
+void MessageProcessor::worker()
+{
+    UserCommandProcessor processor(server_);
+    zsock_t* socket = zsock_new_rep(NULL);
+    zsock_connect(socket, "%s", WORKER_ENDPOINT);
+    zpoller_t* poller = zpoller_new(socket, NULL);
+
+    while (running_.load()) {
+        if (nullptr == zpoller_wait(poller, WORKER_POLL_MS)) {
+            if (zpoller_terminated(poller)) {
+                break;
+            }
+
+            continue;
+        }
+
+        char* msg = zstr_recv(socket);
+
+        if (msg == nullptr) {
+            Log::Error("zeromq recv() failed\n");
+            continue;
+        }
+
+        std::string requestString(msg);
+        zstr_free(&msg);
 
-    bool error = processMessage(requestString, responseString);
+        std::string responseString;
 
-    if (error) {
-        responseString = "";
+        bool error = processMessage(processor, requestString, responseString);
+
+        if (error) {
+            responseString = "";
+        }
+
+        int rc = zstr_send(socket, responseString.c_str());
+
+        if (rc != 0) {
+            Log::vError("MessageProcessor: failed to send response\n"
+                        "request:\n%s\n\n"
+                        "response:\n%s\n\n",
+                        requestString.c_str(), responseString.c_str());
+        }
     }
 
-    int rc = zstr_send(zmqSocket_, responseString.c_str());
+    zpoller_remove(poller, socket);
+    zpoller_destroy(&poller);
+    zsock_destroy(&socket);
+}
 
-    if (rc != 0) {
-        Log::vError("MessageProcessor: failed to send response\n"
-                    "request:\n%s\n\n"
-                    "response:\n%s\n\n",
-                    requestString.c_str(), responseString.c_str());
+bool MessageProcessor::authenticate(Message& message,
+                                    Identifier& credentials) const
+{
+    // These authenticate differently, or not against stored credentials
+    if (message.m_strCommand.Compare("pingNotary") ||
+        message.m_strCommand.Compare("registerNym") ||
+        server_->m_strServerNymID.Compare(message.m_strNymID)) {
+        return false;
     }
+
+    // The wallet only returns nyms whose credentials verified
+    auto stored = App::Me().Contract().Nym(Identifier(message.m_strNymID));
+
+    if (!stored) { return false; }
+
+    // Verify against a private copy, since key objects are not safe to share
+    // between threads
+    Nym sender(message.m_strNymID);
+
+    if (!sender.LoadCredentialIndex(stored->asPublicNym())) { return false; }
+
+    if (!message.VerifySignature(sender)) { return false; }
+
+    credentials = sender.CredentialIndexHash();
+
+    return true;
 }
 
-bool MessageProcessor::processMessage(const std::string& messageString,
+bool MessageProcessor::processMessage(UserCommandProcessor& processor,
+                                      const std::string& messageString,
                                       std::string& reply)
 {
     if (messageString.size() < 1) return false;
@@ -184,8 +296,33 @@ bool MessageProcessor::processMessage(const std::string& messageString,
     ClientConnection client;
     Nym nym(message.m_strNymID);
 
-    bool processedUserCmd = server_->userCommandProcessor_.ProcessUserCommand(
-        message, replyMessage, &client, &nym);
+    // Signature checks are the most expensive part of most requests, and
+    // only need the sender's public credentials, so they run before the
+    // request waits for the notary lock. Executing the request still
+    // happens under server_->lock_: commands touch the server nym, cron,
+    // markets and other users' boxes, none of which have locks of their own.
+    // Requests from different Nyms therefore still run one at a time.
+    Identifier credentials;
+    const bool authenticated = authenticate(message, credentials);
+
+    std::unique_lock<std::mutex> lock(server_->lock_);
+
+    // Every change the request makes to the Nym's numbers is signed and
+    // written in one go, here, instead of at each step along the way. The
+    // write happens before the reply goes out, and a failed write turns the
+    // reply into a failure.
+    DeferredNymfileSave nymfileSave(nym);
+
+    bool processedUserCmd =
+        processor.ProcessUserCommand(
+            message, replyMessage, &client, &nym,
+            authenticated ? &credentials : nullptr);
+
+    if (!nymfileSave.Commit() && processedUserCmd) {
+        Log::vError("Failed saving nymfile for %s after processing %s.\n",
+                    message.m_strNymID.Get(), message.m_strCommand.Get());
+        processedUserCmd = false;
+    }
 
     // By optionally passing in &client, the client Nym's public
     // key will be set on it whenever verification is complete. (So
@@ -232,6 +369,8 @@ bool MessageProcessor::processMessage(const std::string& messageString,
                      message.m_strCommand.Get());
     }
 
+    lock.unlock();
+
     String replyString(replyMessage);
 
     if (!replyString.Exists()) {
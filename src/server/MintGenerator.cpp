@@ -0,0 +1,216 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/server/MintGenerator.hpp>
+#include <opentxs/server/OTServer.hpp>
+#include <opentxs/server/ServerSettings.hpp>
+
+#include <opentxs/cash/Mint.hpp>
+#include <opentxs/core/app/App.hpp>
+#include <opentxs/core/app/Wallet.hpp>
+#include <opentxs/core/util/Common.hpp>
+#include <opentxs/core/Identifier.hpp>
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/String.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// The public copy of the current series, which clients download.
+#define MINT_PUBLIC_SUFFIX ".PUBLIC"
+
+namespace opentxs
+{
+
+MintGenerator::MintGenerator(OTServer& server)
+    : server_(server)
+    , denominations_{1, 5, 10, 20, 50, 100, 500, 1000, 10000, 100000}
+{
+}
+
+int32_t MintGenerator::CurrentSeries(const std::string& unitID) const
+{
+    const String strUnitID(unitID.c_str());
+    std::unique_ptr<Mint> pMint(
+        Mint::MintFactory(server_.m_strNotaryID, strUnitID));
+    OT_ASSERT(nullptr != pMint);
+
+    // LoadMint logs when the file doesn't exist, which is expected for a unit
+    // that hasn't had a mint yet.
+    if (!pMint->LoadMint(MINT_PUBLIC_SUFFIX)) {
+        return -1;
+    }
+
+    return pMint->GetSeries();
+}
+
+bool MintGenerator::NextSeries(const std::string& unitID,
+                               int32_t& series) const
+{
+    series = CurrentSeries(unitID) + 1;
+
+    return Generate(unitID, series);
+}
+
+bool MintGenerator::Generate(const std::string& unitID,
+                             const int32_t series) const
+{
+    const String strUnitID(unitID.c_str());
+    const Identifier theUnitID(strUnitID), theNotaryID(server_.m_strNotaryID);
+    std::unique_ptr<Mint> pMint(Mint::MintFactory(
+        server_.m_strNotaryID, server_.m_strServerNymID, strUnitID));
+    OT_ASSERT(nullptr != pMint);
+
+    // The keys are generated without the notary lock, since that takes
+    // minutes. Generating only seals the private keys to the public key of
+    // the server nym, which requests never change.
+    //
+    // The new series becomes current now. Its tokens are good for six months,
+    // and it is replaced by the next series after three.
+    const time64_t VALID_FROM = OTTimeGetCurrentTime();
+    const time64_t VALID_TO = OTTimeAddTimeInterval(
+        VALID_FROM, OTTimeGetSecondsFromTime(OT_TIME_SIX_MONTHS_IN_SECONDS));
+    const time64_t MINT_EXPIRATION = OTTimeAddTimeInterval(
+        VALID_FROM,
+        OTTimeGetSecondsFromTime(OT_TIME_THREE_MONTHS_IN_SECONDS));
+
+    if (!pMint->GenerateNewMint(series, VALID_FROM, VALID_TO, MINT_EXPIRATION,
+                                theUnitID, theNotaryID, server_.m_nymServer,
+                                denominations_,
+                                ServerSettings::GetMintKeySize(),
+                                ServerSettings::GetMintThreads())) {
+        Log::vError("%s: Failed generating series %d of the mint for %s.\n",
+                    __FUNCTION__, series, unitID.c_str());
+        return false;
+    }
+
+    String strSeries;
+    strSeries.Format("%s%d", ".", series);
+
+    // Signing uses the server nym's private key, and the cached mints are
+    // replaced, so the rest happens under the notary lock like any request.
+    std::lock_guard<std::mutex> lock(server_.lock_);
+
+    // The notary's copy, with the private keys.
+    pMint->SetSavePrivateKeys();
+    pMint->SignContract(server_.m_nymServer);
+    pMint->SaveContract();
+
+    if (!pMint->SaveMint(strSeries.Get())) {
+        Log::vError("%s: Failed saving series %d of the mint for %s.\n",
+                    __FUNCTION__, series, unitID.c_str());
+        return false;
+    }
+
+    // Signing again leaves the private keys out.
+    pMint->ReleaseSignatures();
+    pMint->SignContract(server_.m_nymServer);
+    pMint->SaveContract();
+
+    if (!pMint->SaveMint(MINT_PUBLIC_SUFFIX)) {
+        Log::vError("%s: Failed saving the public copy of series %d of the "
+                    "mint for %s.\n",
+                    __FUNCTION__, series, unitID.c_str());
+        return false;
+    }
+
+    server_.transactor_.forgetMints(strUnitID);
+
+    return true;
+}
+
+std::size_t MintGenerator::NextSeriesForAllUnits() const
+{
+    // Only units which already have a mint are rolled over. A unit gets its
+    // first series when its issuer asks for one.
+    std::map<std::string, int32_t> mints;
+
+    for (auto& unit : App::Me().Contract().UnitDefinitionList()) {
+        const int32_t current = CurrentSeries(unit.first);
+
+        if (0 > current) {
+            Log::vOutput(1, "%s: Skipping %s, which has no mint.\n",
+                         __FUNCTION__, unit.first.c_str());
+            continue;
+        }
+
+        mints[unit.first] = current + 1;
+    }
+
+    const std::size_t total = mints.size();
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t done = 0;
+    std::size_t generated = 0;
+
+    for (auto& unit : mints) {
+        const int32_t series = unit.second;
+
+        if (Generate(unit.first, series)) {
+            ++generated;
+        }
+
+        ++done;
+
+        const double seconds = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count();
+        const double perUnit = seconds / done;
+        const int64_t remaining =
+            static_cast<int64_t>(perUnit * (total - done));
+
+        Log::vOutput(0, "%s: %" PRId64 " of %" PRId64 " units (%s, series "
+                        "%d), %.1fs per unit, about %" PRId64 "s remaining.\n",
+                     __FUNCTION__, static_cast<int64_t>(done),
+                     static_cast<int64_t>(total), unit.first.c_str(), series,
+                     perUnit, remaining);
+    }
+
+    if (generated < total) {
+        Log::vError("%s: Failed generating the next series for %" PRId64
+                    " of %" PRId64 " units.\n",
+                    __FUNCTION__, static_cast<int64_t>(total - generated),
+                    static_cast<int64_t>(total));
+    }
+
+    return generated;
+}
+
+} // namespace opentxs
@@ -40,10 +40,11 @@
 #include <opentxs/server/OTServer.hpp>
 #include <opentxs/server/Macros.hpp>
 #include <opentxs/server/ServerSettings.hpp>
-#include <opentxs/server/PayDividendVisitor.hpp>
+#include <opentxs/server/DividendPayout.hpp>
 #include <opentxs/ext/OTPayment.hpp>
 #include <opentxs/cash/Mint.hpp>
 #include <opentxs/cash/Purse.hpp>
+#include <opentxs/cash/SpentTokenStore.hpp>
 #include <opentxs/cash/Token.hpp>
 #include "opentxs/core/app/App.hpp"
 #include <opentxs/core/contract/basket/BasketItem.hpp>
@@ -63,10 +64,17 @@
 #include <opentxs/core/Item.hpp>
 #include <opentxs/core/trade/OTTrade.hpp>
 #include <opentxs/core/util/OTFolders.hpp>
+#include <opentxs/core/util/Workers.hpp>
 #include <opentxs/core/Log.hpp>
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace opentxs
 {
@@ -74,6 +82,128 @@ namespace opentxs
 typedef std::list<Account*> listOfAccounts;
 typedef std::deque<Token*> dequeOfTokenPtrs;
 
+namespace
+{
+
+// A token popped from a purse being deposited, along with the mint and cash
+// reserve account of its series.
+struct DepositedToken
+{
+    DepositedToken(std::unique_ptr<Token> token, Mint* mint, Account* reserve)
+        : token_(std::move(token))
+        , mint_(mint)
+        , reserve_(reserve)
+    {
+    }
+
+    std::unique_ptr<Token> token_;
+    Mint* mint_;
+    Account* reserve_;
+    const String* private_ = nullptr; // the mint's decrypted key
+    String spendable_; // the decrypted Lucre coin
+    String unit_;
+    String hash_;      // key of the coin in the spent token store
+    bool verified_ = false;
+    bool read_ = false;
+    bool spent_ = true;
+};
+
+// Mint private keys opened for one deposit, by mint and denomination
+typedef std::map<std::pair<const Mint*, int64_t>, String> mapOfMintKeys;
+
+// Decrypts a deposited token, and the mint key it has to be verified with,
+// unless an earlier token of the same purse already needed that key. Both
+// use the server Nym's private key, so this runs on the request thread,
+// before the tokens are handed to the workers.
+bool OpenDepositedToken(Nym& theServerNym, mapOfMintKeys& keys,
+                        DepositedToken& deposited)
+{
+    Token& theToken = *deposited.token_;
+
+    if (!theToken.GetSpendableString(theServerNym, deposited.spendable_)) {
+        Log::vOutput(0, "Notary::NotarizeDeposit: ERROR verifying token: "
+                        "Failure retrieving token data. \n");
+        return false;
+    }
+
+    const auto key =
+        std::make_pair(deposited.mint_, theToken.GetDenomination());
+    auto it = keys.find(key);
+
+    if (keys.end() == it) {
+        String strPrivate;
+
+        if (!deposited.mint_->OpenPrivate(theServerNym,
+                                          theToken.GetDenomination(),
+                                          strPrivate)) {
+            Log::vOutput(0, "Notary::NotarizeDeposit: ERROR verifying token: "
+                            "Failure opening the mint key. \n");
+            return false;
+        }
+
+        it = keys.emplace(key, strPrivate).first;
+    }
+
+    deposited.private_ = &it->second;
+
+    Identifier theTokenHash;
+    theTokenHash.CalculateDigest(deposited.spendable_);
+    deposited.hash_.Set(String(theTokenHash));
+    deposited.unit_.Set(String(theToken.GetInstrumentDefinitionID()));
+
+    return true;
+}
+
+// Verifies the Lucre coin against the mint key, and looks it up in the spent
+// token store. This runs on the workers: each call builds its own Lucre
+// objects from the decrypted key, only reads the store, and only writes to
+// the DepositedToken it is given. The result is logged by the request
+// thread.
+void VerifyDepositedToken(DepositedToken& deposited)
+{
+    // (The signed and unblinded Lucre coin is verified in Lucre using the
+    // appropriate Mint private key.)
+    deposited.verified_ =
+        deposited.mint_->VerifyCoin(*deposited.private_, deposited.spendable_);
+
+    if (!deposited.verified_) return;
+
+    deposited.read_ = SpentTokenStore::IsSpent(
+        deposited.unit_.Get(), deposited.token_->GetSeries(),
+        deposited.hash_.Get(), deposited.spent_);
+}
+
+// Logs the result of VerifyDepositedToken. False unless the token is valid
+// and unspent.
+bool CheckDepositedToken(const DepositedToken& deposited)
+{
+    if (!deposited.verified_) {
+        Log::vOutput(0, "Notary::NotarizeDeposit: ERROR verifying token: "
+                        "Token verification failed. \n");
+        return false;
+    }
+
+    if (!deposited.read_) {
+        Log::vError("Notary::NotarizeDeposit: Unable to read the spent token "
+                    "records for series %d of %s\n",
+                    deposited.token_->GetSeries(), deposited.unit_.Get());
+        return false;
+    }
+
+    if (deposited.spent_) {
+        Log::vOutput(0, "Notary::NotarizeDeposit: ERROR verifying token: "
+                        "Token was already spent: %s\n",
+                     deposited.hash_.Get());
+        return false;
+    }
+
+    Log::Output(3, "Notary::NotarizeDeposit: SUCCESS verifying token...    \n");
+
+    return true;
+}
+
+} // namespace
+
 Notary::Notary(OTServer* server)
     : server_(server)
 {
@@ -1869,295 +1999,49 @@ void Notary::NotarizePayDividend(Nym& theNym, Account& theSourceAccount,
                                 //
                                 // PAY THE SHAREHOLDERS
                                 //
-                                // Here's where we actually loop through the
-                                // asset accounts for the share type,
-                                // and send a voucher to the owner of each one.
-                                //
-                                // This way, the actionPayDividend won't
-                                // possibly load these accounts twice.
-                                // We make them available here this way.
+                                // The owner of each account of the shares
+                                // type is sent a voucher drawn on
+                                // VOUCHER_ACCOUNT_ID (in the amount of
+                                // lAmountPerShare * number of shares in
+                                // account), then the leftovers are refunded
+                                // to the sender. That happens on the payout
+                                // thread, once this request has finished and
+                                // the accounts above are saved. The payout is
+                                // checkpointed, so if the server stops part
+                                // way through it is resumed at startup.
                                 //
-                                mapOfAccounts theAccounts;
-                                theAccounts.insert(
-                                    std::pair<std::string, Account*>(
-                                        strAccountID.Get(), &theSourceAccount));
-                                theAccounts.insert(
-                                    std::pair<std::string, Account*>(
-                                        strSharesIssuerAcct.Get(),
-                                        pSharesIssuerAccount));
-                                theAccounts.insert(
-                                    std::pair<std::string, Account*>(
-                                        strVoucherAcctID.Get(),
-                                        &theVoucherReserveAcct));
-
-                                PayDividendVisitor actionPayDividend(
-                                    NOTARY_ID, NYM_ID,
+                                DividendPayout thePayout(
+                                    *server_, NOTARY_ID, NYM_ID,
+                                    SHARES_INSTRUMENT_DEFINITION_ID,
                                     PAYOUT_INSTRUMENT_DEFINITION_ID,
                                     VOUCHER_ACCOUNT_ID,
                                     strInReferenceTo, // Memo for each voucher
                                                       // (containing original
                                                       // payout request pItem)
-                                    *server_, lAmountPerShare, &theAccounts);
-
-                                // Loops through all the accounts for a given
-                                // instrument definition
-                                // (PAYOUT_INSTRUMENT_DEFINITION_ID),
-                                // and triggers
-                                // actionPayDividend for each one. This sends
-                                // the owner nym for each, a voucher drawn on
-                                // VOUCHER_ACCOUNT_ID. (In the amount of
-                                // lAmountPerShare * number of shares in
-                                // account.)
-                                //
-                                const bool bForEachAcct =
-                                    pSharesContract->VisitAccountRecords(
-                                        actionPayDividend); // <================
-                                                            // pay all the
-                                                            // dividends here.
-
-                                // TODO: Since the above line of code loops
-                                // through all the accounts and loads them
-                                // up, transforms them, and saves them again, we
-                                // cannot use our own loaded accounts below
-                                // this point. (They could overwrite
-                                // themselves.) theSourceAccount especially, was
-                                // passed in
-                                // from above -- so how can we possible warn the
-                                // caller than he cannot save this account
-                                // without
-                                // overwriting work we have done in this
-                                // function?
-                                //
-                                // Aside from any more elegant solution, the
-                                // only way to make it work in this case would
-                                // be to
-                                // make a map or list of all the accounts that
-                                // are already loaded in memory (such as
-                                // theSourceAccount)
-                                // and PASS THEM IN to the above
-                                // VisitAccountRecords call. This way it would
-                                // have the option to use
-                                // the "already loaded" versions, where
-                                // appropriate, instead of loading them twice.
-                                // (As it is,
-                                // theSourceAccount is not used below this
-                                // point, though we couldn't preven the caller
-                                // from using it.)
-                                //
-                                // Therefore we need to have some central system
-                                // where accounts can be loaded, locked, saved,
-                                // etc.
-                                // So we cannot ever overwrite ourselves BY
-                                // DESIGN. (And the same for other data types as
-                                // well, like Nyms.)
-                                // Todo.
-                                //
-                                if (!bForEachAcct) // todo failsafe. Handle this
-                                                   // better.
-                                {
+                                    lAmountPerShare, lTotalCostOfDividend,
+                                    tranIn.GetTransactionNum());
+
+                                if (thePayout.Begin()) {
+                                    server_->QueuePayouts();
+                                }
+                                else {
+                                    // Without a checkpoint the payout thread
+                                    // can't find the payout, so it is paid
+                                    // here instead.
                                     Log::vError(
-                                        "%s: ERROR: After moving funds for "
-                                        "dividend payment, there was some "
-                                        "error when sending out the vouchers "
-                                        "to the payout recipients.\n",
+                                        "%s: ERROR: failed to checkpoint the "
+                                        "dividend payout. It can't be resumed "
+                                        "if interrupted.\n",
                                         szFunc);
-                                }
-                                //
-                                // REFUND ANY LEFTOVERS
-                                //
-                                const int64_t lLeftovers =
-                                    lTotalCostOfDividend -
-                                    (actionPayDividend.GetAmountPaidOut() +
-                                     actionPayDividend.GetAmountReturned());
-                                if (lLeftovers > 0) {
-                                    // Of the total amount removed from the
-                                    // sender's account, and after paying all
-                                    // dividends,
-                                    // there was a leftover amount that wasn't
-                                    // paid to anybody. Therefore, we should pay
-                                    // it back
-                                    // to the sender himself, now.
-                                    //
-                                    Log::vOutput(
-                                        0,
-                                        "%s: After dividend payout, with "
-                                        "%" PRId64 " units removed initially, "
-                                        "there were %" PRId64
-                                        " units remaining. "
-                                        "(Returning them to sender...)\n",
-                                        szFunc, lTotalCostOfDividend,
-                                        lLeftovers);
-                                    Cheque theVoucher(
-                                        NOTARY_ID,
-                                        PAYOUT_INSTRUMENT_DEFINITION_ID);
-
-                                    // 10 minutes ==    600 Seconds
-                                    // 1 hour    ==     3600 Seconds
-                                    // 1 day    ==    86400 Seconds
-                                    // 30 days    ==  2592000 Seconds
-                                    // 3 months ==  7776000 Seconds
-                                    // 6 months == 15552000 Seconds
-
-                                    const time64_t VALID_FROM =
-                                        OTTimeGetCurrentTime(); // This time is
-                                                                // set to TODAY
-                                                                // NOW
-                                    const time64_t VALID_TO =
-                                        OTTimeAddTimeInterval(
-                                            VALID_FROM,
-                                            OTTimeGetSecondsFromTime(
-                                                OT_TIME_SIX_MONTHS_IN_SECONDS)); // This time occurs in 180 days (6 months).  Todo hardcoding.
 
-                                    int64_t lNewTransactionNumber = 0;
-                                    const bool bGotNextTransNum =
-                                        server_->transactor_
-                                            .issueNextTransactionNumberToNym(
-                                                server_->m_nymServer,
-                                                lNewTransactionNumber);
-                                    // We save the
-                                    // transaction
-                                    // number on the server Nym (normally we'd
-                                    // discard it) because
-                                    // when the cheque is deposited, the server
-                                    // nym, as the owner of
-                                    // the voucher account, needs to verify the
-                                    // transaction # on the
-                                    // cheque (to prevent double-spending of
-                                    // cheques.)
-                                    if (bGotNextTransNum) {
-                                        const Identifier NOTARY_NYM_ID(
-                                            server_->m_nymServer);
-                                        const bool bIssueVoucher =
-                                            theVoucher.IssueCheque(
-                                                lLeftovers, // The amount of the
-                                                            // cheque.
-                                                lNewTransactionNumber, // Requiring
-                                                                       // a
-                                                // transaction
-                                                // number
-                                                // prevents
-                                                // double-spending
-                                                // of
-                                                // cheques.
-                                                VALID_FROM, // The expiration
-                                                            // date
-                                                // (valid from/to dates)
-                                                // of the cheque
-                                                VALID_TO, // Vouchers are
-                                                // automatically starting
-                                                // today and lasting 6
-                                                // months.
-                                                VOUCHER_ACCOUNT_ID, // The asset
-                                                // account the
-                                                // cheque is
-                                                // drawn on.
-                                                NOTARY_NYM_ID, // Nym ID of the
-                                                // sender (in this
-                                                // case the server
-                                                // nym.)
-                                                strInReferenceTo, // Optional
-                                                                  // memo
-                                                // field. Includes
-                                                // item note and
-                                                // request memo.
-                                                &NYM_ID);
-
-                                        // All account crediting / debiting
-                                        // happens in the caller, in OTServer.
-                                        //    (AND it happens only ONCE, to
-                                        // cover ALL vouchers.)
-                                        // Then in here, the voucher either gets
-                                        // send to the recipient, or if error,
-                                        // sent back home to
-                                        // the issuer Nym. (ALL the funds are
-                                        // removed, then the vouchers are sent
-                                        // one way or the other.)
-                                        // Any returned vouchers, obviously
-                                        // serve to notify the dividend payer of
-                                        // where the errors were
-                                        // (as well as give him the opportunity
-                                        // to get his money back.)
-                                        //
-                                        bool bSent = false;
-                                        if (bIssueVoucher) {
-                                            theVoucher.SetAsVoucher(
-                                                NOTARY_NYM_ID,
-                                                VOUCHER_ACCOUNT_ID); // All this
-                                                                     // does is
-                                                                     // set the
-                                            // voucher's
-                                            // internal
-                                            // contract
-                                            // string
-                                            theVoucher.SignContract(
-                                                server_->m_nymServer); // to
-                                            // "VOUCHER"
-                                            // instead of
-                                            // "CHEQUE".
-                                            theVoucher.SaveContract();
-
-                                            // Send the voucher to the payments
-                                            // inbox of the recipient.
-                                            //
-                                            const String strVoucher(theVoucher);
-                                            OTPayment thePayment(strVoucher);
-
-                                            // calls DropMessageToNymbox
-                                            bSent =
-                                                server_->SendInstrumentToNym(
-                                                    NOTARY_ID,
-                                                    NOTARY_NYM_ID, // sender nym
-                                                    NYM_ID, // recipient nym
-                                                            // (returning to
-                                                    // original sender.)
-                                                    nullptr, &thePayment,
-                                                    "payDividend"); // todo:
-                                            // hardcoding.
-                                        }
-                                        // If we didn't send it, then we need to
-                                        // return the funds to where they came
-                                        // from.
-                                        //
-                                        if (!bSent) {
-                                            const String
-                                                strPayoutInstrumentDefinitionID(
-                                                    PAYOUT_INSTRUMENT_DEFINITION_ID),
-                                                strSenderNymID(NYM_ID);
-                                            Log::vError(
-                                                "%s: ERROR failed issuing "
-                                                "voucher (to return leftovers "
-                                                "back to "
-                                                "the dividend payout "
-                                                "initiator.) WAS TRYING TO PAY "
-                                                "%" PRId64 " of instrument "
-                                                "definition %s to "
-                                                "Nym "
-                                                "%s.\n",
-                                                szFunc, lLeftovers,
-                                                strPayoutInstrumentDefinitionID
-                                                    .Get(),
-                                                strSenderNymID.Get());
-                                        }  // if !bSent
-                                    }
-                                    else // !bGotNextTransNum
-                                    {
-                                        const String
-                                            strPayoutInstrumentDefinitionID(
-                                                PAYOUT_INSTRUMENT_DEFINITION_ID),
-                                            strRecipientNymID(NYM_ID);
+                                    if (!thePayout.Run()) {
                                         Log::vError(
-                                            "%s: ERROR!! Failed issuing next "
-                                            "transaction "
-                                            "number while trying to send a "
-                                            "voucher (while returning leftover "
-                                            "funds, after paying dividends.) "
-                                            "WAS TRYING TO PAY %" PRId64
-                                            " of asset "
-                                            "type %s to Nym %s.\n",
-                                            szFunc, lLeftovers,
-                                            strPayoutInstrumentDefinitionID
-                                                .Get(),
-                                            strRecipientNymID.Get());
+                                            "%s: ERROR: After moving funds "
+                                            "for dividend payment, there was "
+                                            "some error when sending out the "
+                                            "vouchers to the payout "
+                                            "recipients.\n",
+                                            szFunc);
                                     }
                                 }
                             } // else
@@ -3730,7 +3614,13 @@ void Notary::NotarizeDeposit(Nym& theNym, Account& theAccount,
                 bool bSuccess = false;
 
                 // Pull the token(s) out of the purse that was received from the
-                // client.
+                // client. The cheap checks are done here, while popping. The
+                // expensive one (verifying each Lucre coin against the mint)
+                // is done below, in parallel.
+                std::vector<DepositedToken> tokens;
+                std::set<Account*> reserves;
+                bool bCollected = true;
+
                 while (true) {
                     std::unique_ptr<Token> pToken(
                         thePurse.Pop(server_->m_nymServer));
@@ -3744,175 +3634,173 @@ void Notary::NotarizeDeposit(Nym& theNym, Account& theAccount,
                     if (nullptr == pMint) {
                         Log::Error("Notary::NotarizeDeposit: Unable to get "
                                    "or load Mint.\n");
+                        bCollected = false;
                         break;
                     }
                     else if ((pMintCashReserveAcct =
-                                    pMint->GetCashReserveAccount()) !=
-                               nullptr) {
-                        String strSpendableToken;
-                        bool bToken = pToken->GetSpendableString(
-                            server_->m_nymServer, strSpendableToken);
-
-                        if (!bToken) // if failure getting the spendable token
-                                     // data from the token object
-                        {
-                            bSuccess = false;
-                            Log::vOutput(0, "Notary::NotarizeDeposit: "
-                                            "ERROR verifying token: Failure "
-                                            "retrieving token data. \n");
-                            break;
-                        }
-                        else if (!(pToken->GetInstrumentDefinitionID() ==
-                                     INSTRUMENT_DEFINITION_ID)) // or if failure
-                                                                // verifying
-                        // instrument definition
-                        {
+                                  pMint->GetCashReserveAccount()) == nullptr) {
+                        Log::Error("Notary::NotarizeDeposit: Unable to get "
+                                   "cash reserve account for Mint.\n");
+                        bCollected = false;
+                        break;
+                    }
+                    else if (!(pToken->GetInstrumentDefinitionID() ==
+                               INSTRUMENT_DEFINITION_ID)) // or if failure
+                                                          // verifying
+                    // instrument definition
+                    {
+                        Log::vOutput(0, "Notary::NotarizeDeposit: "
+                                        "ERROR verifying token: Wrong "
+                                        "instrument definition. \n");
+                        bCollected = false;
+                        break;
+                    }
+                    else if (!(pToken->GetNotaryID() ==
+                               NOTARY_ID)) // or if failure verifying
+                                           // server ID
+                    {
+                        Log::vOutput(0, "Notary::NotarizeDeposit: "
+                                        "ERROR verifying token: Wrong "
+                                        "server ID. \n");
+                        bCollected = false;
+                        break;
+                    }
+
+                    tokens.emplace_back(std::move(pToken), pMint,
+                                        pMintCashReserveAcct);
+                    reserves.insert(pMintCashReserveAcct);
+                }
+
+                // Verify the tokens. Everything that needs the server Nym's
+                // private key (decrypting each token, and each mint key once)
+                // is done here. Then the Lucre verifications, and the spent
+                // token lookups behind them, are spread over the shared
+                // worker pool, and their results logged here once all of
+                // them are done.
+                if (bCollected && !tokens.empty()) {
+                    mapOfMintKeys keys;
+                    bSuccess = true;
+
+                    for (auto& deposited : tokens) {
+                        if (!OpenDepositedToken(server_->m_nymServer, keys,
+                                                deposited)) {
                             bSuccess = false;
-                            Log::vOutput(0, "Notary::NotarizeDeposit: "
-                                            "ERROR verifying token: Wrong "
-                                            "instrument definition. \n");
                             break;
                         }
-                        else if (!(pToken->GetNotaryID() ==
-                                     NOTARY_ID)) // or if failure verifying
-                                                 // server ID
-                        {
-                            bSuccess = false;
-                            Log::vOutput(0, "Notary::NotarizeDeposit: "
-                                            "ERROR verifying token: Wrong "
-                                            "server ID. \n");
-                            break;
+                    }
+
+                    if (bSuccess) {
+                        const std::size_t workers = WorkerCount(
+                            ServerSettings::GetTokenVerifyThreads());
+                        const std::size_t threads =
+                            std::min(workers, tokens.size());
+
+                        RunWorkers(threads, [&](std::size_t worker) {
+                            for (std::size_t i = worker; i < tokens.size();
+                                 i += threads) {
+                                VerifyDepositedToken(tokens[i]);
+                            }
+                        });
+
+                        for (auto& deposited : tokens) {
+                            if (!CheckDepositedToken(deposited)) {
+                                bSuccess = false;
+                                break;
+                            }
                         }
-                        // This call to VerifyToken verifies the token's Series
-                        // and From/To dates against the
-                        // mint's, and also verifies that the CURRENT date is
-                        // inside that valid date range.
-                        //
-                        // It also verifies the Lucre coin data itself against
-                        // the key for that series and
-                        // denomination. (The signed and unblinded Lucre coin is
-                        // finally verified in Lucre
-                        // using the appropriate Mint private key.)
-                        //
-                        else if (!(pMint->VerifyToken(
-                                     server_->m_nymServer, strSpendableToken,
-                                     pToken->GetDenomination()))) {
-                            bSuccess = false;
+                    }
+                }
+
+                // The workers each checked the spent token database on their
+                // own, so they can't have noticed the same token showing up
+                // twice in this purse.
+                if (bSuccess) {
+                    std::set<std::string> spendables;
+
+                    for (auto& deposited : tokens) {
+                        if (!spendables.insert(deposited.spendable_.Get())
+                                 .second) {
                             Log::vOutput(0, "Notary::NotarizeDeposit: "
                                             "ERROR verifying token: Token "
-                                            "verification failed. \n");
-                            break;
-                        }
-                        // Lookup the token in the SPENT TOKEN DATABASE, and
-                        // make sure
-                        // that it hasn't already been spent...
-                        else if (pToken->IsTokenAlreadySpent(
-                                     strSpendableToken)) {
-                            // TODO!!!! Need to store the spent token database
-                            // in multiple places, on multiple media!
-                            //          Furthermore need to CHECK those multiple
-                            // places inside IsTokenAlreadySpent.
-                            //          In fact, that should all be configurable
-                            // in the server config file!
-                            //          Related: make sure IsTokenAlreadySpent
-                            // differentiates between ACTUALLY not finding
-                            //          a token as spent (successfully), versus
-                            // some error state with the storage.
+                                            "appears twice in the purse. \n");
                             bSuccess = false;
-                            Log::vOutput(0, "Notary::NotarizeDeposit: "
-                                            "ERROR verifying token: Token "
-                                            "was already spent. \n");
                             break;
                         }
-                        else {
-                            Log::Output(3, "Notary::NotarizeDeposit: "
-                                           "SUCCESS verifying token...    "
-                                           "\n");
-
-                            // need to be able to "roll back" if anything inside
-                            // this block fails.
-                            // so unless bSuccess is true, I don't save the
-                            // account below.
-                            //
+                    }
+                }
 
-                            // two defense mechanisms here:  mint cash reserve
-                            // acct, and spent token database
-                            //
-                            if (false ==
-                                pMintCashReserveAcct->Debit(
-                                    pToken->GetDenomination())) {
-                                Log::Error("Notary::NotarizeDeposit: Error "
-                                           "debiting the mint cash reserve "
-                                           "account. "
-                                           "SHOULD NEVER HAPPEN...\n");
-                                bSuccess = false;
-                                break;
-                            }
-                            // CREDIT the amount to the account...
-                            else if (false ==
-                                     theAccount.Credit(
-                                         pToken->GetDenomination())) {
-                                Log::Error("Notary::NotarizeDeposit: Error "
-                                           "crediting the user's asset "
-                                           "account...\n");
+                // Every token verified. Now move the funds and record the
+                // tokens as spent, one at a time, on this thread.
+                for (std::size_t i = 0; bSuccess && (i < tokens.size()); ++i) {
+                    Token* pToken = tokens[i].token_.get();
+                    pMintCashReserveAcct = tokens[i].reserve_;
 
-                                if (false ==
-                                    pMintCashReserveAcct->Credit(
-                                        pToken->GetDenomination()))
-                                    Log::Error("Notary::NotarizeDeposit: "
-                                               "Failure crediting-back "
-                                               "mint's cash reserve account "
-                                               "while depositing cash.\n");
-                                bSuccess = false;
-                                break;
-                            }
-                            // Spent token database. This is where the call is
-                            // made to add
-                            // the token to the spent token database.
-                            else if (false ==
-                                     pToken->RecordTokenAsSpent(
-                                         strSpendableToken)) {
-                                Log::Error("Notary::NotarizeDeposit: "
-                                           "Failed recording token as "
-                                           "spent...\n");
+                    // need to be able to "roll back" if anything inside
+                    // this block fails.
+                    // so unless bSuccess is true, I don't save the
+                    // account below.
+                    //
 
-                                if (false ==
-                                    pMintCashReserveAcct->Credit(
-                                        pToken->GetDenomination()))
-                                    Log::Error("Notary::NotarizeDeposit: "
-                                               "Failure crediting-back "
-                                               "mint's cash reserve account "
-                                               "while depositing cash.\n");
+                    // two defense mechanisms here:  mint cash reserve
+                    // acct, and spent token database
+                    //
+                    if (false == pMintCashReserveAcct->Debit(
+                                     pToken->GetDenomination())) {
+                        Log::Error("Notary::NotarizeDeposit: Error "
+                                   "debiting the mint cash reserve "
+                                   "account. "
+                                   "SHOULD NEVER HAPPEN...\n");
+                        bSuccess = false;
+                    }
+                    // CREDIT the amount to the account...
+                    else if (false ==
+                             theAccount.Credit(pToken->GetDenomination())) {
+                        Log::Error("Notary::NotarizeDeposit: Error "
+                                   "crediting the user's asset "
+                                   "account...\n");
 
-                                if (false ==
-                                    theAccount.Debit(pToken->GetDenomination()))
-                                    Log::Error("Notary::NotarizeDeposit: "
-                                               "Failure debiting-back user's "
-                                               "asset account while "
-                                               "depositing cash.\n");
+                        if (false ==
+                            pMintCashReserveAcct->Credit(
+                                pToken->GetDenomination()))
+                            Log::Error("Notary::NotarizeDeposit: "
+                                       "Failure crediting-back "
+                                       "mint's cash reserve account "
+                                       "while depositing cash.\n");
+                        bSuccess = false;
+                    }
+                    // Spent token database. This is where the call is
+                    // made to add
+                    // the token to the spent token database.
+                    else if (false ==
+                             pToken->RecordTokenAsSpent(tokens[i].spendable_)) {
+                        Log::Error("Notary::NotarizeDeposit: "
+                                   "Failed recording token as "
+                                   "spent...\n");
 
-                                bSuccess = false;
-                                break;
-                            }
-                            else // SUCCESS!!! (this iteration)
-                            {
-                                Log::vOutput(2, "Notary::NotarizeDeposit: "
-                                                "SUCCESS crediting account "
-                                                "with cash token...\n");
-                                bSuccess = true;
+                        if (false ==
+                            pMintCashReserveAcct->Credit(
+                                pToken->GetDenomination()))
+                            Log::Error("Notary::NotarizeDeposit: "
+                                       "Failure crediting-back "
+                                       "mint's cash reserve account "
+                                       "while depositing cash.\n");
+
+                        if (false ==
+                            theAccount.Debit(pToken->GetDenomination()))
+                            Log::Error("Notary::NotarizeDeposit: "
+                                       "Failure debiting-back user's "
+                                       "asset account while "
+                                       "depositing cash.\n");
 
-                                // No break here -- we allow the loop to carry
-                                // on through.
-                            }
-                        }
-                    }
-                    else {
-                        Log::Error("Notary::NotarizeDeposit: Unable to get "
-                                   "cash reserve account for Mint.\n");
                         bSuccess = false;
-                        break;
                     }
-                } // while success popping token from purse
+                    else // SUCCESS!!! (this iteration)
+                    {
+                        Log::vOutput(2, "Notary::NotarizeDeposit: "
+                                        "SUCCESS crediting account "
+                                        "with cash token...\n");
+                    }
+                }
 
                 if (bSuccess) {
                     // Release any signatures that were there before (They won't
@@ -3936,10 +3824,14 @@ void Notary::NotarizeDeposit(Nym& theNym, Account& theAccount,
                     // cash expires, then after the expiry period, if it remains
                     // in the account,
                     // it is now the property of the transaction server.)
-                    pMintCashReserveAcct->ReleaseSignatures();
-                    pMintCashReserveAcct->SignContract(server_->m_nymServer);
-                    pMintCashReserveAcct->SaveContract();
-                    pMintCashReserveAcct->SaveAccount();
+                    // A purse can hold tokens from several series, each with
+                    // its own mint and reserve.
+                    for (auto& pReserve : reserves) {
+                        pReserve->ReleaseSignatures();
+                        pReserve->SignContract(server_->m_nymServer);
+                        pReserve->SaveContract();
+                        pReserve->SaveAccount();
+                    }
 
                     pResponseItem->SetStatus(Item::acknowledgement);
 
@@ -6925,6 +6817,16 @@ void Notary::NotarizeTransaction(Nym& theNym, OTTransaction& tranIn,
                "Nym: %s  Account: %s\n",
             __FUNCTION__, lTransactionNumber, strIDNym.Get(), strIDAcct.Get());
     }
+    // While a dividend snapshot of this unit is being taken, its balances
+    // must stay put. The number isn't used, so the client can try again.
+    else if (DividendPayout::Frozen(
+                 theFromAccount.GetInstrumentDefinitionID())) {
+        const Identifier idAcct(theFromAccount);
+        const String strIDAcct(idAcct);
+        Log::vOutput(0, "%s: Account %s is frozen while a dividend is being "
+                        "paid on its unit. Trans: %" PRId64 "\n",
+                     __FUNCTION__, strIDAcct.Get(), lTransactionNumber);
+    }
 
     // any other security stuff?
     // Todo do I need to verify the server ID here as well?
@@ -41,11 +41,14 @@
 #include <opentxs/server/ConfigLoader.hpp>
 #include <opentxs/server/Macros.hpp>
 #include <opentxs/server/ServerSettings.hpp>
+#include <opentxs/server/DividendPayout.hpp>
+#include <opentxs/server/MintGenerator.hpp>
 #include <opentxs/server/PayDividendVisitor.hpp>
 
 #include <opentxs/ext/Helpers.hpp>
 #include <opentxs/ext/OTPayment.hpp>
 #include <opentxs/cash/Purse.hpp>
+#include <opentxs/cash/SpentTokenStore.hpp>
 #include <opentxs/cash/Token.hpp>
 #include <opentxs/core/contract/basket/Basket.hpp>
 #include <opentxs/core/crypto/OTAsymmetricKey.hpp>
@@ -55,6 +58,7 @@
 #include <opentxs/core/Cheque.hpp>
 #include <opentxs/core/util/OTDataFolder.hpp>
 #include <opentxs/core/crypto/OTEnvelope.hpp>
+#include <opentxs/core/crypto/IntegrityTag.hpp>
 #include <opentxs/core/util/OTFolders.hpp>
 #include <opentxs/core/crypto/OTKeyring.hpp>
 #include <opentxs/core/Ledger.hpp>
@@ -76,6 +80,8 @@
 
 #include <irrxml/irrXML.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <list>
 #include <map>
@@ -106,14 +112,106 @@ int32_t OTCron::__cron_max_items_per_nym = 10;     // The maximum number of cron
 
 void OTServer::ActivateCron()
 {
+    bool bActivated = false;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        bActivated = m_Cron.ActivateCron();
+    }
+
     Log::vOutput(1, "OTServer::ActivateCron: %s \n",
-                 m_Cron.ActivateCron() ? "(STARTED)" : "FAILED");
+                 bActivated ? "(STARTED)" : "FAILED");
+
+    if (bActivated && !cron_thread_.joinable()) {
+        cron_running_.store(true);
+        cron_thread_ = std::thread(&OTServer::CronThread, this);
+    }
+}
+
+// Cron runs on its own thread, so client requests never wait for a cron
+// round to finish unless they need the notary at the same moment. The
+// thread sleeps until the next round is due, releasing lock_ while it does.
+void OTServer::CronThread()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+
+    while (cron_running_.load()) {
+        const int64_t timeout = m_Cron.computeTimeout();
+
+        if (timeout > 0) {
+            cron_wake_.wait_for(lock, std::chrono::milliseconds(timeout));
+
+            continue;
+        }
+
+        ProcessCron();
+    }
+}
+
+void OTServer::StopCron()
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        cron_running_.store(false);
+    }
+
+    cron_wake_.notify_all();
+
+    if (cron_thread_.joinable()) {
+        cron_thread_.join();
+    }
+}
+
+void OTServer::StartPayouts()
+{
+    if (!payout_thread_.joinable()) {
+        payout_pending_ = true;
+        payout_running_.store(true);
+        payout_thread_ = std::thread(&OTServer::PayoutThread, this);
+    }
+}
+
+// Dividend payouts run on their own thread, holding lock_ for each page of
+// vouchers and releasing it in between, so client requests are served while
+// a large payout is in progress.
+void OTServer::PayoutThread()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+
+    while (payout_running_.load()) {
+        if (!payout_pending_) {
+            payout_wake_.wait(lock);
+
+            continue;
+        }
+
+        payout_pending_ = false;
+        DividendPayout::ResumePending(*this, lock);
+    }
+}
+
+void OTServer::QueuePayouts()
+{
+    payout_pending_ = true;
+    payout_wake_.notify_all();
+}
+
+void OTServer::StopPayouts()
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        payout_running_.store(false);
+    }
+
+    payout_wake_.notify_all();
+
+    if (payout_thread_.joinable()) {
+        payout_thread_.join();
+    }
 }
 
-/// Currently the test server calls this 10 times per second.
-/// It also processes all the input/output at the same rate.
-/// It sleeps in between. (See testserver.cpp for the call
-/// and OTLog::Sleep() for the sleep code.)
+/// Called on the cron thread, with lock_ held, whenever the cron
+/// interval has elapsed.
 ///
 void OTServer::ProcessCron()
 {
@@ -140,14 +238,30 @@ void OTServer::ProcessCron()
         m_Cron.SaveCron();
     }
 
-    m_Cron.ProcessCronItems(); // This needs to be called regularly for trades,
-                               // markets, payment plans, etc to process.
+    // Trades and payment plans could move the shares of a unit while a
+    // dividend snapshot of it is being taken, so they wait for the next round.
+    if (!DividendPayout::Freezing()) {
+        m_Cron.ProcessCronItems(); // This needs to be called regularly for
+                                   // trades, markets, payment plans, etc to
+                                   // process.
+    }
+
+    // Once a series is past its valid-to date none of its tokens can be
+    // deposited, so its spent token records are no longer needed.
+    SpentTokenStore::PruneExpired(OTTimeGetCurrentTime());
 
     // NOTE:  TODO:  OTHER RE-OCCURRING SERVER FUNCTIONS CAN GO HERE AS WELL!!
     //
     // Such as sweeping server accounts after expiration dates, etc.
 }
 
+std::size_t OTServer::GenerateNextMintSeries()
+{
+    // The caller must not hold lock_. Generating keys takes minutes, so it
+    // happens without the lock; MintGenerator takes it to save each series.
+    return MintGenerator(*this).NextSeriesForAllUnits();
+}
+
 const Nym& OTServer::GetServerNym() const
 {
     return m_nymServer;
@@ -162,14 +276,24 @@ OTServer::OTServer()
     : mainFile_(this)
     , notary_(this)
     , transactor_(this)
-    , userCommandProcessor_(this)
+    , cron_running_(false)
+    , payout_running_(false)
+    , payout_pending_(false)
     , m_bReadOnly(false)
     , m_bShutdownFlag(false)
+    , cache_(static_cast<std::size_t>(
+          std::max<int64_t>(0, ServerSettings::GetObjectCacheSize())))
 {
 }
 
 OTServer::~OTServer()
 {
+    StopPayouts();
+    StopCron();
+
+    otInfo << "Object cache: " << cache_.Hits() << " hits, "
+           << cache_.Misses() << " misses.\n";
+
     // PID -- Set it to 0 in the lock file so the next time we run OT, it knows
     // there isn't
     // another copy already running (otherwise we might wind up with two copies
@@ -435,6 +559,9 @@ void OTServer::Init(
         OT_FAIL;
     }
 
+    cache_.SetCapacity(static_cast<std::size_t>(
+        std::max<int64_t>(0, ServerSettings::GetObjectCacheSize())));
+
     String dataPath;
     bool bGetDataFolderSuccess = OTDataFolder::Get(dataPath);
 
@@ -513,6 +640,11 @@ void OTServer::Init(
     }
     OTDB::InitDefaultStorage(OTDB_DEFAULT_STORAGE, OTDB_DEFAULT_PACKER);
 
+    // Spent tokens used to be stored one file per token.
+    if (!readOnly) {
+        SpentTokenStore::MigrateLegacy();
+    }
+
     // Load up the transaction number and other OTServer data members.
     bool mainFileExists = m_strWalletFilename.Exists()
                               ? OTDB::Exists(".", m_strWalletFilename.Get())
@@ -535,6 +667,17 @@ void OTServer::Init(
             Log::vError("Error in Loading Main File!\n");
             OT_FAIL;
         }
+
+        InitIntegrity();
+
+        if (!readOnly) {
+            // Finishes any payout interrupted by the last shutdown.
+            StartPayouts();
+
+            if (!args["nextmintseries"].empty()) {
+                GenerateNextMintSeries();
+            }
+        }
     }
 
     // With the Server's private key loaded, and the latest transaction number
@@ -542,6 +685,57 @@ void OTServer::Init(
     // ready for operation!
 }
 
+void OTServer::InitIntegrity()
+{
+    if (!ServerSettings::GetIntegrityTags()) return;
+
+    const char* szKeyFile = "integrity.key";
+    OTPassword theKey;
+
+    if (OTDB::Exists(".", szKeyFile)) {
+        OTEnvelope theEnvelope;
+        String strKey;
+        OTData theData;
+        const std::string strEnvelope(OTDB::QueryPlainString(".", szKeyFile));
+        const OTASCIIArmor ascEnvelope(strEnvelope.c_str());
+
+        if (!theEnvelope.SetAsciiArmoredData(ascEnvelope) ||
+            !theEnvelope.Open(m_nymServer, strKey) ||
+            !OTASCIIArmor(strKey.Get()).GetData(theData) ||
+            (0 == theData.GetSize())) {
+            Log::vError("%s: Unable to open %s. Integrity tags are disabled.\n",
+                        __FUNCTION__, szKeyFile);
+            return;
+        }
+
+        theKey.setMemory(theData);
+    }
+    else {
+        if (m_bReadOnly || (theKey.randomizeMemory(32) <= 0)) {
+            Log::vError("%s: Unable to create %s. Integrity tags are "
+                        "disabled.\n",
+                        __FUNCTION__, szKeyFile);
+            return;
+        }
+
+        const OTData theData(theKey.getMemory(), theKey.getMemorySize());
+        OTEnvelope theEnvelope;
+        OTASCIIArmor ascEnvelope;
+
+        if (!theEnvelope.Seal(m_nymServer, OTASCIIArmor(theData)) ||
+            !theEnvelope.GetAsciiArmoredData(ascEnvelope) ||
+            !OTDB::StorePlainString(ascEnvelope.Get(), ".", szKeyFile)) {
+            Log::vError("%s: Unable to save %s. Integrity tags are "
+                        "disabled.\n",
+                        __FUNCTION__, szKeyFile);
+            return;
+        }
+    }
+
+    IntegrityTag::Enable(theKey, m_strServerNymID);
+    Log::Output(0, "Integrity tags enabled.\n");
+}
+
 // msg, the request msg from payer, which is attached WHOLE to the Nymbox
 // receipt. contains payment already.
 // or pass pPayment instead: we will create our own msg here (with payment
@@ -720,57 +914,18 @@ bool OTServer::DropMessageToNymbox(const Identifier& NOTARY_ID,
                 break; // should never happen.
             }
         }
-        pMsg->m_strNotaryID = m_strNotaryID;
-        pMsg->m_bSuccess = true;
-        SENDER_NYM_ID.GetString(pMsg->m_strNymID);
-        RECIPIENT_NYM_ID.GetString(pMsg->m_strNymID2); // set the recipient ID
-                                                       // in pMsg to match our
-                                                       // recipient ID.
         // Load up the recipient's public key (so we can encrypt the envelope
         // to him that will contain the payment instrument.)
         //
         Nym nymRecipient(RECIPIENT_NYM_ID);
 
-        bool bLoadedNym =
-            nymRecipient.LoadPublicKey(); // Old style (deprecated.) But this
-                                          // function calls the new style,
-                                          // LoadCredentials, at the top.
-                                          // Eventually we'll just call that
-                                          // here directly.
-        if (!bLoadedNym) {
-            Log::vError("%s: Failed trying to load public key for recipient.\n",
-                        szFunc);
-            return false;
-        }
-        else if (!nymRecipient.VerifyPseudonym()) {
-            Log::vError("%s: Failed trying to verify Nym for recipient.\n",
-                        szFunc);
+        if (!LoadRecipientNym(nymRecipient)) {
             return false;
         }
-        const OTAsymmetricKey& thePubkey = nymRecipient.GetPublicEncrKey();
-        // Wrap the message up into an envelope and attach it to pMsg.
-        //
-        OTEnvelope theEnvelope;
 
-        pMsg->m_ascPayload.Release();
-
-        if ((nullptr != pstrMessage) && pstrMessage->Exists() &&
-            theEnvelope.Seal(thePubkey, *pstrMessage) && // Seal pstrMessage
-                                                         // into theEnvelope,
-                                                         // using nymRecipient's
-                                                         // public key.
-            theEnvelope.GetAsciiArmoredData(
-                pMsg->m_ascPayload)) // Grab the sealed version as
-                                     // base64-encoded string, into
-                                     // pMsg->m_ascPayload.
-        {
-            pMsg->SignContract(m_nymServer);
-            pMsg->SaveContract();
-        }
-        else {
-            Log::vError("%s: Failed trying to seal envelope containing message "
-                        "(or while grabbing the base64-encoded result.)\n",
-                        szFunc);
+        if ((nullptr == pstrMessage) ||
+            !SealMessageToNym(SENDER_NYM_ID, RECIPIENT_NYM_ID, nymRecipient,
+                              *pstrMessage, *pMsg)) {
             return false;
         }
 
@@ -866,6 +1021,167 @@ bool OTServer::DropMessageToNymbox(const Identifier& NOTARY_ID,
     return false;
 }
 
+bool OTServer::LoadRecipientNym(Nym& nymRecipient) const
+{
+    bool bLoadedNym =
+        nymRecipient.LoadPublicKey(); // Old style (deprecated.) But this
+                                      // function calls the new style,
+                                      // LoadCredentials, at the top.
+                                      // Eventually we'll just call that
+                                      // here directly.
+    if (!bLoadedNym) {
+        Log::vError("%s: Failed trying to load public key for recipient.\n",
+                    __FUNCTION__);
+        return false;
+    }
+    else if (!nymRecipient.VerifyPseudonym()) {
+        Log::vError("%s: Failed trying to verify Nym for recipient.\n",
+                    __FUNCTION__);
+        return false;
+    }
+
+    return true;
+}
+
+// Fills in msg "from" SENDER_NYM_ID "to" RECIPIENT_NYM_ID, with strMessage
+// sealed in an envelope to the recipient's public key. msg->m_strCommand
+// must already be set.
+bool OTServer::SealMessageToNym(const Identifier& SENDER_NYM_ID,
+                                const Identifier& RECIPIENT_NYM_ID,
+                                const Nym& nymRecipient,
+                                const String& strMessage, Message& msg) const
+{
+    msg.m_strNotaryID = m_strNotaryID;
+    msg.m_bSuccess = true;
+    SENDER_NYM_ID.GetString(msg.m_strNymID);
+    RECIPIENT_NYM_ID.GetString(msg.m_strNymID2); // set the recipient ID
+                                                 // in msg to match our
+                                                 // recipient ID.
+    const OTAsymmetricKey& thePubkey = nymRecipient.GetPublicEncrKey();
+    // Wrap the message up into an envelope and attach it to msg.
+    //
+    OTEnvelope theEnvelope;
+
+    msg.m_ascPayload.Release();
+
+    if (strMessage.Exists() &&
+        theEnvelope.Seal(thePubkey, strMessage) && // Seal strMessage into
+                                                   // theEnvelope, using
+                                                   // nymRecipient's public
+                                                   // key.
+        theEnvelope.GetAsciiArmoredData(
+            msg.m_ascPayload)) // Grab the sealed version as base64-encoded
+                               // string, into msg.m_ascPayload.
+    {
+        msg.SignContract(m_nymServer);
+        msg.SaveContract();
+
+        return true;
+    }
+
+    Log::vError("%s: Failed trying to seal envelope containing message "
+                "(or while grabbing the base64-encoded result.)\n",
+                __FUNCTION__);
+
+    return false;
+}
+
+// Like SendInstrumentToNym, for several payments to the same recipient. The
+// recipient's nym is loaded once, and the nymbox is loaded, signed and saved
+// once for the whole batch. numbers must hold one transaction number (already
+// issued) for each payment's instrumentNotice. Either every payment is
+// delivered, or none is.
+bool OTServer::SendInstrumentsToNym(
+    const Identifier& NOTARY_ID, const Identifier& SENDER_NYM_ID,
+    const Identifier& RECIPIENT_NYM_ID,
+    const std::vector<const OTPayment*>& payments,
+    const std::vector<int64_t>& numbers, const char* szCommand)
+{
+    OT_ASSERT(payments.size() == numbers.size());
+
+    if (payments.empty()) {
+        return true;
+    }
+
+    Nym nymRecipient(RECIPIENT_NYM_ID);
+
+    if (!LoadRecipientNym(nymRecipient)) {
+        return false;
+    }
+
+    std::vector<String> messages;
+
+    for (auto& pPayment : payments) {
+        OT_ASSERT_MSG((nullptr != pPayment) && pPayment->IsValid(),
+                      "OTServer::SendInstrumentsToNym: You can only pass "
+                      "valid payments here.");
+        String strPayment;
+
+        if (!pPayment->GetPaymentContents(strPayment)) {
+            Log::vError("%s: Error GetPaymentContents Failed", __FUNCTION__);
+            return false;
+        }
+
+        Message theMsg;
+        theMsg.m_strCommand =
+            (nullptr != szCommand) ? szCommand : "sendNymInstrument";
+
+        if (!SealMessageToNym(SENDER_NYM_ID, RECIPIENT_NYM_ID, nymRecipient,
+                              strPayment, theMsg)) {
+            return false;
+        }
+
+        messages.push_back(String(theMsg));
+    }
+
+    Ledger theLedger(RECIPIENT_NYM_ID, RECIPIENT_NYM_ID,
+                     NOTARY_ID); // The recipient's Nymbox.
+
+    if (!(theLedger.LoadNymbox() && theLedger.VerifyContractID() &&
+          theLedger.VerifySignature(m_nymServer))) {
+        const String strRecipientNymID(RECIPIENT_NYM_ID);
+        Log::vError("%s: Failed while trying to load or verify Nymbox: %s\n",
+                    __FUNCTION__, strRecipientNymID.Get());
+        return false;
+    }
+
+    std::vector<OTTransaction*> added;
+
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        OTTransaction* pTransaction = OTTransaction::GenerateTransaction(
+            theLedger, OTTransaction::instrumentNotice, numbers[i]);
+
+        if (nullptr == pTransaction) {
+            const String strRecipientNymID(RECIPIENT_NYM_ID);
+            Log::vError("%s: Failed while trying to generate transaction in "
+                        "order to add a message to Nymbox: %s\n",
+                        __FUNCTION__, strRecipientNymID.Get());
+            return false;
+        }
+
+        pTransaction->SetReferenceToNum(numbers[i]);
+        pTransaction->SetReferenceString(messages[i]);
+        pTransaction->SignContract(m_nymServer);
+        pTransaction->SaveContract();
+        theLedger.AddTransaction(*pTransaction); // The ledger will cleanup.
+        added.push_back(pTransaction);
+    }
+
+    // The box receipts go first, so the notices only become visible (with
+    // the nymbox itself) once everything they refer to is in place.
+    for (auto& pTransaction : added) {
+        if (!pTransaction->SaveBoxReceipt(theLedger)) {
+            return false;
+        }
+    }
+
+    theLedger.ReleaseSignatures();
+    theLedger.SignContract(m_nymServer);
+    theLedger.SaveContract();
+
+    return theLedger.SaveNymbox();
+}
+
 bool OTServer::GetConnectInfo(std::string& strHostname, uint32_t& nPort) const
 {
     bool notUsed = false;
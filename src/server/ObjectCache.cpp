@@ -0,0 +1,190 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/server/ObjectCache.hpp>
+
+#include <opentxs/core/app/App.hpp>
+#include <opentxs/core/app/Wallet.hpp>
+#include <opentxs/core/crypto/OTSignedFile.hpp>
+#include <opentxs/core/util/OTFolders.hpp>
+#include <opentxs/core/Contract.hpp>
+#include <opentxs/core/Identifier.hpp>
+#include <opentxs/core/Log.hpp>
+#include <opentxs/core/Nym.hpp>
+#include <opentxs/core/String.hpp>
+
+namespace opentxs
+{
+
+ObjectCache::ObjectCache(const std::size_t capacity)
+    : capacity_(capacity)
+    , hits_(0)
+    , misses_(0)
+{
+}
+
+std::string ObjectCache::Hash(const String& input)
+{
+    Identifier digest;
+    digest.CalculateDigest(input);
+
+    return String(digest).Get();
+}
+
+bool ObjectCache::Find(const std::string& key, std::string& value)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = entries_.find(key);
+
+    if (entries_.end() == it) {
+        misses_++;
+
+        return false;
+    }
+
+    hits_++;
+    value = it->second.first;
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+
+    return true;
+}
+
+void ObjectCache::Insert(const std::string& key, const std::string& value)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if (0 == capacity_) { return; }
+
+    auto it = entries_.find(key);
+
+    if (entries_.end() != it) {
+        it->second.first = value;
+        lru_.splice(lru_.begin(), lru_, it->second.second);
+
+        return;
+    }
+
+    lru_.push_front(key);
+    entries_.emplace(key, Entry(value, lru_.begin()));
+    Trim();
+}
+
+void ObjectCache::Trim()
+{
+    while (entries_.size() > capacity_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+std::size_t ObjectCache::Size() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    return entries_.size();
+}
+
+void ObjectCache::SetCapacity(const std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    capacity_ = capacity;
+    Trim();
+}
+
+void ObjectCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    entries_.clear();
+    lru_.clear();
+}
+
+bool ObjectCache::VerifyPseudonym(const Nym& nym)
+{
+    // The wallet already remembers verified credentials for every nym in
+    // the process
+    return App::Me().Contract().VerifyNym(nym);
+}
+
+bool ObjectCache::LoadSignedNymfile(Nym& nym, Nym& signer)
+{
+    String nymID, signerID;
+    nym.GetIdentifier(nymID);
+    signer.GetIdentifier(signerID);
+
+    // The file is still read and parsed on every load. Only the checks are
+    // skipped for content which was verified before.
+    return nym.LoadSignedNymfile(
+        signer, [&](OTSignedFile& theNymfile, Nym& theSigner) -> bool {
+            String raw;
+            theNymfile.SaveContractRaw(raw);
+            const std::string key = std::string("nymfile/") + nymID.Get() +
+                                    "/" + signerID.Get() + "/" + Hash(raw);
+            std::string verified;
+
+            if (Find(key, verified)) { return true; }
+
+            if (!Nym::VerifySignedNymfile(theNymfile, theSigner)) {
+                return false;
+            }
+
+            Insert(key, "");
+
+            return true;
+        });
+}
+
+bool ObjectCache::VerifySignature(const Contract& contract, const Nym& signer)
+{
+    String contractID, signerID, raw;
+    contract.GetIdentifier(contractID);
+    signer.GetIdentifier(signerID);
+    contract.SaveContractRaw(raw);
+    const std::string key = std::string("sig/") + contractID.Get() + "/" +
+                            signerID.Get() + "/" + Hash(raw);
+    std::string unused;
+
+    if (Find(key, unused)) { return true; }
+
+    if (!contract.VerifySignature(signer)) { return false; }
+
+    Insert(key, "");
+
+    return true;
+}
+
+} // namespace opentxs
@@ -84,6 +84,83 @@ PayDividendVisitor::~PayDividendVisitor()
     m_lAmountReturned = 0;
 }
 
+// Issues a voucher for lAmount, drawn on the voucher account and payable to
+// RECIPIENT_ID, and signs it with the server nym. The caller must already
+// have issued lTransactionNumber to the server nym. Only reads members, so
+// several threads may issue vouchers from the same visitor at once.
+bool PayDividendVisitor::IssueVoucher(int64_t lAmount,
+                                      int64_t lTransactionNumber,
+                                      const Identifier& RECIPIENT_ID,
+                                      String& strVoucher)
+{
+    OT_ASSERT(nullptr != GetNotaryID());
+    const Identifier& theNotaryID = *(GetNotaryID());
+    OT_ASSERT(nullptr != GetPayoutInstrumentDefinitionID());
+    const Identifier& thePayoutInstrumentDefinitionID =
+        *(GetPayoutInstrumentDefinitionID());
+    OT_ASSERT(nullptr != GetVoucherAcctID());
+    const Identifier& theVoucherAcctID = *(GetVoucherAcctID());
+    OT_ASSERT(nullptr != GetServer());
+    OTServer& theServer = *(GetServer());
+    const Nym& theServerNym = theServer.GetServerNym();
+    const Identifier theServerNymID(theServerNym);
+    OT_ASSERT(nullptr != GetMemo());
+    const String& strMemo = *(GetMemo());
+
+    Cheque theVoucher(theNotaryID, thePayoutInstrumentDefinitionID);
+
+    // 10 minutes ==    600 Seconds
+    // 1 hour    ==     3600 Seconds
+    // 1 day    ==    86400 Seconds
+    // 30 days    ==  2592000 Seconds
+    // 3 months ==  7776000 Seconds
+    // 6 months == 15552000 Seconds
+
+    const time64_t VALID_FROM =
+        OTTimeGetCurrentTime(); // This time is set to TODAY NOW
+    const time64_t VALID_TO = OTTimeAddTimeInterval(
+        VALID_FROM, OTTimeGetSecondsFromTime(
+                        OT_TIME_SIX_MONTHS_IN_SECONDS)); // This time occurs in
+                                                         // 180 days (6 months).
+                                                         // Todo hardcoding.
+
+    const bool bIssueVoucher = theVoucher.IssueCheque(
+        lAmount,            // The amount of the cheque.
+        lTransactionNumber, // Requiring a transaction number prevents
+                            // double-spending of cheques.
+        VALID_FROM, // The expiration date (valid from/to dates) of the cheque
+        VALID_TO,   // Vouchers are automatically starting today and lasting 6
+                    // months.
+        theVoucherAcctID, // The asset account the cheque is drawn on.
+        theServerNymID,   // Nym ID of the sender (in this case the server nym.)
+        strMemo, // Optional memo field. Includes item note and request memo.
+        &RECIPIENT_ID);
+
+    if (!bIssueVoucher) {
+        const String strPayoutInstrumentDefinitionID(
+            thePayoutInstrumentDefinitionID),
+            strRecipientNymID(RECIPIENT_ID);
+        Log::vError("PayDividendVisitor::IssueVoucher: ERROR failed issuing "
+                    "voucher. WAS TRYING TO PAY %" PRId64
+                    " of instrument definition %s to Nym %s.\n",
+                    lAmount, strPayoutInstrumentDefinitionID.Get(),
+                    strRecipientNymID.Get());
+        return false;
+    }
+
+    // All this does is set the voucher's internal contract string to
+    // "VOUCHER" instead of "CHEQUE". We also set the server itself as the
+    // remitter, which is unusual for vouchers, but necessary in the case of
+    // dividends.
+    //
+    theVoucher.SetAsVoucher(theServerNymID, theVoucherAcctID);
+    theVoucher.SignContract(theServerNym);
+    theVoucher.SaveContract();
+    theVoucher.SaveContractRaw(strVoucher);
+
+    return true;
+}
+
 // For each "user" account of a specific instrument definition, this function
 // is called in order to pay a dividend to the Nym who owns that account.
 
@@ -111,8 +188,6 @@ bool PayDividendVisitor::Trigger(Account& theSharesAccount) // theSharesAccount
     OT_ASSERT(nullptr != GetPayoutInstrumentDefinitionID());
     const Identifier& thePayoutInstrumentDefinitionID =
         *(GetPayoutInstrumentDefinitionID());
-    OT_ASSERT(nullptr != GetVoucherAcctID());
-    const Identifier& theVoucherAcctID = *(GetVoucherAcctID());
     OT_ASSERT(nullptr != GetServer());
     OTServer& theServer = *(GetServer());
     Nym& theServerNym = const_cast<Nym&>(theServer.GetServerNym());
@@ -120,8 +195,6 @@ bool PayDividendVisitor::Trigger(Account& theSharesAccount) // theSharesAccount
     const Identifier& RECIPIENT_ID = theSharesAccount.GetNymID();
     OT_ASSERT(nullptr != GetNymID());
     const Identifier& theSenderNymID = *(GetNymID());
-    OT_ASSERT(nullptr != GetMemo());
-    const String& strMemo = *(GetMemo());
     // Note: theSenderNymID is the originator of the Dividend Payout.
     // However, all the actual vouchers will be from "the server Nym" and
     // not from theSenderNymID. So then why is it even here? Because anytime
@@ -130,23 +203,6 @@ bool PayDividendVisitor::Trigger(Account& theSharesAccount) // theSharesAccount
     // just having it get lost in the ether.)
     bool bReturnValue = false;
 
-    Cheque theVoucher(theNotaryID, thePayoutInstrumentDefinitionID);
-
-    // 10 minutes ==    600 Seconds
-    // 1 hour    ==     3600 Seconds
-    // 1 day    ==    86400 Seconds
-    // 30 days    ==  2592000 Seconds
-    // 3 months ==  7776000 Seconds
-    // 6 months == 15552000 Seconds
-
-    const time64_t VALID_FROM =
-        OTTimeGetCurrentTime(); // This time is set to TODAY NOW
-    const time64_t VALID_TO = OTTimeAddTimeInterval(
-        VALID_FROM, OTTimeGetSecondsFromTime(
-                        OT_TIME_SIX_MONTHS_IN_SECONDS)); // This time occurs in
-                                                         // 180 days (6 months).
-                                                         // Todo hardcoding.
-
     int64_t lNewTransactionNumber = 0;
 
     bool bGotNextTransNum =
@@ -157,21 +213,6 @@ bool PayDividendVisitor::Trigger(Account& theSharesAccount) // theSharesAccount
     // the voucher account, needs to verify the transaction # on the
     // cheque (to prevent double-spending of cheques.)
     if (bGotNextTransNum) {
-        const bool bIssueVoucher = theVoucher.IssueCheque(
-            lPayoutAmount,         // The amount of the cheque.
-            lNewTransactionNumber, // Requiring a transaction number prevents
-                                   // double-spending of cheques.
-            VALID_FROM, // The expiration date (valid from/to dates) of the
-                        // cheque
-            VALID_TO, // Vouchers are automatically starting today and lasting 6
-                      // months.
-            theVoucherAcctID, // The asset account the cheque is drawn on.
-            theServerNymID,   // Nym ID of the sender (in this case the server
-                              // nym.)
-            strMemo, // Optional memo field. Includes item note and request
-                     // memo.
-            &RECIPIENT_ID);
-
         // All account crediting / debiting happens in the caller, in OTServer.
         //    (AND it happens only ONCE, to cover ALL vouchers.)
         // Then in here, the voucher either gets send to the recipient, or if
@@ -183,19 +224,12 @@ bool PayDividendVisitor::Trigger(Account& theSharesAccount) // theSharesAccount
         // (as well as give him the opportunity to get his money back.)
         //
         bool bSent = false;
-        if (bIssueVoucher) {
-            // All this does is set the voucher's internal contract string to
-            // "VOUCHER" instead of "CHEQUE". We also set the server itself as
-            // the remitter, which is unusual for vouchers, but necessary in the
-            // case of dividends.
-            //
-            theVoucher.SetAsVoucher(theServerNymID, theVoucherAcctID);
-            theVoucher.SignContract(theServerNym);
-            theVoucher.SaveContract();
+        String strVoucher;
 
+        if (IssueVoucher(lPayoutAmount, lNewTransactionNumber, RECIPIENT_ID,
+                         strVoucher)) {
             // Send the voucher to the payments inbox of the recipient.
             //
-            const String strVoucher(theVoucher);
             OTPayment thePayment(strVoucher);
 
             // calls DropMessageToNymbox
@@ -211,53 +245,18 @@ bool PayDividendVisitor::Trigger(Account& theSharesAccount) // theSharesAccount
                                    // lTotalPayoutAmount, then we return to rest
                                    // to the sender.
         }
-        else {
-            const String strPayoutInstrumentDefinitionID(
-                thePayoutInstrumentDefinitionID),
-                strRecipientNymID(RECIPIENT_ID);
-            Log::vError("PayDividendVisitor::Trigger: ERROR failed "
-                        "issuing voucher (to send to dividend payout "
-                        "recipient.) "
-                        "WAS TRYING TO PAY %" PRId64
-                        " of instrument definition %s to Nym %s.\n",
-                        lPayoutAmount, strPayoutInstrumentDefinitionID.Get(),
-                        strRecipientNymID.Get());
-        }
         // If we didn't send it, then we need to return the funds to where they
         // came from.
         //
         if (!bSent) {
-            Cheque theReturnVoucher(theNotaryID,
-                                    thePayoutInstrumentDefinitionID);
-
-            const bool bIssueReturnVoucher = theReturnVoucher.IssueCheque(
-                lPayoutAmount,         // The amount of the cheque.
-                lNewTransactionNumber, // Requiring a transaction number
-                                       // prevents double-spending of cheques.
-                VALID_FROM, // The expiration date (valid from/to dates) of the
-                            // cheque
-                VALID_TO,   // Vouchers are automatically starting today and
-                            // lasting 6 months.
-                theVoucherAcctID, // The asset account the cheque is drawn on.
-                theServerNymID,   // Nym ID of the sender (in this case the
-                                  // server nym.)
-                strMemo, // Optional memo field. Includes item note and request
-                         // memo.
-                &theSenderNymID); // We're returning the money to its original
-                                  // sender.
-            if (bIssueReturnVoucher) {
-                // All this does is set the voucher's internal contract string
-                // to
-                // "VOUCHER" instead of "CHEQUE".
-                //
-                theReturnVoucher.SetAsVoucher(theServerNymID, theVoucherAcctID);
-                theReturnVoucher.SignContract(theServerNym);
-                theReturnVoucher.SaveContract();
+            String strReturnVoucher;
 
+            // We're returning the money to its original sender.
+            if (IssueVoucher(lPayoutAmount, lNewTransactionNumber,
+                             theSenderNymID, strReturnVoucher)) {
                 // Return the voucher back to the payments inbox of the original
                 // sender.
                 //
-                const String strReturnVoucher(theReturnVoucher);
                 OTPayment theReturnPayment(strReturnVoucher);
 
                 // calls DropMessageToNymbox
@@ -273,21 +272,6 @@ bool PayDividendVisitor::Trigger(Account& theSharesAccount) // theSharesAccount
                                        // is less than lTotalPayoutAmount, then
                                        // we return the rest to the sender.
             }
-            else {
-                const String strPayoutInstrumentDefinitionID(
-                    thePayoutInstrumentDefinitionID),
-                    strSenderNymID(theSenderNymID);
-                Log::vError("PayDividendVisitor::Trigger: ERROR "
-                            "failed issuing voucher (to return back to "
-                            "the dividend payout initiator, after a failed "
-                            "payment attempt to the originally intended "
-                            "recipient.) WAS TRYING TO PAY %" PRId64
-                            " of instrument definition "
-                            "%s to Nym %s.\n",
-                            lPayoutAmount,
-                            strPayoutInstrumentDefinitionID.Get(),
-                            strSenderNymID.Get());
-            }
         }  // if !bSent
     }
     else // !bGotNextTransNum
@@ -49,6 +49,20 @@ int64_t ServerSettings::__min_market_scale = 1;
 int32_t ServerSettings::__heartbeat_no_requests = 10;
 // number of ms between each heartbeat.
 int32_t ServerSettings::__heartbeat_ms_between_beats = 100;
+// The number of threads servicing client requests.
+int32_t ServerSettings::__worker_threads = 4;
+// The number of threads verifying the tokens of a cash deposit.
+// (0 means one per core.)
+int32_t ServerSettings::__token_verify_threads = 0;
+// The number of threads generating the keys of a new mint series.
+// (0 means one per core.)
+int32_t ServerSettings::__mint_threads = 0;
+// The size, in bits, of the keys of a new mint series.
+int32_t ServerSettings::__mint_key_size = 1024;
+// The maximum number of verified objects kept in the notary's cache.
+int64_t ServerSettings::__object_cache_size = 10000;
+// Tag stored objects with a local MAC (off by default.)
+bool ServerSettings::__integrity_tags = false;
 // The Nym who's allowed to do certain
 // commands even if they are turned off.
 std::string ServerSettings::__override_nym_id;
@@ -78,42 +78,80 @@ Transactor::~Transactor()
 /// can be used in transaction requests.
 bool Transactor::issueNextTransactionNumber(int64_t& lTransactionNumber)
 {
+    std::lock_guard<std::mutex> lock(lock_);
+
     // transactionNumber_ stores the last VALID AND ISSUED transaction number.
     // So first, we increment that, since we don't want to issue the same number
-    // twice.
-    transactionNumber_++;
+    // twice. Then we save it to file, and only then do we set it onto the
+    // parameter.
+    return reserveTransactionNumbers(1, lTransactionNumber);
+}
+
+bool Transactor::issueTransactionNumbers(const std::size_t count,
+                                         std::vector<int64_t>& numbers)
+{
+    numbers.clear();
+    std::lock_guard<std::mutex> lock(lock_);
+    int64_t first = 0;
+
+    if (!reserveTransactionNumbers(count, first)) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        numbers.push_back(first + static_cast<int64_t>(i));
+    }
+
+    return true;
+}
+
+bool Transactor::reserveTransactionNumbers(const std::size_t count,
+                                           int64_t& first)
+{
+    OT_ASSERT(0 < count);
+
+    transactionNumber_ += static_cast<int64_t>(count);
 
-    // Next, we save it to file.
     if (!server_->mainFile_.SaveMainFile()) {
         Log::Error("Error saving main server file.\n");
-        transactionNumber_--;
+        transactionNumber_ -= static_cast<int64_t>(count);
         return false;
     }
 
-    // SUCCESS?
-    // Now the server main file has saved the latest transaction number,
-    // NOW we set it onto the parameter and return true.
-    lTransactionNumber = transactionNumber_;
+    first = transactionNumber_ - static_cast<int64_t>(count) + 1;
+
     return true;
 }
 
-bool Transactor::issueNextTransactionNumberToNym(Nym& theNym,
-                                                 int64_t& lTransactionNumber)
+void Transactor::releaseTransactionNumbers(const std::size_t count)
+{
+    transactionNumber_ -= static_cast<int64_t>(count);
+    // Save it back how it was, since we're not issuing these numbers after
+    // all.
+    server_->mainFile_.SaveMainFile();
+}
+
+// If theNym has the same ID as server_->m_nymServer, then we'll use
+// server_->m_nymServer instead of theNym.  (Since it's the same nym anyway,
+// we'll stick to the one we already loaded so any changes don't get
+// overwritten later.)
+Nym& Transactor::issuingNym(Nym& theNym)
 {
     Identifier NYM_ID(theNym), NOTARY_NYM_ID(server_->m_nymServer);
 
-    // If theNym has the same ID as server_->m_nymServer, then we'll use
-    // server_->m_nymServer
-    // instead of theNym.  (Since it's the same nym anyway, we'll stick to the
-    // one we already loaded so any changes don't get overwritten later.)
-    Nym* pNym = nullptr;
+    if (NYM_ID == NOTARY_NYM_ID) return server_->m_nymServer;
 
-    if (NYM_ID == NOTARY_NYM_ID)
-        pNym = &server_->m_nymServer;
-    else
-        pNym = &theNym;
+    return theNym;
+}
+
+bool Transactor::issueNextTransactionNumberToNym(Nym& theNym,
+                                                 int64_t& lTransactionNumber)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    Nym& nym = issuingNym(theNym);
+    int64_t number = 0;
 
-    if (!issueNextTransactionNumber(lTransactionNumber)) {
+    if (!reserveTransactionNumbers(1, number)) {
         return false;
     }
 
@@ -125,21 +163,68 @@ bool Transactor::issueNextTransactionNumberToNym(Nym& theNym,
     // is also recorded in his Nym file.)  That way the server always knows
     // which
     // numbers are valid for each Nym.
-    if (!pNym->AddTransactionNum(server_->m_nymServer, server_->m_strNotaryID,
-                                 transactionNumber_, true)) {
+    if (!nym.AddTransactionNum(server_->m_nymServer, server_->m_strNotaryID,
+                               number, true)) {
         Log::Error("Error adding transaction number to Nym file.\n");
-        transactionNumber_--;
-        server_->mainFile_.SaveMainFile(); // Save it back how it was, since
-                                           // we're not
-                                           // issuing this
-                                           // number after all.
+        releaseTransactionNumbers(1);
         return false;
     }
 
     // SUCCESS?
     // Now the server main file has saved the latest transaction number,
     // NOW we set it onto the parameter and return true.
-    lTransactionNumber = transactionNumber_;
+    lTransactionNumber = number;
+    return true;
+}
+
+bool Transactor::issueTransactionNumbersToNym(Nym& theNym,
+                                              const std::size_t count,
+                                              std::vector<int64_t>& numbers)
+{
+    numbers.clear();
+    std::lock_guard<std::mutex> lock(lock_);
+    Nym& nym = issuingNym(theNym);
+    int64_t first = 0;
+
+    if (!reserveTransactionNumbers(count, first)) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const int64_t number = first + static_cast<int64_t>(i);
+
+        if (!nym.AddTransactionNum(server_->m_nymServer,
+                                   server_->m_strNotaryID, number, false)) {
+            Log::Error("Error adding transaction number to Nym file.\n");
+
+            for (auto& it : numbers) {
+                nym.RemoveTransactionNum(server_->m_strNotaryID, it);
+                nym.RemoveIssuedNum(server_->m_strNotaryID, it);
+            }
+
+            numbers.clear();
+            releaseTransactionNumbers(count);
+            return false;
+        }
+
+        numbers.push_back(number);
+    }
+
+    // One save for the whole batch.
+    if (!nym.SaveSignedNymfile(server_->m_nymServer)) {
+        Log::Error("Error saving Nym file after adding transaction "
+                   "numbers.\n");
+
+        for (auto& it : numbers) {
+            nym.RemoveTransactionNum(server_->m_strNotaryID, it);
+            nym.RemoveIssuedNum(server_->m_strNotaryID, it);
+        }
+
+        numbers.clear();
+        releaseTransactionNumbers(count);
+        return false;
+    }
+
     return true;
 }
 
@@ -219,6 +304,12 @@ bool Transactor::removeTransactionNumber(Nym& theNym,
             server_->m_strNotaryID,
             lTransactionNumber); // the version that doesn't save.
 
+    // Even while the Nym's saves are being deferred until the end of the
+    // request, a burned number has to reach the disk before the transaction
+    // that consumes it does anything. Otherwise a crash part way through could
+    // leave the number usable a second time.
+    if (bRemoved && bSave) bRemoved = pNym->FlushDeferredSave();
+
     return bRemoved;
 }
 
@@ -382,6 +473,17 @@ std::shared_ptr<Account> Transactor::getVoucherAccount(
     return pAccount;
 }
 
+void Transactor::forgetMints(const String& instrumentDefinitionID)
+{
+    auto range = mintsMap_.equal_range(instrumentDefinitionID.Get());
+
+    for (auto it = range.first; it != range.second; ++it) {
+        delete it->second;
+    }
+
+    mintsMap_.erase(range.first, range.second);
+}
+
 /// Lookup the current mint for any given instrument definition ID and series.
 Mint* Transactor::getMint(const Identifier& INSTRUMENT_DEFINITION_ID,
                           int32_t nSeries) // Each asset contract has its own
@@ -75,7 +75,9 @@ UserCommandProcessor::UserCommandProcessor(OTServer* server)
 bool UserCommandProcessor::ProcessUserCommand(Message& theMessage,
                                               Message& msgOut,
                                               ClientConnection* pConnection,
-                                              Nym* pNym)
+                                              Nym* pNym,
+                                              const Identifier*
+                                                  verifiedCredentials)
 {
     msgOut.m_strRequestNum.Set(theMessage.m_strRequestNum);
 
@@ -461,21 +463,31 @@ bool UserCommandProcessor::ProcessUserCommand(Message& theMessage,
     // signature
     // on the message that we're processing.
 
-    if (!pNym->VerifyPseudonym()) {
-        Log::Output(
-            0, "Pseudonym failed to verify. Hash of public key doesn't match "
-               "Nym ID that was sent.\n");
-        return false;
+    // The credentials may have changed since the signature was checked,
+    // before the notary lock was taken. The earlier check only counts if it
+    // was made against the credentials which were just loaded.
+    if (!bNymIsServerNym && (nullptr != verifiedCredentials) &&
+        (*verifiedCredentials == pNym->CredentialIndexHash())) {
+        Log::Output(3, "Pseudonym and signature were verified before the "
+                       "request was queued.\n");
     }
-    Log::Output(3, "Pseudonym verified!\n");
+    else {
+        if (!server_->cache_.VerifyPseudonym(*pNym)) {
+            Log::Output(
+                0, "Pseudonym failed to verify. Hash of public key doesn't "
+                   "match Nym ID that was sent.\n");
+            return false;
+        }
+        Log::Output(3, "Pseudonym verified!\n");
 
-    // So far so good. Now let's see if the signature matches...
-    if (!theMessage.VerifySignature(*pNym)) {
-        Log::Output(0, "Signature verification failed!\n");
-        return false;
+        // So far so good. Now let's see if the signature matches...
+        if (!theMessage.VerifySignature(*pNym)) {
+            Log::Output(0, "Signature verification failed!\n");
+            return false;
+        }
+        Log::Output(3, "Signature verified! The message WAS signed by "
+                       "the Nym\'s private key.\n");
     }
-    Log::Output(3, "Signature verified! The message WAS signed by "
-                   "the Nym\'s private key.\n");
 
     // Get the public key from pNym, and set it into the connection.
     // This is only for verified Nyms, (and we're verified in here!) We
@@ -489,7 +501,8 @@ bool UserCommandProcessor::ProcessUserCommand(Message& theMessage,
     // Now we might as well load up the rest of the Nym.
     // Notice I use the && to only load the nymfile if it's NOT the
     // server Nym.
-    if (!bNymIsServerNym && !pNym->LoadSignedNymfile(server_->m_nymServer)) {
+    if (!bNymIsServerNym &&
+        !server_->cache_.LoadSignedNymfile(*pNym, server_->m_nymServer)) {
         Log::vError("Error loading Nymfile: %s\n", theMessage.m_strNymID.Get());
         return false;
     }
@@ -723,7 +736,7 @@ bool UserCommandProcessor::ProcessUserCommand(Message& theMessage,
         Ledger theNymbox(pNym->GetConstID(), pNym->GetConstID(), NOTARY_ID);
 
         if (theNymbox.LoadNymbox() &&
-            theNymbox.VerifySignature(server_->m_nymServer)) {
+            server_->cache_.VerifySignature(theNymbox, server_->m_nymServer)) {
             // if we remove any replyNotices from the Nymbox, then we will want
             // to save the Nymbox (at the end.)
             bool bIsDirtyNymbox = false;
@@ -871,6 +884,10 @@ bool UserCommandProcessor::ProcessUserCommand(Message& theMessage,
     // and it will still want to set the resource as dirty, internally, even
     // when it doesn't save it right away, because otherwise
     // it wouldn't know to save it later, either.
+    //
+    // (MessageProcessor now does the deferring part: see DeferredNymfileSave.
+    // Saves made while processing a request are held back and written once,
+    // after ProcessUserCommand returns.)
 
     msgOut.m_strNotaryID = server_->m_strNotaryID;
     msgOut.SetAcknowledgments(*pNym); // Must be called AFTER
@@ -1653,7 +1670,7 @@ void UserCommandProcessor::UserCmdGetRequestNumber(Nym& theNym, Message& MsgIn,
         Ledger theLedger(theNymID, theNymID, NOTARY_ID);
 
         if (theLedger.LoadNymbox() && theLedger.VerifyContractID() &&
-            theLedger.VerifySignature(server_->m_nymServer)) {
+            server_->cache_.VerifySignature(theLedger, server_->m_nymServer)) {
             theLedger.CalculateNymboxHash(EXISTING_NYMBOX_HASH);
 
             theNym.SetNymboxHashServerSide(EXISTING_NYMBOX_HASH);
@@ -1852,11 +1869,15 @@ void UserCommandProcessor::UserCmdUsageCredits(Nym& theNym, Message& MsgIn,
     {
         bool bLoadedPublicKey =
             nym2.LoadPublicKey() &&
-            nym2.VerifyPseudonym(); // Old style (deprecated.) For now, this
-                                    // calls LoadCredentials inside (which is
-                                    // the new style.) Eventually we'll just
-                                    // call that here directly.
-        bool bLoadSignedNymfile = nym2.LoadSignedNymfile(server_->m_nymServer);
+            server_->cache_.VerifyPseudonym(nym2); // Old style (deprecated.)
+                                                   // For now, this calls
+                                                   // LoadCredentials inside
+                                                   // (which is the new
+                                                   // style.) Eventually we'll
+                                                   // just call that here
+                                                   // directly.
+        bool bLoadSignedNymfile =
+            server_->cache_.LoadSignedNymfile(nym2, server_->m_nymServer);
         if (!bLoadSignedNymfile &&
             !bLoadedPublicKey) // Nym didn't already exist.
         {
@@ -2730,7 +2751,8 @@ void UserCommandProcessor::UserCmdGetAccountData(Nym&, Message& MsgIn,
                 //
                 bSuccessLoadingInbox =
                     (theInbox.VerifyContractID() &&
-                     theInbox.VerifySignature(server_->m_nymServer));
+                     server_->cache_.VerifySignature(
+                         theInbox, server_->m_nymServer));
 
                 // If we loaded old data in this file... (when whole receipts
                 // used to be stored in boxes.)
@@ -2794,7 +2816,8 @@ void UserCommandProcessor::UserCmdGetAccountData(Nym&, Message& MsgIn,
                 //
                 bSuccessLoadingOutbox =
                     (theOutbox.VerifyContractID() &&
-                     theOutbox.VerifySignature(server_->m_nymServer));
+                     server_->cache_.VerifySignature(
+                         theOutbox, server_->m_nymServer));
 
                 // If we loaded old data in this file... (when whole receipts
                 // used to be stored in boxes.)
@@ -3601,7 +3624,8 @@ void UserCommandProcessor::UserCmdDeleteAssetAcct(Nym& theNym, Message& MsgIn,
     std::unique_ptr<Account> pAccount(
         Account::LoadExistingAccount(ACCOUNT_ID, NOTARY_ID));
 
-    if (nullptr == pAccount || !pAccount->VerifyAccount(server_->m_nymServer)) {
+    if (nullptr == pAccount || !pAccount->VerifyContractID() ||
+        !server_->cache_.VerifySignature(*pAccount, server_->m_nymServer)) {
         Log::vError("%s: Error loading or verifying account: %s\n", szFunc,
                     MsgIn.m_strAcctID.Get());
     }
@@ -3758,7 +3782,8 @@ void UserCommandProcessor::UserCmdGetNymbox(Nym& theNym, Message& MsgIn,
         // the IDs and the Signature, of course.
         //
         msgOut.m_bSuccess = (theLedger.VerifyContractID() &&
-                             theLedger.VerifySignature(server_->m_nymServer));
+                             server_->cache_.VerifySignature(
+                                 theLedger, server_->m_nymServer));
 
         // If we loaded old data in this file... (when whole receipts were
         // stored in boxes.)
@@ -4183,7 +4208,8 @@ void UserCommandProcessor::UserCmdProcessInbox(Nym& theNym, Message& MsgIn,
                             "UserCommandProcessor::UserCmdProcessInbox\n");
         }
         // Make sure I, the server, have signed this file.
-        else if (!theAccount.VerifySignature(server_->m_nymServer)) {
+        else if (!server_->cache_.VerifySignature(
+                     theAccount, server_->m_nymServer)) {
             Log::Error("Error verifying server signature on account in "
                        "UserCommandProcessor::UserCmdProcessInbox\n");
         }
@@ -4732,7 +4758,7 @@ void UserCommandProcessor::DropReplyNoticeToNymbox(
     if (true == bSuccessLoadingNymbox)
         bSuccessLoadingNymbox =
             (theNymbox.VerifyContractID() &&
-             theNymbox.VerifySignature(server_->m_nymServer));
+             server_->cache_.VerifySignature(theNymbox, server_->m_nymServer));
 
     if (!bSuccessLoadingNymbox) {
         const String strNymID(NYM_ID);
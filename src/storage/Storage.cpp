@@ -38,18 +38,83 @@
 
 #include <opentxs/storage/Storage.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <ctime>
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
 
 #ifdef OT_STORAGE_FS
 #include <opentxs/storage/StorageFS.hpp>
-#elif defined OT_STORAGE_SQLITE
+#endif
+#ifdef OT_STORAGE_SQLITE
 #include <opentxs/storage/StorageSqlite3.hpp>
 #endif
+#ifdef OT_STORAGE_LMDB
+#include <opentxs/storage/StorageLMDB.hpp>
+#endif
+
+// Index trie parameters
+#define INDEX_NODE_SIZE 32
+#define INDEX_SLOT_BITS 4
+#define INDEX_MAX_DEPTH 8
+// Header of the record stored for a trie node which has children
+#define INDEX_RECORD_MAGIC "otindex"
+#define INDEX_RECORD_VERSION 2
+
+// Prefix of the keys which record finished subtrees during garbage collection
+#define GC_MARKER_PREFIX "gc-"
 
 namespace opentxs
 {
+namespace
+{
+// Accessors for the repeated item field of each index type
+template<class T> struct IndexItems;
+
+template<> struct IndexItems<proto::StorageCredentials>
+{
+    static const google::protobuf::RepeatedPtrField<proto::StorageItemHash>&
+        Get(const proto::StorageCredentials& index) { return index.cred(); }
+    static proto::StorageItemHash* Add(proto::StorageCredentials& index)
+        { return index.add_cred(); }
+};
+
+template<> struct IndexItems<proto::StorageNymList>
+{
+    static const google::protobuf::RepeatedPtrField<proto::StorageItemHash>&
+        Get(const proto::StorageNymList& index) { return index.nym(); }
+    static proto::StorageItemHash* Add(proto::StorageNymList& index)
+        { return index.add_nym(); }
+};
+
+template<> struct IndexItems<proto::StorageSeeds>
+{
+    static const google::protobuf::RepeatedPtrField<proto::StorageItemHash>&
+        Get(const proto::StorageSeeds& index) { return index.seed(); }
+    static proto::StorageItemHash* Add(proto::StorageSeeds& index)
+        { return index.add_seed(); }
+};
+
+template<> struct IndexItems<proto::StorageServers>
+{
+    static const google::protobuf::RepeatedPtrField<proto::StorageItemHash>&
+        Get(const proto::StorageServers& index) { return index.server(); }
+    static proto::StorageItemHash* Add(proto::StorageServers& index)
+        { return index.add_server(); }
+};
+
+template<> struct IndexItems<proto::StorageUnits>
+{
+    static const google::protobuf::RepeatedPtrField<proto::StorageItemHash>&
+        Get(const proto::StorageUnits& index) { return index.unit(); }
+    static proto::StorageItemHash* Add(proto::StorageUnits& index)
+        { return index.add_unit(); }
+};
+} // namespace
+
 Storage* Storage::instance_pointer_ = nullptr;
 
 Storage::Storage(
@@ -60,6 +125,8 @@ Storage::Storage(
         , config_(config)
         , digest_(hash)
         , random_(random)
+        , cache_(static_cast<std::size_t>(
+            std::max<int64_t>(0, config.cache_size_)))
 {
     std::time_t time = std::time(nullptr);
     last_gc_ = static_cast<int64_t>(time);
@@ -73,134 +140,569 @@ void Storage::Init()
     isLoaded_.store(false);
     gc_running_.store(false);
     gc_resume_.store(false);
+    read_epoch_.store(0);
+    readers_[0].store(0);
+    readers_[1].store(0);
+    gc_started_.store(0);
+    gc_migrated_.store(0);
+    gc_skipped_.store(0);
+    gc_tasks_.store(0);
+    gc_tasks_done_.store(0);
 }
 
-Storage& Storage::It(
+Storage* Storage::Factory(
     const Digest& hash,
     const Random& random,
     const StorageConfig& config)
 {
+    Storage* output = nullptr;
 
-    if (nullptr == instance_pointer_) {
 #ifdef OT_STORAGE_FS
-        instance_pointer_ = new StorageFS(config, hash, random);
-#elif defined OT_STORAGE_SQLITE
-        instance_pointer_ = new StorageSqlite3(config, hash, random);
+    if ("fs" == config.backend_) {
+        output = new StorageFS(config, hash, random);
+    }
+#endif
+#ifdef OT_STORAGE_SQLITE
+    if ("sqlite3" == config.backend_) {
+        output = new StorageSqlite3(config, hash, random);
+    }
 #endif
+#ifdef OT_STORAGE_LMDB
+    if ("lmdb" == config.backend_) {
+        output = new StorageLMDB(config, hash, random);
     }
+#endif
+
+    if (nullptr == output) {
+        std::cerr << "Storage backend " << config.backend_
+                  << " is not available." << std::endl;
+
+        return nullptr;
+    }
+
+    if (!output->Ready()) {
+        std::cerr << "Failed to open storage backend " << config.backend_
+                  << " in " << config.path_ << std::endl;
+        delete output;
 
-    assert(nullptr != instance_pointer_);
+        return nullptr;
+    }
+
+    return output;
+}
+
+Storage& Storage::It(
+    const Digest& hash,
+    const Random& random,
+    const StorageConfig& config)
+{
+    if (nullptr == instance_pointer_) {
+        instance_pointer_ = Factory(hash, random, config);
+    }
+
+    // Nothing can be loaded or saved without a backend
+    if (nullptr == instance_pointer_) { std::abort(); }
 
     return *instance_pointer_;
 }
 
+Storage::Batch::Batch(Storage& storage)
+    : storage_(storage)
+{
+    storage_.BeginBatch();
+}
+
+bool Storage::Batch::Commit()
+{
+    if (!open_) { return true; }
+
+    open_ = false;
+
+    return storage_.EndBatch();
+}
+
+Storage::Batch::~Batch()
+{
+    if (!Commit()) {
+        std::cerr << __FUNCTION__ << ": Failed to commit a batch of writes. "
+                  << "Every change made since the last commit was discarded."
+                  << std::endl;
+    }
+}
+
 void Storage::Read()
 {
     std::lock_guard<std::mutex> readLock(init_lock_);
 
     if (!isLoaded_.load()) {
         isLoaded_.store(true);
+        ReadIndices();
+    }
+}
 
-        root_hash_ = LoadRoot();
+void Storage::ReadIndices()
+{
+    root_hash_ = LoadRoot();
 
-        if (root_hash_.empty()) { return; }
+    if (root_hash_.empty()) { return; }
 
-        std::shared_ptr<proto::StorageRoot> root;
+    std::shared_ptr<const proto::StorageRoot> root;
 
-        if (!LoadProto(root_hash_, root)) { return; }
+    if (!LoadProto(root_hash_, root)) { return; }
 
-        items_ = root->items();
-        current_bucket_.store(root->altlocation());
-        last_gc_ = root->lastgc();
-        gc_resume_.store(root->gc());
-        old_gc_root_ = root->gcroot();
+    items_ = root->items();
+    current_bucket_.store(root->altlocation());
+    last_gc_ = root->lastgc();
+    gc_resume_.store(root->gc());
+    old_gc_root_ = root->gcroot();
 
-        std::shared_ptr<proto::StorageItems> items;
+    std::shared_ptr<const proto::StorageItems> items;
 
-        if (!LoadProto(items_, items)) { return; }
+    if (!LoadProto(items_, items)) { return; }
 
-        if (!items->creds().empty()) {
-            std::shared_ptr<proto::StorageCredentials> creds;
+    if (!items->creds().empty()) {
+        if (!ReadIndex<proto::StorageCredentials>(
+                items->creds(), credentials_, credential_trie_)) {
+            std::cerr << __FUNCTION__ << ": failed to load credential "
+                      << "index item. Database is corrupt." << std::endl;
+            std::cerr << "Hash of bad object: (" << items->creds()
+                      << ")" << std::endl;
+            std::abort();
+        }
+    }
 
-            if (!LoadProto(items->creds(), creds)) {
-                std::cerr << __FUNCTION__ << ": failed to load credential "
-                          << "index item. Database is corrupt." << std::endl;
-                std::cerr << "Hash of bad object: (" << items->creds()
-                          << ")" << std::endl;
-                std::abort();
-            }
+    if (!items->nyms().empty()) {
+        if (!ReadIndex<proto::StorageNymList>(
+                items->nyms(), nyms_, nym_trie_)) {
+            std::cerr << __FUNCTION__ << ": failed to load nym "
+            << "index item. Database is corrupt." << std::endl;
+            std::cerr << "Hash of bad object: (" << items->nyms()
+            << ")" << std::endl;
+            std::abort();
+        }
+    }
 
-            for (auto& it : creds->cred()) {
-                credentials_.insert({it.itemid(), {it.hash(), it.alias()}});
-            }
+    if (!items->seeds().empty()) {
+        std::string defaultSeed;
+        const std::function<void(const proto::StorageSeeds&)> getDefault =
+            [&defaultSeed](const proto::StorageSeeds& root) -> void
+            { defaultSeed = root.defaultseed(); };
+
+        if (!ReadIndex<proto::StorageSeeds>(
+                items->seeds(), seeds_, seed_trie_, getDefault)) {
+            std::cerr << __FUNCTION__ << ": failed to load seed "
+                      << "index item. Database is corrupt." << std::endl;
+            std::cerr << "Hash of bad object: (" << items->seeds()
+                      << ")" << std::endl;
+            std::abort();
         }
 
-        if (!items->nyms().empty()) {
-            std::shared_ptr<proto::StorageNymList> nyms;
+        default_seed_ = defaultSeed;
+    }
 
-            if (!LoadProto(items->nyms(), nyms)) {
-                std::cerr << __FUNCTION__ << ": failed to load nym "
-                << "index item. Database is corrupt." << std::endl;
-                std::cerr << "Hash of bad object: (" << items->nyms()
-                << ")" << std::endl;
-                std::abort();
-            }
+    if (!items->servers().empty()) {
+        if (!ReadIndex<proto::StorageServers>(
+                items->servers(), servers_, server_trie_)) {
+            std::cerr << __FUNCTION__ << ": failed to load server "
+                      << "index item. Database is corrupt." << std::endl;
+            std::cerr << "Hash of bad object: (" << items->servers()
+                      << ")" << std::endl;
+            std::abort();
+        }
+    }
 
-            for (auto& it : nyms->nym()) {
-                nyms_.insert({it.itemid(), {it.hash(), it.alias()}});
-            }
+    if (!items->units().empty()) {
+        if (!ReadIndex<proto::StorageUnits>(
+                items->units(), units_, unit_trie_)) {
+            std::cerr << __FUNCTION__ << ": failed to load unit "
+                      << "index item. Database is corrupt." << std::endl;
+            std::cerr << "Hash of bad object: (" << items->units()
+                      << ")" << std::endl;
+            std::abort();
         }
+    }
+}
 
-        if (!items->seeds().empty()) {
-            std::shared_ptr<proto::StorageSeeds> seeds;
+std::uint32_t Storage::IndexSlot(
+    const std::string& id,
+    const std::uint32_t depth)
+{
+    // FNV-1a, so that the layout of a stored trie does not depend on the
+    // platform or standard library which wrote it.
+    std::uint32_t hash = 2166136261u;
 
-            if (!LoadProto(items->seeds(), seeds)) {
-                std::cerr << __FUNCTION__ << ": failed to load seed "
-                          << "index item. Database is corrupt." << std::endl;
-                std::cerr << "Hash of bad object: (" << items->seeds()
-                          << ")" << std::endl;
-                std::abort();
-            }
+    for (const auto& c : id) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 16777619u;
+    }
 
-            default_seed_ = seeds->defaultseed();
+    const std::uint32_t mask = (1u << INDEX_SLOT_BITS) - 1;
 
-            for (auto& it : seeds->seed()) {
-                seeds_.insert({it.itemid(), {it.hash(), it.alias()}});
-            }
+    return (hash >> (depth * INDEX_SLOT_BITS)) & mask;
+}
+
+void Storage::IndexInsert(
+    IndexNode& node,
+    const std::uint32_t depth,
+    const std::string& id,
+    const Metadata& metadata)
+{
+    node.dirty_ = true;
+    auto existing = node.items_.find(id);
+
+    if ((node.items_.end() != existing) || node.children_.empty()) {
+        node.items_[id] = metadata;
+
+        if ((INDEX_NODE_SIZE < node.items_.size()) &&
+            (INDEX_MAX_DEPTH > depth + 1)) {
+            IndexSplit(node, depth);
+        }
+
+        return;
+    }
+
+    auto& child = node.children_[IndexSlot(id, depth)];
+
+    if (!child) { child.reset(new IndexNode); }
+
+    IndexInsert(*child, depth + 1, id, metadata);
+}
+
+void Storage::IndexSplit(IndexNode& node, const std::uint32_t depth)
+{
+    for (auto& it : node.items_) {
+        auto& child = node.children_[IndexSlot(it.first, depth)];
+
+        if (!child) { child.reset(new IndexNode); }
+
+        child->items_.insert(it);
+        child->dirty_ = true;
+    }
+
+    node.items_.clear();
+    node.dirty_ = true;
+
+    for (auto& it : node.children_) {
+        auto& child = *it.second;
+
+        if ((INDEX_NODE_SIZE < child.items_.size()) &&
+            (INDEX_MAX_DEPTH > depth + 2)) {
+            IndexSplit(child, depth + 1);
         }
+    }
+}
 
-        if (!items->servers().empty()) {
-            std::shared_ptr<proto::StorageServers> servers;
+void Storage::IndexErase(
+    IndexNode& node,
+    const std::uint32_t depth,
+    const std::string& id)
+{
+    if (0 != node.items_.erase(id)) {
+        node.dirty_ = true;
 
-            if (!LoadProto(items->servers(), servers)) {
-                std::cerr << __FUNCTION__ << ": failed to load server "
-                          << "index item. Database is corrupt." << std::endl;
-                std::cerr << "Hash of bad object: (" << items->servers()
-                          << ")" << std::endl;
-                std::abort();
-            }
+        return;
+    }
 
-            for (auto& it : servers->server()) {
-                servers_.insert({it.itemid(), {it.hash(), it.alias()}});
-            }
+    auto it = node.children_.find(IndexSlot(id, depth));
+
+    if (node.children_.end() == it) { return; }
+
+    auto& child = *it->second;
+    IndexErase(child, depth + 1, id);
+
+    if (child.dirty_) {
+        node.dirty_ = true;
+
+        if (child.items_.empty() && child.children_.empty()) {
+            node.children_.erase(it);
         }
+    }
+}
 
-        if (!items->units().empty()) {
-            std::shared_ptr<proto::StorageUnits> units;
+void Storage::IndexUpdate(
+    const Index& index,
+    IndexNode& trie,
+    const std::string& id)
+{
+    auto it = index.find(id);
 
-            if (!LoadProto(items->units(), units)) {
-                std::cerr << __FUNCTION__ << ": failed to load unit "
-                          << "index item. Database is corrupt." << std::endl;
-                std::cerr << "Hash of bad object: (" << items->units()
-                          << ")" << std::endl;
-                std::abort();
-            }
+    if ((index.end() == it) || it->second.first.empty()) {
+        IndexErase(trie, 0, id);
+    } else {
+        IndexInsert(trie, 0, id, it->second);
+    }
 
-            for (auto& it : units->unit()) {
-                units_.insert({it.itemid(), {it.hash(), it.alias()}});
-            }
+    // The root is always rewritten, since its hash is what the caller needs
+    trie.dirty_ = true;
+}
+
+bool Storage::LoadRaw(const std::string& key, std::string& value)
+{
+    if (key.empty()) { return false; }
+
+    // Objects written since the last root update have not reached the
+    // backend yet
+    if (LoadPending(key, value)) { return true; }
+
+    bool attemptFirst;
+    if (gc_running_.load()) {
+        attemptFirst = !current_bucket_;
+    } else {
+        attemptFirst = current_bucket_;
+    }
+
+    bool found = false;
+    const std::size_t readSlot = BeginRead();
+
+    // try the other bucket if the object is not in the first one
+    for (const bool bucket : {attemptFirst, !attemptFirst}) {
+        if (Load(key, value, bucket) && !value.empty()) {
+            found = true;
+
+            break;
+        }
+    }
+
+    EndRead(readSlot);
+
+    return found;
+}
+
+bool Storage::LoadInPlace(
+    const std::string& key,
+    const bool bucket,
+    const Reader& reader) const
+{
+    std::string value;
+
+    if (!Load(key, value, bucket)) { return false; }
+
+    return reader(value.data(), value.size());
+}
+
+bool Storage::StoreRaw(const std::string& value, std::string& key)
+{
+    if (nullptr == digest_) { return false; }
+
+    if (!digest_(Storage::HASH_TYPE, value, key)) { return false; }
+
+    return StorePending(key, value);
+}
+
+// A node record is a text object:
+//
+//     otindex 2
+//     <hash of the leaf protobuf, or an empty line>
+//     <slot in hex> <hash of child node>
+//     ...
+//
+// Serialized index protobufs always begin with the tag of the version field
+// (0x08), so the two formats can not be confused.
+bool Storage::LoadIndexNode(
+    const std::string& hash,
+    std::string& leaves,
+    std::map<std::uint32_t, std::string>& children)
+{
+    leaves.clear();
+    children.clear();
+    std::string data;
+
+    if (!LoadRaw(hash, data)) { return false; }
+
+    const std::string magic = std::string(INDEX_RECORD_MAGIC) + " ";
+
+    if (0 != data.compare(0, magic.size(), magic)) {
+        // A node without children is stored as a flat index
+        leaves = hash;
+
+        return true;
+    }
+
+    std::istringstream record(data.substr(magic.size()));
+    std::string line;
+
+    if (!std::getline(record, line) ||
+        (std::to_string(INDEX_RECORD_VERSION) != line)) {
+        std::cerr << __FUNCTION__ << ": unsupported index node version ("
+                  << line << ")" << std::endl;
+
+        return false;
+    }
+
+    if (!std::getline(record, leaves)) { return false; }
+
+    while (std::getline(record, line)) {
+        const std::size_t space = line.find(' ');
+
+        if ((std::string::npos == space) || (0 == space) ||
+            (line.size() == space + 1)) {
+            return false;
+        }
+
+        char* end = nullptr;
+        const unsigned long slot = std::strtoul(line.c_str(), &end, 16);
+
+        if ((line.c_str() + space != end) ||
+            ((1ul << INDEX_SLOT_BITS) <= slot)) {
+            return false;
         }
+
+        const auto inserted = children.insert(
+            {static_cast<std::uint32_t>(slot), line.substr(space + 1)});
+
+        if (!inserted.second) { return false; }
     }
+
+    // Nodes without children are never written as records
+    return !children.empty();
+}
+
+bool Storage::StoreIndexNode(
+    const std::string& leaves,
+    const std::map<std::uint32_t, std::string>& children,
+    std::string& hash)
+{
+    std::ostringstream record;
+    record << INDEX_RECORD_MAGIC << " " << INDEX_RECORD_VERSION << "\n"
+           << leaves << "\n";
+
+    for (auto& it : children) {
+        record << std::hex << it.first << " " << it.second << "\n";
+    }
+
+    return StoreRaw(record.str(), hash);
+}
+
+template<class T>
+bool Storage::ReadIndex(
+    const std::string& hash,
+    Index& index,
+    IndexNode& node,
+    const std::function<void(const T&)>& root,
+    const std::uint32_t depth)
+{
+    std::string leaves;
+    std::map<std::uint32_t, std::string> children;
+
+    if (!LoadIndexNode(hash, leaves, children)) { return false; }
+
+    node.hash_ = hash;
+    node.dirty_ = false;
+
+    if (!leaves.empty()) {
+        std::shared_ptr<const T> serialized;
+
+        if (!LoadProto(leaves, serialized)) { return false; }
+
+        if (root) { root(*serialized); }
+
+        for (auto& it : IndexItems<T>::Get(*serialized)) {
+            const Metadata metadata{it.hash(), it.alias()};
+            index.insert({it.itemid(), metadata});
+            node.items_.insert({it.itemid(), metadata});
+        }
+    }
+
+    for (auto& it : children) {
+        std::unique_ptr<IndexNode> child(new IndexNode);
+
+        if (!ReadIndex<T>(it.second, index, *child, nullptr, depth + 1)) {
+            return false;
+        }
+
+        node.children_[it.first].reset(child.release());
+    }
+
+    return true;
+}
+
+template<class T>
+bool Storage::StoreIndex(
+    IndexNode& node,
+    T& serialized,
+    const std::function<void(T&)>& decorate)
+{
+    std::map<std::uint32_t, std::string> children;
+
+    for (auto& it : node.children_) {
+        auto& child = *it.second;
+
+        if (child.dirty_) {
+            T childIndex;
+
+            if (!StoreIndex<T>(child, childIndex)) { return false; }
+        }
+
+        children[it.first] = child.hash_;
+    }
+
+    serialized.set_version(1);
+
+    for (auto& it : node.items_) {
+        if (!it.first.empty() && !it.second.first.empty()) {
+            proto::StorageItemHash* item = IndexItems<T>::Add(serialized);
+            item->set_version(1);
+            item->set_itemid(it.first);
+            item->set_hash(it.second.first);
+            item->set_alias(it.second.second);
+        }
+    }
+
+    if (decorate) { decorate(serialized); }
+
+    std::string leaves;
+    const bool hasLeaves =
+        children.empty() || decorate || !node.items_.empty();
+
+    if (hasLeaves) {
+        if (!proto::Check(serialized, 0, 0xFFFFFFFF)) {
+            abort();
+        }
+
+        if (!StoreProto(serialized, leaves)) { return false; }
+    }
+
+    if (children.empty()) {
+        node.hash_ = leaves;
+    } else if (!StoreIndexNode(leaves, children, node.hash_)) {
+        return false;
+    }
+
+    node.dirty_ = false;
+
+    return true;
+}
+
+template<class T>
+bool Storage::WalkIndex(
+    const std::string& hash,
+    const std::function<bool(const std::string&)>& node,
+    const std::function<bool(const proto::StorageItemHash&)>& leaf)
+{
+    if (!node(hash)) { return false; }
+
+    std::string leaves;
+    std::map<std::uint32_t, std::string> children;
+
+    if (!LoadIndexNode(hash, leaves, children)) { return false; }
+
+    if (!leaves.empty()) {
+        if ((leaves != hash) && !node(leaves)) { return false; }
+
+        std::shared_ptr<const T> serialized;
+
+        if (!LoadProto(leaves, serialized)) { return false; }
+
+        for (auto& it : IndexItems<T>::Get(*serialized)) {
+            if (!leaf(it)) { return false; }
+        }
+    }
+
+    for (auto& it : children) {
+        if (!WalkIndex<T>(it.second, node, leaf)) { return false; }
+    }
+
+    return true;
 }
 
 // Applies a lambda to all public nyms in the database in a detached thread.
@@ -228,14 +730,14 @@ bool Storage::RemoveServer(const std::string& id)
 {
     if (!isLoaded_.load()) { Read(); }
 
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     // Block reads while modifying server map
     std::unique_lock<std::mutex> serverlock(server_lock_);
     auto deleted = servers_.erase(id);
 
     if (0 != deleted) {
-        return UpdateServers(serverlock);
+        return UpdateServers(serverlock, id);
     }
 
     return false;
@@ -245,14 +747,14 @@ bool Storage::RemoveUnitDefinition(const std::string& id)
 {
     if (!isLoaded_.load()) { Read(); }
 
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     // Block reads while modifying unit map
     std::unique_lock<std::mutex> unitlock(unit_lock_);
     auto deleted = units_.erase(id);
 
     if (0 != deleted) {
-        return UpdateUnits(unitlock);
+        return UpdateUnits(unitlock, id);
     }
 
     return false;
@@ -270,7 +772,7 @@ void Storage::RunMapPublicNyms(NymLambda lambda)
     std::string index = items_;
     write_lock_.unlock();
 
-    std::shared_ptr<proto::StorageItems> items;
+    std::shared_ptr<const proto::StorageItems> items;
 
     if (!LoadProto(items_, items)) {
         gc_lock_.unlock();
@@ -282,25 +784,24 @@ void Storage::RunMapPublicNyms(NymLambda lambda)
         return;
     }
 
-    std::shared_ptr<proto::StorageNymList> nyms;
+    WalkIndex<proto::StorageNymList>(
+        items->nyms(),
+        [](const std::string&) -> bool { return true; },
+        [&](const proto::StorageItemHash& it) -> bool
+        {
+            std::shared_ptr<const proto::StorageNym> nymIndex;
 
-    if (!LoadProto(items->nyms(), nyms)) {
-        gc_lock_.unlock();
-        return;
-    }
-
-    for (auto& it : nyms->nym()) {
-        std::shared_ptr<proto::StorageNym> nymIndex;
+            if (!LoadProto(it.hash(), nymIndex)) { return true; }
 
-        if (!LoadProto(it.hash(), nymIndex)) { continue; }
+            std::shared_ptr<const proto::CredentialIndex> nym;
 
-        std::shared_ptr<proto::CredentialIndex> nym;
+            if (!LoadProto(nymIndex->credlist().hash(), nym))
+                { return true; }
 
-        if (!LoadProto(nymIndex->credlist().hash(), nym))
-            { continue; }
+            lambda(*nym);
 
-        lambda(*nym);
-    }
+            return true;
+        });
 
     gc_lock_.unlock();
 }
@@ -317,7 +818,7 @@ void Storage::RunMapServers(ServerLambda lambda)
     std::string index = items_;
     write_lock_.unlock();
 
-    std::shared_ptr<proto::StorageItems> items;
+    std::shared_ptr<const proto::StorageItems> items;
 
     if (!LoadProto(items_, items)) {
         gc_lock_.unlock();
@@ -329,21 +830,20 @@ void Storage::RunMapServers(ServerLambda lambda)
         return;
     }
 
-    std::shared_ptr<proto::StorageServers> servers;
+    WalkIndex<proto::StorageServers>(
+        items->servers(),
+        [](const std::string&) -> bool { return true; },
+        [&](const proto::StorageItemHash& it) -> bool
+        {
+            std::shared_ptr<const proto::ServerContract> server;
 
-    if (!LoadProto(items->servers(), servers)) {
-        gc_lock_.unlock();
-        return;
-    }
+            if (!LoadProto(it.hash(), server))
+                { return true; }
 
-    for (auto& it : servers->server()) {
-        std::shared_ptr<proto::ServerContract> server;
+            lambda(*server);
 
-        if (!LoadProto(it.hash(), server))
-            { continue; }
-
-        lambda(*server);
-    }
+            return true;
+        });
 
     gc_lock_.unlock();
 }
@@ -360,7 +860,7 @@ void Storage::RunMapUnits(UnitLambda lambda)
     std::string index = items_;
     write_lock_.unlock();
 
-    std::shared_ptr<proto::StorageItems> items;
+    std::shared_ptr<const proto::StorageItems> items;
 
     if (!LoadProto(items_, items)) {
         gc_lock_.unlock();
@@ -372,21 +872,20 @@ void Storage::RunMapUnits(UnitLambda lambda)
         return;
     }
 
-    std::shared_ptr<proto::StorageUnits> units;
+    WalkIndex<proto::StorageUnits>(
+        items->units(),
+        [](const std::string&) -> bool { return true; },
+        [&](const proto::StorageItemHash& it) -> bool
+        {
+            std::shared_ptr<const proto::UnitDefinition> unit;
 
-    if (!LoadProto(items->units(), units)) {
-        gc_lock_.unlock();
-        return;
-    }
+            if (!LoadProto(it.hash(), unit))
+                { return true; }
 
-    for (auto& it : units->unit()) {
-        std::shared_ptr<proto::UnitDefinition> unit;
+            lambda(*unit);
 
-        if (!LoadProto(it.hash(), unit))
-            { continue; }
-
-        lambda(*unit);
-    }
+            return true;
+        });
 
     gc_lock_.unlock();
 }
@@ -427,32 +926,15 @@ bool Storage::UpdateNymCreds(
 
 bool Storage::UpdateCredentials(const std::string& id, const std::string& hash)
 {
-    // Do not test for existing object - we always regenerate from scratch
     if (!id.empty() && !hash.empty()) {
 
         // Block reads while updating credential map
         cred_lock_.lock();
         credentials_[id].first = hash;
-        proto::StorageCredentials credIndex;
-        credIndex.set_version(1);
-        for (auto& cred : credentials_) {
-            if (!cred.first.empty() && !cred.second.first.empty()) {
-                proto::StorageItemHash* item = credIndex.add_cred();
-                item->set_version(1);
-                item->set_itemid(cred.first);
-                item->set_hash(cred.second.first);
-                item->set_alias(cred.second.second);
-            }
-        }
+        IndexUpdate(credentials_, credential_trie_, id);
         cred_lock_.unlock();
 
-        if (!proto::Check(credIndex, 0, 0xFFFFFFFF)) {
-            abort();
-        }
-
-        if (StoreProto(credIndex)) {
-            return UpdateItems(credIndex);
-        }
+        return UpdateIndices();
     }
 
     return false;
@@ -479,7 +961,7 @@ bool Storage::UpdateNym(const proto::StorageNym& nym, const std::string& alias)
         nyms_[id].first = hash;
         nyms_[id].second = newAlias;
 
-        return UpdateNyms(nymLock);
+        return UpdateNyms(nymLock, id);
     }
 
     return false;
@@ -493,36 +975,20 @@ bool Storage::UpdateNymAlias(const std::string& id, const std::string& alias)
         std::unique_lock<std::mutex> nymLock(nym_lock_);
         nyms_[id].second = alias;
 
-        return UpdateNyms(nymLock);
+        return UpdateNyms(nymLock, id);
     }
 
     return false;
 }
 
-bool Storage::UpdateNyms(std::unique_lock<std::mutex>& nymLock)
+bool Storage::UpdateNyms(
+    std::unique_lock<std::mutex>& nymLock,
+    const std::string& id)
 {
-    proto::StorageNymList nymIndex;
-    nymIndex.set_version(1);
-    for (auto& nym : nyms_) {
-        if (!nym.first.empty() && !nym.second.first.empty()) {
-            proto::StorageItemHash* item = nymIndex.add_nym();
-            item->set_version(1);
-            item->set_itemid(nym.first);
-            item->set_hash(nym.second.first);
-            item->set_alias(nym.second.second);
-        }
-    }
+    IndexUpdate(nyms_, nym_trie_, id);
     nymLock.unlock();
 
-    if (!proto::Check(nymIndex, 0, 0xFFFFFFFF)) {
-        abort();
-    }
-
-    if (StoreProto(nymIndex)) {
-        return UpdateItems(nymIndex);
-    }
-
-    return false;
+    return UpdateIndices();
 }
 
 bool Storage::UpdateSeed(
@@ -548,7 +1014,7 @@ bool Storage::UpdateSeed(
             default_seed_ = id;
         }
 
-        return UpdateSeeds(seedLock);
+        return UpdateSeeds(seedLock, id);
     }
 
     return false;
@@ -562,7 +1028,7 @@ bool Storage::UpdateSeedAlias(const std::string& id, const std::string& alias)
         std::unique_lock<std::mutex> seedLock(seed_lock_);
         seeds_[id].second = alias;
 
-        return UpdateSeeds(seedLock);
+        return UpdateSeeds(seedLock, id);
     }
 
     return false;
@@ -576,38 +1042,20 @@ bool Storage::UpdateSeedDefault(const std::string& id)
         std::unique_lock<std::mutex> seedLock(default_seed_lock_);
         default_seed_ = id;
 
-        return UpdateSeeds(seedLock);
+        return UpdateSeeds(seedLock, id);
     }
 
     return false;
 }
 
-bool Storage::UpdateSeeds(std::unique_lock<std::mutex>& seedlock)
+bool Storage::UpdateSeeds(
+    std::unique_lock<std::mutex>& seedlock,
+    const std::string& id)
 {
-    proto::StorageSeeds seedIndex;
-    seedIndex.set_version(1);
-    seedIndex.set_defaultseed(default_seed_);
-
-    for (auto& seed : seeds_) {
-        if (!seed.first.empty() && !seed.second.first.empty()) {
-            proto::StorageItemHash* item = seedIndex.add_seed();
-            item->set_version(1);
-            item->set_itemid(seed.first);
-            item->set_hash(seed.second.first);
-            item->set_alias(seed.second.second);
-        }
-    }
+    IndexUpdate(seeds_, seed_trie_, id);
     seedlock.unlock();
 
-    if (!proto::Check(seedIndex, 0, 0xFFFFFFFF)) {
-        abort();
-    }
-
-    if (StoreProto(seedIndex)) {
-        return UpdateItems(seedIndex);
-    }
-
-    return false;
+    return UpdateIndices();
 }
 
 bool Storage::UpdateServer(
@@ -629,7 +1077,7 @@ bool Storage::UpdateServer(
         servers_[id].first = hash;
         servers_[id].second = newAlias;
 
-        return UpdateServers(serverlock);
+        return UpdateServers(serverlock, id);
     }
 
     return false;
@@ -644,36 +1092,20 @@ bool Storage::UpdateServerAlias(const std::string& id, const std::string& alias)
         std::unique_lock<std::mutex> serverlock(server_lock_);
         servers_[id].second = alias;
 
-        return UpdateServers(serverlock);
+        return UpdateServers(serverlock, id);
     }
 
     return false;
 }
 
-bool Storage::UpdateServers(std::unique_lock<std::mutex>& serverlock)
+bool Storage::UpdateServers(
+    std::unique_lock<std::mutex>& serverlock,
+    const std::string& id)
 {
-    proto::StorageServers serverIndex;
-    serverIndex.set_version(1);
-    for (auto& server : servers_) {
-        if (!server.first.empty() && !server.second.first.empty()) {
-            proto::StorageItemHash* item = serverIndex.add_server();
-            item->set_version(1);
-            item->set_itemid(server.first);
-            item->set_hash(server.second.first);
-            item->set_alias(server.second.second);
-        }
-    }
+    IndexUpdate(servers_, server_trie_, id);
     serverlock.unlock();
 
-    if (!proto::Check(serverIndex, 0, 0xFFFFFFFF)) {
-        abort();
-    }
-
-    if (StoreProto(serverIndex)) {
-        return UpdateItems(serverIndex);
-    }
-
-    return false;
+    return UpdateIndices();
 }
 
 bool Storage::UpdateUnit(
@@ -696,7 +1128,7 @@ bool Storage::UpdateUnit(
         units_[id].first = hash;
         units_[id].second = newAlias;
 
-        return UpdateUnits(unitlock);
+        return UpdateUnits(unitlock, id);
     }
 
     return false;
@@ -706,193 +1138,138 @@ bool Storage::UpdateUnitAlias(const std::string& id, const std::string& alias)
 {
     if (!id.empty() && !alias.empty()) {
 
-        // Block reads while updating unit map
-        std::unique_lock<std::mutex> unitlock(unit_lock_);
-        units_[id].second = alias;
-
-        return UpdateUnits(unitlock);
-    }
-
-    return false;
-}
-
-bool Storage::UpdateUnits(std::unique_lock<std::mutex>& unitlock)
-{
-    proto::StorageUnits unitIndex;
-    unitIndex.set_version(1);
-    for (auto& unit : units_) {
-        if (!unit.first.empty() && !unit.second.first.empty()) {
-            proto::StorageItemHash* item = unitIndex.add_unit();
-            item->set_version(1);
-            item->set_itemid(unit.first);
-            item->set_hash(unit.second.first);
-            item->set_alias(unit.second.second);
-        }
-    }
-    unitlock.unlock();
-
-    if (!proto::Check(unitIndex, 0, 0xFFFFFFFF)) {
-        abort();
-    }
-
-    if (StoreProto(unitIndex)) {
-        return UpdateItems(unitIndex);
-    }
-
-    return false;
-}
-
-
-bool Storage::UpdateItems(const proto::StorageCredentials& creds)
-{
-    // Reuse existing object, since it may contain more than just creds
-    std::shared_ptr<proto::StorageItems> items;
-
-    if (!LoadProto(items_, items, true)) {
-        items = std::make_shared<proto::StorageItems>();
-        items->set_version(1);
-    } else {
-        items->clear_creds();
-    }
-
-    if (digest_) {
-        std::string plaintext = ProtoAsString<proto::StorageCredentials>(creds);
-        std::string hash;
-        digest_(Storage::HASH_TYPE, plaintext, hash);
-
-        items->set_creds(hash);
-
-        if (!proto::Check(*items, 0, 0xFFFFFFFF)) {
-            abort();
-        }
-
-        if (StoreProto(*items)) {
-            return UpdateRoot(*items);
-        }
+        // Block reads while updating unit map
+        std::unique_lock<std::mutex> unitlock(unit_lock_);
+        units_[id].second = alias;
+
+        return UpdateUnits(unitlock, id);
     }
 
     return false;
 }
 
-bool Storage::UpdateItems(const proto::StorageNymList& nyms)
+bool Storage::UpdateUnits(
+    std::unique_lock<std::mutex>& unitlock,
+    const std::string& id)
 {
-    // Reuse existing object, since it may contain more than just nyms
-    std::shared_ptr<proto::StorageItems> items;
+    IndexUpdate(units_, unit_trie_, id);
+    unitlock.unlock();
 
-    if (!LoadProto(items_, items, true)) {
-        items = std::make_shared<proto::StorageItems>();
-        items->set_version(1);
-    } else {
-        items->clear_nyms();
-    }
+    return UpdateIndices();
+}
 
-    if (digest_) {
-        std::string plaintext = ProtoAsString<proto::StorageNymList>(nyms);
-        std::string hash;
-        digest_(Storage::HASH_TYPE, plaintext, hash);
 
-        items->set_nyms(hash);
+bool Storage::UpdateIndices()
+{
+    // Writes made inside a batch are committed when the last batch closes
+    if (0 < batches_) { return true; }
 
-        if (!proto::Check(*items, 0, 0xFFFFFFFF)) {
-            abort();
-        }
+    if (WriteIndices()) { return true; }
 
-        if (StoreProto(*items)) {
-            return UpdateRoot(*items);
-        }
-    }
+    Rollback();
 
     return false;
 }
 
-bool Storage::UpdateItems(const proto::StorageSeeds& seeds)
+void Storage::Rollback()
 {
-    // Reuse existing object, since it may contain more than just seeds
+    std::lock_guard<std::mutex> readLock(init_lock_);
+    std::lock(cred_lock_, nym_lock_, seed_lock_, server_lock_, unit_lock_,
+              default_seed_lock_, pending_lock_);
+    std::lock_guard<std::mutex> credLock(cred_lock_, std::adopt_lock);
+    std::lock_guard<std::mutex> nymLock(nym_lock_, std::adopt_lock);
+    std::lock_guard<std::mutex> seedLock(seed_lock_, std::adopt_lock);
+    std::lock_guard<std::mutex> serverLock(server_lock_, std::adopt_lock);
+    std::lock_guard<std::mutex> unitLock(unit_lock_, std::adopt_lock);
+    std::lock_guard<std::mutex> defaultLock(
+        default_seed_lock_, std::adopt_lock);
+    std::unique_lock<std::mutex> pendingLock(pending_lock_, std::adopt_lock);
+
+    // Objects staged for a root which will never be written
+    pending_.clear();
+    pendingLock.unlock();
+
+    credentials_.clear();
+    nyms_.clear();
+    seeds_.clear();
+    servers_.clear();
+    units_.clear();
+    credential_trie_ = IndexNode();
+    nym_trie_ = IndexNode();
+    seed_trie_ = IndexNode();
+    server_trie_ = IndexNode();
+    unit_trie_ = IndexNode();
+    default_seed_.clear();
+    items_.clear();
+
+    // Back to the state of the last root which reached the backend
+    ReadIndices();
+}
+
+bool Storage::WriteIndices()
+{
+
+    // Reuse existing object, since it may contain more than just indices
     std::shared_ptr<proto::StorageItems> items;
 
     if (!LoadProto(items_, items, true)) {
         items = std::make_shared<proto::StorageItems>();
         items->set_version(1);
-    } else {
-        items->clear_seeds();
     }
 
-    if (digest_) {
-        std::string plaintext = ProtoAsString(seeds);
-        std::string hash;
-        digest_(Storage::HASH_TYPE, plaintext, hash);
-
-        items->set_seeds(hash);
+    if (credential_trie_.dirty_) {
+        proto::StorageCredentials credIndex;
 
-        if (!proto::Check(*items, 0, 0xFFFFFFFF)) {
-            abort();
-        }
+        if (!StoreIndex(credential_trie_, credIndex)) { return false; }
 
-        if (StoreProto(*items)) {
-            return UpdateRoot(*items);
-        }
+        items->set_creds(credential_trie_.hash_);
     }
 
-    return false;
-}
+    if (nym_trie_.dirty_) {
+        proto::StorageNymList nymIndex;
 
-bool Storage::UpdateItems(const proto::StorageServers& servers)
-{
-    // Reuse existing object, since it may contain more than just servers
-    std::shared_ptr<proto::StorageItems> items;
+        if (!StoreIndex(nym_trie_, nymIndex)) { return false; }
 
-    if (!LoadProto(items_, items, true)) {
-        items = std::make_shared<proto::StorageItems>();
-        items->set_version(1);
-    } else {
-        items->clear_servers();
+        items->set_nyms(nym_trie_.hash_);
     }
 
-    if (digest_) {
-        std::string plaintext = ProtoAsString<proto::StorageServers>(servers);
-        std::string hash;
-        digest_(Storage::HASH_TYPE, plaintext, hash);
+    if (seed_trie_.dirty_) {
+        std::unique_lock<std::mutex> seedLock(default_seed_lock_);
+        const std::string defaultSeed = default_seed_;
+        seedLock.unlock();
 
-        items->set_servers(hash);
+        proto::StorageSeeds seedIndex;
+        const std::function<void(proto::StorageSeeds&)> setDefault =
+            [&defaultSeed](proto::StorageSeeds& root) -> void
+            { root.set_defaultseed(defaultSeed); };
 
-        if (!proto::Check(*items, 0, 0xFFFFFFFF)) {
-            abort();
-        }
+        if (!StoreIndex(seed_trie_, seedIndex, setDefault)) { return false; }
 
-        if (StoreProto(*items)) {
-            return UpdateRoot(*items);
-        }
+        items->set_seeds(seed_trie_.hash_);
     }
 
-    return false;
-}
+    if (server_trie_.dirty_) {
+        proto::StorageServers serverIndex;
 
-bool Storage::UpdateItems(const proto::StorageUnits& units)
-{
-    // Reuse existing object, since it may contain more than just units
-    std::shared_ptr<proto::StorageItems> items;
+        if (!StoreIndex(server_trie_, serverIndex)) { return false; }
 
-    if (!LoadProto(items_, items, true)) {
-        items = std::make_shared<proto::StorageItems>();
-        items->set_version(1);
-    } else {
-        items->clear_units();
+        items->set_servers(server_trie_.hash_);
     }
 
-    if (digest_) {
-        std::string plaintext = ProtoAsString<proto::StorageUnits>(units);
-        std::string hash;
-        digest_(Storage::HASH_TYPE, plaintext, hash);
+    if (unit_trie_.dirty_) {
+        proto::StorageUnits unitIndex;
 
-        items->set_units(hash);
+        if (!StoreIndex(unit_trie_, unitIndex)) { return false; }
 
-        if (!proto::Check(*items, 0, 0xFFFFFFFF)) {
-            abort();
-        }
+        items->set_units(unit_trie_.hash_);
+    }
 
-        if (StoreProto(*items)) {
-            return UpdateRoot(*items);
-        }
+    if (!proto::Check(*items, 0, 0xFFFFFFFF)) {
+        abort();
+    }
+
+    if (StoreProto(*items)) {
+        return UpdateRoot(*items);
     }
 
     return false;
@@ -933,6 +1310,8 @@ bool Storage::UpdateRoot(const proto::StorageItems& items)
 
             root_hash_ = hash;
 
+            if (!Flush()) { return false; }
+
             return StoreRoot(hash);
         }
     }
@@ -965,6 +1344,8 @@ bool Storage::UpdateRoot(
 
             root_hash_ = hash;
 
+            if (!Flush()) { return false; }
+
             return StoreRoot(hash);
         }
     }
@@ -996,6 +1377,8 @@ bool Storage::UpdateRoot()
 
             root_hash_ = hash;
 
+            if (!Flush()) { return false; }
+
             return StoreRoot(hash);
         }
     }
@@ -1078,7 +1461,7 @@ bool Storage::Load(
     nymLock.unlock();
 
     if (found) {
-        std::shared_ptr<proto::StorageNym> nymIndex;
+        std::shared_ptr<const proto::StorageNym> nymIndex;
 
         if (LoadProto(hash, nymIndex, checking)) {
             std::string credListHash = nymIndex->credlist().hash();
@@ -1247,7 +1630,7 @@ bool Storage::SetDefaultSeed(const std::string& id)
     if (!isLoaded_.load()) { Read(); }
 
     // block writes while searching seed map
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     // do not set the default seed to an id that's not present in the map
     bool found = (seeds_.find(id) != seeds_.end());
@@ -1265,7 +1648,7 @@ bool Storage::SetNymAlias(const std::string& id, const std::string& alias)
     if (!isLoaded_.load()) { Read(); }
 
     // block writes while searching nym map
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     bool found = (nyms_.find(id) != nyms_.end());
 
@@ -1282,7 +1665,7 @@ bool Storage::SetSeedAlias(const std::string& id, const std::string& alias)
     if (!isLoaded_.load()) { Read(); }
 
     // block writes while searching seed map
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     bool found = (seeds_.find(id) != seeds_.end());
 
@@ -1299,7 +1682,7 @@ bool Storage::SetServerAlias(const std::string& id, const std::string& alias)
     if (!isLoaded_.load()) { Read(); }
 
     // block writes while searching server map
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     bool found = (servers_.find(id) != servers_.end());
 
@@ -1318,7 +1701,7 @@ bool Storage::SetUnitDefinitionAlias(
     if (!isLoaded_.load()) { Read(); }
 
     // block writes while searching server map
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     bool found = (units_.find(id) != units_.end());
 
@@ -1379,7 +1762,7 @@ bool Storage::Store(const proto::Credential& data)
     }
 
     std::string key;
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     if (StoreProto(data, key)) {
 
@@ -1412,7 +1795,7 @@ bool Storage::Store(const proto::CredentialIndex& data, const std::string alias)
     }
 
     std::string key, plaintext;
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     if (StoreProto(data, key, plaintext)) {
         if (config_.auto_publish_nyms_ && config_.dht_callback_) {
@@ -1431,7 +1814,7 @@ bool Storage::Store(const proto::Seed& data, const std::string alias)
     const std::string& id = data.fingerprint();
 
     std::string key;
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     if (StoreProto(data, key)) {
 
@@ -1452,7 +1835,7 @@ bool Storage::Store(const proto::ServerContract& data, const std::string alias)
     if (!proto::Check(storageVersion, 0, 0xFFFFFFFF)) { return false; }
 
     std::string key, plaintext;
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     if (StoreProto(data, key, plaintext)) {
         if (config_.auto_publish_servers_ && config_.dht_callback_) {
@@ -1476,7 +1859,7 @@ bool Storage::Store(const proto::UnitDefinition& data, const std::string alias)
     if (!proto::Check(storageVersion, 0, 0xFFFFFFFF)) { return false; }
 
     std::string key, plaintext;
-    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto writeLock = LockWrites();
 
     if (StoreProto(data, key)) {
         if (config_.auto_publish_units_ && config_.dht_callback_) {
@@ -1520,15 +1903,22 @@ Storage::ObjectList Storage::UnitDefinitionList()
 void Storage::CollectGarbage()
 {
     bool oldLocation = current_bucket_.load();
-    current_bucket_.store(!(current_bucket_.load()));
 
     std::shared_ptr<proto::StorageRoot> root;
     std::string gcroot, gcitems;
     bool updated = false;
 
+    gc_migrated_.store(0);
+    gc_skipped_.store(0);
+    gc_tasks_.store(0);
+    gc_tasks_done_.store(0);
+    gc_started_.store(static_cast<int64_t>(std::time(nullptr)));
+
     if (!gc_resume_.load()) {
+        current_bucket_.store(!oldLocation);
+
         // Do not allow changes to root index object until we've updated it.
-        std::unique_lock<std::mutex> writeLock(write_lock_);
+        auto writeLock = LockWrites();
         gcroot = root_hash_;
 
         if (!LoadProto(root_hash_, root, true)) {
@@ -1540,6 +1930,9 @@ void Storage::CollectGarbage()
         updated = UpdateRoot(*root, gcroot);
         writeLock.unlock();
     } else {
+        // The root written when the interrupted run started already points
+        // at the new bucket
+        oldLocation = !oldLocation;
         gcroot = old_gc_root_;
 
         if (!LoadProto(old_gc_root_, root)) {
@@ -1555,101 +1948,392 @@ void Storage::CollectGarbage()
         gc_running_.store(false);
         return;
     }
-    MigrateKey(gcitems);
-    std::shared_ptr<proto::StorageItems> items;
+    std::shared_ptr<const proto::StorageItems> items;
 
     if (!LoadProto(gcitems, items)) {
         gc_running_.store(false);
         return;
     }
 
-    if (!items->creds().empty()) {
-        MigrateKey(items->creds());
-        std::shared_ptr<proto::StorageCredentials> creds;
+    // Every node of each index trie is migrated, along with the objects
+    // the leaves point to. Subtrees are split across the worker pool.
+    std::vector<std::function<bool()>> tasks;
+    std::vector<std::string> roots;
+    const std::function<bool(const proto::StorageItemHash&)> migrateLeaf =
+        [this](const proto::StorageItemHash& it) -> bool
+        { return MigrateKey(it.hash()); };
+    const std::function<bool(const proto::StorageItemHash&)> migrateNym =
+        [this](const proto::StorageItemHash& it) -> bool
+        {
+            std::shared_ptr<const proto::StorageNym> nym;
 
-        if (!LoadProto(items->creds(), creds)) {
-            gc_running_.store(false);
-            return;
-        }
+            if (!LoadProto(it.hash(), nym)) { return false; }
+            if (!MigrateKey(nym->credlist().hash())) { return false; }
 
-        for (auto& it : creds->cred()) {
-            MigrateKey(it.hash());
-        }
+            return MigrateKey(it.hash());
+        };
+    bool queued = true;
+
+    if (!items->creds().empty()) {
+        queued &= QueueIndex<proto::StorageCredentials>(
+            items->creds(), migrateLeaf, tasks, roots);
     }
 
     if (!items->nyms().empty()) {
-        MigrateKey(items->nyms());
-        std::shared_ptr<proto::StorageNymList> nyms;
+        queued &= QueueIndex<proto::StorageNymList>(
+            items->nyms(), migrateNym, tasks, roots);
+    }
+
+    if (!items->seeds().empty()) {
+        queued &= QueueIndex<proto::StorageSeeds>(
+            items->seeds(), migrateLeaf, tasks, roots);
+    }
+
+    if (!items->servers().empty()) {
+        queued &= QueueIndex<proto::StorageServers>(
+            items->servers(), migrateLeaf, tasks, roots);
+    }
+
+    if (!items->units().empty()) {
+        queued &= QueueIndex<proto::StorageUnits>(
+            items->units(), migrateLeaf, tasks, roots);
+    }
+
+    if (!queued || !RunGCTasks(tasks)) {
+        gc_running_.store(false);
+        return;
+    }
 
-        if (!LoadProto(items->nyms(), nyms)) {
+    // Index roots are finished last, so that a marker on any node always
+    // means its whole subtree has been migrated
+    for (auto& hash : roots) {
+        if (!MigrateKey(hash) || !MarkMigrated(hash)) {
             gc_running_.store(false);
             return;
         }
+    }
+
+    if (!MigrateKey(gcitems)) {
+        gc_running_.store(false);
+        return;
+    }
 
-        for (auto& it : nyms->nym()) {
-            MigrateKey(it.hash());
-            std::shared_ptr<proto::StorageNym> nym;
+    auto writeLock = LockWrites();
+    UpdateRoot();
+    writeLock.unlock();
 
-            if (!LoadProto(it.hash(), nym)) {
-                gc_running_.store(false);
-                return;
-            }
+    WaitForReaders();
+    EmptyBucket(oldLocation);
 
-            MigrateKey(nym->credlist().hash());
-        }
+    // The totals stay available from GarbageCollectionStatus()
+    gc_running_.store(false);
+}
+
+template<class T>
+bool Storage::QueueIndex(
+    const std::string& hash,
+    const std::function<bool(const proto::StorageItemHash&)>& leaf,
+    std::vector<std::function<bool()>>& tasks,
+    std::vector<std::string>& roots)
+{
+    if (Migrated(hash)) {
+        gc_skipped_++;
+
+        return true;
     }
 
-    if (!items->seeds().empty()) {
-        MigrateKey(items->seeds());
-        std::shared_ptr<proto::StorageSeeds> seeds;
+    std::string leafHash;
+    std::map<std::uint32_t, std::string> children;
 
-        if (!LoadProto(items->seeds(), seeds)) {
-            gc_running_.store(false);
-            return;
-        }
+    if (!LoadIndexNode(hash, leafHash, children)) { return false; }
 
-        for (auto& it : seeds->seed()) {
-            MigrateKey(it.hash());
-        }
+    for (auto& it : children) {
+        const std::string child = it.second;
+        tasks.push_back(
+            [this, child, leaf]() -> bool
+            { return MigrateIndex<T>(child, leaf); });
     }
 
-    if (!items->servers().empty()) {
-        MigrateKey(items->servers());
-        std::shared_ptr<proto::StorageServers> servers;
+    if (!leafHash.empty()) {
+        std::shared_ptr<const T> serialized;
 
-        if (!LoadProto(items->servers(), servers)) {
-            gc_running_.store(false);
-            return;
-        }
+        if (!LoadProto(leafHash, serialized)) { return false; }
+
+        std::vector<proto::StorageItemHash> leaves;
 
-        for (auto& it : servers->server()) {
-            MigrateKey(it.hash());
+        for (auto& it : IndexItems<T>::Get(*serialized)) {
+            leaves.push_back(it);
         }
+
+        // The leaf protobuf of a node record is a separate object
+        const std::string record = (leafHash != hash) ? leafHash : "";
+
+        tasks.push_back(
+            [this, leaves, leaf, record]() -> bool
+            {
+                for (auto& it : leaves) {
+                    if (!leaf(it)) { return false; }
+                }
+
+                return record.empty() || MigrateKey(record);
+            });
     }
 
-    if (!items->units().empty()) {
-        MigrateKey(items->units());
-        std::shared_ptr<proto::StorageUnits> units;
+    roots.push_back(hash);
 
-        if (!LoadProto(items->units(), units)) {
-            gc_running_.store(false);
-            return;
+    return true;
+}
+
+template<class T>
+bool Storage::MigrateIndex(
+    const std::string& hash,
+    const std::function<bool(const proto::StorageItemHash&)>& leaf)
+{
+    if (Migrated(hash)) {
+        gc_skipped_++;
+
+        return true;
+    }
+
+    std::string leaves;
+    std::map<std::uint32_t, std::string> children;
+
+    if (!LoadIndexNode(hash, leaves, children)) { return false; }
+
+    if (!leaves.empty()) {
+        std::shared_ptr<const T> serialized;
+
+        if (!LoadProto(leaves, serialized)) { return false; }
+
+        for (auto& it : IndexItems<T>::Get(*serialized)) {
+            if (!leaf(it)) { return false; }
         }
 
-        for (auto& it : units->unit()) {
-            MigrateKey(it.hash());
+        if ((leaves != hash) && !MigrateKey(leaves)) { return false; }
+    }
+
+    for (auto& it : children) {
+        if (!MigrateIndex<T>(it.second, leaf)) { return false; }
+    }
+
+    if (!MigrateKey(hash)) { return false; }
+
+    return MarkMigrated(hash);
+}
+
+bool Storage::RunGCTasks(const std::vector<std::function<bool()>>& tasks)
+{
+    gc_tasks_.store(tasks.size());
+
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> success(true);
+
+    auto worker = [&tasks, &next, &success, this]() -> void
+    {
+        while (success.load()) {
+            const std::size_t task = next++;
+
+            if (task >= tasks.size()) { return; }
+
+            if (tasks[task]()) {
+                gc_tasks_done_++;
+            } else {
+                success.store(false);
+            }
         }
+    };
+
+    std::size_t threads = 1;
+
+    if (0 < config_.gc_threads_) {
+        threads = static_cast<std::size_t>(config_.gc_threads_);
     }
 
-    std::unique_lock<std::mutex> writeLock(write_lock_);
-    UpdateRoot();
-    writeLock.unlock();
+    threads = std::min(threads, tasks.size());
+    std::vector<std::thread> pool;
 
-    std::unique_lock<std::mutex> bucketLock(bucket_lock_);
-    EmptyBucket(oldLocation);
-    bucketLock.unlock();
+    // The calling thread is one of the workers
+    for (std::size_t i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
 
-    gc_running_.store(false);
+    worker();
+
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    return success.load();
+}
+
+std::string Storage::MigratedKey(const std::string& hash)
+{
+    return std::string(GC_MARKER_PREFIX) + hash;
+}
+
+bool Storage::Migrated(const std::string& hash)
+{
+    std::string notUsed;
+
+    return Load(MigratedKey(hash), notUsed, current_bucket_.load());
+}
+
+bool Storage::MarkMigrated(const std::string& hash)
+{
+    // Markers are not reachable from the root, so the next collection
+    // discards them along with the rest of this bucket
+    return Store(MigratedKey(hash), hash, current_bucket_.load());
+}
+
+void Storage::Throttle()
+{
+    if (0 >= config_.gc_max_keys_per_second_) { return; }
+
+    const std::chrono::microseconds interval(
+        1000000 / config_.gc_max_keys_per_second_);
+
+    std::unique_lock<std::mutex> throttleLock(throttle_lock_);
+    const auto now = std::chrono::steady_clock::now();
+
+    if (throttle_next_ < now) { throttle_next_ = now; }
+
+    const auto slot = throttle_next_;
+    throttle_next_ += interval;
+    throttleLock.unlock();
+
+    std::this_thread::sleep_until(slot);
+}
+
+Storage::GCStatus Storage::GarbageCollectionStatus() const
+{
+    GCStatus status;
+    status.running_ = gc_running_.load();
+    status.started_ = gc_started_.load();
+    status.migrated_ = gc_migrated_.load();
+    status.skipped_ = gc_skipped_.load();
+    status.tasks_ = gc_tasks_.load();
+    status.tasks_done_ = gc_tasks_done_.load();
+
+    return status;
+}
+
+bool Storage::Store(const KeyValues& values, const bool bucket) const
+{
+    for (auto& it : values) {
+        if (!Store(it.first, it.second, bucket)) { return false; }
+    }
+
+    return true;
+}
+
+std::size_t Storage::BeginRead()
+{
+    while (true) {
+        const std::uint64_t epoch = read_epoch_.load();
+        const std::size_t slot = epoch % 2;
+        readers_[slot]++;
+
+        // If the epoch advanced in the meantime the writer may already have
+        // seen this slot as empty, so register again in the new one
+        if (epoch == read_epoch_.load()) { return slot; }
+
+        readers_[slot]--;
+    }
+}
+
+void Storage::EndRead(const std::size_t slot)
+{
+    readers_[slot]--;
+}
+
+void Storage::WaitForReaders()
+{
+    // New reads register in the other slot from now on
+    const std::uint64_t epoch = read_epoch_++;
+    const std::size_t slot = epoch % 2;
+
+    while (0 < readers_[slot].load()) {
+        std::this_thread::yield();
+    }
+}
+
+bool Storage::Flush()
+{
+    KeyValues values;
+    std::unique_lock<std::mutex> pendingLock(pending_lock_);
+
+    if (pending_.empty()) { return true; }
+
+    values.reserve(pending_.size());
+
+    for (auto& it : pending_) {
+        values.push_back({it.first, it.second});
+    }
+
+    if (!Store(values, current_bucket_.load())) { return false; }
+
+    pending_.clear();
+
+    return true;
+}
+
+bool Storage::LoadPending(const std::string& key, std::string& value)
+{
+    std::lock_guard<std::mutex> pendingLock(pending_lock_);
+    auto it = pending_.find(key);
+
+    if (pending_.end() == it) { return false; }
+
+    value = it->second;
+
+    return true;
+}
+
+bool Storage::StorePending(const std::string& key, const std::string& value)
+{
+    std::lock_guard<std::mutex> pendingLock(pending_lock_);
+    pending_[key] = value;
+
+    return true;
+}
+
+void Storage::BeginBatch()
+{
+    if (!isLoaded_.load()) { Read(); }
+
+    auto writeLock = LockWrites();
+    batch_owner_ = std::this_thread::get_id();
+    ++batches_;
+}
+
+bool Storage::EndBatch()
+{
+    std::lock_guard<std::mutex> writeLock(write_lock_);
+
+    assert(0 < batches_);
+
+    if (0 == batches_) { return false; }
+
+    --batches_;
+
+    if (0 < batches_) { return true; }
+
+    batch_owner_ = std::thread::id();
+    const bool committed = UpdateIndices();
+    batch_closed_.notify_all();
+
+    return committed;
+}
+
+std::unique_lock<std::mutex> Storage::LockWrites()
+{
+    auto writeLock = LockWrites();
+    const auto self = std::this_thread::get_id();
+    batch_closed_.wait(writeLock, [&]() -> bool {
+        return (0 == batches_) || (self == batch_owner_);
+    });
+
+    return writeLock;
 }
 
 bool Storage::MigrateKey(const std::string& key)
@@ -1658,9 +2342,12 @@ bool Storage::MigrateKey(const std::string& key)
 
     // try to load the key from the inactive bucket
     if (Load(key, value, !(current_bucket_.load()))) {
+        Throttle();
 
         // save to the active bucket
         if (Store(key, value, current_bucket_.load())) {
+            gc_migrated_++;
+
             return true;
         } else {
             return false;
@@ -1682,6 +2369,14 @@ void Storage::RunGC()
     if (!gc_running_.load() && ( gc_resume_.load() || intervalExceeded)) {
         assert (!gc_running_.load());
         gc_running_.store(true);
+
+        // Reap the thread of the previous run before starting a new one
+        if (nullptr != gc_thread_) {
+            if (gc_thread_->joinable()) { gc_thread_->join(); }
+
+            delete gc_thread_;
+        }
+
         gc_thread_ = new std::thread(&Storage::CollectGarbage, this);
     }
 }
@@ -1691,6 +2386,7 @@ void Storage::Storage::Cleanup_Storage()
     if ((nullptr != gc_thread_) && gc_thread_->joinable()) {
         gc_thread_->join();
         delete gc_thread_;
+        gc_thread_ = nullptr;
     }
 }
 
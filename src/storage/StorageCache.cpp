@@ -0,0 +1,177 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include <opentxs/storage/StorageCache.hpp>
+
+#include <functional>
+
+// Number of independently locked parts of the cache
+#define STORAGE_CACHE_SHARDS 16
+// Allocator and node overhead of an entry: the shared_ptr control block, the
+// hash table node and the LRU list node
+#define STORAGE_CACHE_ENTRY_OVERHEAD 128
+
+namespace opentxs
+{
+
+StorageCache::StorageCache(const std::size_t capacity)
+    : shards_(new Shard[STORAGE_CACHE_SHARDS])
+{
+    hits_.store(0);
+    misses_.store(0);
+
+    for (std::size_t i = 0; i < STORAGE_CACHE_SHARDS; ++i) {
+        shards_[i].capacity_ = capacity / STORAGE_CACHE_SHARDS;
+    }
+}
+
+std::size_t StorageCache::Footprint(
+    const std::string& hash,
+    const std::size_t objectSize,
+    const std::size_t serializedSize)
+{
+    // The key is held by both the hash table and the LRU list
+    return objectSize + (2 * serializedSize) + (2 * hash.capacity()) +
+           sizeof(Entry) + STORAGE_CACHE_ENTRY_OVERHEAD;
+}
+
+StorageCache::Shard& StorageCache::ShardFor(const std::string& hash) const
+{
+    return shards_[std::hash<std::string>()(hash) % STORAGE_CACHE_SHARDS];
+}
+
+StorageCache::Object StorageCache::Get(const std::string& hash)
+{
+    Shard& shard = ShardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+    auto it = shard.entries_.find(hash);
+
+    if (shard.entries_.end() == it) {
+        misses_++;
+
+        return nullptr;
+    }
+
+    hits_++;
+    shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second.position_);
+
+    return it->second.object_;
+}
+
+void StorageCache::Insert(
+    const std::string& hash,
+    const Object& object,
+    const std::size_t objectSize,
+    const std::size_t serializedSize)
+{
+    const std::size_t size = Footprint(hash, objectSize, serializedSize);
+    Shard& shard = ShardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+
+    // Objects larger than the whole shard would only evict everything else
+    if (size > shard.capacity_) { return; }
+
+    auto it = shard.entries_.find(hash);
+
+    if (shard.entries_.end() != it) {
+        shard.lru_.splice(
+            shard.lru_.begin(), shard.lru_, it->second.position_);
+
+        return;
+    }
+
+    shard.lru_.push_front(hash);
+    shard.entries_.emplace(hash, Entry{object, size, shard.lru_.begin()});
+    shard.bytes_ += size;
+    shard.Trim();
+}
+
+void StorageCache::Shard::Trim()
+{
+    while ((bytes_ > capacity_) && !lru_.empty()) {
+        auto it = entries_.find(lru_.back());
+        bytes_ -= it->second.size_;
+        entries_.erase(it);
+        lru_.pop_back();
+    }
+}
+
+std::size_t StorageCache::Bytes() const
+{
+    std::size_t output = 0;
+
+    for (std::size_t i = 0; i < STORAGE_CACHE_SHARDS; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].lock_);
+        output += shards_[i].bytes_;
+    }
+
+    return output;
+}
+
+std::size_t StorageCache::Count() const
+{
+    std::size_t output = 0;
+
+    for (std::size_t i = 0; i < STORAGE_CACHE_SHARDS; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].lock_);
+        output += shards_[i].entries_.size();
+    }
+
+    return output;
+}
+
+void StorageCache::SetCapacity(const std::size_t capacity)
+{
+    for (std::size_t i = 0; i < STORAGE_CACHE_SHARDS; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].lock_);
+        shards_[i].capacity_ = capacity / STORAGE_CACHE_SHARDS;
+        shards_[i].Trim();
+    }
+}
+
+void StorageCache::Clear()
+{
+    for (std::size_t i = 0; i < STORAGE_CACHE_SHARDS; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].lock_);
+        shards_[i].entries_.clear();
+        shards_[i].lru_.clear();
+        shards_[i].bytes_ = 0;
+    }
+}
+
+} // namespace opentxs
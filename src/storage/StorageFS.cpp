@@ -71,7 +71,27 @@ void StorageFS::Purge(const std::string& path)
 {
     if (path.empty()) { return; }
 
-    boost::filesystem::remove_all(path);
+    // Remove one file at a time under the gc rate limit, instead of a single
+    // remove_all which saturates the disk when the bucket is large. The
+    // entries are listed first, since removing them while iterating the
+    // directory is unspecified.
+    boost::system::error_code ec;
+    boost::filesystem::directory_iterator end;
+    std::vector<boost::filesystem::path> entries;
+
+    for (boost::filesystem::directory_iterator it(path, ec); it != end;
+         it.increment(ec)) {
+        if (ec) { break; }
+
+        entries.push_back(it->path());
+    }
+
+    for (const auto& entry : entries) {
+        Throttle();
+        boost::filesystem::remove_all(entry, ec);
+    }
+
+    boost::filesystem::remove_all(path, ec);
 }
 
 std::string StorageFS::LoadRoot() const
@@ -0,0 +1,319 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifdef OT_STORAGE_LMDB
+#include <opentxs/storage/StorageLMDB.hpp>
+
+#include <cerrno>
+#include <iostream>
+#include <string>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+namespace opentxs
+{
+namespace
+{
+// Creates folder and any missing parents
+bool CreateFolder(const std::string& folder)
+{
+    if (folder.empty()) { return false; }
+
+    for (std::size_t i = 1; i <= folder.size(); ++i) {
+        const bool end = (folder.size() == i);
+
+        if (!end && ('/' != folder[i]) && ('\\' != folder[i])) { continue; }
+
+        const std::string parent = folder.substr(0, i);
+#ifdef _WIN32
+        const bool created = (0 == _mkdir(parent.c_str()));
+#else
+        const bool created = (0 == mkdir(parent.c_str(), 0700));
+#endif
+
+        if (!created && (EEXIST != errno)) {
+            std::cerr << "Failed to create folder " << parent << std::endl;
+
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+StorageLMDB::StorageLMDB(
+    const StorageConfig& config,
+    const Digest&hash,
+    const Random& random)
+        : ot_super(config, hash, random)
+        , folder_(config.path_)
+{
+    Init_StorageLMDB();
+}
+
+bool StorageLMDB::Get(
+    const MDB_dbi database,
+    const std::string& key,
+    const Reader& reader) const
+{
+    if (nullptr == env_) { return false; }
+
+    MDB_txn* transaction = nullptr;
+
+    if (0 != mdb_txn_begin(env_, nullptr, MDB_RDONLY, &transaction)) {
+        return false;
+    }
+
+    MDB_val mdbKey{key.size(), const_cast<char*>(key.data())};
+    MDB_val mdbValue{0, nullptr};
+    bool success = false;
+
+    // The returned value points directly into the memory map, and is only
+    // valid until the transaction ends
+    if (0 == mdb_get(transaction, database, &mdbKey, &mdbValue)) {
+        success = reader(
+            static_cast<const char*>(mdbValue.mv_data), mdbValue.mv_size);
+    }
+
+    mdb_txn_abort(transaction);
+
+    return success;
+}
+
+bool StorageLMDB::Get(
+    const MDB_dbi database,
+    const std::string& key,
+    std::string& value) const
+{
+    return Get(
+        database,
+        key,
+        [&value](const char* data, const std::size_t size) -> bool
+        {
+            value.assign(data, size);
+
+            return true;
+        });
+}
+
+bool StorageLMDB::Put(
+    const MDB_dbi database,
+    const std::string& key,
+    const std::string& value) const
+{
+    if (nullptr == env_) { return false; }
+
+    MDB_txn* transaction = nullptr;
+
+    if (0 != mdb_txn_begin(env_, nullptr, 0, &transaction)) { return false; }
+
+    MDB_val mdbKey{key.size(), const_cast<char*>(key.data())};
+    MDB_val mdbValue{value.size(), const_cast<char*>(value.data())};
+
+    if (0 != mdb_put(transaction, database, &mdbKey, &mdbValue, 0)) {
+        mdb_txn_abort(transaction);
+
+        return false;
+    }
+
+    return (0 == mdb_txn_commit(transaction));
+}
+
+bool StorageLMDB::OpenDatabase(
+    MDB_txn* transaction,
+    const std::string& name,
+    MDB_dbi& database)
+{
+    const int result =
+        mdb_dbi_open(transaction, name.c_str(), MDB_CREATE, &database);
+
+    if (0 != result) {
+        std::cerr << "Failed to open database " << name << ": "
+                  << mdb_strerror(result) << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+void StorageLMDB::Init_StorageLMDB()
+{
+    MDB_txn* transaction = nullptr;
+    // mdb_env_open expects the environment's folder to exist
+    bool success = CreateFolder(folder_);
+    success = success && (0 == mdb_env_create(&env_));
+
+    success = success && (0 == mdb_env_set_maxdbs(env_, 3));
+    success = success && (0 == mdb_env_set_mapsize(
+        env_, static_cast<std::size_t>(config_.lmdb_map_size_)));
+    // MDB_NOTLS lets read transactions be started from any thread without
+    // tying up a reader slot per thread
+    success = success && (0 == mdb_env_open(
+        env_, folder_.c_str(), MDB_NOTLS, 0664));
+    success = success && (0 == mdb_txn_begin(env_, nullptr, 0, &transaction));
+    success = success &&
+        OpenDatabase(transaction, config_.lmdb_primary_bucket_, primary_);
+    success = success &&
+        OpenDatabase(transaction, config_.lmdb_secondary_bucket_, secondary_);
+    success = success &&
+        OpenDatabase(transaction, config_.lmdb_control_table_, control_);
+
+    if (success) {
+        success = (0 == mdb_txn_commit(transaction));
+    } else if (nullptr != transaction) {
+        mdb_txn_abort(transaction);
+    }
+
+    ready_ = success;
+
+    if (!ready_) {
+        std::cerr << "Failed to initialize database in " << folder_
+                  << std::endl;
+    }
+}
+
+std::string StorageLMDB::LoadRoot() const
+{
+    std::string value;
+
+    if (Get(control_, config_.lmdb_root_key_, value)) {
+
+        return value;
+    }
+
+    return "";
+}
+
+bool StorageLMDB::Load(
+    const std::string& key,
+    std::string& value,
+    const bool bucket) const
+{
+    return Get(GetDatabase(bucket), key, value);
+}
+
+bool StorageLMDB::LoadInPlace(
+    const std::string& key,
+    const bool bucket,
+    const Reader& reader) const
+{
+    return Get(GetDatabase(bucket), key, reader);
+}
+
+bool StorageLMDB::StoreRoot(const std::string& hash)
+{
+    return Put(control_, config_.lmdb_root_key_, hash);
+}
+
+bool StorageLMDB::Store(
+    const std::string& key,
+    const std::string& value,
+    const bool bucket) const
+{
+    return Put(GetDatabase(bucket), key, value);
+}
+
+bool StorageLMDB::Store(const KeyValues& values, const bool bucket) const
+{
+    if (nullptr == env_) { return false; }
+
+    const MDB_dbi database = GetDatabase(bucket);
+    MDB_txn* transaction = nullptr;
+
+    if (0 != mdb_txn_begin(env_, nullptr, 0, &transaction)) { return false; }
+
+    for (auto& it : values) {
+        MDB_val mdbKey{it.first.size(), const_cast<char*>(it.first.data())};
+        MDB_val mdbValue{
+            it.second.size(),
+            const_cast<char*>(it.second.data())};
+
+        if (0 != mdb_put(transaction, database, &mdbKey, &mdbValue, 0)) {
+            mdb_txn_abort(transaction);
+
+            return false;
+        }
+    }
+
+    return (0 == mdb_txn_commit(transaction));
+}
+
+bool StorageLMDB::EmptyBucket(const bool bucket)
+{
+    if (nullptr == env_) { return false; }
+
+    MDB_txn* transaction = nullptr;
+
+    if (0 != mdb_txn_begin(env_, nullptr, 0, &transaction)) { return false; }
+
+    // Deletes every key but keeps the database handle open
+    if (0 != mdb_drop(transaction, GetDatabase(bucket), 0)) {
+        mdb_txn_abort(transaction);
+
+        return false;
+    }
+
+    return (0 == mdb_txn_commit(transaction));
+}
+
+void StorageLMDB::Cleanup_StorageLMDB()
+{
+    if (nullptr != env_) {
+        mdb_env_close(env_);
+        env_ = nullptr;
+    }
+}
+
+void StorageLMDB::Cleanup()
+{
+    Cleanup_StorageLMDB();
+}
+
+StorageLMDB::~StorageLMDB()
+{
+    Cleanup_StorageLMDB();
+}
+
+} // namespace opentxs
+#endif
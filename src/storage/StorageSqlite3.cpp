@@ -38,8 +38,14 @@
 #ifdef OT_STORAGE_SQLITE
 #include <opentxs/storage/StorageSqlite3.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <iostream>
 #include <string>
 
+// How long a reader waits for the writer to finish a commit before giving up
+#define SQLITE3_BUSY_TIMEOUT_MS 5000
+
 namespace opentxs
 {
 StorageSqlite3::StorageSqlite3(
@@ -52,27 +58,167 @@ StorageSqlite3::StorageSqlite3(
     Init_StorageSqlite3();
 }
 
+std::string StorageSqlite3::Filename() const
+{
+    return folder_ + "/" + config_.sqlite3_db_file_;
+}
+
+sqlite3_stmt* StorageSqlite3::Prepared(
+    sqlite3* db,
+    std::map<std::string, sqlite3_stmt*>& statements,
+    const std::string& tablename,
+    const std::string& query) const
+{
+    auto& statement = statements[tablename];
+
+    if (nullptr == statement) {
+        if (SQLITE_OK !=
+            sqlite3_prepare_v2(db, query.c_str(), -1, &statement, 0)) {
+            std::cerr << "Failed to prepare statement: " << query << std::endl
+                      << sqlite3_errmsg(db) << std::endl;
+            sqlite3_finalize(statement);
+            statements.erase(tablename);
+
+            return nullptr;
+        }
+    }
+
+    return statement;
+}
+
+std::unique_ptr<StorageSqlite3::Reader> StorageSqlite3::CheckoutReader() const
+{
+    {
+        std::lock_guard<std::mutex> readerLock(reader_lock_);
+
+        if (!readers_.empty()) {
+            std::unique_ptr<Reader> reader(std::move(readers_.back()));
+            readers_.pop_back();
+
+            return reader;
+        }
+    }
+
+    std::unique_ptr<Reader> reader(new Reader);
+
+    if (SQLITE_OK != sqlite3_open_v2(
+        Filename().c_str(),
+        &reader->db_,
+        SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+        nullptr)) {
+            std::cerr << "Failed to open a read connection: "
+                      << sqlite3_errmsg(reader->db_) << std::endl;
+            CloseReader(*reader);
+
+            return nullptr;
+    }
+
+    sqlite3_busy_timeout(reader->db_, SQLITE3_BUSY_TIMEOUT_MS);
+
+    return reader;
+}
+
+void StorageSqlite3::ReturnReader(std::unique_ptr<Reader>& reader) const
+{
+    std::lock_guard<std::mutex> readerLock(reader_lock_);
+    readers_.push_back(std::move(reader));
+}
+
+void StorageSqlite3::CloseReader(Reader& reader) const
+{
+    for (auto& it : reader.select_statements_) {
+        sqlite3_finalize(it.second);
+    }
+
+    reader.select_statements_.clear();
+    sqlite3_close(reader.db_);
+    reader.db_ = nullptr;
+}
+
+void StorageSqlite3::CloseReaders() const
+{
+    std::lock_guard<std::mutex> readerLock(reader_lock_);
+
+    for (auto& reader : readers_) {
+        CloseReader(*reader);
+    }
+
+    readers_.clear();
+}
+
+void StorageSqlite3::FinalizeStatements(const std::string& tablename) const
+{
+    auto it = upsert_statements_.find(tablename);
+
+    if (upsert_statements_.end() != it) {
+        sqlite3_finalize(it->second);
+        upsert_statements_.erase(it);
+    }
+
+    // Idle readers may hold statements on the table too
+    CloseReaders();
+}
+
+void StorageSqlite3::FinalizeStatements() const
+{
+    for (auto& it : upsert_statements_) {
+        sqlite3_finalize(it.second);
+    }
+
+    upsert_statements_.clear();
+    CloseReaders();
+}
+
 bool StorageSqlite3::Select(
     const std::string& key,
     const std::string& tablename,
     std::string& value) const
 {
-    sqlite3_stmt* statement = nullptr;
-    const std::string query =
-        "select v from `" + tablename + "` where k=?1 LIMIT 0,1;";
+    return Select(
+        key,
+        tablename,
+        [&value](const char* data, const std::size_t size) -> bool
+        {
+            value.assign(data, size);
+
+            return true;
+        });
+}
+
+bool StorageSqlite3::Select(
+    const std::string& key,
+    const std::string& tablename,
+    const ot_super::Reader& read) const
+{
+    std::unique_ptr<Reader> reader = CheckoutReader();
+
+    if (!reader) { return false; }
+
+    sqlite3_stmt* statement = Prepared(
+        reader->db_,
+        reader->select_statements_,
+        tablename,
+        "select v from `" + tablename + "` where k=?1 LIMIT 0,1;");
+
+    if (nullptr == statement) {
+        ReturnReader(reader);
+
+        return false;
+    }
 
-    sqlite3_prepare_v2(db_, query.c_str(), -1, &statement, 0);
     sqlite3_bind_text(statement, 1, key.c_str(), key.size(), SQLITE_STATIC);
     int result = sqlite3_step(statement);
     bool success = false;
 
+    // The blob belongs to the statement, and is valid until it is reset
     if (result == SQLITE_ROW) {
         const void* pResult = sqlite3_column_blob(statement, 0);
         uint32_t size = sqlite3_column_bytes(statement, 0);
-        value.assign(static_cast<const char*>(pResult), size);
-        success = true;
+        success = read(static_cast<const char*>(pResult), size);
     }
-    sqlite3_finalize(statement);
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+    ReturnReader(reader);
 
     return success;
 }
@@ -82,16 +228,29 @@ bool StorageSqlite3::Upsert(
     const std::string& tablename,
     const std::string& value) const
 {
-    sqlite3_stmt *statement;
-    const std::string query =
-        "insert or replace into `" + tablename +
-        "` (k, v) values (?1, ?2);";
+    std::lock_guard<std::mutex> writeLock(write_lock_);
+
+    return UpsertLocked(key, tablename, value);
+}
+
+bool StorageSqlite3::UpsertLocked(
+    const std::string& key,
+    const std::string& tablename,
+    const std::string& value) const
+{
+    sqlite3_stmt* statement = Prepared(
+        db_,
+        upsert_statements_,
+        tablename,
+        "insert or replace into `" + tablename + "` (k, v) values (?1, ?2);");
+
+    if (nullptr == statement) { return false; }
 
-    sqlite3_prepare_v2(db_, query.c_str(), -1, &statement, 0);
     sqlite3_bind_text(statement, 1, key.c_str(), key.size(), SQLITE_STATIC);
     sqlite3_bind_blob(statement, 2, value.c_str(), value.size(), SQLITE_STATIC);
     int result = sqlite3_step(statement);
-    sqlite3_finalize(statement);
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
 
     return (result == SQLITE_DONE);
 }
@@ -109,6 +268,8 @@ bool StorageSqlite3::Create(const std::string& tablename)
 bool StorageSqlite3::Purge(const std::string& tablename)
 {
     const std::string sql = "DROP TABLE `" + tablename + "`;";
+    std::lock_guard<std::mutex> writeLock(write_lock_);
+    FinalizeStatements(tablename);
 
     if (SQLITE_OK ==
         sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr)) {
@@ -118,25 +279,53 @@ bool StorageSqlite3::Purge(const std::string& tablename)
     return false;
 }
 
+bool StorageSqlite3::Pragma(
+    const std::string& name,
+    const std::string& value,
+    const std::list<std::string>& allowed)
+{
+    std::string mode = value;
+    std::transform(mode.begin(), mode.end(), mode.begin(), ::toupper);
+
+    if (allowed.end() == std::find(allowed.begin(), allowed.end(), mode)) {
+        std::cerr << "Invalid value for " << name << ": " << value
+                  << std::endl;
+
+        return false;
+    }
+
+    const std::string sql = "PRAGMA " + name + "=" + mode + ";";
+
+    return (SQLITE_OK ==
+        sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr));
+}
+
 void StorageSqlite3::Init_StorageSqlite3()
 {
-    const std::string filename = folder_ + "/" + config_.sqlite3_db_file_;
+    const std::string filename = Filename();
 
     if (SQLITE_OK == sqlite3_open_v2(
         filename.c_str(),
         &db_,
         SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
         nullptr)) {
-            Create(config_.sqlite3_primary_bucket_);
-            Create(config_.sqlite3_secondary_bucket_);
-            Create(config_.sqlite3_control_table_);
-            sqlite3_exec(
-                db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
-    } else {
-        std::cout << "Failed to initialize database." << std::endl;
-        assert(false);
+            ready_ = Create(config_.sqlite3_primary_bucket_) &&
+                     Create(config_.sqlite3_secondary_bucket_) &&
+                     Create(config_.sqlite3_control_table_);
+            Pragma(
+                "journal_mode",
+                config_.sqlite3_journal_mode_,
+                {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"});
+            Pragma(
+                "synchronous",
+                config_.sqlite3_synchronous_,
+                {"OFF", "NORMAL", "FULL", "EXTRA"});
     }
 
+    if (!ready_) {
+        std::cerr << "Failed to initialize database " << filename << ": "
+                  << sqlite3_errmsg(db_) << std::endl;
+    }
 }
 
 std::string StorageSqlite3::LoadRoot() const
@@ -159,6 +348,14 @@ bool StorageSqlite3::Load(
     return Select(key, GetTableName(bucket), value);
 }
 
+bool StorageSqlite3::LoadInPlace(
+    const std::string& key,
+    const bool bucket,
+    const ot_super::Reader& reader) const
+{
+    return Select(key, GetTableName(bucket), reader);
+}
+
 bool StorageSqlite3::StoreRoot(const std::string& hash)
 {
     return Upsert(
@@ -173,6 +370,29 @@ bool StorageSqlite3::Store(
     return Upsert(key, GetTableName(bucket), value);
 }
 
+bool StorageSqlite3::Store(const KeyValues& values, const bool bucket) const
+{
+    const std::string tablename = GetTableName(bucket);
+    std::lock_guard<std::mutex> writeLock(write_lock_);
+
+    if (SQLITE_OK !=
+        sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr)) {
+
+        return false;
+    }
+
+    for (auto& it : values) {
+        if (!UpsertLocked(it.first, tablename, it.second)) {
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+
+            return false;
+        }
+    }
+
+    return (SQLITE_OK ==
+        sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr));
+}
+
 bool StorageSqlite3::EmptyBucket(const bool bucket)
 {
     return Purge(GetTableName(bucket));
@@ -180,7 +400,10 @@ bool StorageSqlite3::EmptyBucket(const bool bucket)
 
 void StorageSqlite3::Cleanup_StorageSqlite3()
 {
+    std::lock_guard<std::mutex> writeLock(write_lock_);
+    FinalizeStatements();
     sqlite3_close(db_);
+    db_ = nullptr;
 }
 
 void StorageSqlite3::Cleanup()
@@ -0,0 +1,44 @@
+#ifndef OPENTXS_TESTS_CORE_ARMORFIXTURE_HPP
+#define OPENTXS_TESTS_CORE_ARMORFIXTURE_HPP
+
+#include <gtest/gtest.h>
+#include <opentxs/core/crypto/OTASCIIArmor.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace opentxs
+{
+namespace test
+{
+
+// Roughly the shape of a box full of receipts: repetitive XML with
+// changing numbers.
+inline std::string Receipts(int32_t receipts)
+{
+    std::string output("<accountLedger type=\"inbox\">\n");
+
+    for (int32_t i = 0; i < receipts; ++i) {
+        const std::string number = std::to_string(1000000 + 7 * i);
+        output += "<transaction type=\"chequeReceipt\" transactionNum=\"" +
+                  number + "\" inReferenceTo=\"" + number +
+                  "\" adjustment=\"" + std::to_string(i % 977) + "\"/>\n";
+    }
+
+    return output + "</accountLedger>\n";
+}
+
+// Puts the default codec back afterwards
+class ArmorFixture : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        OTASCIIArmor::SetCompression(OTASCIIArmor::CODEC_ZLIB, 9, 0);
+    }
+};
+
+} // namespace test
+} // namespace opentxs
+
+#endif // OPENTXS_TESTS_CORE_ARMORFIXTURE_HPP
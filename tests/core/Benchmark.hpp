@@ -0,0 +1,49 @@
+#ifndef OPENTXS_TESTS_CORE_BENCHMARK_HPP
+#define OPENTXS_TESTS_CORE_BENCHMARK_HPP
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace opentxs
+{
+namespace test
+{
+
+// Times the span between construction and each call to Milliseconds()
+class Stopwatch
+{
+public:
+    Stopwatch()
+        : start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    double Milliseconds() const
+    {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start_)
+            .count();
+    }
+
+    void Restart() { start_ = std::chrono::steady_clock::now(); }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Prints one line of a benchmark's results, and records value under key in
+// the XML output
+inline void Report(const std::string& line, const std::string& key,
+                   double value)
+{
+    std::cout << line << std::endl;
+    ::testing::Test::RecordProperty(key, static_cast<int>(value));
+}
+
+} // namespace test
+} // namespace opentxs
+
+#endif // OPENTXS_TESTS_CORE_BENCHMARK_HPP
@@ -0,0 +1,50 @@
+#include "Benchmark.hpp"
+#include "LedgerFixture.hpp"
+
+#include <cstdint>
+#include <string>
+
+using namespace opentxs;
+
+// Each lookup is logarithmic (or constant) in the size of the box, so a
+// round of them should cost about the same whether the box is small or
+// large
+TEST(Benchmark_Ledger, lookups)
+{
+    const Identifier theNymID(test::NYM_ID);
+    const Identifier theNotaryID(test::NOTARY_ID);
+    const int64_t sizes[] = {1000, 20000};
+    const int64_t lookups = 1000;
+
+    for (const auto size : sizes) {
+        Ledger nymbox(theNymID, theNymID, theNotaryID);
+        ASSERT_TRUE(
+            nymbox.GenerateLedger(theNymID, theNotaryID, Ledger::nymbox));
+
+        test::Fill(nymbox, size);
+
+        const test::Stopwatch timer;
+        int64_t found = 0;
+
+        for (int64_t i = 0; i < lookups; ++i) {
+            const int64_t n = 10 * (1 + (i * 7919) % (size / 10));
+
+            if (nullptr != nymbox.GetTransaction(n)) ++found;
+            if (nullptr != nymbox.GetReplyNotice(100000 + n)) ++found;
+            if (nullptr != nymbox.GetFinalReceipt(200001 + n - 10)) ++found;
+            if (0 <= nymbox.GetTransactionIndex(n)) ++found;
+            if (nullptr != nymbox.GetTransactionByIndex(
+                               static_cast<int32_t>(n - 1)))
+                ++found;
+        }
+
+        const double elapsed = timer.Milliseconds();
+
+        EXPECT_EQ(5 * lookups, found);
+
+        test::Report(std::to_string(size) + " transactions: " +
+                         std::to_string(5 * lookups) + " lookups in " +
+                         std::to_string(elapsed) + " ms",
+                     "size_" + std::to_string(size) + "_ms", elapsed);
+    }
+}
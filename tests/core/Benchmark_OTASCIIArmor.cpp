@@ -0,0 +1,74 @@
+#include "ArmorFixture.hpp"
+#include "Benchmark.hpp"
+
+#include <opentxs/core/String.hpp>
+
+#include <cstdint>
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+const int32_t ROUNDS = 200;
+
+class Benchmark_OTASCIIArmor : public test::ArmorFixture
+{
+};
+
+} // namespace
+
+TEST_F(Benchmark_OTASCIIArmor, codecs)
+{
+    const std::string input = test::Receipts(2000);
+    const String strInput(input.c_str());
+
+    struct Setting {
+        const char* name;
+        OTASCIIArmor::Codec codec;
+        int32_t level;
+    };
+
+    const Setting settings[] = {{"zlib9", OTASCIIArmor::CODEC_ZLIB, 9},
+                                {"zlib1", OTASCIIArmor::CODEC_ZLIB, 1},
+#ifdef OT_ARMOR_LZ4
+                                {"lz4", OTASCIIArmor::CODEC_LZ4, 0},
+#endif
+                                {"stored", OTASCIIArmor::CODEC_STORED, 0}};
+
+    for (const auto& setting : settings) {
+        OTASCIIArmor::SetCompression(setting.codec, setting.level, 0);
+        OTASCIIArmor armored;
+        std::string output;
+
+        test::Stopwatch timer;
+
+        for (int32_t i = 0; i < ROUNDS; ++i) {
+            ASSERT_TRUE(armored.SetString(strInput));
+        }
+
+        const double encoded = timer.Milliseconds();
+        timer.Restart();
+
+        for (int32_t i = 0; i < ROUNDS; ++i) {
+            ASSERT_TRUE(armored.GetString(output));
+        }
+
+        const double decoded = timer.Milliseconds();
+
+        EXPECT_EQ(input, output);
+
+        const std::string name(setting.name);
+        test::Report(name + ": " + std::to_string(input.size()) +
+                         " bytes armored to " +
+                         std::to_string(armored.GetLength()),
+                     name + "_bytes", armored.GetLength());
+        test::Report(name + ": " + std::to_string(ROUNDS) + " encodes in " +
+                         std::to_string(encoded) + " ms",
+                     name + "_encode_ms", encoded);
+        test::Report(name + ": " + std::to_string(ROUNDS) + " decodes in " +
+                         std::to_string(decoded) + " ms",
+                     name + "_decode_ms", decoded);
+    }
+}
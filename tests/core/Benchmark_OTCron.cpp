@@ -0,0 +1,48 @@
+#include "Benchmark.hpp"
+#include "CronFixture.hpp"
+
+#include <cstdint>
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+const int32_t DUE = 10;
+const int32_t ROUNDS = 100;
+
+class Benchmark_OTCron : public test::CronFixture,
+                         public ::testing::WithParamInterface<int32_t>
+{
+};
+
+} // namespace
+
+// The cost of a round shouldn't grow with the number of items waiting on
+// cron
+TEST_P(Benchmark_OTCron, rounds)
+{
+    const int32_t idle = GetParam();
+    int32_t nDueCalls = 0;
+    int32_t nIdleCalls = 0;
+    AddItems(DUE, nDueCalls, idle, nIdleCalls);
+
+    const test::Stopwatch timer;
+
+    for (int32_t i = 0; i < ROUNDS; ++i) {
+        cron_.ProcessCronItems();
+    }
+
+    const double elapsed = timer.Milliseconds();
+
+    test::Report(std::to_string(idle) + " idle items: " +
+                     std::to_string(ROUNDS) + " rounds over " +
+                     std::to_string(DUE) + " due items in " +
+                     std::to_string(elapsed) + " ms",
+                 "idle_" + std::to_string(idle) + "_ms", elapsed);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    DormantItems, Benchmark_OTCron,
+    ::testing::Values(0, 10000, 100000, 1000000));
@@ -0,0 +1,64 @@
+#include "Benchmark.hpp"
+#include "StorageFixture.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+const int32_t SEEDS = 500;
+
+} // namespace
+
+// Times a batch of stores, then loads from a reopened store, with every
+// compiled-in backend
+TEST(Benchmark_StorageBackends, store_and_load)
+{
+    for (const auto& backend : test::Backends()) {
+        const std::string folder = test::TempFolder();
+        double stored = 0;
+
+        {
+            auto storage = test::Open(backend, folder);
+            ASSERT_NE(nullptr, storage.get());
+            const test::Stopwatch timer;
+
+            {
+                Storage::Batch batch(*storage);
+
+                for (int32_t i = 0; i < SEEDS; ++i) {
+                    ASSERT_TRUE(storage->Store(test::MakeSeed(i), "alias"));
+                }
+
+                ASSERT_TRUE(batch.Commit());
+            }
+
+            stored = timer.Milliseconds();
+        }
+
+        // Reopened, so that every load reaches the backend
+        auto storage = test::Open(backend, folder);
+        ASSERT_NE(nullptr, storage.get());
+        const test::Stopwatch timer;
+
+        for (int32_t i = 0; i < SEEDS; ++i) {
+            std::shared_ptr<proto::Seed> seed;
+            ASSERT_TRUE(storage->Load(test::Fingerprint(i), seed));
+        }
+
+        const double loaded = timer.Milliseconds();
+
+        test::Report(backend + ": " + std::to_string(SEEDS) +
+                         " seeds stored in " + std::to_string(stored) +
+                         " ms",
+                     backend + "_store_ms", stored);
+        test::Report(backend + ": " + std::to_string(SEEDS) +
+                         " seeds loaded in " + std::to_string(loaded) +
+                         " ms",
+                     backend + "_load_ms", loaded);
+    }
+}
@@ -0,0 +1,37 @@
+#include "Benchmark.hpp"
+#include "StorageFixture.hpp"
+
+#include <cstdint>
+#include <string>
+
+using namespace opentxs;
+
+// Times importing objects one at a time into indices of increasing size
+TEST(Benchmark_StorageIndex, import)
+{
+    StorageConfig config;
+    const int32_t sizes[] = {500, 4000, 32000};
+
+    for (const auto size : sizes) {
+        test::Backend backend;
+        test::StorageMemory storage(config, backend);
+
+        const test::Stopwatch timer;
+
+        for (int32_t i = 0; i < size; ++i) {
+            ASSERT_TRUE(storage.Store(
+                test::MakeSeed(i), "alias" + std::to_string(i)));
+        }
+
+        const double elapsed = timer.Milliseconds();
+        const std::string name = "seeds_" + std::to_string(size);
+
+        test::Report(std::to_string(size) + " seeds imported in " +
+                         std::to_string(elapsed) + " ms",
+                     name + "_ms", elapsed);
+        test::Report(std::to_string(size) + " seeds imported with " +
+                         std::to_string(backend.written_) +
+                         " bytes written",
+                     name + "_bytes", backend.written_);
+    }
+}
@@ -0,0 +1,111 @@
+#ifdef OT_STORAGE_SQLITE
+#include "Benchmark.hpp"
+#include "StorageFixture.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace opentxs;
+
+namespace
+{
+
+const int32_t SEEDS = 200;
+const int32_t READERS = 4;
+
+} // namespace
+
+// Each store outside a batch commits (and with the default synchronous=FULL,
+// syncs) the object, its index and the root. A batch commits once.
+TEST(Benchmark_StorageSqlite3, batched_writes)
+{
+    auto database = test::Open("sqlite3", test::TempFolder());
+    ASSERT_NE(nullptr, database.get());
+    Storage& storage = *database;
+
+    test::Stopwatch timer;
+
+    for (int32_t i = 0; i < SEEDS; ++i) {
+        ASSERT_TRUE(storage.Store(test::MakeSeed(i), "alias"));
+    }
+
+    const double single = timer.Milliseconds();
+    timer.Restart();
+
+    {
+        Storage::Batch batch(storage);
+
+        for (int32_t i = SEEDS; i < 2 * SEEDS; ++i) {
+            ASSERT_TRUE(storage.Store(test::MakeSeed(i), "alias"));
+        }
+
+        ASSERT_TRUE(batch.Commit());
+    }
+
+    const double batched = timer.Milliseconds();
+
+    test::Report(std::to_string(SEEDS) + " seeds stored one at a time: " +
+                     std::to_string(single) + " ms",
+                 "single_ms", single);
+    test::Report(std::to_string(SEEDS) + " seeds stored in one batch: " +
+                     std::to_string(batched) + " ms",
+                 "batched_ms", batched);
+
+    EXPECT_LT(batched, single);
+}
+
+// Reads from separate threads use separate connections, so they proceed
+// side by side instead of taking turns
+TEST(Benchmark_StorageSqlite3, concurrent_reads)
+{
+    auto database = test::Open("sqlite3", test::TempFolder());
+    ASSERT_NE(nullptr, database.get());
+    Storage& storage = *database;
+
+    {
+        Storage::Batch batch(storage);
+
+        for (int32_t i = 0; i < SEEDS; ++i) {
+            ASSERT_TRUE(storage.Store(test::MakeSeed(i), "alias"));
+        }
+
+        ASSERT_TRUE(batch.Commit());
+    }
+
+    const auto readAll = [&storage]() {
+        for (int32_t i = 0; i < SEEDS; ++i) {
+            std::shared_ptr<proto::Seed> seed;
+            EXPECT_TRUE(storage.Load(test::Fingerprint(i), seed));
+        }
+    };
+
+    test::Stopwatch timer;
+    readAll();
+    const double serial = timer.Milliseconds();
+
+    std::vector<std::thread> threads;
+    timer.Restart();
+
+    for (int32_t i = 0; i < READERS; ++i) {
+        threads.emplace_back(readAll);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const double parallel = timer.Milliseconds();
+
+    test::Report(std::to_string(SEEDS) + " seeds read by one thread: " +
+                     std::to_string(serial) + " ms",
+                 "serial_ms", serial);
+    test::Report(std::to_string(SEEDS) + " seeds read " +
+                     std::to_string(READERS) + " times over by " +
+                     std::to_string(READERS) + " threads: " +
+                     std::to_string(parallel) + " ms",
+                 "parallel_ms", parallel);
+}
+#endif // OT_STORAGE_SQLITE
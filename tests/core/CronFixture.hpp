@@ -0,0 +1,104 @@
+#ifndef OPENTXS_TESTS_CORE_CRONFIXTURE_HPP
+#define OPENTXS_TESTS_CORE_CRONFIXTURE_HPP
+
+#include <gtest/gtest.h>
+#include <opentxs/core/Nym.hpp>
+#include <opentxs/core/cron/OTCron.hpp>
+#include <opentxs/core/cron/OTCronItem.hpp>
+
+#include <cstdint>
+
+namespace opentxs
+{
+namespace test
+{
+
+// A cron item which always wakes at the same time, and counts how often
+// it's processed
+class CountingItem : public OTCronItem
+{
+public:
+    CountingItem(int64_t lTransactionNum, time64_t tWake, int32_t& nCalls)
+        : OTCronItem()
+        , wake_(tWake)
+        , calls_(nCalls)
+    {
+        SetTransactionNum(lTransactionNum);
+    }
+
+    bool ProcessCron() override
+    {
+        ++calls_;
+
+        return true;
+    }
+
+    time64_t GetNextWakeTime() override { return wake_; }
+
+private:
+    time64_t wake_;
+    int32_t& calls_;
+};
+
+// Makes every call to ProcessCronItems a round, and restores the cron
+// settings afterwards
+class CronFixture : public ::testing::Test
+{
+protected:
+    Nym server_nym_;
+    OTCron cron_;
+    int32_t ms_between_process_;
+    int32_t refill_amount_;
+
+    void SetUp() override
+    {
+        ms_between_process_ = OTCron::GetCronMsBetweenProcess();
+        refill_amount_ = OTCron::GetCronRefillAmount();
+
+        // 10 numbers are plenty since no item is ever removed
+        OTCron::SetCronMsBetweenProcess(0);
+        OTCron::SetCronRefillAmount(10);
+
+        cron_.SetServerNym(&server_nym_);
+        cron_.ActivateCron();
+
+        for (int64_t i = 1; i <= 10; ++i) {
+            cron_.AddTransactionNumber(i);
+        }
+    }
+
+    void TearDown() override
+    {
+        OTCron::SetCronMsBetweenProcess(ms_between_process_);
+        OTCron::SetCronRefillAmount(refill_amount_);
+    }
+
+    // Adds due items which are always due, and idle items which wake an
+    // hour from now
+    void AddItems(int32_t due, int32_t& nDueCalls, int32_t idle,
+                  int32_t& nIdleCalls)
+    {
+        const time64_t tLater =
+            OTTimeAddTimeInterval(OTTimeGetCurrentTime(), 3600);
+        int64_t lTransactionNum = 0;
+
+        for (int32_t i = 0; i < due; ++i) {
+            auto pItem = new CountingItem(++lTransactionNum, OT_TIME_ZERO,
+                                          nDueCalls);
+            ASSERT_TRUE(
+                cron_.AddCronItem(*pItem, nullptr, false, OT_TIME_ZERO));
+        }
+
+        for (int32_t i = 0; i < idle; ++i) {
+            auto pItem =
+                new CountingItem(++lTransactionNum, tLater, nIdleCalls);
+            ASSERT_TRUE(
+                cron_.AddCronItem(*pItem, nullptr, false, OT_TIME_ZERO));
+        }
+    }
+};
+
+} // namespace test
+} // namespace opentxs
+
+#endif // OPENTXS_TESTS_CORE_CRONFIXTURE_HPP
@@ -0,0 +1,50 @@
+#ifndef OPENTXS_TESTS_CORE_LEDGERFIXTURE_HPP
+#define OPENTXS_TESTS_CORE_LEDGERFIXTURE_HPP
+
+#include <gtest/gtest.h>
+#include <opentxs/core/Identifier.hpp>
+#include <opentxs/core/Ledger.hpp>
+#include <opentxs/core/OTTransaction.hpp>
+
+#include <cstdint>
+
+namespace opentxs
+{
+namespace test
+{
+
+const char* const NOTARY_ID = "otx5GxsMEQzrdyeb4YhxZM6qXuTLFKDmXEbp";
+const char* const NYM_ID = "ot2Cz9Ys1VZQtSXb8VsRwPUn8LQVJ7mhGT9R";
+
+// Adds count transactions numbered from 1 to a nymbox. Every tenth is a
+// replyNotice for request 100000 + n, every tenth after that a finalReceipt
+// in reference to 200000 + n, and the rest are notices in reference to n.
+inline void Fill(Ledger& theLedger, int64_t count)
+{
+    for (int64_t n = 1; n <= count; ++n) {
+        OTTransaction::transactionType theType = OTTransaction::notice;
+
+        if (0 == n % 10)
+            theType = OTTransaction::replyNotice;
+        else if (1 == n % 10)
+            theType = OTTransaction::finalReceipt;
+
+        OTTransaction* pTransaction =
+            OTTransaction::GenerateTransaction(theLedger, theType, n);
+        ASSERT_NE(nullptr, pTransaction);
+
+        if (OTTransaction::replyNotice == theType)
+            pTransaction->SetRequestNum(100000 + n);
+        else if (OTTransaction::finalReceipt == theType)
+            pTransaction->SetReferenceToNum(200000 + n);
+        else
+            pTransaction->SetReferenceToNum(n);
+
+        ASSERT_TRUE(theLedger.AddTransaction(*pTransaction));
+    }
+}
+
+} // namespace test
+} // namespace opentxs
+
+#endif // OPENTXS_TESTS_CORE_LEDGERFIXTURE_HPP
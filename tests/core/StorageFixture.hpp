@@ -0,0 +1,195 @@
+#ifndef OPENTXS_TESTS_CORE_STORAGEFIXTURE_HPP
+#define OPENTXS_TESTS_CORE_STORAGEFIXTURE_HPP
+
+#include <gtest/gtest.h>
+#include <opentxs/storage/Storage.hpp>
+#include <opentxs/storage/StorageConfig.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace opentxs
+{
+namespace test
+{
+
+// FNV-1a is plenty for a few thousand test objects
+inline bool Fnv1a(const uint32_t, const std::string& data, std::string& hash)
+{
+    std::uint64_t digest = 14695981039346656037ull;
+
+    for (const auto& c : data) {
+        digest ^= static_cast<std::uint8_t>(c);
+        digest *= 1099511628211ull;
+    }
+
+    char encoded[32]{};
+    std::snprintf(
+        encoded,
+        sizeof(encoded),
+        "%016llx",
+        static_cast<unsigned long long>(digest));
+    hash = encoded;
+
+    return true;
+}
+
+inline std::string NoRandom() { return ""; }
+
+inline std::string Fingerprint(int32_t i)
+{
+    return "otSeedForStorageTests" + std::to_string(i);
+}
+
+inline proto::Seed MakeSeed(int32_t i)
+{
+    proto::Seed seed;
+    seed.set_version(1);
+    seed.set_words("words" + std::to_string(i));
+    seed.set_passphrase("passphrase");
+    seed.set_fingerprint(Fingerprint(i));
+
+    return seed;
+}
+
+// A new, empty folder under /tmp
+inline std::string TempFolder()
+{
+    char path[] = "/tmp/otstorageXXXXXX";
+    EXPECT_NE(nullptr, mkdtemp(path));
+
+    return path;
+}
+
+// Opens backend in folder, with the object cache turned off so that every
+// read reaches the backend. Returns nullptr if that backend isn't compiled
+// in.
+inline std::unique_ptr<Storage> Open(
+    const std::string& backend,
+    const std::string& folder)
+{
+    StorageConfig config;
+    config.backend_ = backend;
+    config.path_ = folder;
+    config.cache_size_ = 0;
+
+    return std::unique_ptr<Storage>(
+        Storage::Factory(Fnv1a, NoRandom, config));
+}
+
+// The names of every compiled-in backend
+inline std::vector<std::string> Backends()
+{
+    std::vector<std::string> output;
+#ifdef OT_STORAGE_FS
+    output.push_back("fs");
+#endif
+#ifdef OT_STORAGE_SQLITE
+    output.push_back("sqlite3");
+#endif
+#ifdef OT_STORAGE_LMDB
+    output.push_back("lmdb");
+#endif
+
+    return output;
+}
+
+const std::string RECORD = "otindex 2\n";
+
+typedef std::map<std::string, std::string> Bucket;
+
+// The objects held by a StorageMemory, which outlive it so that the index
+// can be examined and reopened
+class Backend
+{
+public:
+    Bucket buckets_[2];
+    std::string root_;
+    // Makes every object write fail
+    bool fail_ = false;
+    // Bytes written to either bucket so far
+    std::size_t written_ = 0;
+
+    std::size_t Records() const
+    {
+        std::size_t output = 0;
+
+        for (auto& bucket : buckets_) {
+            for (auto& it : bucket) {
+                if (0 == it.second.compare(0, RECORD.size(), RECORD)) {
+                    ++output;
+                }
+            }
+        }
+
+        return output;
+    }
+};
+
+// Stores objects in memory
+class StorageMemory : public Storage
+{
+private:
+    Backend& backend_;
+
+    std::string LoadRoot() const override { return backend_.root_; }
+
+    bool StoreRoot(const std::string& hash) override
+    {
+        backend_.root_ = hash;
+
+        return true;
+    }
+
+    bool Load(
+        const std::string& key,
+        std::string& value,
+        const bool bucket) const override
+    {
+        auto& objects = backend_.buckets_[bucket ? 1 : 0];
+        auto it = objects.find(key);
+
+        if (objects.end() == it) { return false; }
+
+        value = it->second;
+
+        return true;
+    }
+
+    bool Store(
+        const std::string& key,
+        const std::string& value,
+        const bool bucket) const override
+    {
+        if (backend_.fail_) { return false; }
+
+        backend_.buckets_[bucket ? 1 : 0][key] = value;
+        backend_.written_ += value.size();
+
+        return true;
+    }
+
+    bool EmptyBucket(const bool bucket) override
+    {
+        backend_.buckets_[bucket ? 1 : 0].clear();
+
+        return true;
+    }
+
+public:
+    StorageMemory(const StorageConfig& config, Backend& backend)
+        : Storage(config, Fnv1a, NoRandom)
+        , backend_(backend)
+    {
+    }
+};
+
+} // namespace test
+} // namespace opentxs
+
+#endif // OPENTXS_TESTS_CORE_STORAGEFIXTURE_HPP
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <opentxs/core/contract/AccountRegistry.hpp>
+#include <opentxs/core/OTStorage.hpp>
+#include <opentxs/core/String.hpp>
+#include <opentxs/core/util/OTDataFolder.hpp>
+#include <opentxs/core/util/OTFolders.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+// More than one log's worth, so the sorted file is written at least once
+const int32_t MANY = 5000;
+const int32_t PAGE = 100;
+
+std::string Account(int32_t i)
+{
+    char id[32]{};
+    std::snprintf(id, sizeof(id), "otAccount%06d", i);
+
+    return id;
+}
+
+std::string ContractPath(const std::string& file)
+{
+    std::string path;
+    OTDB::FormPathString(path, OTFolders::Contract().Get(), file);
+
+    return path;
+}
+
+// Reads the whole list, one page at a time
+AccountRegistry::AccountList All(const std::string& unit)
+{
+    AccountRegistry::AccountList output, page;
+    std::string after;
+
+    do {
+        EXPECT_TRUE(AccountRegistry::Page(unit, after, PAGE, page));
+        output.insert(output.end(), page.begin(), page.end());
+
+        if (!page.empty()) { after = page.back(); }
+    } while (PAGE == page.size());
+
+    return output;
+}
+
+class Test_AccountRegistry : public ::testing::Test
+{
+public:
+    static void SetUpTestCase()
+    {
+        char home[] = "/tmp/otaccountregistryXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(home));
+        setenv("HOME", home, 1);
+        ASSERT_TRUE(OTDataFolder::Init(String("server")));
+        ASSERT_TRUE(OTDB::InitDefaultStorage(OTDB_DEFAULT_STORAGE,
+                                             OTDB_DEFAULT_PACKER));
+    }
+};
+
+} // namespace
+
+TEST_F(Test_AccountRegistry, add_page_and_reload)
+{
+    const std::string unit = "otUnitAddPageReload";
+
+    // Added out of order, to be read back sorted
+    for (int32_t i = MANY - 1; i >= 0; --i) {
+        ASSERT_TRUE(AccountRegistry::Add(unit, Account(i)));
+    }
+
+    ASSERT_TRUE(AccountRegistry::Add(unit, Account(1)));
+    EXPECT_EQ(static_cast<std::size_t>(MANY), AccountRegistry::Count(unit));
+
+    for (int32_t pass = 0; pass < 2; ++pass) {
+        const auto list = All(unit);
+        ASSERT_EQ(static_cast<std::size_t>(MANY), list.size());
+
+        for (int32_t i = 0; i < MANY; ++i) {
+            ASSERT_EQ(Account(i), list[i]);
+        }
+
+        AccountRegistry::Unload();
+        EXPECT_EQ(static_cast<std::size_t>(MANY),
+                  AccountRegistry::Count(unit));
+    }
+
+    AccountRegistry::AccountList page;
+    ASSERT_TRUE(AccountRegistry::Page(unit, Account(MANY / 2), 2, page));
+    ASSERT_EQ(2u, page.size());
+    EXPECT_EQ(Account(MANY / 2 + 1), page[0]);
+    EXPECT_EQ(Account(MANY / 2 + 2), page[1]);
+}
+
+TEST_F(Test_AccountRegistry, erase)
+{
+    const std::string unit = "otUnitErase";
+
+    for (int32_t i = 0; i < MANY; ++i) {
+        ASSERT_TRUE(AccountRegistry::Add(unit, Account(i)));
+    }
+
+    // Every other account, both from the sorted file and from the log
+    for (int32_t i = 0; i < MANY; i += 2) {
+        ASSERT_TRUE(AccountRegistry::Erase(unit, Account(i)));
+    }
+
+    ASSERT_TRUE(AccountRegistry::Erase(unit, Account(0)));
+    AccountRegistry::Unload();
+    EXPECT_EQ(static_cast<std::size_t>(MANY / 2),
+              AccountRegistry::Count(unit));
+
+    const auto list = All(unit);
+    ASSERT_EQ(static_cast<std::size_t>(MANY / 2), list.size());
+
+    for (int32_t i = 0; i < MANY / 2; ++i) {
+        ASSERT_EQ(Account(2 * i + 1), list[i]);
+    }
+}
+
+TEST_F(Test_AccountRegistry, torn_line_is_dropped)
+{
+    const std::string unit = "otUnitTornLine";
+
+    ASSERT_TRUE(AccountRegistry::Add(unit, Account(1)));
+    ASSERT_TRUE(AccountRegistry::Add(unit, Account(2)));
+    AccountRegistry::Unload();
+
+    {
+        // A crash in the middle of an append
+        std::ofstream log(ContractPath(unit + ".r"), std::ios::app);
+        log << "+otAcc";
+    }
+
+    EXPECT_EQ(2u, AccountRegistry::Count(unit));
+
+    const auto list = All(unit);
+    ASSERT_EQ(2u, list.size());
+    EXPECT_EQ(Account(1), list[0]);
+    EXPECT_EQ(Account(2), list[1]);
+
+    // Later appends start on a fresh line
+    ASSERT_TRUE(AccountRegistry::Add(unit, Account(3)));
+    AccountRegistry::Unload();
+    EXPECT_EQ(3u, AccountRegistry::Count(unit));
+}
+
+TEST_F(Test_AccountRegistry, invalid_id_is_rejected)
+{
+    const std::string unit = "otUnitInvalidID";
+
+    EXPECT_FALSE(AccountRegistry::Add(unit, ""));
+    EXPECT_FALSE(AccountRegistry::Add(unit, "bad\nid"));
+    EXPECT_EQ(0u, AccountRegistry::Count(unit));
+}
+
+TEST_F(Test_AccountRegistry, log_only_records_are_imported)
+{
+    const std::string unit = "otUnitLogOnly";
+
+    {
+        // Written before the sorted file existed
+        std::ofstream log(ContractPath(unit + ".r"));
+        log << "+" << Account(2) << "\n+" << Account(1) << "\n-"
+            << Account(2) << "\n+" << Account(3) << "\n";
+    }
+
+    AccountRegistry::Unload();
+    EXPECT_EQ(2u, AccountRegistry::Count(unit));
+
+    const auto list = All(unit);
+    ASSERT_EQ(2u, list.size());
+    EXPECT_EQ(Account(1), list[0]);
+    EXPECT_EQ(Account(3), list[1]);
+}
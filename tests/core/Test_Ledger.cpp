@@ -0,0 +1,37 @@
+#include "LedgerFixture.hpp"
+
+using namespace opentxs;
+
+TEST(Test_Ledger, lookups_follow_changes)
+{
+    const Identifier theNymID(test::NYM_ID);
+    const Identifier theNotaryID(test::NOTARY_ID);
+    Ledger nymbox(theNymID, theNymID, theNotaryID);
+    ASSERT_TRUE(nymbox.GenerateLedger(theNymID, theNotaryID, Ledger::nymbox));
+
+    test::Fill(nymbox, 100);
+
+    ASSERT_EQ(100, nymbox.GetTransactionCount());
+    EXPECT_EQ(0, nymbox.GetTransactionIndex(1));
+    EXPECT_EQ(99, nymbox.GetTransactionIndex(100));
+    EXPECT_EQ(50, nymbox.GetTransactionByIndex(49)->GetTransactionNum());
+    EXPECT_EQ(20, nymbox.GetReplyNotice(100020)->GetTransactionNum());
+    EXPECT_EQ(31, nymbox.GetFinalReceipt(200031)->GetTransactionNum());
+    EXPECT_EQ(1, nymbox.GetTransactionCountInRefTo(42));
+    EXPECT_EQ(1, nymbox.GetTransaction(OTTransaction::finalReceipt)
+                     ->GetTransactionNum());
+
+    ASSERT_TRUE(nymbox.RemoveTransaction(20));
+    ASSERT_TRUE(nymbox.RemoveTransaction(31));
+    ASSERT_TRUE(nymbox.RemoveTransaction(42));
+    ASSERT_TRUE(nymbox.RemoveTransaction(1));
+
+    EXPECT_EQ(nullptr, nymbox.GetTransaction(20));
+    EXPECT_EQ(nullptr, nymbox.GetReplyNotice(100020));
+    EXPECT_EQ(nullptr, nymbox.GetFinalReceipt(200031));
+    EXPECT_EQ(0, nymbox.GetTransactionCountInRefTo(42));
+    EXPECT_EQ(-1, nymbox.GetTransactionIndex(42));
+    EXPECT_EQ(95, nymbox.GetTransactionIndex(100));
+    EXPECT_EQ(11, nymbox.GetTransaction(OTTransaction::finalReceipt)
+                      ->GetTransactionNum());
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <opentxs/core/Identifier.hpp>
+#include <opentxs/core/Nym.hpp>
+#include <opentxs/core/String.hpp>
+#include <opentxs/core/crypto/OTASCIIArmor.hpp>
+
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+const char* NOTARY_ID = "otx5GxsMEQzrdyeb4YhxZM6qXuTLFKDmXEbp";
+
+// A nymfile holding issued number 1 only, with that list then replaced by
+// strNumbers.
+String Nymfile(const char* strNumbers)
+{
+    Nym nym;
+    nym.AddIssuedNum(String(NOTARY_ID), 1);
+    String strNym;
+    nym.SavePseudonym(strNym);
+
+    std::string output(strNym.Get());
+    const std::string original(OTASCIIArmor(String("1")).Get());
+    const auto position = output.find(original);
+    EXPECT_NE(std::string::npos, position);
+
+    if (std::string::npos != position) {
+        output.replace(position, original.size(),
+                       OTASCIIArmor(String(strNumbers)).Get());
+    }
+
+    return String(output.c_str());
+}
+
+} // namespace
+
+TEST(Nym, numbers_round_trip)
+{
+    const Identifier theNotaryID(NOTARY_ID);
+    Nym nym;
+
+    for (int64_t number = 10; number < 110; ++number) {
+        nym.AddIssuedNum(String(NOTARY_ID), number);
+    }
+
+    nym.AddTransactionNum(String(NOTARY_ID), 50);
+    nym.AddTransactionNum(String(NOTARY_ID), 51);
+    nym.AddTentativeNum(String(NOTARY_ID), 200);
+    nym.AddAcknowledgedNum(String(NOTARY_ID), 7);
+
+    String strNym;
+    ASSERT_TRUE(nym.SavePseudonym(strNym));
+
+    Nym loaded;
+    ASSERT_TRUE(loaded.LoadNymFromString(strNym));
+    ASSERT_EQ(100, loaded.GetIssuedNumCount(theNotaryID));
+    ASSERT_EQ(10, loaded.GetIssuedNum(theNotaryID, 0));
+    ASSERT_EQ(109, loaded.GetIssuedNum(theNotaryID, 99));
+    ASSERT_EQ(2, loaded.GetTransactionNumCount(theNotaryID));
+    ASSERT_EQ(50, loaded.GetTransactionNum(theNotaryID, 0));
+    ASSERT_EQ(1, loaded.GetGenericNumCount(loaded.GetMapTentativeNum(),
+                                           theNotaryID));
+    ASSERT_EQ(1, loaded.GetAcknowledgedNumCount(theNotaryID));
+    ASSERT_TRUE(loaded.VerifyIssuedNumbersOnNym(nym));
+}
+
+TEST(Nym, loads_ranges)
+{
+    const Identifier theNotaryID(NOTARY_ID);
+    Nym loaded;
+    ASSERT_TRUE(loaded.LoadNymFromString(Nymfile("1-10,5-20,30")));
+    ASSERT_EQ(21, loaded.GetIssuedNumCount(theNotaryID));
+    ASSERT_EQ(30, loaded.GetIssuedNum(theNotaryID, 20));
+}
+
+TEST(Nym, rejects_malformed_numbers)
+{
+    Nym loaded;
+    ASSERT_FALSE(loaded.LoadNymFromString(Nymfile("1,2,x")));
+}
+
+TEST(Nym, limits_numbers_from_others)
+{
+    Nym trusted;
+    trusted.AddIssuedNum(String(NOTARY_ID), 1);
+
+    Nym untrusted;
+    untrusted.LimitNumbersTo(trusted);
+    ASSERT_FALSE(untrusted.LoadNymFromString(Nymfile("1-9223372036854775806")));
+
+    Nym limited;
+    limited.LimitNumbersTo(trusted);
+    ASSERT_TRUE(limited.LoadNymFromString(Nymfile("1-50")));
+}
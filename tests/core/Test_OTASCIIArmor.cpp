@@ -0,0 +1,91 @@
+#include "ArmorFixture.hpp"
+
+#include <opentxs/core/OTData.hpp>
+#include <opentxs/core/String.hpp>
+
+#include <cstdint>
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+class Test_OTASCIIArmor : public test::ArmorFixture
+{
+};
+
+} // namespace
+
+TEST_F(Test_OTASCIIArmor, every_codec_round_trips)
+{
+    const OTASCIIArmor::Codec codecs[] = {OTASCIIArmor::CODEC_ZLIB,
+                                          OTASCIIArmor::CODEC_STORED,
+#ifdef OT_ARMOR_LZ4
+                                          OTASCIIArmor::CODEC_LZ4
+#endif
+    };
+    const std::string inputs[] = {"x", "abcdabcdabcdabcdabcdabcd",
+                                  test::Receipts(1), test::Receipts(2000)};
+
+    for (const auto codec : codecs) {
+        OTASCIIArmor::SetCompression(codec, 9, 0);
+
+        for (const auto& input : inputs) {
+            const OTASCIIArmor armored(String(input.c_str()));
+            String output;
+
+            ASSERT_TRUE(armored.GetString(output));
+            EXPECT_EQ(input, std::string(output.Get()));
+        }
+    }
+}
+
+#ifdef OT_ARMOR_LZ4
+// Whatever the codec in use, armor written with any other one still decodes
+TEST_F(Test_OTASCIIArmor, codecs_read_each_other)
+{
+    const std::string input = test::Receipts(100);
+
+    OTASCIIArmor::SetCompression(OTASCIIArmor::CODEC_LZ4, 9, 0);
+    const OTASCIIArmor lz4(String(input.c_str()));
+    OTASCIIArmor::SetCompression(OTASCIIArmor::CODEC_ZLIB, 9, 0);
+    const OTASCIIArmor zlib(String(input.c_str()));
+
+    String output;
+    ASSERT_TRUE(lz4.GetString(output));
+    EXPECT_EQ(input, std::string(output.Get()));
+
+    OTASCIIArmor::SetCompression(OTASCIIArmor::CODEC_LZ4, 9, 0);
+    ASSERT_TRUE(zlib.GetString(output));
+    EXPECT_EQ(input, std::string(output.Get()));
+}
+#else
+// Without LZ4 support, armor is written with zlib instead, and LZ4 armor
+// fails to decode
+TEST_F(Test_OTASCIIArmor, lz4_is_rejected)
+{
+    const std::string input = test::Receipts(100);
+
+    OTASCIIArmor::SetCompression(OTASCIIArmor::CODEC_LZ4, 9, 0);
+    const OTASCIIArmor armored(String(input.c_str()));
+    OTData payload;
+    ASSERT_TRUE(armored.GetData(payload));
+    ASSERT_LT(0u, payload.GetSize());
+    // A zlib stream, with no codec header
+    EXPECT_NE(0, static_cast<const uint8_t*>(payload.GetPointer())[0]);
+
+    OTASCIIArmor::SetCompression(OTASCIIArmor::CODEC_STORED, 9, 0);
+    const OTASCIIArmor stored(String(input.c_str()));
+    ASSERT_TRUE(stored.GetData(payload));
+    std::string header(static_cast<const char*>(payload.GetPointer()),
+                       payload.GetSize());
+    ASSERT_LT(3u, header.size());
+    header[2] = static_cast<char>(OTASCIIArmor::CODEC_LZ4);
+    const OTASCIIArmor lz4(
+        OTData(header.data(), static_cast<uint32_t>(header.size())));
+
+    String output;
+    EXPECT_FALSE(lz4.GetString(output));
+}
+#endif
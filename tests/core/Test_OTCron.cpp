@@ -0,0 +1,28 @@
+#include "CronFixture.hpp"
+
+#include <cstdint>
+
+using namespace opentxs;
+
+namespace
+{
+
+class Test_OTCron : public test::CronFixture
+{
+};
+
+} // namespace
+
+// A round only touches the items which are due
+TEST_F(Test_OTCron, rounds_skip_idle_items)
+{
+    int32_t nDueCalls = 0;
+    int32_t nIdleCalls = 0;
+    AddItems(10, nDueCalls, 1000, nIdleCalls);
+
+    for (int32_t i = 0; i < 100; ++i) {
+        cron_.ProcessCronItems();
+    }
+
+    EXPECT_EQ(0, nIdleCalls);
+}
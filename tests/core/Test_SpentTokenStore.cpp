@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <opentxs/cash/SpentTokenStore.hpp>
+#include <opentxs/core/OTStorage.hpp>
+#include <opentxs/core/String.hpp>
+#include <opentxs/core/util/OTDataFolder.hpp>
+#include <opentxs/core/util/OTFolders.hpp>
+#include <opentxs/core/util/OTPaths.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+const std::string UNIT = "otUnitForSpentTokenStoreTests";
+
+std::string Hash(int32_t i)
+{
+    return "otTokenHash" + std::to_string(i);
+}
+
+std::string SpentPath(const std::string& file)
+{
+    std::string path;
+    OTDB::FormPathString(path, OTFolders::Spent().Get(), file);
+
+    return path;
+}
+
+std::string PartitionPath(int32_t series, const std::string& extension)
+{
+    return SpentPath(UNIT + "." + std::to_string(series) + extension);
+}
+
+bool IsSpent(int32_t series, const std::string& hash)
+{
+    bool spent = false;
+    EXPECT_TRUE(SpentTokenStore::IsSpent(UNIT, series, hash, spent));
+
+    return spent;
+}
+
+bool Record(int32_t series, const std::string& hash)
+{
+    return SpentTokenStore::Record(UNIT, series, OTTimeGetCurrentTime() +
+                                                     OT_TIME_DAY_IN_SECONDS,
+                                   hash, "token");
+}
+
+class Test_SpentTokenStore : public ::testing::Test
+{
+public:
+    static void SetUpTestCase()
+    {
+        char home[] = "/tmp/otspenttokensXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(home));
+        setenv("HOME", home, 1);
+        ASSERT_TRUE(OTDataFolder::Init(String("server")));
+        ASSERT_TRUE(OTDB::InitDefaultStorage(OTDB_DEFAULT_STORAGE,
+                                             OTDB_DEFAULT_PACKER));
+    }
+};
+
+} // namespace
+
+TEST_F(Test_SpentTokenStore, record_and_lookup)
+{
+    ASSERT_FALSE(IsSpent(1, Hash(1)));
+    ASSERT_TRUE(Record(1, Hash(1)));
+    ASSERT_TRUE(IsSpent(1, Hash(1)));
+    ASSERT_FALSE(IsSpent(1, Hash(2)));
+    ASSERT_FALSE(Record(1, Hash(1)));
+    // other series
+    ASSERT_FALSE(IsSpent(2, Hash(1)));
+}
+
+TEST_F(Test_SpentTokenStore, reopen_after_growth)
+{
+    // Enough to grow the index more than once.
+    for (int32_t i = 0; i < 1500; i++) {
+        ASSERT_TRUE(Record(3, Hash(i)));
+    }
+
+    SpentTokenStore::Unload();
+
+    for (int32_t i = 0; i < 1500; i++) {
+        ASSERT_TRUE(IsSpent(3, Hash(i))) << i;
+    }
+
+    ASSERT_FALSE(IsSpent(3, Hash(1500)));
+}
+
+// A crash after the log append, before the index was updated.
+TEST_F(Test_SpentTokenStore, crash_before_index)
+{
+    ASSERT_TRUE(Record(4, Hash(0)));
+    SpentTokenStore::Unload();
+
+    {
+        std::ofstream log(PartitionPath(4, ".l"),
+                          std::ios::out | std::ios::app | std::ios::binary);
+        log << Hash(1) << " token\n";
+    }
+
+    ASSERT_TRUE(IsSpent(4, Hash(1)));
+    ASSERT_FALSE(Record(4, Hash(1)));
+    ASSERT_TRUE(Record(4, Hash(2)));
+    SpentTokenStore::Unload();
+    ASSERT_TRUE(IsSpent(4, Hash(0)));
+    ASSERT_TRUE(IsSpent(4, Hash(1)));
+    ASSERT_TRUE(IsSpent(4, Hash(2)));
+}
+
+// A crash after the index slot was written, before the header moved on: the
+// record is indexed twice, which must be harmless.
+TEST_F(Test_SpentTokenStore, crash_before_header)
+{
+    ASSERT_TRUE(Record(5, Hash(0)));
+    SpentTokenStore::Unload();
+
+    std::uint64_t indexed = 0;
+
+    {
+        std::fstream index(PartitionPath(5, ".i"),
+                           std::ios::in | std::ios::out | std::ios::binary);
+        index.seekg(16);
+        index.read(reinterpret_cast<char*>(&indexed), 8);
+        ASSERT_TRUE(index.good());
+    }
+
+    ASSERT_TRUE(Record(5, Hash(1)));
+    SpentTokenStore::Unload();
+
+    {
+        std::fstream index(PartitionPath(5, ".i"),
+                           std::ios::in | std::ios::out | std::ios::binary);
+        index.seekp(16);
+        index.write(reinterpret_cast<const char*>(&indexed), 8);
+        ASSERT_TRUE(index.good());
+    }
+
+    ASSERT_TRUE(IsSpent(5, Hash(1)));
+    ASSERT_TRUE(Record(5, Hash(2)));
+    SpentTokenStore::Unload();
+    ASSERT_TRUE(IsSpent(5, Hash(0)));
+    ASSERT_TRUE(IsSpent(5, Hash(1)));
+    ASSERT_TRUE(IsSpent(5, Hash(2)));
+}
+
+// A crash part way through the log append.
+TEST_F(Test_SpentTokenStore, torn_log_line)
+{
+    ASSERT_TRUE(Record(6, Hash(0)));
+    SpentTokenStore::Unload();
+
+    {
+        std::ofstream log(PartitionPath(6, ".l"),
+                          std::ios::out | std::ios::app | std::ios::binary);
+        log << Hash(1) << " tok";
+    }
+
+    // Refusing the torn record is the safe side.
+    ASSERT_TRUE(IsSpent(6, Hash(1)));
+    ASSERT_TRUE(Record(6, Hash(2)));
+    SpentTokenStore::Unload();
+    ASSERT_TRUE(IsSpent(6, Hash(2)));
+    ASSERT_TRUE(IsSpent(6, Hash(0)));
+}
+
+TEST_F(Test_SpentTokenStore, missing_index_is_rebuilt)
+{
+    ASSERT_TRUE(Record(7, Hash(0)));
+    ASSERT_TRUE(Record(7, Hash(1)));
+    SpentTokenStore::Unload();
+    ASSERT_EQ(0, std::remove(PartitionPath(7, ".i").c_str()));
+    ASSERT_TRUE(IsSpent(7, Hash(0)));
+    ASSERT_TRUE(IsSpent(7, Hash(1)));
+    ASSERT_FALSE(IsSpent(7, Hash(2)));
+}
+
+TEST_F(Test_SpentTokenStore, migrate_legacy_folder)
+{
+    const std::string folder = UNIT + ".8";
+    ASSERT_TRUE(OTDB::StorePlainString("legacy token",
+                                       OTFolders::Spent().Get(), folder,
+                                       Hash(0)));
+    SpentTokenStore::Unload();
+
+    // Consulted before migration
+    ASSERT_TRUE(IsSpent(8, Hash(0)));
+    ASSERT_FALSE(IsSpent(8, Hash(1)));
+
+    ASSERT_EQ(1u, SpentTokenStore::MigrateLegacy());
+    ASSERT_FALSE(OTPaths::FolderExists(String(SpentPath(folder) + "/")));
+    ASSERT_TRUE(IsSpent(8, Hash(0)));
+
+    SpentTokenStore::Unload();
+    ASSERT_TRUE(IsSpent(8, Hash(0)));
+    ASSERT_FALSE(Record(8, Hash(0)));
+    ASSERT_EQ(0u, SpentTokenStore::MigrateLegacy());
+}
+
+TEST_F(Test_SpentTokenStore, prune)
+{
+    ASSERT_TRUE(Record(9, Hash(0)));
+    ASSERT_TRUE(SpentTokenStore::Prune(UNIT, 9));
+    ASSERT_FALSE(IsSpent(9, Hash(0)));
+}
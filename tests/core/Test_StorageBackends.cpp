@@ -0,0 +1,69 @@
+#include "StorageFixture.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace opentxs;
+
+namespace
+{
+
+const int32_t SEEDS = 500;
+
+} // namespace
+
+TEST(Test_StorageBackends, unknown_backend)
+{
+    EXPECT_EQ(nullptr, test::Open("nonexistent", test::TempFolder()).get());
+}
+
+// Stores and reads back the same seeds with every compiled-in backend
+TEST(Test_StorageBackends, round_trip)
+{
+    for (const auto& backend : test::Backends()) {
+        const std::string folder = test::TempFolder();
+
+        {
+            auto storage = test::Open(backend, folder);
+            ASSERT_NE(nullptr, storage.get());
+            Storage::Batch batch(*storage);
+
+            for (int32_t i = 0; i < SEEDS; ++i) {
+                ASSERT_TRUE(storage->Store(test::MakeSeed(i), "alias"));
+            }
+
+            ASSERT_TRUE(batch.Commit());
+        }
+
+        // Reopened, so that every load reaches the backend
+        auto storage = test::Open(backend, folder);
+        ASSERT_NE(nullptr, storage.get());
+
+        for (int32_t i = 0; i < SEEDS; ++i) {
+            std::shared_ptr<proto::Seed> seed;
+
+            ASSERT_TRUE(storage->Load(test::Fingerprint(i), seed));
+            EXPECT_EQ("words" + std::to_string(i), seed->words());
+        }
+    }
+}
+
+#ifdef OT_STORAGE_LMDB
+TEST(Test_StorageBackends, lmdb_creates_folder)
+{
+    const std::string folder = test::TempFolder() + "/nested/lmdb";
+
+    {
+        auto storage = test::Open("lmdb", folder);
+        ASSERT_NE(nullptr, storage.get());
+        ASSERT_TRUE(storage->Store(test::MakeSeed(1), "alias"));
+    }
+
+    auto storage = test::Open("lmdb", folder);
+    ASSERT_NE(nullptr, storage.get());
+    std::shared_ptr<proto::Seed> seed;
+    ASSERT_TRUE(storage->Load(test::Fingerprint(1), seed));
+    EXPECT_EQ("words1", seed->words());
+}
+#endif // OT_STORAGE_LMDB
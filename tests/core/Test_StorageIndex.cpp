@@ -0,0 +1,256 @@
+#include "StorageFixture.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace opentxs;
+using namespace opentxs::test;
+
+namespace
+{
+
+// Enough seeds that the index splits below the first level of the trie
+const int32_t MANY = 2000;
+
+void StoreSeeds(Storage& storage, int32_t count)
+{
+    Storage::Batch batch(storage);
+
+    for (int32_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(storage.Store(MakeSeed(i), "alias" + std::to_string(i)));
+    }
+
+    ASSERT_TRUE(batch.Commit());
+}
+
+void ExpectSeeds(Storage& storage, int32_t count)
+{
+    for (int32_t i = 0; i < count; ++i) {
+        std::shared_ptr<proto::Seed> seed;
+        std::string alias;
+
+        ASSERT_TRUE(storage.Load(Fingerprint(i), seed, alias));
+        EXPECT_EQ("words" + std::to_string(i), seed->words());
+        EXPECT_EQ("alias" + std::to_string(i), alias);
+    }
+}
+
+} // namespace
+
+TEST(Test_StorageIndex, small_index_stays_flat)
+{
+    StorageConfig config;
+    Backend backend;
+
+    {
+        StorageMemory storage(config, backend);
+        StoreSeeds(storage, 10);
+    }
+
+    // A node without children is written as the v1 flat index protobuf
+    EXPECT_EQ(0u, backend.Records());
+
+    StorageMemory reopened(config, backend);
+    ExpectSeeds(reopened, 10);
+}
+
+TEST(Test_StorageIndex, split_and_lookup_at_depth)
+{
+    StorageConfig config;
+    Backend backend;
+
+    {
+        StorageMemory storage(config, backend);
+        StoreSeeds(storage, MANY);
+        ASSERT_TRUE(storage.SetDefaultSeed(Fingerprint(7)));
+        ExpectSeeds(storage, MANY);
+    }
+
+    // The root and every full child at the first level hold node records
+    EXPECT_LT(16u, backend.Records());
+
+    StorageMemory reopened(config, backend);
+    ExpectSeeds(reopened, MANY);
+    EXPECT_EQ(Fingerprint(7), reopened.DefaultSeed());
+}
+
+TEST(Test_StorageIndex, update_at_depth)
+{
+    StorageConfig config;
+    Backend backend;
+
+    {
+        StorageMemory storage(config, backend);
+        StoreSeeds(storage, MANY);
+        ASSERT_TRUE(storage.SetSeedAlias(Fingerprint(1234), "renamed"));
+    }
+
+    StorageMemory memory(config, backend);
+    Storage& reopened = memory;
+    std::shared_ptr<proto::Seed> seed;
+    std::string alias;
+
+    ASSERT_TRUE(reopened.Load(Fingerprint(1234), seed, alias));
+    EXPECT_EQ("renamed", alias);
+    ASSERT_TRUE(reopened.Load(Fingerprint(1235), seed, alias));
+    EXPECT_EQ("alias1235", alias);
+}
+
+TEST(Test_StorageIndex, corrupt_record_is_rejected)
+{
+    StorageConfig config;
+    Backend backend;
+
+    {
+        StorageMemory storage(config, backend);
+        StoreSeeds(storage, MANY);
+    }
+
+    // A record from a newer version must not be read as a leaf protobuf
+    for (auto& bucket : backend.buckets_) {
+        for (auto& it : bucket) {
+            if (0 == it.second.compare(0, RECORD.size(), RECORD)) {
+                it.second.replace(0, RECORD.size(), "otindex 3\n");
+            }
+        }
+    }
+
+    StorageMemory memory(config, backend);
+    Storage& reopened = memory;
+    std::shared_ptr<proto::Seed> seed;
+
+    EXPECT_DEATH(reopened.Load(Fingerprint(0), seed), "");
+}
+
+TEST(Test_StorageIndex, batch_writes_nothing_until_commit)
+{
+    StorageConfig config;
+    Backend backend;
+    StorageMemory storage(config, backend);
+    StoreSeeds(storage, 10);
+    const std::string root = backend.root_;
+    const auto objects = backend.buckets_[0].size();
+
+    {
+        Storage::Batch batch(storage);
+
+        // Staged, not stored
+        ASSERT_TRUE(storage.Store(MakeSeed(10), "alias10"));
+        EXPECT_EQ(root, backend.root_);
+        EXPECT_EQ(objects, backend.buckets_[0].size());
+
+        ASSERT_TRUE(batch.Commit());
+    }
+
+    EXPECT_NE(root, backend.root_);
+    ExpectSeeds(storage, 11);
+}
+
+TEST(Test_StorageIndex, failed_commit_rolls_back)
+{
+    StorageConfig config;
+    Backend backend;
+    StorageMemory storage(config, backend);
+    StoreSeeds(storage, 10);
+    const std::string root = backend.root_;
+
+    {
+        Storage::Batch batch(storage);
+
+        for (int32_t i = 10; i < 20; ++i) {
+            ASSERT_TRUE(storage.Store(MakeSeed(i), "alias"));
+        }
+
+        backend.fail_ = true;
+        EXPECT_FALSE(batch.Commit());
+        backend.fail_ = false;
+    }
+
+    EXPECT_EQ(root, backend.root_);
+    ExpectSeeds(storage, 10);
+
+    std::shared_ptr<proto::Seed> seed;
+    EXPECT_FALSE(storage.Load(Fingerprint(15), seed));
+
+    // Nothing from the failed batch is written with the next root
+    ASSERT_TRUE(storage.Store(MakeSeed(20), "alias20"));
+    StorageMemory memory(config, backend);
+    Storage& reopened = memory;
+    EXPECT_FALSE(reopened.Load(Fingerprint(15), seed));
+    ASSERT_TRUE(reopened.Load(Fingerprint(20), seed));
+    ExpectSeeds(reopened, 10);
+}
+
+// A write from another thread waits for an open batch, so a failed commit
+// can't discard it
+TEST(Test_StorageIndex, rollback_keeps_other_threads_writes)
+{
+    StorageConfig config;
+    Backend backend;
+    StorageMemory storage(config, backend);
+    StoreSeeds(storage, 10);
+    std::atomic<bool> stored(false);
+    bool result = false;
+    std::thread writer;
+
+    {
+        Storage::Batch batch(storage);
+
+        for (int32_t i = 10; i < 20; ++i) {
+            ASSERT_TRUE(storage.Store(MakeSeed(i), "alias"));
+        }
+
+        writer = std::thread([&]() {
+            result = storage.Store(MakeSeed(20), "alias20");
+            stored.store(true);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(stored.load());
+
+        backend.fail_ = true;
+        EXPECT_FALSE(batch.Commit());
+        backend.fail_ = false;
+    }
+
+    writer.join();
+
+    EXPECT_TRUE(result);
+    ExpectSeeds(storage, 10);
+
+    std::shared_ptr<proto::Seed> seed;
+    EXPECT_FALSE(storage.Load(Fingerprint(15), seed));
+    EXPECT_TRUE(storage.Load(Fingerprint(20), seed));
+}
+
+// Importing objects one at a time rewrites only one path through the trie,
+// so the bytes written per import grow with the depth of the trie rather
+// than with the size of the index
+TEST(Test_StorageIndex, import_cost)
+{
+    StorageConfig config;
+    const int32_t sizes[] = {500, 4000};
+    double perImport[2]{};
+
+    for (int32_t n = 0; n < 2; ++n) {
+        const int32_t size = sizes[n];
+        Backend backend;
+        StorageMemory storage(config, backend);
+
+        for (int32_t i = 0; i < size; ++i) {
+            ASSERT_TRUE(
+                storage.Store(MakeSeed(i), "alias" + std::to_string(i)));
+        }
+
+        perImport[n] = static_cast<double>(backend.written_) / size;
+
+        ExpectSeeds(storage, size);
+    }
+
+    // A flat index would write about eight times as much per import for an
+    // index eight times the size
+    EXPECT_GT(3 * perImport[0], perImport[1]);
+}
@@ -0,0 +1,98 @@
+#ifdef OT_STORAGE_SQLITE
+#include "StorageFixture.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace opentxs;
+
+namespace
+{
+
+const int32_t SEEDS = 200;
+const int32_t READERS = 4;
+
+void ExpectSeeds(Storage& storage, int32_t begin, int32_t end)
+{
+    for (int32_t i = begin; i < end; ++i) {
+        std::shared_ptr<proto::Seed> seed;
+
+        ASSERT_TRUE(storage.Load(test::Fingerprint(i), seed));
+        EXPECT_EQ("words" + std::to_string(i), seed->words());
+    }
+}
+
+} // namespace
+
+// Stores made one at a time and in a batch both reach the database
+TEST(Test_StorageSqlite3, single_and_batched_writes)
+{
+    auto database = test::Open("sqlite3", test::TempFolder());
+    ASSERT_NE(nullptr, database.get());
+    Storage& storage = *database;
+
+    for (int32_t i = 0; i < SEEDS; ++i) {
+        ASSERT_TRUE(storage.Store(test::MakeSeed(i), "alias"));
+    }
+
+    {
+        Storage::Batch batch(storage);
+
+        for (int32_t i = SEEDS; i < 2 * SEEDS; ++i) {
+            ASSERT_TRUE(storage.Store(test::MakeSeed(i), "alias"));
+        }
+
+        ASSERT_TRUE(batch.Commit());
+    }
+
+    ExpectSeeds(storage, 0, 2 * SEEDS);
+}
+
+// Every reader thread gets its own connection and statements, and sees
+// every seed
+TEST(Test_StorageSqlite3, concurrent_reads)
+{
+    auto database = test::Open("sqlite3", test::TempFolder());
+    ASSERT_NE(nullptr, database.get());
+    Storage& storage = *database;
+
+    {
+        Storage::Batch batch(storage);
+
+        for (int32_t i = 0; i < SEEDS; ++i) {
+            ASSERT_TRUE(storage.Store(test::MakeSeed(i), "alias"));
+        }
+
+        ASSERT_TRUE(batch.Commit());
+    }
+
+    const auto readAll = [&storage](int32_t& failures) {
+        for (int32_t i = 0; i < SEEDS; ++i) {
+            std::shared_ptr<proto::Seed> seed;
+
+            if (!storage.Load(test::Fingerprint(i), seed) ||
+                ("words" + std::to_string(i) != seed->words())) {
+                ++failures;
+            }
+        }
+    };
+
+    std::vector<int32_t> threadFailures(READERS, 0);
+    std::vector<std::thread> threads;
+
+    for (int32_t i = 0; i < READERS; ++i) {
+        threads.emplace_back(readAll, std::ref(threadFailures[i]));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& count : threadFailures) {
+        EXPECT_EQ(0, count);
+    }
+}
+#endif // OT_STORAGE_SQLITE
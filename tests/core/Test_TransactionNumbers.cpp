@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <opentxs/core/String.hpp>
+#include <opentxs/core/TransactionNumbers.hpp>
+
+using namespace opentxs;
+
+namespace
+{
+
+std::string Output(const TransactionNumbers& numbers, bool bRanges)
+{
+    String output;
+    numbers.Output(output, bRanges);
+
+    return output.Get();
+}
+
+} // namespace
+
+TEST(TransactionNumbers, empty)
+{
+    TransactionNumbers numbers;
+    String output;
+    ASSERT_TRUE(numbers.empty());
+    ASSERT_FALSE(numbers.Output(output));
+}
+
+TEST(TransactionNumbers, add_merges_adjacent)
+{
+    TransactionNumbers numbers;
+    ASSERT_TRUE(numbers.Add(5));
+    ASSERT_TRUE(numbers.Add(7));
+    ASSERT_TRUE(numbers.Add(6));
+    ASSERT_FALSE(numbers.Add(6));
+    ASSERT_EQ(3u, numbers.size());
+    ASSERT_EQ(1u, numbers.RangeCount());
+    ASSERT_EQ("5-7", Output(numbers, true));
+}
+
+TEST(TransactionNumbers, remove_splits_range)
+{
+    TransactionNumbers numbers;
+    ASSERT_TRUE(numbers.Insert(1, 10));
+    ASSERT_TRUE(numbers.Remove(5));
+    ASSERT_FALSE(numbers.Remove(5));
+    ASSERT_FALSE(numbers.Contains(5));
+    ASSERT_TRUE(numbers.Contains(4));
+    ASSERT_TRUE(numbers.Contains(6));
+    ASSERT_EQ(9u, numbers.size());
+    ASSERT_EQ("1-4,6-10", Output(numbers, true));
+}
+
+TEST(TransactionNumbers, output_list_by_default)
+{
+    TransactionNumbers numbers;
+    numbers.Insert(3, 6);
+    numbers.Add(9);
+    ASSERT_EQ("3,4,5,6,9", Output(numbers, false));
+    ASSERT_EQ("3-6,9", Output(numbers, true));
+}
+
+TEST(TransactionNumbers, round_trip_both_formats)
+{
+    TransactionNumbers numbers;
+    numbers.Insert(100, 199);
+    numbers.Add(250);
+    numbers.Insert(300, 302);
+
+    for (const bool bRanges : {false, true}) {
+        String output;
+        ASSERT_TRUE(numbers.Output(output, bRanges));
+        TransactionNumbers loaded;
+        ASSERT_TRUE(loaded.Load(output));
+        ASSERT_EQ(numbers.size(), loaded.size());
+        ASSERT_EQ(Output(numbers, true), Output(loaded, true));
+    }
+}
+
+TEST(TransactionNumbers, load_overlapping_ranges)
+{
+    TransactionNumbers numbers;
+    ASSERT_TRUE(numbers.Load(String("10-20, 15-25,26,5-9,40")));
+    ASSERT_EQ(23u, numbers.size());
+    ASSERT_EQ("5-26,40", Output(numbers, true));
+    ASSERT_EQ(5, numbers.Lowest());
+    ASSERT_EQ(40, numbers.Highest());
+    ASSERT_EQ(5, numbers.at(0));
+    ASSERT_EQ(40, numbers.at(22));
+}
+
+TEST(TransactionNumbers, load_rejects_malformed)
+{
+    const char* inputs[] = {"1,x", "5-3", "-4", "1-", "1-2-3", "3 4",
+                            "99999999999999999999", "1-99999999999999999999"};
+
+    for (const char* input : inputs) {
+        TransactionNumbers numbers;
+        numbers.Add(1000);
+        ASSERT_FALSE(numbers.Load(String(input))) << input;
+        // all or nothing
+        ASSERT_EQ(1u, numbers.size()) << input;
+    }
+}
+
+TEST(TransactionNumbers, load_limit)
+{
+    TransactionNumbers numbers;
+    ASSERT_FALSE(numbers.Load(String("1-9223372036854775806"), 1000));
+    ASSERT_TRUE(numbers.empty());
+    ASSERT_FALSE(numbers.Load(String("1-600,700-1100"), 1000));
+    ASSERT_TRUE(numbers.empty());
+    ASSERT_TRUE(numbers.Load(String("1-600,700-1099"), 1000));
+    ASSERT_EQ(1000u, numbers.size());
+}
+
+TEST(TransactionNumbers, insert_set)
+{
+    TransactionNumbers numbers;
+    numbers.Insert(1, 5);
+    numbers.Insert(20, 30);
+    TransactionNumbers other;
+    other.Insert(4, 12);
+    other.Insert(INT64_MAX - 1, INT64_MAX);
+    numbers.Insert(other);
+    ASSERT_EQ("1-12,20-30,9223372036854775806-9223372036854775807",
+              Output(numbers, true));
+    ASSERT_EQ(25u, numbers.size());
+    ASSERT_FALSE(numbers.Insert(8, 7));
+}
+
+TEST(TransactionNumbers, trim_lowest)
+{
+    TransactionNumbers numbers;
+    numbers.Insert(1, 1000000000);
+    numbers.Add(2000000000);
+    numbers.TrimLowest(100);
+    ASSERT_EQ(100u, numbers.size());
+    ASSERT_EQ(999999902, numbers.Lowest());
+    ASSERT_EQ(2000000000, numbers.Highest());
+    numbers.TrimLowest(1);
+    ASSERT_EQ("2000000000", Output(numbers, true));
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <opentxs/core/util/Workers.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace opentxs;
+
+TEST(Test_Workers, every_call_runs_once)
+{
+    const std::size_t count = 64;
+    std::vector<std::atomic<int>> calls(count);
+
+    for (auto& call : calls) {
+        call.store(0);
+    }
+
+    RunWorkers(count, [&calls](std::size_t i) { calls[i]++; });
+
+    for (auto& call : calls) {
+        EXPECT_EQ(1, call.load());
+    }
+}
+
+// Threads are reused from one call to the next, instead of each call
+// starting its own
+TEST(Test_Workers, threads_are_shared)
+{
+    std::mutex lock;
+    std::set<std::thread::id> threads;
+
+    for (int i = 0; i < 100; ++i) {
+        RunWorkers(WorkerCount(0), [&](std::size_t) {
+            std::lock_guard<std::mutex> guard(lock);
+            threads.insert(std::this_thread::get_id());
+        });
+    }
+
+    EXPECT_GE(WorkerCount(0), threads.size());
+}
+
+// A worker may itself call RunWorkers, and more calls than threads may be
+// running at once
+TEST(Test_Workers, nested_calls_finish)
+{
+    const std::size_t outer = 4 * WorkerCount(0);
+    std::atomic<std::size_t> total(0);
+    std::vector<std::thread> callers;
+
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&]() {
+            RunWorkers(outer, [&](std::size_t) {
+                RunWorkers(8, [&](std::size_t) { total++; });
+            });
+        });
+    }
+
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    EXPECT_EQ(4 * outer * 8, total.load());
+}